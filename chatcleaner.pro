@@ -17,23 +17,11 @@ INCLUDEPATH += src/ \
 DEPENDPATH += src/ \
 	src/chatcleaner/ \
 	src/net/
+# The message filter is part of pokerth_lib, so that the server can
+# also use it directly.
 SOURCES += src/chatcleaner/chatcleaner.cpp \
-	src/chatcleaner/cleanerserver.cpp \
-	src/chatcleaner/messagefilter.cpp \
-	src/chatcleaner/badwordcheck.cpp \
-	src/chatcleaner/textfloodcheck.cpp \
-	src/chatcleaner/cleanerconfig.cpp \
-	src/chatcleaner/capsfloodcheck.cpp \
-	src/chatcleaner/letterrepeatingcheck.cpp \
-	src/chatcleaner/urlcheck.cpp
-HEADERS += src/chatcleaner/cleanerserver.h \
-	src/chatcleaner/messagefilter.h \
-	src/chatcleaner/badwordcheck.h \
-	src/chatcleaner/textfloodcheck.h \
-	src/chatcleaner/cleanerconfig.h \
-	src/chatcleaner/capsfloodcheck.h \
-	src/chatcleaner/letterrepeatingcheck.h \
-	src/chatcleaner/urlcheck.h
+	src/chatcleaner/cleanerserver.cpp
+HEADERS += src/chatcleaner/cleanerserver.h
 LIBPATH += lib
 LIBS += -lpokerth_lib \
 	-lpokerth_protocol \
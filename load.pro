@@ -19,18 +19,21 @@ QT -= core gui
 
 INCLUDEPATH += . \
 		src \
-		src/third_party/asn1
+		src/third_party/websocketpp
 
 DEPENDPATH += . \
-		src \
-		src/third_party/asn1
+		src
 
 # Input
 HEADERS += \
-		src/game_defs.h
+		src/game_defs.h \
+		src/net/netpacket.h \
+		src/tests/loadclient.h \
+		src/third_party/protobuf/pokerth.pb.h
 
 SOURCES += \
-		src/load.cpp
+		src/load.cpp \
+		src/tests/loadclient.cpp
 
 LIBS += -lpokerth_protocol
 
@@ -39,6 +42,7 @@ unix : !mac {
 	##### My release static build options
 	#QMAKE_CXXFLAGS += -ffunction-sections -fdata-sections
 	#QMAKE_LFLAGS += -Wl,--gc-sections
+	QMAKE_CXXFLAGS += -std=gnu++11
 
 	QMAKE_LIBDIR += lib $${PREFIX}/lib /opt/gsasl/lib
 	INCLUDEPATH += $${PREFIX}/include
@@ -91,7 +95,7 @@ unix : !mac {
 	kFreeBSD = $$find(UNAME, "kFreeBSD")
 
 	LIBS += $$BOOST_LIBS
-	LIBS += -lgsasl
+	LIBS += -lprotobuf
 
 	POST_TARGETDEPS += ./lib/libpokerth_protocol.a
 
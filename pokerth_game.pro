@@ -203,6 +203,7 @@ HEADERS += src/engine/game.h \
 	src/gui/qt/gametable/mytimeoutlabel.h \
 	src/gui/qt/gametable/mynamelabel.h \
 	src/gui/qt/settingsdialog/mystylelistitem.h \
+	src/gui/qt/gamelobbydialog/mygamelistmodel.h \
 	src/gui/qt/gamelobbydialog/mygamelistsortfilterproxymodel.h \
 	src/gui/qt/internetgamelogindialog/internetgamelogindialogimpl.h \
 	src/engine/local_engine/replay.h \
@@ -279,6 +280,7 @@ SOURCES += src/pokerth.cpp \
 	src/gui/qt/gametable/mytimeoutlabel.cpp \
 	src/gui/qt/gametable/mynamelabel.cpp \
 	src/gui/qt/settingsdialog/mystylelistitem.cpp \
+	src/gui/qt/gamelobbydialog/mygamelistmodel.cpp \
 	src/gui/qt/gamelobbydialog/mygamelistsortfilterproxymodel.cpp \
 	src/gui/qt/internetgamelogindialog/internetgamelogindialogimpl.cpp \
 	src/engine/local_engine/replay.cpp \
@@ -508,7 +510,8 @@ unix:!mac {
 		kFreeBSD = $$find(UNAME, "kFreeBSD")
 		LIBS += -lsqlite3 \
 				-ltinyxml \
-				-lprotobuf
+				-lprotobuf \
+				-lz
 		LIBS += $$BOOST_LIBS
 		LIBS += -lSDL \
 				-lSDL_mixer \
@@ -63,6 +63,15 @@ HEADERS += \
 		src/gui/guiinterface.h \
 		src/net/chatcleanermanager.h \
 		src/net/chatcleanercallback.h \
+		src/net/chatfilterthread.h \
+		src/chatcleaner/ahocorasick.h \
+		src/chatcleaner/badwordcheck.h \
+		src/chatcleaner/capsfloodcheck.h \
+		src/chatcleaner/cleanerconfig.h \
+		src/chatcleaner/letterrepeatingcheck.h \
+		src/chatcleaner/messagefilter.h \
+		src/chatcleaner/textfloodcheck.h \
+		src/chatcleaner/urlcheck.h \
 		src/net/clientcallback.h \
 		src/net/clientcontext.h \
 		src/net/clientexception.h \
@@ -79,8 +88,13 @@ HEADERS += \
 		src/net/serveracceptwebhelper.h \
 		src/net/servergame.h \
 		src/net/servergamestate.h \
+		src/net/serverspectatorfanout.h \
+		src/net/serverauthpool.h \
+		src/net/serverauthcache.h \
 		src/net/serverlobbythread.h \
 		src/net/serverbanmanager.h \
+		src/net/namepatternmatcher.h \
+		src/net/ipaddresstrie.h \
 		src/net/servercallback.h \
 		src/net/serveradminbot.h \
 		src/net/serverlobbybot.h \
@@ -98,10 +112,10 @@ HEADERS += \
 		src/net/transferdata.h \
 		src/net/transferhelper.h \
 		src/net/uploaderthread.h \
-		src/net/uploadhelper.h \
 		src/net/downloaderthread.h \
 		src/net/downloadhelper.h \
 		src/engine/local_engine/cardsvalue.h \
+		src/engine/local_engine/boardoddscache.h \
 		src/engine/local_engine/localboard.h \
 		src/engine/local_engine/localenginefactory.h \
 		src/engine/local_engine/localhand.h \
@@ -116,6 +130,7 @@ HEADERS += \
 		src/engine/local_engine/localexception.h \
 		src/engine/local_engine/arraydata.h \
 		src/engine/log.h \
+		src/engine/handhistory.h \
 		src/engine/network_engine/clientboard.h \
 		src/engine/network_engine/clientenginefactory.h \
 		src/engine/network_engine/clienthand.h \
@@ -138,6 +153,7 @@ HEADERS += \
 		src/net/uploadcallback.h \
 		src/net/websocket_defs.h \
 		src/net/websocketdata.h \
+		src/net/websocketdeflate.h \
     src/net/validation/lobbymessagevalidator.h \
     src/net/validation/authmessagevalidator.h \
     src/net/validation/gamemessagevalidator.h \
@@ -162,6 +178,7 @@ SOURCES += \
 		src/core/common/avatarmanager.cpp \
 		src/core/common/pokerthexception.cpp \
 		src/engine/local_engine/cardsvalue.cpp \
+		src/engine/local_engine/boardoddscache.cpp \
 		src/engine/local_engine/localboard.cpp \
 		src/engine/local_engine/localenginefactory.cpp \
 		src/engine/local_engine/localhand.cpp \
@@ -175,6 +192,7 @@ SOURCES += \
 		src/engine/local_engine/localexception.cpp \
 		src/engine/local_engine/arraydata.cpp \
 		src/engine/log.cpp \
+		src/engine/handhistory.cpp \
 		src/engine/network_engine/clientboard.cpp \
 		src/engine/network_engine/clientenginefactory.cpp \
 		src/engine/network_engine/clienthand.cpp \
@@ -182,6 +200,15 @@ SOURCES += \
 		src/engine/network_engine/clientbero.cpp \
 		src/net/common/chatcleanermanager.cpp \
 		src/net/common/chatcleanercallback.cpp \
+		src/net/common/chatfilterthread.cpp \
+		src/chatcleaner/ahocorasick.cpp \
+		src/chatcleaner/badwordcheck.cpp \
+		src/chatcleaner/capsfloodcheck.cpp \
+		src/chatcleaner/cleanerconfig.cpp \
+		src/chatcleaner/letterrepeatingcheck.cpp \
+		src/chatcleaner/messagefilter.cpp \
+		src/chatcleaner/textfloodcheck.cpp \
+		src/chatcleaner/urlcheck.cpp \
 		src/net/common/clientcallback.cpp \
 		src/net/common/clientcontext.cpp \
 		src/net/common/clientstate.cpp \
@@ -196,9 +223,14 @@ SOURCES += \
 		src/net/common/serveracceptwebhelper.cpp \
 		src/net/common/servergame.cpp \
 		src/net/common/servergamestate.cpp \
+		src/net/common/serverspectatorfanout.cpp \
+		src/net/common/serverauthpool.cpp \
+		src/net/common/serverauthcache.cpp \
 		src/net/common/serverlobbythread.cpp \
 		src/net/common/serverdelaytime.cpp \
 		src/net/common/serverbanmanager.cpp \
+		src/net/common/namepatternmatcher.cpp \
+		src/net/common/ipaddresstrie.cpp \
 		src/net/common/servercallback.cpp \
 		src/net/common/serveradminbot.cpp \
 		src/net/common/serverlobbybot.cpp \
@@ -214,7 +246,6 @@ SOURCES += \
 		src/net/common/servermanager.cpp \
 		src/net/common/transferhelper.cpp \
 		src/net/common/uploaderthread.cpp \
-		src/net/common/uploadhelper.cpp \
 		src/gui/generic/serverguiwrapper.cpp \
 		src/gui/qttoolsinterface.cpp \
 		src/net/common/sendbuffer.cpp \
@@ -274,7 +274,8 @@ unix : !mac {
 	LIBS += $$BOOST_LIBS
 	LIBS += -lsqlite3 \
 			-ltinyxml \
-			-lprotobuf
+			-lprotobuf \
+			-lz
 	LIBS += -lgsasl
 	!isEmpty( BSD ): isEmpty( kFreeBSD ){
 		LIBS += -lcrypto -liconv
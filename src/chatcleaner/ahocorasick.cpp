@@ -0,0 +1,219 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+#include "ahocorasick.h"
+
+#include <algorithm>
+#include <deque>
+
+using namespace std;
+
+AhoCorasick::AhoCorasick()
+	: nodes(1), numPatterns(0), built(true)
+{
+}
+
+void AhoCorasick::clear()
+{
+	nodes.assign(1, Node());
+	nodePatterns.clear();
+	outputs.clear();
+	numPatterns = 0;
+	built = true;
+}
+
+unsigned AhoCorasick::addPattern(const string &pattern)
+{
+	unsigned patternId = numPatterns++;
+	// Empty patterns are never reported.
+	if (!pattern.empty()) {
+		unsigned cur = 0;
+		for (string::const_iterator i = pattern.begin(); i != pattern.end(); ++i) {
+			unsigned char c = static_cast<unsigned char>(*i);
+			unsigned child = findChild(cur, c);
+			if (!child) {
+				child = nodes.size();
+				nodes[cur].next.push_back(make_pair(c, child));
+				nodes.push_back(Node());
+			}
+			cur = child;
+		}
+		if (nodePatterns.size() < nodes.size())
+			nodePatterns.resize(nodes.size());
+		nodePatterns[cur].push_back(patternId);
+	}
+	built = false;
+	return patternId;
+}
+
+void AhoCorasick::build()
+{
+	nodePatterns.resize(nodes.size());
+	outputs.clear();
+
+	// Breadth first, so that the failure node of each node is done before it.
+	deque<unsigned> queue;
+	vector<Node>::iterator root = nodes.begin();
+	sort(root->next.begin(), root->next.end());
+	for (TransitionList::const_iterator i = root->next.begin(); i != root->next.end(); ++i) {
+		nodes[i->second].fail = 0;
+		queue.push_back(i->second);
+	}
+	while (!queue.empty()) {
+		unsigned cur = queue.front();
+		queue.pop_front();
+		Node &node = nodes[cur];
+		sort(node.next.begin(), node.next.end());
+
+		// Outputs of a node are its own patterns followed by those of its failure node.
+		node.firstOutput = outputs.size();
+		outputs.insert(outputs.end(), nodePatterns[cur].begin(), nodePatterns[cur].end());
+		const Node &failNode = nodes[node.fail];
+		for (unsigned j = 0; j < failNode.numOutputs; j++)
+			outputs.push_back(outputs[failNode.firstOutput + j]);
+		node.numOutputs = outputs.size() - node.firstOutput;
+
+		for (TransitionList::const_iterator i = node.next.begin(); i != node.next.end(); ++i) {
+			nodes[i->second].fail = step(node.fail, i->first);
+			queue.push_back(i->second);
+		}
+	}
+	nodePatterns.clear();
+	built = true;
+}
+
+bool AhoCorasick::scan(const string &text, vector<char> &found, bool fold) const
+{
+	found.assign(numPatterns, 0);
+	if (!built)
+		return false;
+
+	bool retVal = false;
+	unsigned cur = 0;
+	string::const_iterator i = text.begin();
+	while (i != text.end()) {
+		unsigned char c = static_cast<unsigned char>(*i);
+		++i;
+		if (fold) {
+			if (c < 0x80) {
+				if (c >= 'A' && c <= 'Z')
+					c += 'a' - 'A';
+			} else if ((c & 0xE0) == 0xC0 && i != text.end()) {
+				// Fold the two byte sequence and feed its first byte now.
+				unsigned cp = foldCodePoint(((c & 0x1F) << 6) | (static_cast<unsigned char>(*i) & 0x3F));
+				++i;
+				cur = step(cur, static_cast<unsigned char>(0xC0 | (cp >> 6)));
+				retVal |= markOutputs(cur, found);
+				c = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+			}
+		}
+		cur = step(cur, c);
+		retVal |= markOutputs(cur, found);
+	}
+	return retVal;
+}
+
+string AhoCorasick::foldCase(const string &text)
+{
+	string result;
+	result.reserve(text.size());
+	string::const_iterator i = text.begin();
+	while (i != text.end()) {
+		unsigned char c = static_cast<unsigned char>(*i);
+		if (c < 0x80) {
+			result += static_cast<char>((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+			++i;
+		} else if ((c & 0xE0) == 0xC0 && i + 1 != text.end()) {
+			unsigned cp = foldCodePoint(((c & 0x1F) << 6) | (static_cast<unsigned char>(*(i + 1)) & 0x3F));
+			result += static_cast<char>(0xC0 | (cp >> 6));
+			result += static_cast<char>(0x80 | (cp & 0x3F));
+			i += 2;
+		} else {
+			result += *i;
+			++i;
+		}
+	}
+	return result;
+}
+
+unsigned AhoCorasick::foldCodePoint(unsigned cp)
+{
+	// Only two byte sequences contain letters with simple case mapping.
+	if ((cp >= 0xC0 && cp <= 0xDE && cp != 0xD7)
+			|| (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2)
+			|| (cp >= 0x410 && cp <= 0x42F)) {
+		cp += 0x20;
+	} else if (cp >= 0x400 && cp <= 0x40F) {
+		cp += 0x50;
+	} else if (cp == 0x178) {
+		cp = 0xFF;
+	} else if (cp >= 0x100 && cp <= 0x17F && cp != 0x130 && cp != 0x131 && cp != 0x138 && cp != 0x149 && cp != 0x17F) {
+		// Latin Extended-A: pairs start at even code points, except
+		// the range U+0139 to U+0148 and U+0179 to U+017E.
+		bool oddUpper = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+		if ((cp & 1) == (oddUpper ? 1u : 0u))
+			cp++;
+	}
+	return cp;
+}
+
+bool AhoCorasick::markOutputs(unsigned node, vector<char> &found) const
+{
+	const Node &n = nodes[node];
+	for (unsigned j = 0; j < n.numOutputs; j++)
+		found[outputs[n.firstOutput + j]] = 1;
+	return n.numOutputs != 0;
+}
+
+unsigned AhoCorasick::findChild(unsigned node, unsigned char c) const
+{
+	const TransitionList &next = nodes[node].next;
+	if (built) {
+		TransitionList::const_iterator pos = lower_bound(next.begin(), next.end(), make_pair(c, 0u));
+		if (pos != next.end() && pos->first == c)
+			return pos->second;
+	} else {
+		for (TransitionList::const_iterator i = next.begin(); i != next.end(); ++i) {
+			if (i->first == c)
+				return i->second;
+		}
+	}
+	return 0;
+}
+
+unsigned AhoCorasick::step(unsigned node, unsigned char c) const
+{
+	while (true) {
+		unsigned child = findChild(node, c);
+		if (child || node == 0)
+			return child;
+		node = nodes[node].fail;
+	}
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+#ifndef AHOCORASICK_H
+#define AHOCORASICK_H
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// Multi pattern matcher over UTF-8 byte strings. Patterns are added first,
+// then build() compiles the automaton. scan() walks the text once and marks
+// every pattern which occurs in it. Case folding is left to the caller,
+// foldCase() can be used for patterns and text.
+class AhoCorasick
+{
+public:
+	AhoCorasick();
+
+	void clear();
+	// Returns the index of the pattern, which is used by scan().
+	unsigned addPattern(const std::string &pattern);
+	void build();
+
+	unsigned getNumPatterns() const {
+		return numPatterns;
+	}
+
+	// found is resized to getNumPatterns(), found[i] is set if pattern i occurs.
+	// Returns true if any pattern was found. If fold is set, the text is
+	// case folded on the fly like foldCase() does.
+	bool scan(const std::string &text, std::vector<char> &found, bool fold = false) const;
+
+	// Lower case conversion of UTF-8 text for Latin, Greek and Cyrillic letters.
+	static std::string foldCase(const std::string &text);
+
+private:
+	typedef std::vector<std::pair<unsigned char, unsigned> > TransitionList;
+
+	struct Node {
+		Node() : fail(0), firstOutput(0), numOutputs(0) {}
+		TransitionList next;
+		unsigned fail;
+		unsigned firstOutput;
+		unsigned numOutputs;
+	};
+
+	static unsigned foldCodePoint(unsigned cp);
+	bool markOutputs(unsigned node, std::vector<char> &found) const;
+	unsigned findChild(unsigned node, unsigned char c) const;
+	unsigned step(unsigned node, unsigned char c) const;
+
+	std::vector<Node> nodes;
+	std::vector<std::vector<unsigned> > nodePatterns;
+	std::vector<unsigned> outputs;
+	unsigned numPatterns;
+	bool built;
+};
+
+#endif // AHOCORASICK_H
@@ -30,33 +30,59 @@
  *****************************************************************************/
 #include "badwordcheck.h"
 
-#include <QtCore>
+using namespace std;
 
 BadWordCheck::BadWordCheck()
+	: numBadWords(0)
 {
 }
 
-bool BadWordCheck::run(QString msg)
+void BadWordCheck::setBadWords(const list<string> &bw, const list<string> &bwe)
 {
-	msg = msg.toLower();
-	bool badMessage(false);
+	matcher.clear();
+	list<string>::const_iterator it = bw.begin();
+	while (it != bw.end()) {
+		matcher.addPattern(AhoCorasick::foldCase(*it));
+		++it;
+	}
+	numBadWords = matcher.getNumPatterns();
+	vector<string> exceptionStrings;
+	list<string>::const_iterator it2 = bwe.begin();
+	while (it2 != bwe.end()) {
+		exceptionStrings.push_back(AhoCorasick::foldCase(*it2));
+		matcher.addPattern(exceptionStrings.back());
+		++it2;
+	}
+	matcher.build();
 
-	QStringListIterator it(badWords);
-	while (it.hasNext()) {
-		QString bw=it.next();
-		if(msg.contains(bw)) {
-			badMessage=true;
-			//exception check
-			QStringListIterator it2(badWordsException);
-			while (it2.hasNext()) {
-				QString bwe=it2.next();
-				if(bwe.contains(bw) && msg.contains(bwe)) {
-					badMessage=false;
+	// Scanning an exception with the automaton yields the bad words it contains.
+	exceptionsOfBadWord.assign(numBadWords, vector<unsigned>());
+	for (unsigned i = 0; i < exceptionStrings.size(); i++) {
+		matcher.scan(exceptionStrings[i], found);
+		for (unsigned j = 0; j < numBadWords; j++) {
+			if (found[j]) exceptionsOfBadWord[j].push_back(numBadWords + i);
+		}
+	}
+}
+
+bool BadWordCheck::run(const string &msg) const
+{
+	if (!matcher.scan(msg, found, true)) return false;
+
+	// A bad word is ok if an exception containing it is part of the message.
+	for (unsigned i = 0; i < numBadWords; i++) {
+		if (found[i]) {
+			bool exception = false;
+			vector<unsigned>::const_iterator it = exceptionsOfBadWord[i].begin();
+			while (it != exceptionsOfBadWord[i].end()) {
+				if (found[*it]) {
+					exception = true;
+					break;
 				}
+				++it;
 			}
+			if (!exception) return true;
 		}
 	}
-
-	if(badMessage) return true;
-	else return false;
+	return false;
 }
@@ -31,28 +31,28 @@
 #ifndef BADWORDCHECK_H
 #define BADWORDCHECK_H
 
-#include <QtCore>
+#include <list>
+#include <string>
+#include <vector>
+#include "ahocorasick.h"
 
-class BadWordCheck: public QObject
+class BadWordCheck
 {
-	Q_OBJECT
 public:
 	BadWordCheck();
 
-	void setBadWords(QStringList bw) {
-		badWords = bw;
-	}
+	void setBadWords(const std::list<std::string> &bw, const std::list<std::string> &bwe);
 
-	void setBadWordsException(QStringList bwe) {
-		badWordsException = bwe;
-	}
-
-	bool run(QString);
+	bool run(const std::string &msg) const;
 
 private:
-
-	QStringList badWords;
-	QStringList badWordsException;
+	// Bad words and exceptions in one automaton, exceptions follow the bad words.
+	AhoCorasick matcher;
+	// Scan result, kept to avoid allocations.
+	mutable std::vector<char> found;
+	unsigned numBadWords;
+	// For each bad word the ids of the exceptions containing it.
+	std::vector<std::vector<unsigned> > exceptionsOfBadWord;
 };
 
 #endif // BADWORDCHECK_H
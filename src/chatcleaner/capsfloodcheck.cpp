@@ -30,24 +30,28 @@
  *****************************************************************************/
 #include "capsfloodcheck.h"
 
-#include <QtCore>
+#include <cctype>
+
+using namespace std;
 
 CapsFloodCheck::CapsFloodCheck()
 	: capsNumberToTrigger(0)
 {
 }
 
-bool CapsFloodCheck::run(QString msg)
+bool CapsFloodCheck::run(const string &msg) const
 {
-	msg = msg.simplified().remove(" ");
-	QRegExp e(QString("[A-Z]{%1,}").arg(capsNumberToTrigger));
-	if(e.isValid()) {
-		e.setCaseSensitivity(Qt::CaseSensitive);
-		e.indexIn(msg);
-		if(e.matchedLength() != -1 ) return true;
-		else return false;
-	} else {
-//		qDebug() << "The current Caps Flood RegExp is invalid" << endl;
-		return false;
+	// Look for capsNumberToTrigger capital letters in a row, white space is ignored.
+	if (capsNumberToTrigger < 0) return false;
+	if (capsNumberToTrigger == 0) return true;
+	int numCaps = 0;
+	for (string::const_iterator i = msg.begin(); i != msg.end(); ++i) {
+		char c = *i;
+		if (c >= 'A' && c <= 'Z') {
+			if (++numCaps >= capsNumberToTrigger) return true;
+		} else if (!isspace(static_cast<unsigned char>(c))) {
+			numCaps = 0;
+		}
 	}
+	return false;
 }
@@ -31,18 +31,17 @@
 #ifndef CAPSFLOODCHECK_H
 #define CAPSFLOODCHECK_H
 
-#include <QtCore>
+#include <string>
 
-class CapsFloodCheck: public QObject
+class CapsFloodCheck
 {
-	Q_OBJECT
 public:
 	CapsFloodCheck();
 
 	void setCapsNumberToTrigger(int n) {
 		capsNumberToTrigger = n;
 	}
-	bool run(QString);
+	bool run(const std::string &msg) const;
 
 private:
 
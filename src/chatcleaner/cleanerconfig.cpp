@@ -29,7 +29,6 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 #include "cleanerconfig.h"
-#include <QtCore>
 
 #include <tinyxml.h>
 
@@ -267,7 +266,7 @@ void CleanerConfig::fillBuffer()
 					}
 				}
 			} else {
-				qDebug("Could not find the root element in the config file!");
+				cerr << "Could not find the root element in the config file!" << endl;
 			}
 		}
 	}
@@ -450,7 +449,7 @@ void CleanerConfig::updateConfig(ConfigState myConfigState)
 			}
 			newDoc.SaveFile( configFileName );
 		} else {
-			qDebug("Cannot update config file: Unable to load configuration.");
+			cerr << "Cannot update config file: Unable to load configuration." << endl;
 		}
 
 
@@ -608,21 +607,27 @@ void CleanerConfig::writeConfigString(string varName, string varCont)
 }
 std::string CleanerConfig::stringToUtf8(const std::string &myString)
 {
-
-	QString tmpString = QString::fromStdString(myString);
-	std::string myUtf8String = tmpString.toUtf8().constData();
-
-	return myUtf8String;
+	// Config values are kept as UTF-8.
+	return myString;
 }
 
 std::string CleanerConfig::stringFromUtf8(const std::string &myString)
 {
-	QString tmpString = QString::fromUtf8(myString.c_str());
-
-	return tmpString.toStdString();
+	return myString;
 }
 
 std::string CleanerConfig::getDefaultLanguage()
 {
-	return QLocale::system().name().toStdString();
+	// Same format as QLocale::name(), e.g. "de_DE". The variables are checked
+	// in the order of the POSIX locale lookup, empty values are ignored.
+	const char *lang = getenv("LC_ALL");
+	if (!lang || !*lang)
+		lang = getenv("LC_MESSAGES");
+	if (!lang || !*lang)
+		lang = getenv("LANG");
+	string langStr(lang ? lang : "");
+	langStr = langStr.substr(0, langStr.find_first_of(".@"));
+	if (langStr.empty() || langStr == "POSIX")
+		langStr = "C";
+	return langStr;
 }
@@ -42,7 +42,7 @@
 
 using namespace std;
 
-CleanerServer::CleanerServer(): config(0), blockConnection(false), m_recvBufUsed(0), secondsSinceLastConfigChange(0)
+CleanerServer::CleanerServer(): configRefreshTimer(0), config(0), blockConnection(false), m_recvBufUsed(0), secondsSinceLastConfigChange(0)
 {
 	config = new CleanerConfig;
 
@@ -170,15 +170,12 @@ bool CleanerServer::handleMessage(ChatCleanerMessage &msg)
 		error = false;
 		const CleanerChatRequestMessage &netRequest = msg.cleanerchatrequestmessage();
 		unsigned playerId = netRequest.playerid();
-		QString nick(QString::fromUtf8(netRequest.playername().c_str()));
-		QString message(QString::fromUtf8(netRequest.chatmessage().c_str()));
 		unsigned gameId = netRequest.gameid();
 
-		QStringList checkreturn = myMessageFilter->check(gameId, playerId, nick, message);
-		QString checkAction = checkreturn.at(0);
-		QString checkMessage = checkreturn.at(1);
+		string checkMessage;
+		MessageFilterAction checkAction = myMessageFilter->check(gameId, playerId, netRequest.playername(), netRequest.chatmessage(), checkMessage);
 
-		if (!checkAction.isEmpty()) {
+		if (checkAction != FILTER_ACTION_NOTHING) {
 			boost::shared_ptr<ChatCleanerMessage> tmpReply(ChatCleanerMessage::default_instance().New());
 			tmpReply->set_messagetype(ChatCleanerMessage::Type_CleanerChatReplyMessage);
 			CleanerChatReplyMessage *netReply = tmpReply->mutable_cleanerchatreplymessage();
@@ -187,17 +184,17 @@ bool CleanerServer::handleMessage(ChatCleanerMessage &msg)
 			netReply->set_cleanerchattype(netRequest.cleanerchattype());
 			netReply->set_playerid(netRequest.playerid());
 
-			if(checkAction == "warn") {
+			if(checkAction == FILTER_ACTION_WARN) {
 				netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionWarning);
-			} else if (checkAction == "kick") {
+			} else if (checkAction == FILTER_ACTION_KICK) {
 				netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionKick);
-			} else if (checkAction == "kickban") {
+			} else if (checkAction == FILTER_ACTION_KICKBAN) {
 				netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionBan);
-			} else if (checkAction == "mute") {
+			} else if (checkAction == FILTER_ACTION_MUTE) {
 				netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionMute);
 			}
 
-			netReply->set_cleanertext(checkMessage.toUtf8());
+			netReply->set_cleanertext(checkMessage);
 			sendMessageToClient(*tmpReply);
 		}
 	}
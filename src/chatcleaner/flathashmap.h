@@ -0,0 +1,159 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <boost/functional/hash.hpp>
+#include <boost/cstdint.hpp>
+#include <vector>
+#include <cstddef>
+
+// Open addressing hash map with linear probing. Entries are stored in a
+// single array, lookups and updates of existing keys do not allocate.
+// Pointers returned by find() and insert() are invalidated by insert() and erase().
+template <typename Key, typename Value, typename Hash = boost::hash<Key> >
+class FlatHashMap
+{
+public:
+	FlatHashMap() : numEntries(0) {
+		slots.resize(16);
+	}
+
+	size_t size() const {
+		return numEntries;
+	}
+
+	void clear() {
+		slots.assign(slots.size(), Slot());
+		numEntries = 0;
+	}
+
+	Value *find(const Key &key) {
+		size_t pos = findPos(key);
+		return pos != slots.size() ? &slots[pos].value : 0;
+	}
+
+	const Value *find(const Key &key) const {
+		size_t pos = findPos(key);
+		return pos != slots.size() ? &slots[pos].value : 0;
+	}
+
+	// Returns the existing value or a default constructed new value.
+	Value &insert(const Key &key) {
+		Value *existing = find(key);
+		if (existing) return *existing;
+		if ((numEntries + 1) * 4 > slots.size() * 3) rehash(slots.size() * 2);
+		size_t pos = hashPos(key);
+		while (slots[pos].used) pos = (pos + 1) & (slots.size() - 1);
+		slots[pos].used = true;
+		slots[pos].key = key;
+		slots[pos].value = Value();
+		numEntries++;
+		return slots[pos].value;
+	}
+
+	bool erase(const Key &key) {
+		size_t pos = findPos(key);
+		if (pos == slots.size()) return false;
+		eraseSlot(pos);
+		return true;
+	}
+
+	// Removes all entries for which pred(key, value) returns true.
+	template <typename Pred>
+	void eraseIf(Pred pred) {
+		size_t pos = 0;
+		while (pos < slots.size()) {
+			// eraseSlot may move a later entry to pos, check it again.
+			if (slots[pos].used && pred(slots[pos].key, slots[pos].value)) eraseSlot(pos);
+			else pos++;
+		}
+	}
+
+private:
+	struct Slot {
+		Slot() : used(false), key(), value() {}
+		bool used;
+		Key key;
+		Value value;
+	};
+
+	size_t hashPos(const Key &key) const {
+		// boost::hash of integers is the identity, mix the bits so that
+		// consecutive ids do not form long probe sequences.
+		boost::uint64_t h = Hash()(key);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		return static_cast<size_t>(h) & (slots.size() - 1);
+	}
+
+	// Returns slots.size() if the key is not found.
+	size_t findPos(const Key &key) const {
+		size_t pos = hashPos(key);
+		while (slots[pos].used) {
+			if (slots[pos].key == key) return pos;
+			pos = (pos + 1) & (slots.size() - 1);
+		}
+		return slots.size();
+	}
+
+	// Backward shift deletion, keeps probe sequences intact without tombstones.
+	void eraseSlot(size_t pos) {
+		size_t mask = slots.size() - 1;
+		size_t next = (pos + 1) & mask;
+		while (slots[next].used) {
+			size_t home = hashPos(slots[next].key);
+			// Move the entry back if its home position is not within (pos, next].
+			if (((next - home) & mask) >= ((next - pos) & mask)) {
+				slots[pos] = slots[next];
+				pos = next;
+			}
+			next = (next + 1) & mask;
+		}
+		slots[pos] = Slot();
+		numEntries--;
+	}
+
+	void rehash(size_t newSize) {
+		std::vector<Slot> oldSlots(newSize);
+		oldSlots.swap(slots);
+		numEntries = 0;
+		for (size_t i = 0; i < oldSlots.size(); i++) {
+			if (oldSlots[i].used) insert(oldSlots[i].key) = oldSlots[i].value;
+		}
+	}
+
+	std::vector<Slot> slots;
+	size_t numEntries;
+};
+
+#endif // FLATHASHMAP_H
@@ -30,25 +30,40 @@
  *****************************************************************************/
 #include "letterrepeatingcheck.h"
 
-#include <QtCore>
+#include <cctype>
+
+using namespace std;
 
 LetterRepeatingCheck::LetterRepeatingCheck()
 	: letterNumberToTrigger(0)
 {
 }
 
-bool LetterRepeatingCheck::run(QString msg)
+bool LetterRepeatingCheck::run(const string &msg) const
 {
-	msg = msg.simplified().remove(" ");
-	QRegExp e(QString(".*(.)\\1{%1,}.*").arg(letterNumberToTrigger-1));
-	if(e.isValid()) {
-		if(e.exactMatch(msg)) {
-			return true;
+	// Look for the same character letterNumberToTrigger times in a row, white space is ignored.
+	if (letterNumberToTrigger < 1) return false;
+	string::size_type lastPos = string::npos;
+	string::size_type lastLen = 0;
+	int numRepeated = 0;
+	string::size_type pos = 0;
+	while (pos < msg.size()) {
+		if (isspace(static_cast<unsigned char>(msg[pos]))) {
+			pos++;
+			continue;
+		}
+		// Compare whole UTF-8 sequences.
+		string::size_type len = 1;
+		while (pos + len < msg.size() && (static_cast<unsigned char>(msg[pos + len]) & 0xC0) == 0x80) len++;
+		if (len == lastLen && msg.compare(pos, len, msg, lastPos, lastLen) == 0) {
+			numRepeated++;
 		} else {
-			return false;
+			numRepeated = 1;
 		}
-	} else {
-//		qDebug() << "The current Letter Repeating RegExp is invalid" << endl;
-		return false;
+		lastPos = pos;
+		lastLen = len;
+		if (numRepeated >= letterNumberToTrigger) return true;
+		pos += len;
 	}
+	return false;
 }
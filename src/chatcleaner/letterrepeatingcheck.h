@@ -31,18 +31,17 @@
 #ifndef LETTERREPEATINGCHECK_H
 #define LETTERREPEATINGCHECK_H
 
-#include <QtCore>
+#include <string>
 
-class LetterRepeatingCheck: public QObject
+class LetterRepeatingCheck
 {
-	Q_OBJECT
 public:
 	LetterRepeatingCheck();
 
 	void setLetterNumberToTrigger(int n) {
 		letterNumberToTrigger = n;
 	}
-	bool run(QString);
+	bool run(const std::string &msg) const;
 
 private:
 
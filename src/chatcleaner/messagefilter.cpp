@@ -30,7 +30,6 @@
  *****************************************************************************/
 #include "messagefilter.h"
 
-#include <QtCore>
 #include "badwordcheck.h"
 #include "textfloodcheck.h"
 #include "cleanerconfig.h"
@@ -38,13 +37,11 @@
 #include "letterrepeatingcheck.h"
 #include "urlcheck.h"
 
-enum ActionType {
-	NOTHING,
-	WARN,
-	KICK,
-	KICKBAN,
-	MUTE
-};
+#include <algorithm>
+
+#define KICK_COUNTER_MIN_PURGE_THRESHOLD	256
+
+using namespace std;
 
 enum OffenceType {
 	NONE,
@@ -55,17 +52,15 @@ enum OffenceType {
 	URL
 };
 
-MessageFilter::MessageFilter(CleanerConfig *c): config(c)
+MessageFilter::MessageFilter(CleanerConfig *c)
+	: kickCounterPurgeThreshold(KICK_COUNTER_MIN_PURGE_THRESHOLD),
+	  warnLevelToKick(0), kickNumberToBan(0), secondsToForgetAboutKick(0), config(c)
 {
 	myBadWordCheck = new BadWordCheck;
 	myTextFloodCheck = new TextFloodCheck;
 	myCapsFloodCheck = new CapsFloodCheck;
 	myLetterRepeatingCheck = new LetterRepeatingCheck;
 	myUrlCheck = new UrlCheck;
-
-	cleanTimer = new QTimer();
-	connect(cleanTimer, SIGNAL(timeout()), this, SLOT(cleanKickCounterList()));
-	cleanTimer->start(30000);
 }
 
 MessageFilter::~MessageFilter()
@@ -76,14 +71,12 @@ MessageFilter::~MessageFilter()
 	delete myCapsFloodCheck;
 	delete myLetterRepeatingCheck;
 	delete myUrlCheck;
-	delete cleanTimer;
 }
 
-QStringList MessageFilter::check(unsigned gameId, unsigned playerId, QString nick, QString msg)
+MessageFilterAction MessageFilter::check(unsigned gameId, unsigned playerId, const string &nick, const string &msg, string &returnMessage)
 {
-	QStringList returnList;
-	QString returnMessage;
-	QString returnAction;
+	MessageFilterAction action = FILTER_ACTION_NOTHING;
+	returnMessage.clear();
 
 	OffenceType offence = NONE;
 
@@ -95,106 +88,96 @@ QStringList MessageFilter::check(unsigned gameId, unsigned playerId, QString nic
 
 	if(offence) {
 
-		ActionType action = NOTHING;
-		QMap<unsigned, ClientWarnInfos>::const_iterator i = myClientWarnLevelList.find(playerId);
+		ClientWarnInfos *warnInfos = myClientWarnLevelList.find(playerId);
 
-		if(i == myClientWarnLevelList.end()) {
-			ClientWarnInfos tmpInfos;
+		if(!warnInfos) {
+			ClientWarnInfos &tmpInfos = myClientWarnLevelList.insert(playerId);
 			tmpInfos.warnLevel = 1;
 			tmpInfos.lastWarnType = offence;
 			tmpInfos.nick = nick;
-			myClientWarnLevelList.insert(playerId, tmpInfos);
-			action = WARN;
+			action = FILTER_ACTION_WARN;
 		} else {
-			if(i.value().warnLevel == warnLevelToKick || i.value().lastWarnType == offence) {
+			if(warnInfos->warnLevel == warnLevelToKick || warnInfos->lastWarnType == offence) {
+				//remove playerId from all lists and as LAST from myClientWarnLevelList
+				myTextFloodCheck->removeNickFromList(playerId);
+				myClientWarnLevelList.erase(playerId);
 				if(gameId) {
 					//check for ingame to do not kick but mute
-					action = MUTE;
-					//remove playerId from all lists and as LAST from myClientWarnLevelList
-					myTextFloodCheck->removeNickFromList(i.key());
-					myClientWarnLevelList.remove(i.key());
+					action = FILTER_ACTION_MUTE;
 				} else {
 					//				Kick Command
-					action = KICK;
-					//remove playerId from all lists and as LAST from myClientWarnLevelList
-					myTextFloodCheck->removeNickFromList(i.key());
-					myClientWarnLevelList.remove(i.key());
+					action = FILTER_ACTION_KICK;
+					size_t now = timer.elapsed().total_seconds();
 					//check if player is already on kickCounterList
-					QMap<QString, ClientKickInfos>::const_iterator j = myClientKickCounterList.find(nick);
-					if(j == myClientKickCounterList.end()) {
+					ClientKickInfos *kickInfos = myClientKickCounterList.find(nick);
+					if(kickInfos && now - kickInfos->lastKickTimestamp > static_cast<size_t>(secondsToForgetAboutKick)) {
+						myClientKickCounterList.erase(nick);
+						kickInfos = 0;
+					}
+					if(!kickInfos) {
 						//if player is NOT on this list put the playerId on it to ban after multiple offence
-						ClientKickInfos tmpInfos;
+						if(myClientKickCounterList.size() >= kickCounterPurgeThreshold) {
+							cleanKickCounterList(now);
+						}
+						ClientKickInfos &tmpInfos = myClientKickCounterList.insert(nick);
 						tmpInfos.kickNumber = 1;
-						tmpInfos.lastKickTimestamp = timer.elapsed().total_seconds();
-						myClientKickCounterList.insert(nick, tmpInfos);
+						tmpInfos.lastKickTimestamp = now;
 					} else {
 						//pleayer is already on the list: either raise kickNumber or kickban when kickNumerToBan is reached
-						if(j.value().kickNumber == kickNumberToBan) {
-							action = KICKBAN;
+						if(kickInfos->kickNumber == kickNumberToBan) {
+							action = FILTER_ACTION_KICKBAN;
 							//remove player from kickCounterList
-							myClientKickCounterList.remove(j.key());
+							myClientKickCounterList.erase(nick);
 						} else {
-							ClientKickInfos tmpInfos;
-							tmpInfos.kickNumber = j.value().kickNumber+1;
-							tmpInfos.lastKickTimestamp = timer.elapsed().total_seconds();
-							myClientKickCounterList.insert(nick, tmpInfos);
+							kickInfos->kickNumber++;
+							kickInfos->lastKickTimestamp = now;
 						}
 					}
 				}
 			} else {
-				ClientWarnInfos tmpInfos;
-				tmpInfos.warnLevel = i.value().warnLevel+1;
-				tmpInfos.lastWarnType = offence;
-				tmpInfos.nick = nick;
-				myClientWarnLevelList.insert(playerId, tmpInfos);
-				action = WARN;
+				warnInfos->warnLevel++;
+				warnInfos->lastWarnType = offence;
+				warnInfos->nick = nick;
+				action = FILTER_ACTION_WARN;
 			}
 		}
 
-		if(action == WARN) {
+		if(action == FILTER_ACTION_WARN) {
 
 			switch(offence) {
 			case BAD_WORD: {
-				returnMessage = QString ("%1: Warning! No racial, religious, sexually inflammatory or otherwise insulting language\n").arg(nick);
+				returnMessage = nick + ": Warning! No racial, religious, sexually inflammatory or otherwise insulting language\n";
 			}
 			break;
 			case TEXT_FLOOD_LINES: {
-				returnMessage = QString ("%1: Warning! You've triggered text flood (lines) protection, slow down your typing!\n").arg(nick);
+				returnMessage = nick + ": Warning! You've triggered text flood (lines) protection, slow down your typing!\n";
 			}
 			break;
 			case CAPS_FLOOD: {
-				returnMessage = QString ("%1: Warning: You've triggered caps flood protection, release your caps!\n").arg(nick);
+				returnMessage = nick + ": Warning: You've triggered caps flood protection, release your caps!\n";
 			}
 			break;
 			case LETTER_REPEATING: {
-				returnMessage = QString ("%1: Warning: You've triggered letter repeating protection, stop repeating!\n").arg(nick);
+				returnMessage = nick + ": Warning: You've triggered letter repeating protection, stop repeating!\n";
 			}
 			break;
 			case URL: {
-				returnMessage = QString ("%1: Warning: You've triggered url spam protection, stop posting urls!\n").arg(nick);
+				returnMessage = nick + ": Warning: You've triggered url spam protection, stop posting urls!\n";
 			}
 			break;
 			default:
 				;
 			}
-			returnAction = QString("warn");
-		} else if(action == KICK) {
-			returnMessage = QString("%1 kicked! Please respect: http://chatrules.pokerth.net\n").arg(nick);
-			returnAction = QString("kick");
-		} else if(action == KICKBAN) {
-			returnMessage = QString("%1 kicked and banned! Please respect: http://chatrules.pokerth.net\n").arg(nick);
-			returnAction = QString("kickban");
-		} else if(action == MUTE) {
-			returnMessage = QString("%1 muted! Please respect: http://chatrules.pokerth.net\n").arg(nick);
-			returnAction = QString("mute");
+		} else if(action == FILTER_ACTION_KICK) {
+			returnMessage = nick + " kicked! Please respect: http://chatrules.pokerth.net\n";
+		} else if(action == FILTER_ACTION_KICKBAN) {
+			returnMessage = nick + " kicked and banned! Please respect: http://chatrules.pokerth.net\n";
+		} else if(action == FILTER_ACTION_MUTE) {
+			returnMessage = nick + " muted! Please respect: http://chatrules.pokerth.net\n";
 		}
-	} else {
-		returnAction = QString("");
-		returnMessage = QString("");
 	}
 
-	returnList << returnAction << returnMessage;
-	return returnList;
+	return action;
 }
 
 void MessageFilter::refreshConfig()
@@ -203,40 +186,11 @@ void MessageFilter::refreshConfig()
 	//	global settings
 	warnLevelToKick = config->readConfigInt("WarnLevelToKick");
 	kickNumberToBan = config->readConfigInt("KickNumberToBan");
+	secondsToForgetAboutKick = config->readConfigInt("SecondsToForgetAboutKick");
 
 	// special check settings
-	//Bad Words
-	std::list<std::string> badWordsList = config->readConfigStringList("BadWordsList");
-	std::list<std::string>::iterator it0;
-	QStringList bwList;
-	for(it0= badWordsList.begin(); it0 != badWordsList.end(); ++it0) {
-		bwList << QString::fromUtf8(it0->c_str());
-	}
-	myBadWordCheck->setBadWords(bwList);
-
-	std::list<std::string> badWordsExceptionList = config->readConfigStringList("BadWordsException");
-	std::list<std::string>::iterator it1;
-	QStringList bweList;
-	for(it1= badWordsExceptionList.begin(); it1 != badWordsExceptionList.end(); ++it1) {
-		bweList << QString::fromUtf8(it1->c_str());
-	}
-	myBadWordCheck->setBadWordsException(bweList);
-
-	std::list<std::string> urlStringsList = config->readConfigStringList("UrlStringsList");
-	std::list<std::string>::iterator it2;
-	QStringList urlList;
-	for(it2= urlStringsList.begin(); it2 != urlStringsList.end(); ++it2) {
-		urlList << QString::fromUtf8(it2->c_str());
-	}
-	myUrlCheck->setUrlStrings(urlList);
-
-	std::list<std::string> urlExceptionStringsList = config->readConfigStringList("UrlExceptionStringsList");
-	std::list<std::string>::iterator it3;
-	QStringList urlExceptionList;
-	for(it3= urlExceptionStringsList.begin(); it3 != urlExceptionStringsList.end(); ++it3) {
-		urlExceptionList << QString::fromUtf8(it3->c_str());
-	}
-	myUrlCheck->setUrlExceptionStrings(urlExceptionList);
+	myBadWordCheck->setBadWords(config->readConfigStringList("BadWordsList"), config->readConfigStringList("BadWordsException"));
+	myUrlCheck->setUrlStrings(config->readConfigStringList("UrlStringsList"), config->readConfigStringList("UrlExceptionStringsList"));
 
 	myTextFloodCheck->setTextFloodLevelToTrigger(config->readConfigInt("TextFloodLevelToTrigger"));
 	myCapsFloodCheck->setCapsNumberToTrigger(config->readConfigInt("CapsFloodCapsNumberToTrigger"));
@@ -244,14 +198,8 @@ void MessageFilter::refreshConfig()
 
 }
 
-void MessageFilter::cleanKickCounterList()
+void MessageFilter::cleanKickCounterList(size_t now)
 {
-	QMapIterator<QString, ClientKickInfos> it(myClientKickCounterList);
-	while (it.hasNext()) {
-		it.next();
-		if(timer.elapsed().total_seconds()-it.value().lastKickTimestamp > static_cast<unsigned>(config->readConfigInt("SecondsToForgetAboutKick"))) {
-//            qDebug() << it.key() << "removed from kick counter list" << endl;
-			myClientKickCounterList.remove(it.key());
-		}
-	}
+	myClientKickCounterList.eraseIf(KickExpiredPredicate(now, secondsToForgetAboutKick));
+	kickCounterPurgeThreshold = std::max(static_cast<size_t>(KICK_COUNTER_MIN_PURGE_THRESHOLD), myClientKickCounterList.size() * 2);
 }
@@ -31,11 +31,10 @@
 #ifndef MESSAGEFILTER_H
 #define MESSAGEFILTER_H
 
-#include <QtCore>
+#include <string>
 #include <stdlib.h>
-#ifndef Q_MOC_RUN
 #include <third_party/boost/timers.hpp>
-#endif
+#include "flathashmap.h"
 
 class BadWordCheck;
 class TextFloodCheck;
@@ -44,20 +43,29 @@ class CapsFloodCheck;
 class LetterRepeatingCheck;
 class UrlCheck;
 
-class MessageFilter: public QObject
+enum MessageFilterAction {
+	FILTER_ACTION_NOTHING,
+	FILTER_ACTION_WARN,
+	FILTER_ACTION_KICK,
+	FILTER_ACTION_KICKBAN,
+	FILTER_ACTION_MUTE
+};
+
+// Runs all chat checks and keeps track of the warnings per player.
+// Used by the chatcleaner process and by the server in-process filter.
+// This class is not thread safe.
+class MessageFilter
 {
-	Q_OBJECT
 public:
 	MessageFilter(CleanerConfig*);
 	~MessageFilter();
 
-	QStringList check(unsigned, unsigned, QString, QString);
+	MessageFilterAction check(unsigned gameId, unsigned playerId, const std::string &nick, const std::string &msg, std::string &returnMessage);
 	void refreshConfig();
 
-public slots:
-	void cleanKickCounterList();
-
 private:
+	void cleanKickCounterList(size_t now);
+
 	BadWordCheck *myBadWordCheck;
 	TextFloodCheck *myTextFloodCheck;
 	CapsFloodCheck *myCapsFloodCheck;
@@ -65,26 +73,39 @@ private:
 	UrlCheck *myUrlCheck;
 
 	struct ClientWarnInfos {
-		QString nick;
+		ClientWarnInfos() : lastWarnType(0), warnLevel(0) {}
+		std::string nick;
 		int lastWarnType;
 		int warnLevel;
 	};
 
 	struct ClientKickInfos {
+		ClientKickInfos() : lastKickTimestamp(0), kickNumber(0) {}
 		size_t lastKickTimestamp;
 		int kickNumber;
 	};
 
-	QMap<unsigned, ClientWarnInfos> myClientWarnLevelList;
-	QMap<QString, ClientKickInfos> myClientKickCounterList;
+	struct KickExpiredPredicate {
+		KickExpiredPredicate(size_t n, size_t s) : now(n), seconds(s) {}
+		bool operator()(const std::string &, const ClientKickInfos &infos) const {
+			return now - infos.lastKickTimestamp > seconds;
+		}
+		size_t now;
+		size_t seconds;
+	};
+
+	FlatHashMap<unsigned, ClientWarnInfos> myClientWarnLevelList;
+	// Expired entries are ignored on lookup and removed when the list grows.
+	FlatHashMap<std::string, ClientKickInfos> myClientKickCounterList;
+	size_t kickCounterPurgeThreshold;
 
 	int warnLevelToKick;
 	int kickNumberToBan;
+	int secondsToForgetAboutKick;
 
 	CleanerConfig *config;
 
 	boost::timers::portable::second_timer timer;
-	QTimer *cleanTimer;
 };
 
 #endif // MESSAGEFILTER_H
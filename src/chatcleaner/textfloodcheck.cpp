@@ -29,94 +29,82 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 #include "textfloodcheck.h"
-#include <QtCore>
+
+#include <algorithm>
+
+#define TEXT_FLOOD_IDLE_SEC				3
+#define TEXT_FLOOD_DECAY_INTERVAL_SEC	4
+#define TEXT_FLOOD_MIN_PURGE_THRESHOLD	1024
+
+using namespace std;
 
 TextFloodCheck::TextFloodCheck()
+	: purgeThreshold(TEXT_FLOOD_MIN_PURGE_THRESHOLD), textFloodLevelToTrigger(0)
 {
 	timer.reset();
 	timer.start();
-
-	cleanTimer = new QTimer();
-
-	connect(cleanTimer, SIGNAL(timeout()), this, SLOT(cleanMsgTimesList()));
-
-	cleanTimer->start(4000);
-
 }
 
 TextFloodCheck::~TextFloodCheck()
 {
-	delete cleanTimer;
 }
 
-bool TextFloodCheck::run(unsigned playerId)
+bool TextFloodCheck::runAt(unsigned playerId, size_t now)
 {
+	TextFloodInfos *infos = msgTimesList.find(playerId);
 
-	QMapIterator<unsigned, TextFloodInfos> it(msgTimesList);
-	while (it.hasNext()) {
-		it.next();
-//		 qDebug() << "counter: " << msgTimesList.count() << " playerid: " << it.key() << " floodlevel: " << it.value().floodLevel << " timestamp: " <<  it.value().timeStamp;
-	}
-
-	QMap<unsigned, TextFloodInfos>::const_iterator i = msgTimesList.find(playerId);
-
-	if(i == msgTimesList.end()) {
-		TextFloodInfos tmpInfos1;
-		tmpInfos1.floodLevel = 0;
-		tmpInfos1.timeStamp = timer.elapsed().total_seconds();
-		msgTimesList.insert(playerId, tmpInfos1);
-		qDebug () << "Add Player: set player floodlevel to " << tmpInfos1.floodLevel;
+	if(!infos) {
+		if (msgTimesList.size() >= purgeThreshold) {
+			purgeIdlePlayers(now);
+		}
+		TextFloodInfos &newInfos = msgTimesList.insert(playerId);
+		newInfos.floodLevel = 0;
+		newInfos.timeStamp = now;
 	} else {
-		TextFloodInfos tmpInfos2;
-		if(timer.elapsed().total_seconds()-i.value().timeStamp <= 1) {
-			if(i.value().floodLevel == textFloodLevelToTrigger) {
-				TextFloodInfos tmpInfos3;
-				tmpInfos3.floodLevel = i.value().floodLevel-1;
-				tmpInfos3.timeStamp = timer.elapsed().total_seconds();
-				qDebug () << "Trigger: set player floodlevel to " << tmpInfos3.floodLevel;
-				msgTimesList.insert(playerId, tmpInfos3);
+		size_t idle = now - infos->timeStamp;
+		infos->floodLevel = decayedLevel(*infos, now);
+		infos->timeStamp = now;
+		if(idle <= 1) {
+			if(infos->floodLevel == textFloodLevelToTrigger) {
+				infos->floodLevel = infos->floodLevel-1;
 				return true;
 			} else {
-				tmpInfos2.floodLevel = i.value().floodLevel+1;
-				qDebug () << "Raise: set player floodlevel to " << tmpInfos2.floodLevel << " from " << i.value().floodLevel;
+				infos->floodLevel = infos->floodLevel+1;
 			}
-		} else {
-			tmpInfos2.floodLevel = i.value().floodLevel;
-			qDebug () << "Keep: player floodlevel is " << tmpInfos2.floodLevel << " from " << i.value().floodLevel;
 		}
-
-		tmpInfos2.timeStamp = timer.elapsed().total_seconds();
-		msgTimesList.insert(playerId, tmpInfos2);
 	}
 	return false;
 }
 
-void TextFloodCheck::cleanMsgTimesList()
+int TextFloodCheck::getFloodLevel(unsigned playerId, size_t now) const
 {
+	const TextFloodInfos *infos = msgTimesList.find(playerId);
+	return infos ? decayedLevel(*infos, now) : 0;
+}
 
-	QMapIterator<unsigned, TextFloodInfos> it(msgTimesList);
-	while (it.hasNext()) {
-		it.next();
-		if(timer.elapsed().total_seconds()-it.value().timeStamp > 3) {
+void TextFloodCheck::removeNickFromList(unsigned playerId)
+{
+	msgTimesList.erase(playerId);
+}
 
-			if(it.value().floodLevel == 0) {
-				msgTimesList.remove(it.key());
-				qDebug () << "Refresh: player removed from List";
-			} else {
-				TextFloodInfos tmpInfos;
-				tmpInfos.floodLevel = it.value().floodLevel-1;
-				tmpInfos.timeStamp = it.value().timeStamp;
-				qDebug () << "Refresh: player floodlevel to " << tmpInfos.floodLevel;
-				msgTimesList.insert(it.key(), tmpInfos);
-			}
-		}
-//		qDebug() << msgTimesList.count() << it.key() << ": " << it.value().floodLevel << it.value().timeStamp << endl;
+int TextFloodCheck::decayedLevel(const TextFloodInfos &infos, size_t now)
+{
+	size_t idle = now - infos.timeStamp;
+	if (idle <= TEXT_FLOOD_IDLE_SEC) {
+		return infos.floodLevel;
 	}
+	size_t decay = (idle - TEXT_FLOOD_IDLE_SEC - 1) / TEXT_FLOOD_DECAY_INTERVAL_SEC + 1;
+	return decay >= static_cast<size_t>(infos.floodLevel) ? 0 : infos.floodLevel - static_cast<int>(decay);
 }
 
-void TextFloodCheck::removeNickFromList(unsigned playerId)
+bool TextFloodCheck::IdlePredicate::operator()(unsigned, const TextFloodInfos &infos) const
 {
+	// Players whose level has dropped to zero are the same as unknown players.
+	return now - infos.timeStamp > TEXT_FLOOD_IDLE_SEC && decayedLevel(infos, now) == 0;
+}
 
-//	qDebug() << "id " << playerId << "removed from textfloodcheck list" << endl;
-	msgTimesList.remove(playerId);
+void TextFloodCheck::purgeIdlePlayers(size_t now)
+{
+	msgTimesList.eraseIf(IdlePredicate(now));
+	purgeThreshold = max(static_cast<size_t>(TEXT_FLOOD_MIN_PURGE_THRESHOLD), msgTimesList.size() * 2);
 }
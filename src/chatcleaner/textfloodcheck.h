@@ -31,16 +31,17 @@
 #ifndef TEXTFLOODCHECK_H
 #define TEXTFLOODCHECK_H
 
-#include <QtCore>
-#ifndef Q_MOC_RUN
 #include <third_party/boost/timers.hpp>
-#endif
 #include <stdlib.h>
+#include "flathashmap.h"
 
 
-class TextFloodCheck: public QObject
+// The flood level of a player rises with every message sent within a second
+// of the previous one. After 3 seconds without messages it drops by one per
+// 4 seconds. The decay is computed when the player writes again, there is
+// no periodic sweep of the list.
+class TextFloodCheck
 {
-	Q_OBJECT
 public:
 	TextFloodCheck();
 	~TextFloodCheck();
@@ -49,20 +50,35 @@ public:
 		textFloodLevelToTrigger = level;
 	}
 
-	bool run(unsigned);
+	bool run(unsigned playerId) {
+		return runAt(playerId, timer.elapsed().total_seconds());
+	}
+	// Same as run(), with the time in seconds given by the caller.
+	bool runAt(unsigned playerId, size_t now);
+	// Current flood level of a player, 0 for unknown players.
+	int getFloodLevel(unsigned playerId, size_t now) const;
 
-public slots:
-	void cleanMsgTimesList();
 	void removeNickFromList(unsigned);
 
 private:
-	QTimer *cleanTimer;
-	boost::timers::portable::second_timer timer;
 	struct TextFloodInfos {
+		TextFloodInfos() : floodLevel(0), timeStamp(0) {}
 		int floodLevel;
 		size_t timeStamp;
 	};
-	QMap<unsigned, TextFloodInfos> msgTimesList;
+
+	struct IdlePredicate {
+		IdlePredicate(size_t n) : now(n) {}
+		bool operator()(unsigned, const TextFloodInfos &infos) const;
+		size_t now;
+	};
+
+	static int decayedLevel(const TextFloodInfos &infos, size_t now);
+	void purgeIdlePlayers(size_t now);
+
+	boost::timers::portable::second_timer timer;
+	FlatHashMap<unsigned, TextFloodInfos> msgTimesList;
+	size_t purgeThreshold;
 
 	int textFloodLevelToTrigger;
 };
@@ -30,32 +30,47 @@
  *****************************************************************************/
 #include "urlcheck.h"
 
-#include <QtCore>
+#include <vector>
+
+using namespace std;
 
 UrlCheck::UrlCheck()
+	: numUrlStrings(0)
 {
 }
 
-bool UrlCheck::run(QString msg)
+void UrlCheck::setUrlStrings(const list<string> &us, const list<string> &ues)
 {
-	msg = msg.toLower();
+	matcher.clear();
+	list<string>::const_iterator it1 = us.begin();
+	while (it1 != us.end()) {
+		matcher.addPattern(AhoCorasick::foldCase(*it1));
+		++it1;
+	}
+	numUrlStrings = matcher.getNumPatterns();
+	list<string>::const_iterator it2 = ues.begin();
+	while (it2 != ues.end()) {
+		matcher.addPattern(AhoCorasick::foldCase(*it2));
+		++it2;
+	}
+	matcher.build();
+}
 
-	QStringListIterator it1(urlStrings);
+bool UrlCheck::run(const string &msg) const
+{
+	if (!matcher.scan(msg, found, true)) return false;
 
-	while (it1.hasNext()) {
-		if(msg.contains(it1.next())) {
-			QStringListIterator it2(urlExceptionStrings);
-			bool exception = false;
-			while (it2.hasNext()) {
-				if(msg.contains(it2.next())) {
-					exception = true;
-					break;
-				}
-			}
-			if(!exception) {
-				return true;
-			}
+	bool url = false;
+	for (unsigned i = 0; i < numUrlStrings; i++) {
+		if (found[i]) {
+			url = true;
+			break;
+		}
+	}
+	if (url) {
+		for (unsigned i = numUrlStrings; i < found.size(); i++) {
+			if (found[i]) return false;
 		}
 	}
-	return false;
+	return url;
 }
@@ -31,26 +31,25 @@
 #ifndef URLCHECK_H
 #define URLCHECK_H
 
-#include <QtCore>
+#include <list>
+#include <string>
+#include <vector>
+#include "ahocorasick.h"
 
-class UrlCheck: public QObject
+class UrlCheck
 {
-	Q_OBJECT
 public:
 	UrlCheck();
 
-	void setUrlStrings(QStringList us) {
-		urlStrings = us;
-	}
-	void setUrlExceptionStrings(QStringList ues) {
-		urlExceptionStrings = ues;
-	}
-	bool run(QString);
+	void setUrlStrings(const std::list<std::string> &us, const std::list<std::string> &ues);
+	bool run(const std::string &msg) const;
 
 private:
-
-	QStringList urlStrings;
-	QStringList urlExceptionStrings;
+	// Url strings and exceptions in one automaton, exceptions follow the url strings.
+	AhoCorasick matcher;
+	// Scan result, kept to avoid allocations.
+	mutable std::vector<char> found;
+	unsigned numUrlStrings;
 };
 
 #endif // URLCHECK_H
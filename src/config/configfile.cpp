@@ -64,7 +64,7 @@ ConfigFile::ConfigFile(char *argv0, bool readonly) : noWriteAccess(readonly)
 	myConfigState = OK;
 
 	// !!!! Revisionsnummer der Configdefaults !!!!!
-	configRev = 104;
+	configRev = 111;
 
 	//standard defaults
 	logOnOffDefault = "1";
@@ -225,11 +225,24 @@ ConfigFile::ConfigFile(char *argv0, bool readonly) : noWriteAccess(readonly)
 	configList.push_back(ConfigInfo("ServerWebSocketPort", CONFIG_TYPE_INT, "7233"));
 	configList.push_back(ConfigInfo("ServerWebSocketResource", CONFIG_TYPE_STRING, ""));
 	configList.push_back(ConfigInfo("ServerWebSocketOrigin", CONFIG_TYPE_STRING, ""));
+	configList.push_back(ConfigInfo("ServerWebSocketCompression", CONFIG_TYPE_INT, "0"));
+	configList.push_back(ConfigInfo("ServerWebSocketContextTakeover", CONFIG_TYPE_INT, "1"));
+	configList.push_back(ConfigInfo("ServerWebSocketCompressionWindowBits", CONFIG_TYPE_INT, "12"));
+	configList.push_back(ConfigInfo("ServerWebSocketCompressionThreshold", CONFIG_TYPE_INT, "128"));
+	configList.push_back(ConfigInfo("ServerWebSocketBatchFrames", CONFIG_TYPE_INT, "1"));
 	configList.push_back(ConfigInfo("ServerUsePutAvatars", CONFIG_TYPE_INT, "0"));
 	configList.push_back(ConfigInfo("ServerPutAvatarsAddress", CONFIG_TYPE_STRING, ""));
 	configList.push_back(ConfigInfo("ServerPutAvatarsUser", CONFIG_TYPE_STRING, ""));
 	configList.push_back(ConfigInfo("ServerPutAvatarsPassword", CONFIG_TYPE_STRING, ""));
 	configList.push_back(ConfigInfo("ServerBruteForceProtection", CONFIG_TYPE_INT, "1"));
+	configList.push_back(ConfigInfo("ServerMaxLobbySessions", CONFIG_TYPE_INT, "512"));
+	configList.push_back(ConfigInfo("ServerMaxSessions", CONFIG_TYPE_INT, "2000"));
+	configList.push_back(ConfigInfo("ServerSpectatorTickMsec", CONFIG_TYPE_INT, "100"));
+	configList.push_back(ConfigInfo("ServerSpectatorThreads", CONFIG_TYPE_INT, "1"));
+	configList.push_back(ConfigInfo("ServerMaxSpectatorsPerGame", CONFIG_TYPE_INT, "1000"));
+	configList.push_back(ConfigInfo("ServerAuthThreads", CONFIG_TYPE_INT, "2"));
+	configList.push_back(ConfigInfo("ServerAuthMaxPerAddress", CONFIG_TYPE_INT, "4"));
+	configList.push_back(ConfigInfo("ServerAuthCacheTimeoutSec", CONFIG_TYPE_INT, "900"));
 	configList.push_back(ConfigInfo("InternetServerConfigMode", CONFIG_TYPE_INT, "0"));
 	configList.push_back(ConfigInfo("InternetServerListAddress", CONFIG_TYPE_STRING, "pokerth.net/serverlist.xml.z"));
 	configList.push_back(ConfigInfo("InternetServerAddress", CONFIG_TYPE_STRING, "pokerth.6dns.org"));
@@ -289,6 +302,7 @@ ConfigFile::ConfigFile(char *argv0, bool readonly) : noWriteAccess(readonly)
 	configList.push_back(ConfigInfo("LogDir", CONFIG_TYPE_STRING, logDir));
 	configList.push_back(ConfigInfo("LogStoreDuration", CONFIG_TYPE_INT, "2"));
 	configList.push_back(ConfigInfo("LogInterval", CONFIG_TYPE_INT, "1"));
+	configList.push_back(ConfigInfo("LogHandHistoryBinary", CONFIG_TYPE_INT, "0"));
 	configList.push_back(ConfigInfo("UserDataDir", CONFIG_TYPE_STRING, dataDir));
 	configList.push_back(ConfigInfo("CacheDir", CONFIG_TYPE_STRING, cacheDir));
 	configList.push_back(ConfigInfo("CLA_NoWriteAccess", CONFIG_TYPE_INT, "0"));
@@ -314,6 +328,8 @@ ConfigFile::ConfigFile(char *argv0, bool readonly) : noWriteAccess(readonly)
 
 	//fill tempList firstTime
 	configBufferList = configList;
+	buildConfigIndex();
+	publishSnapshot();
 
 	// 	cout << configTempList[3].name << " " << configTempList[10].defaultValue << endl;
 
@@ -418,6 +434,7 @@ void ConfigFile::fillBuffer()
 			// 			cout << configBufferList[i].name << " " << configBufferList[i].defaultValue << endl;
 		}
 	}
+	publishSnapshot();
 }
 
 void ConfigFile::checkAndCorrectBuffer()
@@ -456,6 +473,9 @@ void ConfigFile::writeBuffer() const
 
 	boost::recursive_mutex::scoped_lock lock(m_configMutex);
 
+	// End of a batch of writes, publish the changes for the readers.
+	getSnapshot();
+
 	//write buffer to disc if enabled
 	if(!noWriteAccess) {
 		TiXmlDocument doc;
@@ -670,157 +690,172 @@ ConfigState ConfigFile::getConfigState() const
 	return myConfigState;
 }
 
-string ConfigFile::readConfigString(string varName) const
+ConfigKey ConfigFile::getConfigKey(const string &varName) const
 {
-	boost::recursive_mutex::scoped_lock lock(m_configMutex);
-
-	size_t i;
-	string tempString("");
-
-	for (i=0; i<configBufferList.size(); i++) {
+	boost::unordered_map<string, int>::const_iterator pos = configIndex.find(varName);
+	if (pos == configIndex.end())
+		return ConfigKey();
+	return ConfigKey(pos->second);
+}
 
-		if (configBufferList[i].name == varName) {
-			tempString = configBufferList[i].defaultValue;
-		}
-	}
+string ConfigFile::readConfigString(string varName) const
+{
+	return readConfigString(getConfigKey(varName));
+}
 
-	return tempString;
+string ConfigFile::readConfigString(ConfigKey key) const
+{
+	if (!key.isValid())
+		return "";
+	return getSnapshot()->values[key.slot].defaultValue;
 }
 
 int ConfigFile::readConfigInt(string varName) const
 {
-	boost::recursive_mutex::scoped_lock lock(m_configMutex);
-
-	size_t i;
-	string tempString("");
-	int tempInt=0;
-
-	for (i=0; i<configBufferList.size(); i++) {
+	return readConfigInt(getConfigKey(varName));
+}
 
-		if (configBufferList[i].name == varName) {
-			tempString = configBufferList[i].defaultValue;
-		}
-	}
+int ConfigFile::readConfigInt(ConfigKey key) const
+{
+	if (!key.isValid())
+		return 0;
+	return getSnapshot()->intValues[key.slot];
+}
 
-	istringstream isst;
-	isst.str (tempString);
-	isst >> tempInt;
+list<int> ConfigFile::readConfigIntList(string varName) const
+{
+	ConfigKey key(getConfigKey(varName));
+	if (!key.isValid())
+		return list<int>();
+	return getSnapshot()->intListValues[key.slot];
+}
 
-	return tempInt;
+list<string> ConfigFile::readConfigStringList(string varName) const
+{
+	ConfigKey key(getConfigKey(varName));
+	if (!key.isValid())
+		return list<string>();
+	return getSnapshot()->values[key.slot].defaultListValue;
 }
 
-list<int> ConfigFile::readConfigIntList(string varName) const
+void ConfigFile::writeConfigInt(string varName, int varCont)
 {
 	boost::recursive_mutex::scoped_lock lock(m_configMutex);
 
-	size_t i;
-	list<string> tempStringList;
-	list<int> tempIntList;
+	ConfigKey key(getConfigKey(varName));
+	if (key.isValid()) {
+		ostringstream intToString;
+		intToString << varCont;
+		configBufferList[key.slot].defaultValue = intToString.str();
+		invalidateSnapshot();
+	}
+}
 
-	for (i=0; i<configBufferList.size(); i++) {
+void ConfigFile::writeConfigIntList(string varName, list<int> varCont)
+{
+	boost::recursive_mutex::scoped_lock lock(m_configMutex);
 
-		if (configBufferList[i].name == varName) {
-			tempStringList = configBufferList[i].defaultListValue;
+	ConfigKey key(getConfigKey(varName));
+	if (key.isValid()) {
+		ostringstream intToString;
+		list<string> stringList;
+		list<int>::iterator it;
+		for(it = varCont.begin(); it != varCont.end(); ++it) {
+
+			intToString << (*it);
+			stringList.push_back(intToString.str());
+			intToString.str("");
+			intToString.clear();
 		}
-	}
-
-	istringstream isst;
-	int tempInt;
-	list<string>::iterator it;
-	for(it = tempStringList.begin(); it != tempStringList.end(); ++it) {
 
-		isst.str(*it);
-		isst >> tempInt;
-		tempIntList.push_back(tempInt);
-		isst.str("");
-		isst.clear();
+		configBufferList[key.slot].defaultListValue = stringList;
+		invalidateSnapshot();
 	}
-
-	return tempIntList;
 }
 
-list<string> ConfigFile::readConfigStringList(string varName) const
+void ConfigFile::writeConfigString(string varName, string varCont)
 {
 	boost::recursive_mutex::scoped_lock lock(m_configMutex);
 
-	size_t i;
-	list<string> tempStringList;
-
-	for (i=0; i<configBufferList.size(); i++) {
-
-		if (configBufferList[i].name == varName) {
-			tempStringList = configBufferList[i].defaultListValue;
-		}
+	ConfigKey key(getConfigKey(varName));
+	if (key.isValid()) {
+		configBufferList[key.slot].defaultValue = varCont;
+		invalidateSnapshot();
 	}
-
-	return tempStringList;
 }
 
-void ConfigFile::writeConfigInt(string varName, int varCont)
+void ConfigFile::writeConfigStringList(string varName, list<string> varCont)
 {
 	boost::recursive_mutex::scoped_lock lock(m_configMutex);
 
-	size_t i;
-	ostringstream intToString;
-
-	for (i=0; i<configBufferList.size(); i++) {
-
-		if (configBufferList[i].name == varName) {
-			intToString << varCont;
-			configBufferList[i].defaultValue = intToString.str();
-		}
+	ConfigKey key(getConfigKey(varName));
+	if (key.isValid()) {
+		configBufferList[key.slot].defaultListValue = varCont;
+		invalidateSnapshot();
 	}
 }
 
-void ConfigFile::writeConfigIntList(string varName, list<int> varCont)
+void ConfigFile::buildConfigIndex()
 {
-	boost::recursive_mutex::scoped_lock lock(m_configMutex);
-
-	size_t i;
-	ostringstream intToString;
-	list<string> stringList;
+	// The list is fixed after construction, so the index is never changed
+	// and can be read without locking. Later entries win, as before.
+	configIndex.clear();
+	for (size_t i=0; i<configList.size(); i++) {
+		configIndex[configList[i].name] = static_cast<int>(i);
+	}
+}
 
-	for (i=0; i<configBufferList.size(); i++) {
+void ConfigFile::invalidateSnapshot()
+{
+	// Called with m_configMutex held.
+	boost::atomic_store(&m_configSnapshot, boost::shared_ptr<const ConfigSnapshot>());
+}
 
-		if (configBufferList[i].name == varName) {
-			list<int>::iterator it;
-			for(it = varCont.begin(); it != varCont.end(); ++it) {
+boost::shared_ptr<const ConfigFile::ConfigSnapshot> ConfigFile::publishSnapshot() const
+{
+	// Called with m_configMutex held (or during construction).
+	boost::shared_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot);
+	snapshot->values = configBufferList;
+	snapshot->intValues.resize(configBufferList.size(), 0);
+	snapshot->intListValues.resize(configBufferList.size());
 
-				intToString << (*it);
-				stringList.push_back(intToString.str());
-				intToString.str("");
-				intToString.clear();
-			}
+	for (size_t i=0; i<configBufferList.size(); i++) {
 
-			configBufferList[i].defaultListValue = stringList;
-		}
-	}
-}
+		istringstream isst;
+		int tempInt = 0;
+		isst.str(configBufferList[i].defaultValue);
+		isst >> tempInt;
+		snapshot->intValues[i] = tempInt;
 
-void ConfigFile::writeConfigString(string varName, string varCont)
-{
-	boost::recursive_mutex::scoped_lock lock(m_configMutex);
+		const list<string> &tempStringList = configBufferList[i].defaultListValue;
+		list<string>::const_iterator it;
+		isst.clear();
+		for(it = tempStringList.begin(); it != tempStringList.end(); ++it) {
 
-	size_t i;
-	for (i=0; i<configBufferList.size(); i++) {
-		if (configBufferList[i].name == varName) {
-			configBufferList[i].defaultValue = varCont;
+			isst.str(*it);
+			isst >> tempInt;
+			snapshot->intListValues[i].push_back(tempInt);
+			isst.str("");
+			isst.clear();
 		}
 	}
 
+	boost::shared_ptr<const ConfigSnapshot> constSnapshot(snapshot);
+	boost::atomic_store(&m_configSnapshot, constSnapshot);
+	return constSnapshot;
 }
 
-void ConfigFile::writeConfigStringList(string varName, list<string> varCont)
+boost::shared_ptr<const ConfigFile::ConfigSnapshot> ConfigFile::getSnapshot() const
 {
-	boost::recursive_mutex::scoped_lock lock(m_configMutex);
-
-	size_t i;
-	for (i=0; i<configBufferList.size(); i++) {
-
-		if (configBufferList[i].name == varName) {
-			configBufferList[i].defaultListValue = varCont;
-		}
+	boost::shared_ptr<const ConfigSnapshot> snapshot(boost::atomic_load(&m_configSnapshot));
+	if (!snapshot) {
+		// Dropped by a write, the first reader publishes the new one.
+		boost::recursive_mutex::scoped_lock lock(m_configMutex);
+		snapshot = boost::atomic_load(&m_configSnapshot);
+		if (!snapshot)
+			snapshot = publishSnapshot();
 	}
+	return snapshot;
 }
 
 void ConfigFile::deleteConfigFile()
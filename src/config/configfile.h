@@ -33,10 +33,13 @@
 #define CONFIGFILE_H
 
 #include <vector>
+#include <list>
 #include <string>
 
 #ifndef Q_MOC_RUN
 #include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #endif
 
 enum ConfigState { NONEXISTING, OLD, OK };
@@ -44,6 +47,25 @@ enum ConfigType { CONFIG_TYPE_INT, CONFIG_TYPE_STRING, CONFIG_TYPE_INT_LIST, CON
 
 class QtToolsInterface;
 
+// Handle to a config variable, avoids the name lookup on every read.
+class ConfigKey
+{
+public:
+	ConfigKey() : slot(INVALID_SLOT) {}
+
+	bool isValid() const {
+		return slot != INVALID_SLOT;
+	}
+
+private:
+	enum { INVALID_SLOT = -1 };
+	explicit ConfigKey(int s) : slot(s) {}
+
+	int slot;
+
+	friend class ConfigFile;
+};
+
 class ConfigFile
 {
 public:
@@ -58,11 +80,15 @@ public:
 	void updateConfig(ConfigState);
 	ConfigState getConfigState() const;
 
+	ConfigKey getConfigKey(const std::string &varName) const;
+
 	std::string readConfigString(std::string varName) const;
+	std::string readConfigString(ConfigKey key) const;
 	std::list<std::string> readConfigStringList(std::string varName) const;
 	void writeConfigString(std::string varName, std::string varCont);
 	void writeConfigStringList(std::string varName, std::list<std::string> varCont);
 	int readConfigInt(std::string varName) const;
+	int readConfigInt(ConfigKey key) const;
 	std::list<int> readConfigIntList(std::string varName) const;
 	void writeConfigInt(std::string varName, int varCont);
 	void writeConfigIntList(std::string varName, std::list<int> varCont);
@@ -84,8 +110,24 @@ private:
 
 	};
 
+	// Immutable copy of the buffer with pre-parsed values. Readers use the
+	// current snapshot without locking. Writers only drop it, the next read
+	// or writeBuffer() publishes a new one, so a batch of writes is copied once.
+	struct ConfigSnapshot {
+		std::vector<ConfigInfo> values;
+		std::vector<int> intValues;
+		std::vector<std::list<int> > intListValues;
+	};
+
+	void buildConfigIndex();
+	void invalidateSnapshot();
+	boost::shared_ptr<const ConfigSnapshot> publishSnapshot() const;
+	boost::shared_ptr<const ConfigSnapshot> getSnapshot() const;
+
 	std::vector<ConfigInfo> configList;
 	std::vector<ConfigInfo> configBufferList;
+	boost::unordered_map<std::string, int> configIndex;
+	mutable boost::shared_ptr<const ConfigSnapshot> m_configSnapshot;
 
 	std::string configFileName;
 	std::string logDir;
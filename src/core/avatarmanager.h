@@ -45,6 +45,11 @@
 
 #define MIN_AVATAR_FILE_SIZE	32
 #define MAX_AVATAR_FILE_SIZE	30720
+// Number of avatars kept as prepared network packets.
+#define MAX_AVATAR_PACKET_CACHE_ENTRIES	512
+// Index of the cache directory (MD5, size, modification time).
+#define AVATAR_CACHE_INDEX_FILE_NAME	"avatar_index.txt"
+#define MAX_AVATAR_HASH_THREADS			4
 
 struct AvatarFileState;
 class UploaderThread;
@@ -65,6 +70,9 @@ public:
 	static unsigned ChunkReadAvatarFile(boost::shared_ptr<AvatarFileState> fileState, unsigned char *data, unsigned chunkSize);
 
 	static int AvatarFileToNetPackets(const std::string &fileName, unsigned requestId, NetPacketList &packets);
+	// Same as AvatarFileToNetPackets, but uses an in-memory LRU cache of the packets.
+	int CachedAvatarToNetPackets(const MD5Buf &md5buf, const std::string &fileName, unsigned requestId, NetPacketList &packets);
+	void GetPacketCacheStats(unsigned &outHits, unsigned &outMisses, unsigned &outNumEntries) const;
 	static AvatarFileType GetAvatarFileType(const std::string &fileName);
 	static std::string GetAvatarFileExtension(AvatarFileType fileType);
 
@@ -77,12 +85,39 @@ public:
 
 	void RemoveOldAvatarCacheEntries();
 
+	// Whether the background check of the cache directory is complete.
+	bool IsCacheRevalidated() const;
+
 protected:
 	typedef std::map<MD5Buf, std::string> AvatarMap;
 	typedef std::list<MD5Buf> AvatarList;
 	typedef std::map<std::time_t, MD5Buf> TimeAvatarMap;
 
+	struct AvatarPacketCacheEntry {
+		AvatarPacketCacheEntry() : requestId(0) {}
+		unsigned requestId;
+		// Shared with all sessions, never modified after insertion.
+		NetPacketList packets;
+		AvatarList::iterator lruPos;
+	};
+	typedef std::map<MD5Buf, AvatarPacketCacheEntry> AvatarPacketMap;
+
+	struct AvatarIndexEntry {
+		AvatarIndexEntry() : size(0), lastWriteTime(0) {}
+		MD5Buf md5buf;
+		boost::uintmax_t size;
+		std::time_t lastWriteTime;
+	};
+	// Maps file name to index entry.
+	typedef std::map<std::string, AvatarIndexEntry> AvatarIndexMap;
+
 	bool InternalReadDirectory(const std::string &dir, AvatarMap &avatars);
+	void RemoveFromPacketCache(const MD5Buf &md5buf);
+
+	static bool InternalLoadIndex(const std::string &indexFileName, AvatarIndexMap &index);
+	static bool InternalSaveIndex(const std::string &indexFileName, const AvatarIndexMap &index);
+	void InternalRevalidateCache(const std::string &cacheDir);
+	void SaveCacheIndex();
 
 private:
 	mutable boost::mutex	m_avatarsMutex;
@@ -90,10 +125,20 @@ private:
 
 	mutable boost::mutex	m_cachedAvatarsMutex;
 	AvatarMap				m_cachedAvatars;
+	AvatarIndexMap			m_cacheIndex;
+	bool					m_cacheRevalidated;
+	bool					m_removeOldEntriesPending;
+	boost::shared_ptr<boost::thread> m_revalidateThread;
 
 	mutable boost::mutex	m_cacheDirMutex;
 	std::string				m_cacheDir;
 
+	mutable boost::mutex	m_packetCacheMutex;
+	AvatarPacketMap			m_packetCache;
+	AvatarList				m_packetCacheLru;
+	unsigned				m_packetCacheHits;
+	unsigned				m_packetCacheMisses;
+
 	const bool				m_useExternalServer;
 	const std::string		m_externalServerAddress;
 	const std::string		m_externalServerUser;
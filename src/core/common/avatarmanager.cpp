@@ -42,6 +42,7 @@
 #include <core/openssl_wrapper.h>
 
 #include <fstream>
+#include <sstream>
 #include <cstring>
 
 #define MAX_NUMBER_OF_FILES			NetHelper::GetMaxNumberOfAvatarFiles()
@@ -66,7 +67,8 @@ struct AvatarFileState {
 
 AvatarManager::AvatarManager(bool useExternalServer, const std::string &externalServerAddress,
 							 const string &externalServerUser, const string &externalServerPassword)
-	: m_useExternalServer(useExternalServer), m_externalServerAddress(externalServerAddress),
+	: m_cacheRevalidated(false), m_removeOldEntriesPending(false), m_packetCacheHits(0), m_packetCacheMisses(0),
+	  m_useExternalServer(useExternalServer), m_externalServerAddress(externalServerAddress),
 	  m_externalServerUser(externalServerUser), m_externalServerPassword(externalServerPassword)
 {
 	m_uploader.reset(new UploaderThread());
@@ -74,6 +76,11 @@ AvatarManager::AvatarManager(bool useExternalServer, const std::string &external
 
 AvatarManager::~AvatarManager()
 {
+	if (m_revalidateThread) {
+		m_revalidateThread->interrupt();
+		m_revalidateThread->join();
+	}
+	SaveCacheIndex();
 	m_uploader->SignalTermination();
 	m_uploader->Join(UPLOADER_THREAD_TERMINATE_TIMEOUT);
 }
@@ -99,9 +106,25 @@ AvatarManager::Init(const string &dataDir, const string &cacheDir)
 	if (cacheDir.empty() || tmpCachePath.empty())
 		LOG_ERROR("Cache directory was not set!");
 	else {
+		// Use the index of the last run, the directory is checked in the background.
+		AvatarIndexMap tmpIndex;
 		boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
-		tmpRet = InternalReadDirectory(tmpCachePath.directory_string(), m_cachedAvatars);
-		retVal = retVal && tmpRet;
+		if (InternalLoadIndex((tmpCachePath / AVATAR_CACHE_INDEX_FILE_NAME).file_string(), tmpIndex)) {
+			m_cacheIndex.swap(tmpIndex);
+			AvatarIndexMap::const_iterator i = m_cacheIndex.begin();
+			AvatarIndexMap::const_iterator end = m_cacheIndex.end();
+			while (i != end) {
+				m_cachedAvatars.insert(AvatarMap::value_type(i->second.md5buf, i->first));
+				++i;
+			}
+		} else {
+			tmpRet = InternalReadDirectory(tmpCachePath.directory_string(), m_cachedAvatars);
+			retVal = retVal && tmpRet;
+		}
+		if (!m_revalidateThread) {
+			m_revalidateThread.reset(new boost::thread(
+										 boost::bind(&AvatarManager::InternalRevalidateCache, this, tmpCachePath.directory_string())));
+		}
 	}
 
 	m_uploader->Run();
@@ -242,6 +265,98 @@ AvatarManager::AvatarFileToNetPackets(const string &fileName, unsigned requestId
 	return retVal;
 }
 
+int
+AvatarManager::CachedAvatarToNetPackets(const MD5Buf &md5buf, const std::string &fileName, unsigned requestId, NetPacketList &packets)
+{
+	NetPacketList sourcePackets;
+	{
+		boost::mutex::scoped_lock lock(m_packetCacheMutex);
+		AvatarPacketMap::iterator pos = m_packetCache.find(md5buf);
+		if (pos != m_packetCache.end()) {
+			// Move to front of LRU list.
+			m_packetCacheLru.splice(m_packetCacheLru.begin(), m_packetCacheLru, pos->second.lruPos);
+			m_packetCacheHits++;
+			if (pos->second.requestId == requestId) {
+				// Clients use the player id as request id, so the packets can usually be shared.
+				packets.insert(packets.end(), pos->second.packets.begin(), pos->second.packets.end());
+				return 0;
+			}
+			sourcePackets = pos->second.packets;
+		}
+	}
+
+	NetPacketList preparedPackets;
+	if (sourcePackets.empty()) {
+		int retVal = AvatarFileToNetPackets(fileName, requestId, preparedPackets);
+		if (retVal != 0)
+			return retVal;
+	} else {
+		// Different request id, copy the messages instead of reading the file again.
+		NetPacketList::const_iterator i = sourcePackets.begin();
+		NetPacketList::const_iterator end = sourcePackets.end();
+		while (i != end) {
+			boost::shared_ptr<NetPacket> tmpPacket(new NetPacket);
+			tmpPacket->GetMsg()->CopyFrom(*(*i)->GetMsg());
+			LobbyMessage *netLobby = tmpPacket->GetMsg()->mutable_lobbymessage();
+			switch (netLobby->messagetype()) {
+			case LobbyMessage::Type_AvatarHeaderMessage:
+				netLobby->mutable_avatarheadermessage()->set_requestid(requestId);
+				break;
+			case LobbyMessage::Type_AvatarDataMessage:
+				netLobby->mutable_avatardatamessage()->set_requestid(requestId);
+				break;
+			case LobbyMessage::Type_AvatarEndMessage:
+				netLobby->mutable_avatarendmessage()->set_requestid(requestId);
+				break;
+			default:
+				break;
+			}
+			preparedPackets.push_back(tmpPacket);
+			++i;
+		}
+	}
+
+	{
+		boost::mutex::scoped_lock lock(m_packetCacheMutex);
+		AvatarPacketMap::iterator pos = m_packetCache.find(md5buf);
+		if (pos == m_packetCache.end()) {
+			m_packetCacheMisses++;
+			m_packetCacheLru.push_front(md5buf);
+			pos = m_packetCache.insert(AvatarPacketMap::value_type(md5buf, AvatarPacketCacheEntry())).first;
+			pos->second.lruPos = m_packetCacheLru.begin();
+			if (m_packetCache.size() > MAX_AVATAR_PACKET_CACHE_ENTRIES) {
+				m_packetCache.erase(m_packetCacheLru.back());
+				m_packetCacheLru.pop_back();
+			}
+		}
+		// Keep the packets of the most recent request id, older lists stay valid for their senders.
+		pos->second.requestId = requestId;
+		pos->second.packets = preparedPackets;
+	}
+	packets.insert(packets.end(), preparedPackets.begin(), preparedPackets.end());
+	return 0;
+}
+
+void
+AvatarManager::GetPacketCacheStats(unsigned &outHits, unsigned &outMisses, unsigned &outNumEntries) const
+{
+	boost::mutex::scoped_lock lock(m_packetCacheMutex);
+	outHits = m_packetCacheHits;
+	outMisses = m_packetCacheMisses;
+	outNumEntries = static_cast<unsigned>(m_packetCache.size());
+}
+
+void
+AvatarManager::RemoveFromPacketCache(const MD5Buf &md5buf)
+{
+	boost::mutex::scoped_lock lock(m_packetCacheMutex);
+	AvatarPacketMap::iterator pos = m_packetCache.find(md5buf);
+	if (pos != m_packetCache.end()) {
+		m_packetCacheLru.erase(pos->second.lruPos);
+		m_packetCache.erase(pos);
+	}
+}
+
 AvatarFileType
 AvatarManager::GetAvatarFileType(const string &fileName)
 {
@@ -382,6 +497,11 @@ AvatarManager::StoreAvatarInCache(const MD5Buf &md5buf, AvatarFileType avatarFil
 					{
 						boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
 						m_cachedAvatars.insert(AvatarMap::value_type(md5buf, fileName));
+						AvatarIndexEntry &entry = m_cacheIndex[fileName];
+						entry.md5buf = md5buf;
+						entry.size = size;
+						boost::system::error_code ec;
+						entry.lastWriteTime = last_write_time(tmpPath, ec);
 					}
 					retVal = true;
 				}
@@ -427,6 +547,14 @@ AvatarManager::IsValidAvatarFileType(AvatarFileType avatarFileType, const unsign
 void
 AvatarManager::RemoveOldAvatarCacheEntries()
 {
+	{
+		// Defer the cleanup until the cache was checked in the background.
+		boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
+		if (m_revalidateThread && !m_cacheRevalidated) {
+			m_removeOldEntriesPending = true;
+			return;
+		}
+	}
 	string cacheDir;
 	{
 		boost::mutex::scoped_lock lock(m_cacheDirMutex);
@@ -471,6 +599,7 @@ AvatarManager::RemoveOldAvatarCacheEntries()
 				AvatarList::const_iterator end = removeList.end();
 				while (i != end) {
 					m_cachedAvatars.erase(*i);
+					RemoveFromPacketCache(*i);
 					++i;
 				}
 				removeList.clear();
@@ -489,6 +618,7 @@ AvatarManager::RemoveOldAvatarCacheEntries()
 					if (pos != m_cachedAvatars.end()) {
 						path tmpPath(pos->second);
 						remove(tmpPath);
+						RemoveFromPacketCache(pos->first);
 						m_cachedAvatars.erase(pos);
 					}
 					timeMap.erase(i);
@@ -505,6 +635,7 @@ AvatarManager::RemoveOldAvatarCacheEntries()
 				if (pos != m_cachedAvatars.end()) {
 					path tmpPath(pos->second);
 					remove(tmpPath);
+					RemoveFromPacketCache(pos->first);
 					m_cachedAvatars.erase(pos);
 				}
 				timeMap.erase(i);
@@ -515,6 +646,233 @@ AvatarManager::RemoveOldAvatarCacheEntries()
 	}
 }
 
+bool
+AvatarManager::IsCacheRevalidated() const
+{
+	boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
+	return m_cacheRevalidated;
+}
+
+bool
+AvatarManager::InternalLoadIndex(const std::string &indexFileName, AvatarIndexMap &index)
+{
+	std::ifstream i(indexFileName.c_str(), ios_base::in);
+	if (i.fail())
+		return false;
+
+	// Format per line: <md5> <size> <modification time> <file name>
+	string line;
+	while (getline(i, line)) {
+		istringstream lineStream(line);
+		string md5sum;
+		AvatarIndexEntry entry;
+		string fileName;
+		lineStream >> md5sum >> entry.size >> entry.lastWriteTime;
+		lineStream >> ws;
+		getline(lineStream, fileName);
+		if (lineStream.fail() || fileName.empty() || !entry.md5buf.FromString(md5sum))
+			return false;
+		index[fileName] = entry;
+	}
+	return true;
+}
+
+bool
+AvatarManager::InternalSaveIndex(const std::string &indexFileName, const AvatarIndexMap &index)
+{
+	bool retVal = false;
+	try {
+		// Write to a temporary file first, so that the index is never incomplete.
+		string tmpFileName(indexFileName + ".tmp");
+		{
+			std::ofstream o(tmpFileName.c_str(), ios_base::out | ios_base::trunc);
+			if (o.fail())
+				return false;
+			AvatarIndexMap::const_iterator i = index.begin();
+			AvatarIndexMap::const_iterator end = index.end();
+			while (i != end) {
+				o << i->second.md5buf.ToString() << " " << i->second.size << " " << i->second.lastWriteTime << " " << i->first << "\n";
+				++i;
+			}
+			retVal = !o.fail();
+		}
+		if (retVal)
+			rename(tmpFileName, indexFileName);
+	} catch (...) {
+		LOG_ERROR("Exception caught when trying to save avatar index.");
+		retVal = false;
+	}
+	return retVal;
+}
+
+// Hashes files for the cache revalidation.
+class AvatarHashWorker
+{
+public:
+	AvatarHashWorker(const vector<string> &fileNames, vector<MD5Buf> &results, vector<bool> &resultValid)
+		: m_fileNames(fileNames), m_results(results), m_resultValid(resultValid), m_nextFile(0) {}
+
+	void operator()() {
+		while (true) {
+			boost::this_thread::interruption_point();
+			size_t curFile;
+			{
+				boost::mutex::scoped_lock lock(m_nextFileMutex);
+				if (m_nextFile >= m_fileNames.size())
+					break;
+				curFile = m_nextFile++;
+			}
+			MD5Buf tmpBuf;
+			bool valid = CryptHelper::MD5Sum(m_fileNames[curFile], tmpBuf);
+			boost::mutex::scoped_lock lock(m_nextFileMutex);
+			m_results[curFile] = tmpBuf;
+			m_resultValid[curFile] = valid;
+		}
+	}
+
+private:
+	const vector<string> &m_fileNames;
+	vector<MD5Buf> &m_results;
+	vector<bool> &m_resultValid;
+	boost::mutex m_nextFileMutex;
+	size_t m_nextFile;
+};
+
+void
+AvatarManager::InternalRevalidateCache(const std::string &cacheDir)
+{
+	try {
+		AvatarIndexMap oldIndex;
+		bool removeOldEntries;
+		{
+			boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
+			oldIndex = m_cacheIndex;
+		}
+
+		// Only new or modified files need to be hashed.
+		AvatarIndexMap newIndex;
+		vector<string> hashFileNames;
+		vector<AvatarIndexEntry> hashEntries;
+		path tmpPath(cacheDir);
+		if (exists(tmpPath) && is_directory(tmpPath)) {
+			directory_iterator i(tmpPath);
+			directory_iterator end;
+			while (i != end) {
+				boost::this_thread::interruption_point();
+				MD5Buf md5buf;
+				if (is_regular(i->status()) && md5buf.FromString(basename(i->path()))) {
+					string fileName(i->path().file_string());
+					AvatarIndexEntry entry;
+					entry.md5buf = md5buf;
+					entry.size = file_size(i->path());
+					entry.lastWriteTime = last_write_time(i->path());
+					AvatarIndexMap::const_iterator pos = oldIndex.find(fileName);
+					if (pos != oldIndex.end() && pos->second.size == entry.size
+							&& pos->second.lastWriteTime == entry.lastWriteTime && pos->second.md5buf == md5buf) {
+						newIndex[fileName] = entry;
+					} else {
+						hashFileNames.push_back(fileName);
+						hashEntries.push_back(entry);
+					}
+				}
+				++i;
+			}
+		}
+
+		if (!hashFileNames.empty()) {
+			vector<MD5Buf> results(hashFileNames.size());
+			vector<bool> resultValid(hashFileNames.size(), false);
+			AvatarHashWorker worker(hashFileNames, results, resultValid);
+			unsigned numThreads = boost::thread::hardware_concurrency();
+			numThreads = max(1u, min(numThreads, (unsigned)MAX_AVATAR_HASH_THREADS));
+			boost::thread_group workers;
+			for (unsigned t = 0; t < numThreads; t++)
+				workers.create_thread(boost::ref(worker));
+			try {
+				workers.join_all();
+			} catch (boost::thread_interrupted &) {
+				workers.interrupt_all();
+				workers.join_all();
+				throw;
+			}
+			for (size_t f = 0; f < hashFileNames.size(); f++) {
+				if (resultValid[f] && results[f] == hashEntries[f].md5buf)
+					newIndex[hashFileNames[f]] = hashEntries[f];
+				else
+					LOG_ERROR("Avatar cache file \"" << hashFileNames[f] << "\" does not match its MD5 sum.");
+			}
+			LOG_VERBOSE("Hashed " << hashFileNames.size() << " new or modified avatar cache files.");
+		}
+
+		{
+			boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
+			// Keep entries which were stored in the meantime.
+			AvatarIndexMap::const_iterator i = m_cacheIndex.begin();
+			AvatarIndexMap::const_iterator end = m_cacheIndex.end();
+			while (i != end) {
+				AvatarIndexMap::const_iterator oldPos = oldIndex.find(i->first);
+				if (oldPos == oldIndex.end() || oldPos->second.lastWriteTime != i->second.lastWriteTime)
+					newIndex[i->first] = i->second;
+				++i;
+			}
+			// Remove entries which were not confirmed, add files which were not in the index.
+			AvatarMap::iterator a = m_cachedAvatars.begin();
+			while (a != m_cachedAvatars.end()) {
+				if (newIndex.find(a->second) == newIndex.end())
+					m_cachedAvatars.erase(a++);
+				else
+					++a;
+			}
+			i = newIndex.begin();
+			end = newIndex.end();
+			while (i != end) {
+				m_cachedAvatars.insert(AvatarMap::value_type(i->second.md5buf, i->first));
+				++i;
+			}
+			m_cacheIndex.swap(newIndex);
+			m_cacheRevalidated = true;
+			removeOldEntries = m_removeOldEntriesPending;
+		}
+		if (removeOldEntries)
+			RemoveOldAvatarCacheEntries();
+		SaveCacheIndex();
+	} catch (boost::thread_interrupted &) {
+		// Terminated during revalidation.
+	} catch (...) {
+		LOG_ERROR("Exception caught when trying to revalidate avatar cache.");
+	}
+}
+
+void
+AvatarManager::SaveCacheIndex()
+{
+	string cacheDir;
+	{
+		boost::mutex::scoped_lock lock(m_cacheDirMutex);
+		cacheDir = m_cacheDir;
+	}
+	if (cacheDir.empty())
+		return;
+
+	AvatarIndexMap tmpIndex;
+	{
+		boost::mutex::scoped_lock lock(m_cachedAvatarsMutex);
+		if (!m_cacheRevalidated)
+			return;
+		// Skip files which were removed from the cache.
+		AvatarIndexMap::const_iterator i = m_cacheIndex.begin();
+		AvatarIndexMap::const_iterator end = m_cacheIndex.end();
+		while (i != end) {
+			AvatarMap::const_iterator pos = m_cachedAvatars.find(i->second.md5buf);
+			if (pos != m_cachedAvatars.end() && pos->second == i->first)
+				tmpIndex.insert(*i);
+			++i;
+		}
+	}
+	path tmpPath(cacheDir);
+	InternalSaveIndex((tmpPath / AVATAR_CACHE_INDEX_FILE_NAME).file_string(), tmpIndex);
+}
+
 bool
 AvatarManager::InternalReadDirectory(const std::string &dir, AvatarMap &avatars)
 {
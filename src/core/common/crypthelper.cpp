@@ -248,6 +248,20 @@ CryptHelper::HMACSha1(const unsigned char *keyData, unsigned keySize, const unsi
 	return retVal;
 }
 
+bool
+CryptHelper::PBKDF2Sha1(const std::string &password, const unsigned char *saltData, unsigned saltSize, unsigned iterations, SHA1Buf &buf)
+{
+	bool retVal;
+#ifdef HAVE_OPENSSL
+	retVal = PKCS5_PBKDF2_HMAC_SHA1(password.c_str(), static_cast<int>(password.length()), saltData, static_cast<int>(saltSize),
+									static_cast<int>(iterations), buf.GetDataSize(), buf.GetData()) == 1;
+#else
+	retVal = gcry_kdf_derive(password.c_str(), password.length(), GCRY_KDF_PBKDF2, GCRY_MD_SHA1, saltData, saltSize,
+							 iterations, buf.GetDataSize(), buf.GetData()) == 0;
+#endif
+	return retVal;
+}
+
 void
 CryptHelper::BytesToKey(const unsigned char *keyData, unsigned keySize, unsigned char *key, unsigned char *iv)
 {
@@ -49,6 +49,17 @@ loghelper_init(const std::string & /*logDir*/, int logLevel)
 	g_logLevel = logLevel;
 }
 
+void
+loghelper_cleanup()
+{
+}
+
+bool
+internal_log_enabled(int logLevel)
+{
+	return g_logLevel >= logLevel;
+}
+
 void
 internal_log_err(const string &msg)
 {
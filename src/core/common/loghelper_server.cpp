@@ -39,9 +39,13 @@
 #endif
 
 #include <core/loghelper.h>
+#include <core/thread.h>
 #include <fstream>
+#include <ctime>
+#include <boost/atomic.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/date_time.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
 
 
 using namespace std;
@@ -49,10 +53,273 @@ using namespace boost::filesystem;
 using namespace boost::posix_time;
 
 #define SERVER_MSG_LOG_FILE_NAME				"server_messages.log"
+// Rotate the log file when it grows beyond this size.
+#define SERVER_MSG_LOG_MAX_SIZE					(32 * 1024 * 1024)
+#define SERVER_MSG_LOG_NUM_BACKUPS				5
+// Maximum time a non-error line may stay in the queue.
+#define SERVER_MSG_LOG_FLUSH_INTERVAL_MSEC		200
+// Check at most this often whether the file was moved away externally.
+#define SERVER_MSG_LOG_REOPEN_CHECK_SEC			5
+// Lines beyond this number are dropped while the writer is behind.
+#define SERVER_MSG_LOG_MAX_PENDING				100000
+
+enum LogEntryType { LOG_ENTRY_ERR, LOG_ENTRY_MSG, LOG_ENTRY_OUT };
+
+// Single log line, linked into the lock-free queue.
+struct LogEntry {
+	LogEntry(LogEntryType t, const string &m) : next(NULL), type(t), timestamp(time(NULL)), msg(m) {}
+	LogEntry *next;
+	LogEntryType type;
+	time_t timestamp;
+	string msg;
+};
 
 static string g_logFile;
 static int g_logLevel = 1;
 
+// Producers push entries onto an intrusive lock-free stack, the writer swaps
+// out the whole stack at once. The stack is not owned by the writer, so that
+// producers never access the writer after it was stopped.
+static boost::atomic<LogEntry *> g_logHead(NULL);
+static boost::atomic<unsigned> g_logNumPending(0);
+static boost::atomic<unsigned> g_logNumDropped(0);
+static boost::atomic<bool> g_logWriterStopped(false);
+static boost::mutex g_logWakeupMutex;
+static boost::condition_variable g_logWakeupCond;
+
+static void
+push_log_entry(LogEntry *entry)
+{
+	LogEntry *oldHead = g_logHead.load(boost::memory_order_relaxed);
+	do {
+		entry->next = oldHead;
+	} while (!g_logHead.compare_exchange_weak(oldHead, entry));
+}
+
+// Removes all pending entries and returns them in the order they were pushed.
+static LogEntry *
+take_log_entries()
+{
+	LogEntry *entry = g_logHead.exchange(NULL);
+	// The stack is in LIFO order, reverse it.
+	LogEntry *ordered = NULL;
+	unsigned numEntries = 0;
+	while (entry) {
+		LogEntry *next = entry->next;
+		entry->next = ordered;
+		ordered = entry;
+		entry = next;
+		numEntries++;
+	}
+	if (numEntries)
+		g_logNumPending.fetch_sub(numEntries, boost::memory_order_relaxed);
+	return ordered;
+}
+
+static const char *
+log_entry_prefix(LogEntryType type)
+{
+	switch (type) {
+	case LOG_ENTRY_ERR:
+		return " ERR: ";
+	case LOG_ENTRY_MSG:
+		return " MSG: ";
+	default:
+		return " OUT: ";
+	}
+}
+
+static string
+log_timestamp(time_t timestamp)
+{
+	ostringstream timeStream;
+	timeStream << boost::date_time::c_local_adjustor<ptime>::utc_to_local(from_time_t(timestamp));
+	return timeStream.str();
+}
+
+static string
+log_dropped_msg(unsigned numDropped)
+{
+	ostringstream msgStream;
+	msgStream << numDropped << " log lines were dropped, because the log writer could not keep up." << endl;
+	return msgStream.str();
+}
+
+// Background writer. Swaps out the pending stack, restores the order and
+// writes the batch to the file which is kept open.
+class LogWriterThread : public Thread
+{
+public:
+	LogWriterThread(const string &fileName)
+		: m_fileName(fileName), m_fileSize(0), m_lastReopenCheck(0), m_lastTimestamp(0) {}
+
+	virtual void SignalTermination() {
+		Thread::SignalTermination();
+		g_logWakeupCond.notify_one();
+	}
+
+protected:
+	virtual void Main() {
+		OpenFile();
+		while (!ShouldTerminate()) {
+			if (!WriteBatch()) {
+				boost::mutex::scoped_lock lock(g_logWakeupMutex);
+				g_logWakeupCond.timed_wait(lock, millisec(SERVER_MSG_LOG_FLUSH_INTERVAL_MSEC));
+			}
+		}
+		// Drain remaining lines before terminating.
+		WriteBatch();
+		m_stream.close();
+	}
+
+	bool WriteBatch() {
+		LogEntry *ordered = take_log_entries();
+		unsigned numDropped = g_logNumDropped.exchange(0, boost::memory_order_relaxed);
+		if (!ordered && !numDropped)
+			return false;
+
+		CheckReopen();
+		while (ordered) {
+			LogEntry *next = ordered->next;
+			WriteEntry(*ordered);
+			delete ordered;
+			ordered = next;
+		}
+		if (numDropped)
+			WriteEntry(LogEntry(LOG_ENTRY_ERR, log_dropped_msg(numDropped)));
+		m_stream.flush();
+		return true;
+	}
+
+	void WriteEntry(const LogEntry &entry) {
+		if (m_fileSize >= SERVER_MSG_LOG_MAX_SIZE) {
+			// Rotation happens between two lines, nothing is lost.
+			RotateFile();
+		}
+		if (!m_stream.is_open())
+			return;
+
+		if (entry.timestamp != m_lastTimestamp) {
+			m_timestampStr = log_timestamp(entry.timestamp);
+			m_lastTimestamp = entry.timestamp;
+		}
+		m_stream << m_timestampStr << log_entry_prefix(entry.type) << entry.msg;
+		m_fileSize += m_timestampStr.size() + 6 + entry.msg.size();
+	}
+
+	void OpenFile() {
+		m_stream.clear();
+		m_stream.open(m_fileName.c_str(), ios_base::out | ios_base::app);
+		m_fileSize = 0;
+		if (m_stream.is_open()) {
+			boost::system::error_code ec;
+			boost::uintmax_t tmpSize = file_size(m_fileName, ec);
+			if (!ec)
+				m_fileSize = tmpSize;
+		}
+	}
+
+	void CheckReopen() {
+		// Reopen the file if it was moved away, e.g. by logrotate.
+		time_t now = time(NULL);
+		if (now - m_lastReopenCheck >= SERVER_MSG_LOG_REOPEN_CHECK_SEC) {
+			m_lastReopenCheck = now;
+			boost::system::error_code ec;
+			if (!m_stream.is_open() || !exists(m_fileName, ec)) {
+				m_stream.close();
+				OpenFile();
+			}
+		}
+	}
+
+	void RotateFile() {
+		m_stream.close();
+		boost::system::error_code ec;
+		for (int i = SERVER_MSG_LOG_NUM_BACKUPS - 1; i >= 1; i--) {
+			ostringstream from, to;
+			from << m_fileName << "." << i;
+			to << m_fileName << "." << (i + 1);
+			if (exists(from.str(), ec))
+				rename(from.str(), to.str(), ec);
+		}
+		rename(m_fileName, m_fileName + ".1", ec);
+		OpenFile();
+	}
+
+private:
+	const string m_fileName;
+	std::ofstream m_stream;
+	boost::uintmax_t m_fileSize;
+	time_t m_lastReopenCheck;
+	time_t m_lastTimestamp;
+	string m_timestampStr;
+};
+
+static boost::once_flag g_logWriterOnce = BOOST_ONCE_INIT;
+static LogWriterThread *g_logWriter = NULL;
+
+static void
+start_log_writer()
+{
+	// The writer is started lazily, because the server forks into
+	// the background after loghelper_init.
+	g_logWriter = new LogWriterThread(g_logFile);
+	g_logWriter->Run();
+}
+
+static void
+no_log_writer()
+{
+}
+
+// Used after the writer was stopped, e.g. for messages of destructors
+// during shutdown. Lines are written directly, as before the writer existed.
+static void
+write_log_entries_sync()
+{
+	static boost::mutex syncMutex;
+	boost::mutex::scoped_lock lock(syncMutex);
+
+	LogEntry *ordered = take_log_entries();
+	unsigned numDropped = g_logNumDropped.exchange(0, boost::memory_order_relaxed);
+	std::ofstream o(g_logFile.c_str(), ios_base::out | ios_base::app);
+	while (ordered) {
+		LogEntry *next = ordered->next;
+		if (!o.fail())
+			o << log_timestamp(ordered->timestamp) << log_entry_prefix(ordered->type) << ordered->msg;
+		delete ordered;
+		ordered = next;
+	}
+	if (numDropped && !o.fail())
+		o << log_timestamp(time(NULL)) << log_entry_prefix(LOG_ENTRY_ERR) << log_dropped_msg(numDropped);
+}
+
+static void
+enqueue_log_entry(LogEntryType type, const string &msg)
+{
+	if (g_logFile.empty())
+		return;
+	if (!g_logWriterStopped.load())
+		boost::call_once(g_logWriterOnce, start_log_writer);
+
+	// Bound the memory if the writer cannot keep up, e.g. on a stalled disk.
+	if (g_logNumPending.fetch_add(1, boost::memory_order_relaxed) >= SERVER_MSG_LOG_MAX_PENDING) {
+		g_logNumPending.fetch_sub(1, boost::memory_order_relaxed);
+		g_logNumDropped.fetch_add(1, boost::memory_order_relaxed);
+		return;
+	}
+	push_log_entry(new LogEntry(type, msg));
+
+	// If the writer has not seen the stop flag yet, it will write the entry
+	// in its final batch. Otherwise the entry is written here.
+	if (g_logWriterStopped.load())
+		write_log_entries_sync();
+	else if (type == LOG_ENTRY_ERR) {
+		// Errors are written without delay.
+		g_logWakeupCond.notify_one();
+	}
+}
+
 void
 loghelper_init(const string &logDir, int logLevel)
 {
@@ -64,42 +331,45 @@ loghelper_init(const string &logDir, int logLevel)
 }
 
 void
-internal_log_err(const string &msg)
+loghelper_cleanup()
 {
-	if (!g_logFile.empty()) {
-		std::ofstream o(g_logFile.c_str(), ios_base::out | ios_base::app);
-		if (!o.fail()) {
-			o << second_clock::local_time() << " ERR: " << msg;
-			o.flush();
-		}
+	g_logWriterStopped.store(true);
+	// Wait for a writer which is just being started, and do not start one anymore.
+	boost::call_once(g_logWriterOnce, no_log_writer);
+	if (g_logWriter) {
+		g_logWriter->SignalTermination();
+		g_logWriter->Join(THREAD_WAIT_INFINITE);
+		delete g_logWriter;
+		g_logWriter = NULL;
 	}
 }
 
+bool
+internal_log_enabled(int logLevel)
+{
+	return g_logLevel >= logLevel;
+}
+
+void
+internal_log_err(const string &msg)
+{
+	enqueue_log_entry(LOG_ENTRY_ERR, msg);
+}
+
 void
 internal_log_msg(const std::string &msg)
 {
-	if (g_logLevel) {
-		if (!g_logFile.empty()) {
-			std::ofstream o(g_logFile.c_str(), ios_base::out | ios_base::app);
-			if (!o.fail())
-				o << second_clock::local_time() << " MSG: " << msg;
-		}
-	}
+	if (g_logLevel)
+		enqueue_log_entry(LOG_ENTRY_MSG, msg);
 }
 
 void
 internal_log_level(const std::string &msg, int logLevel)
 {
-	if (g_logLevel >= logLevel) {
-		if (!g_logFile.empty()) {
-			std::ofstream o(g_logFile.c_str(), ios_base::out | ios_base::app);
-			if (!o.fail())
-				o << second_clock::local_time() << " OUT: " << msg;
-		}
-	}
+	if (g_logLevel >= logLevel)
+		enqueue_log_entry(LOG_ENTRY_OUT, msg);
 }
 
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
-
@@ -91,6 +91,7 @@ public:
 	static bool MD5Sum(const std::string &fileName, MD5Buf &buf);
 	static bool SHA1Hash(const unsigned char *data, unsigned dataSize, SHA1Buf &buf);
 	static bool HMACSha1(const unsigned char *keyData, unsigned keySize, const unsigned char *plainData, unsigned plainSize, SHA1Buf &buf);
+	static bool PBKDF2Sha1(const std::string &password, const unsigned char *saltData, unsigned saltSize, unsigned iterations, SHA1Buf &buf);
 	static bool AES128Encrypt(const unsigned char *keyData, unsigned keySize, const std::string &plainStr, std::vector<unsigned char> &outCipher);
 	static bool AES128Decrypt(const unsigned char *keyData, unsigned keySize, const unsigned char *cipher, unsigned cipherSize, std::string &outPlain);
 
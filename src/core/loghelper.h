@@ -37,7 +37,11 @@
 #include <sstream>
 
 void loghelper_init(const std::string &logDir, int logLevel);
+// Write all pending log lines and stop the log writer.
+void loghelper_cleanup();
 
+// Check the log level before formatting a message.
+bool internal_log_enabled(int logLevel);
 void internal_log_err(const std::string &msg);
 void internal_log_msg(const std::string &msg);
 void internal_log_level(const std::string &msg, int logLevel);
@@ -53,17 +57,21 @@ void internal_log_level(const std::string &msg, int logLevel);
 #define LOG_MSG(_e) \
 	do \
 	{ \
-		std::ostringstream outStream; \
-		outStream << _e << std::endl; \
-		internal_log_msg(outStream.str()); \
+		if (internal_log_enabled(1)) { \
+			std::ostringstream outStream; \
+			outStream << _e << std::endl; \
+			internal_log_msg(outStream.str()); \
+		} \
 	} \
 	while(false)
 #define LOG_VERBOSE(_e) \
 	do \
 	{ \
-		std::ostringstream outStream; \
-		outStream << _e << std::endl; \
-		internal_log_level(outStream.str(), 2); \
+		if (internal_log_enabled(2)) { \
+			std::ostringstream outStream; \
+			outStream << _e << std::endl; \
+			internal_log_level(outStream.str(), 2); \
+		} \
 	} \
 	while(false)
 
@@ -0,0 +1,650 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include "handhistory.h"
+#include "log.h"
+#include "game_defs.h"
+
+#include <sqlite3.h>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+#define HAND_HISTORY_TRAILER_SIZE		12
+#define HAND_HISTORY_MAX_RECORD_SIZE	(1024 * 1024)
+#define HAND_HISTORY_MAX_VARINT_SIZE	10
+
+void
+HandHistoryAppendVarint(string &buf, boost::uint64_t val)
+{
+	while (val >= 0x80) {
+		buf += static_cast<char>((val & 0x7F) | 0x80);
+		val >>= 7;
+	}
+	buf += static_cast<char>(val);
+}
+
+void
+HandHistoryAppendSigned(string &buf, int val)
+{
+	// Zigzag encoding, small negative values (e.g. -1 for "none") stay small.
+	HandHistoryAppendVarint(buf, (static_cast<boost::uint32_t>(val) << 1) ^ static_cast<boost::uint32_t>(val >> 31));
+}
+
+bool
+HandHistoryParseVarint(const string &buf, size_t &pos, boost::uint64_t &val)
+{
+	val = 0;
+	for (unsigned i = 0; i < HAND_HISTORY_MAX_VARINT_SIZE; i++) {
+		if (pos >= buf.size())
+			return false;
+		unsigned char c = static_cast<unsigned char>(buf[pos++]);
+		// The last byte may only contain the highest bit.
+		if (i == HAND_HISTORY_MAX_VARINT_SIZE - 1 && c > 1)
+			return false;
+		val |= static_cast<boost::uint64_t>(c & 0x7F) << (i * 7);
+		if (!(c & 0x80))
+			return true;
+	}
+	return false;
+}
+
+bool
+HandHistoryParseSigned(const string &buf, size_t &pos, int &val)
+{
+	boost::uint64_t tmp;
+	if (!HandHistoryParseVarint(buf, pos, tmp) || tmp > 0xFFFFFFFFULL)
+		return false;
+	boost::uint32_t tmp32 = static_cast<boost::uint32_t>(tmp);
+	val = static_cast<int>((tmp32 >> 1) ^ (~(tmp32 & 1) + 1));
+	return true;
+}
+
+static bool
+readVarint(istream &stream, boost::uint64_t &val, boost::uint64_t &offset)
+{
+	val = 0;
+	for (unsigned i = 0; i < HAND_HISTORY_MAX_VARINT_SIZE; i++) {
+		int c = stream.get();
+		if (c == EOF || (i == HAND_HISTORY_MAX_VARINT_SIZE - 1 && c > 1))
+			return false;
+		offset++;
+		val |= static_cast<boost::uint64_t>(c & 0x7F) << (i * 7);
+		if (!(c & 0x80))
+			return true;
+	}
+	return false;
+}
+
+HandHistoryWriter::HandHistoryWriter()
+	: m_offset(0), m_uniqueGameID(0)
+{
+}
+
+HandHistoryWriter::~HandHistoryWriter()
+{
+	close();
+}
+
+bool
+HandHistoryWriter::open(const string &fileName)
+{
+	close();
+	m_stream.open(fileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+	if (m_stream.fail())
+		return false;
+
+	string header(HAND_HISTORY_FILE_MAGIC);
+	HandHistoryAppendVarint(header, HAND_HISTORY_FORMAT_VERSION);
+	m_stream.write(header.data(), header.size());
+	m_offset = header.size();
+	m_uniqueGameID = 0;
+	m_index.clear();
+	return true;
+}
+
+void
+HandHistoryWriter::close()
+{
+	if (!m_stream.is_open())
+		return;
+
+	// Index footer.
+	boost::uint64_t indexOffset = m_offset;
+	string payload;
+	HandHistoryAppendVarint(payload, m_index.size());
+	for (vector<HandHistoryIndexEntry>::const_iterator i = m_index.begin(); i != m_index.end(); ++i) {
+		HandHistoryAppendSigned(payload, i->uniqueGameID);
+		HandHistoryAppendSigned(payload, i->handID);
+		HandHistoryAppendVarint(payload, i->offset);
+	}
+	writeRawRecord(HAND_HISTORY_RECORD_INDEX, payload);
+
+	char trailer[HAND_HISTORY_TRAILER_SIZE];
+	for (int i = 0; i < 8; i++)
+		trailer[i] = static_cast<char>((indexOffset >> (i * 8)) & 0xFF);
+	memcpy(trailer + 8, HAND_HISTORY_INDEX_MAGIC, 4);
+	m_stream.write(trailer, sizeof(trailer));
+	m_stream.close();
+	m_index.clear();
+}
+
+void
+HandHistoryWriter::flush()
+{
+	if (m_stream.is_open())
+		m_stream.flush();
+}
+
+void
+HandHistoryWriter::writeSession(const string &version, const string &date, const string &time, int logVersion)
+{
+	m_values.clear();
+	m_values.push_back(logVersion);
+	m_strings.clear();
+	m_strings.push_back(version);
+	m_strings.push_back(date);
+	m_strings.push_back(time);
+	writeRecord(HAND_HISTORY_RECORD_SESSION, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeGame(int uniqueGameID, int gameID, int startMoney, int startSb, int dealerPos)
+{
+	m_uniqueGameID = uniqueGameID;
+	m_index.push_back(HandHistoryIndexEntry(uniqueGameID, 0, m_offset));
+
+	m_values.clear();
+	m_values.push_back(uniqueGameID);
+	m_values.push_back(gameID);
+	m_values.push_back(startMoney);
+	m_values.push_back(startSb);
+	m_values.push_back(dealerPos);
+	m_strings.clear();
+	writeRecord(HAND_HISTORY_RECORD_GAME, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writePlayer(int seat, const string &name)
+{
+	m_values.clear();
+	m_values.push_back(seat);
+	m_strings.clear();
+	m_strings.push_back(name);
+	writeRecord(HAND_HISTORY_RECORD_PLAYER, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeHand(int handID, int dealerSeat, int sbAmount, int sbSeat, int bbAmount, int bbSeat, const vector<int> &seatCash)
+{
+	m_index.push_back(HandHistoryIndexEntry(m_uniqueGameID, handID, m_offset));
+
+	m_values.clear();
+	m_values.push_back(handID);
+	m_values.push_back(dealerSeat);
+	m_values.push_back(sbAmount);
+	m_values.push_back(sbSeat);
+	m_values.push_back(bbAmount);
+	m_values.push_back(bbSeat);
+	m_values.insert(m_values.end(), seatCash.begin(), seatCash.end());
+	m_strings.clear();
+	writeRecord(HAND_HISTORY_RECORD_HAND, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeAction(int round, int seat, int action, int amount)
+{
+	m_values.clear();
+	m_values.push_back(round);
+	m_values.push_back(seat);
+	m_values.push_back(action);
+	m_values.push_back(amount);
+	m_strings.clear();
+	writeRecord(HAND_HISTORY_RECORD_ACTION, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeBoardCards(int round, const int boardCards[5])
+{
+	m_values.clear();
+	m_values.push_back(round);
+	m_values.insert(m_values.end(), boardCards, boardCards + 5);
+	m_strings.clear();
+	writeRecord(HAND_HISTORY_RECORD_BOARD_CARDS, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeHoleCards(int seat, int card1, int card2)
+{
+	m_values.clear();
+	m_values.push_back(seat);
+	m_values.push_back(card1);
+	m_values.push_back(card2);
+	m_strings.clear();
+	writeRecord(HAND_HISTORY_RECORD_HOLE_CARDS, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeHandValue(int seat, int cardsValueInt, const string &handName)
+{
+	m_values.clear();
+	m_values.push_back(seat);
+	m_values.push_back(cardsValueInt);
+	m_strings.clear();
+	m_strings.push_back(handName);
+	writeRecord(HAND_HISTORY_RECORD_HAND_VALUE, m_values, m_strings);
+}
+
+void
+HandHistoryWriter::writeRecord(HandHistoryRecordType type, const vector<int> &values, const vector<string> &strings)
+{
+	if (!m_stream.is_open())
+		return;
+
+	string payload;
+	HandHistoryAppendVarint(payload, values.size());
+	for (vector<int>::const_iterator i = values.begin(); i != values.end(); ++i)
+		HandHistoryAppendSigned(payload, *i);
+	HandHistoryAppendVarint(payload, strings.size());
+	for (vector<string>::const_iterator i = strings.begin(); i != strings.end(); ++i) {
+		HandHistoryAppendVarint(payload, i->size());
+		payload += *i;
+	}
+	writeRawRecord(type, payload);
+}
+
+void
+HandHistoryWriter::writeRawRecord(HandHistoryRecordType type, const string &payload)
+{
+	if (!m_stream.is_open())
+		return;
+
+	m_buf.clear();
+	m_buf += static_cast<char>(type);
+	HandHistoryAppendVarint(m_buf, payload.size());
+	m_buf += payload;
+	m_stream.write(m_buf.data(), m_buf.size());
+	m_offset += m_buf.size();
+}
+
+HandHistoryReader::HandHistoryReader()
+	: m_offset(0), m_dataStart(0), m_uniqueGameID(0), m_handID(0)
+{
+}
+
+HandHistoryReader::~HandHistoryReader()
+{
+}
+
+bool
+HandHistoryReader::open(const string &fileName)
+{
+	close();
+	m_stream.open(fileName.c_str(), ios_base::in | ios_base::binary);
+	if (m_stream.fail())
+		return false;
+
+	char magic[4];
+	m_stream.read(magic, sizeof(magic));
+	m_offset = sizeof(magic);
+	boost::uint64_t version;
+	if (m_stream.fail() || memcmp(magic, HAND_HISTORY_FILE_MAGIC, sizeof(magic)) != 0
+			|| !readVarint(m_stream, version, m_offset) || version != HAND_HISTORY_FORMAT_VERSION) {
+		close();
+		return false;
+	}
+	m_dataStart = m_offset;
+	return true;
+}
+
+void
+HandHistoryReader::close()
+{
+	if (m_stream.is_open())
+		m_stream.close();
+	m_stream.clear();
+	m_offset = m_dataStart = 0;
+	m_uniqueGameID = m_handID = 0;
+}
+
+bool
+HandHistoryReader::next(HandHistoryRecord &record)
+{
+	int type = m_stream.get();
+	if (type == EOF || type == HAND_HISTORY_RECORD_INDEX || type < HAND_HISTORY_RECORD_SESSION || type > HAND_HISTORY_RECORD_INDEX)
+		return false;
+
+	boost::uint64_t recordOffset = m_offset;
+	m_offset++;
+	boost::uint64_t size;
+	if (!readVarint(m_stream, size, m_offset) || size > HAND_HISTORY_MAX_RECORD_SIZE)
+		return false;
+	m_buf.resize(static_cast<size_t>(size));
+	if (size) {
+		m_stream.read(&m_buf[0], size);
+		if (m_stream.gcount() != static_cast<streamsize>(size))
+			return false;
+	}
+	m_offset += size;
+
+	size_t pos = 0;
+	boost::uint64_t count;
+	if (!HandHistoryParseVarint(m_buf, pos, count) || count > size)
+		return false;
+	record.values.resize(static_cast<size_t>(count));
+	for (size_t i = 0; i < record.values.size(); i++) {
+		if (!HandHistoryParseSigned(m_buf, pos, record.values[i]))
+			return false;
+	}
+	if (!HandHistoryParseVarint(m_buf, pos, count) || count > size)
+		return false;
+	record.strings.resize(static_cast<size_t>(count));
+	for (size_t i = 0; i < record.strings.size(); i++) {
+		boost::uint64_t len;
+		if (!HandHistoryParseVarint(m_buf, pos, len) || len > m_buf.size() - pos)
+			return false;
+		record.strings[i].assign(m_buf, pos, static_cast<size_t>(len));
+		pos += static_cast<size_t>(len);
+	}
+
+	record.type = static_cast<HandHistoryRecordType>(type);
+	if (record.type == HAND_HISTORY_RECORD_GAME && !record.values.empty()) {
+		m_uniqueGameID = record.values[0];
+		m_handID = 0;
+	} else if (record.type == HAND_HISTORY_RECORD_HAND && !record.values.empty()) {
+		m_handID = record.values[0];
+	}
+	record.uniqueGameID = m_uniqueGameID;
+	record.handID = m_handID;
+	record.offset = recordOffset;
+	return true;
+}
+
+bool
+HandHistoryReader::readIndex(vector<HandHistoryIndexEntry> &index)
+{
+	index.clear();
+	if (!m_stream.is_open())
+		return false;
+
+	m_stream.clear();
+	m_stream.seekg(0, ios_base::end);
+	boost::uint64_t fileSize = m_stream.tellg();
+	if (fileSize >= m_dataStart + HAND_HISTORY_TRAILER_SIZE) {
+		unsigned char trailer[HAND_HISTORY_TRAILER_SIZE];
+		m_stream.seekg(static_cast<streamoff>(fileSize - HAND_HISTORY_TRAILER_SIZE));
+		m_stream.read(reinterpret_cast<char *>(trailer), sizeof(trailer));
+		if (!m_stream.fail() && memcmp(trailer + 8, HAND_HISTORY_INDEX_MAGIC, 4) == 0) {
+			boost::uint64_t indexOffset = 0;
+			for (int i = 0; i < 8; i++)
+				indexOffset |= static_cast<boost::uint64_t>(trailer[i]) << (i * 8);
+			m_stream.seekg(static_cast<streamoff>(indexOffset));
+			m_offset = indexOffset + 1;
+			boost::uint64_t size;
+			if (indexOffset >= m_dataStart && m_stream.get() == HAND_HISTORY_RECORD_INDEX
+					&& readVarint(m_stream, size, m_offset) && size <= fileSize - indexOffset) {
+				m_buf.resize(static_cast<size_t>(size));
+				if (size)
+					m_stream.read(&m_buf[0], size);
+				size_t pos = 0;
+				boost::uint64_t count;
+				if (!m_stream.fail() && HandHistoryParseVarint(m_buf, pos, count) && count <= size) {
+					bool ok = true;
+					for (boost::uint64_t i = 0; i < count && ok; i++) {
+						int uniqueGameID, handID;
+						boost::uint64_t offset;
+						ok = HandHistoryParseSigned(m_buf, pos, uniqueGameID) && HandHistoryParseSigned(m_buf, pos, handID)
+							 && HandHistoryParseVarint(m_buf, pos, offset);
+						if (ok)
+							index.push_back(HandHistoryIndexEntry(uniqueGameID, handID, offset));
+					}
+					if (ok) {
+						HandHistoryIndexEntry start(0, 0, m_dataStart);
+						seek(start);
+						return true;
+					}
+				}
+			}
+			index.clear();
+		}
+	}
+
+	// No valid footer, scan the file.
+	HandHistoryIndexEntry start(0, 0, m_dataStart);
+	if (!seek(start))
+		return false;
+	HandHistoryRecord record;
+	while (next(record)) {
+		if (record.type == HAND_HISTORY_RECORD_GAME || record.type == HAND_HISTORY_RECORD_HAND)
+			index.push_back(HandHistoryIndexEntry(record.uniqueGameID, record.handID, record.offset));
+	}
+	return seek(start);
+}
+
+bool
+HandHistoryReader::seek(const HandHistoryIndexEntry &entry)
+{
+	if (!m_stream.is_open() || entry.offset < m_dataStart)
+		return false;
+	m_stream.clear();
+	m_stream.seekg(static_cast<streamoff>(entry.offset));
+	m_offset = entry.offset;
+	m_uniqueGameID = entry.uniqueGameID;
+	m_handID = 0;
+	return !m_stream.fail();
+}
+
+// Collects one row of the Hand table, it is inserted when the hand is complete.
+struct ExportHandRow {
+	ExportHandRow() : valid(false) {}
+	bool valid;
+	HandHistoryRecord hand;
+	int cards[MAX_NUMBER_OF_PLAYERS][2];
+	int handInt[MAX_NUMBER_OF_PLAYERS];
+	string handText[MAX_NUMBER_OF_PLAYERS];
+	int boardCards[5];
+
+	void reset(const HandHistoryRecord &record) {
+		valid = true;
+		hand = record;
+		for (int i = 0; i < MAX_NUMBER_OF_PLAYERS; i++) {
+			cards[i][0] = cards[i][1] = -1;
+			handInt[i] = -1;
+			handText[i].clear();
+		}
+		for (int i = 0; i < 5; i++)
+			boardCards[i] = -1;
+	}
+};
+
+static void
+bindOptionalInt(sqlite3_stmt *stmt, int col, int val)
+{
+	if (val >= 0)
+		sqlite3_bind_int(stmt, col, val);
+	else
+		sqlite3_bind_null(stmt, col);
+}
+
+static bool
+insertHandRow(sqlite3_stmt *stmt, const ExportHandRow &row)
+{
+	const vector<int> &v = row.hand.values;
+	if (v.size() < 6)
+		return false;
+	sqlite3_reset(stmt);
+	int col = 1;
+	sqlite3_bind_int(stmt, col++, v[0]);
+	sqlite3_bind_int(stmt, col++, row.hand.uniqueGameID);
+	for (int i = 1; i < 6; i++)
+		sqlite3_bind_int(stmt, col++, v[i]);
+	for (int i = 0; i < MAX_NUMBER_OF_PLAYERS; i++) {
+		bindOptionalInt(stmt, col++, 6 + i < static_cast<int>(v.size()) ? v[6 + i] : -1);
+		bindOptionalInt(stmt, col++, row.cards[i][0]);
+		bindOptionalInt(stmt, col++, row.cards[i][1]);
+		if (row.handInt[i] >= 0)
+			sqlite3_bind_text(stmt, col++, row.handText[i].c_str(), -1, SQLITE_TRANSIENT);
+		else
+			sqlite3_bind_null(stmt, col++);
+		bindOptionalInt(stmt, col++, row.handInt[i]);
+	}
+	for (int i = 0; i < 5; i++)
+		bindOptionalInt(stmt, col++, row.boardCards[i]);
+	return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool
+HandHistoryExportToSqlite(const string &historyFileName, const string &sqliteFileName)
+{
+	HandHistoryReader reader;
+	if (!reader.open(historyFileName))
+		return false;
+
+	sqlite3 *db = NULL;
+	if (sqlite3_open(sqliteFileName.c_str(), &db) != SQLITE_OK) {
+		sqlite3_close(db);
+		return false;
+	}
+
+	string handSql = "INSERT INTO Hand VALUES (?,?,?,?,?,?,?";
+	for (int i = 0; i < MAX_NUMBER_OF_PLAYERS * 5 + 5; i++)
+		handSql += ",?";
+	handSql += ");";
+
+	char *errmsg = NULL;
+	string schema = "BEGIN;" + Log::getSqliteLogSchema();
+	sqlite3_stmt *sessionStmt = NULL, *gameStmt = NULL, *playerStmt = NULL, *handStmt = NULL, *actionStmt = NULL;
+	bool ok = sqlite3_exec(db, schema.c_str(), 0, 0, &errmsg) == SQLITE_OK
+			  && sqlite3_prepare_v2(db, "INSERT INTO Session VALUES (?,?,?,?);", -1, &sessionStmt, NULL) == SQLITE_OK
+			  && sqlite3_prepare_v2(db, "INSERT INTO Game (UniqueGameID,GameID,Startmoney,StartSb,DealerPos) VALUES (?,?,?,?,?);", -1, &gameStmt, NULL) == SQLITE_OK
+			  && sqlite3_prepare_v2(db, "INSERT INTO Player VALUES (?,?,?);", -1, &playerStmt, NULL) == SQLITE_OK
+			  && sqlite3_prepare_v2(db, handSql.c_str(), -1, &handStmt, NULL) == SQLITE_OK
+			  && sqlite3_prepare_v2(db, "INSERT INTO Action (HandID,UniqueGameID,BeRo,Player,Action,Amount) VALUES (?,?,?,?,?,?);", -1, &actionStmt, NULL) == SQLITE_OK;
+	if (errmsg) {
+		cout << "Error in statement: " << schema << "[" << errmsg << "]." << endl;
+		sqlite3_free(errmsg);
+	}
+
+	ExportHandRow handRow;
+	HandHistoryRecord record;
+	while (ok && reader.next(record)) {
+		const vector<int> &v = record.values;
+		switch (record.type) {
+		case HAND_HISTORY_RECORD_SESSION:
+			if (v.size() >= 1 && record.strings.size() >= 3) {
+				sqlite3_reset(sessionStmt);
+				for (int i = 0; i < 3; i++)
+					sqlite3_bind_text(sessionStmt, i + 1, record.strings[i].c_str(), -1, SQLITE_TRANSIENT);
+				sqlite3_bind_int(sessionStmt, 4, v[0]);
+				ok = sqlite3_step(sessionStmt) == SQLITE_DONE;
+			}
+			break;
+		case HAND_HISTORY_RECORD_GAME:
+			if (handRow.valid)
+				ok = insertHandRow(handStmt, handRow);
+			handRow.valid = false;
+			if (ok && v.size() >= 5) {
+				sqlite3_reset(gameStmt);
+				for (int i = 0; i < 5; i++)
+					sqlite3_bind_int(gameStmt, i + 1, v[i]);
+				ok = sqlite3_step(gameStmt) == SQLITE_DONE;
+			}
+			break;
+		case HAND_HISTORY_RECORD_PLAYER:
+			if (v.size() >= 1 && record.strings.size() >= 1) {
+				sqlite3_reset(playerStmt);
+				sqlite3_bind_int(playerStmt, 1, record.uniqueGameID);
+				sqlite3_bind_int(playerStmt, 2, v[0]);
+				sqlite3_bind_text(playerStmt, 3, record.strings[0].c_str(), -1, SQLITE_TRANSIENT);
+				ok = sqlite3_step(playerStmt) == SQLITE_DONE;
+			}
+			break;
+		case HAND_HISTORY_RECORD_HAND:
+			if (handRow.valid)
+				ok = insertHandRow(handStmt, handRow);
+			handRow.reset(record);
+			break;
+		case HAND_HISTORY_RECORD_ACTION:
+			if (v.size() >= 4) {
+				string actionText;
+				bool hasAmount;
+				if (Log::getActionLogText(static_cast<PlayerActionLog>(v[2]), actionText, hasAmount)) {
+					sqlite3_reset(actionStmt);
+					sqlite3_bind_int(actionStmt, 1, record.handID);
+					sqlite3_bind_int(actionStmt, 2, record.uniqueGameID);
+					sqlite3_bind_int(actionStmt, 3, v[0]);
+					sqlite3_bind_int(actionStmt, 4, v[1]);
+					sqlite3_bind_text(actionStmt, 5, actionText.c_str(), -1, SQLITE_TRANSIENT);
+					if (hasAmount)
+						sqlite3_bind_int(actionStmt, 6, v[3]);
+					else
+						sqlite3_bind_null(actionStmt, 6);
+					ok = sqlite3_step(actionStmt) == SQLITE_DONE;
+				}
+			}
+			break;
+		case HAND_HISTORY_RECORD_BOARD_CARDS:
+			if (handRow.valid && v.size() >= 6) {
+				for (int i = 0; i < 5; i++) {
+					if (v[i + 1] >= 0)
+						handRow.boardCards[i] = v[i + 1];
+				}
+			}
+			break;
+		case HAND_HISTORY_RECORD_HOLE_CARDS:
+			if (handRow.valid && v.size() >= 3 && v[0] >= 1 && v[0] <= MAX_NUMBER_OF_PLAYERS) {
+				handRow.cards[v[0] - 1][0] = v[1];
+				handRow.cards[v[0] - 1][1] = v[2];
+			}
+			break;
+		case HAND_HISTORY_RECORD_HAND_VALUE:
+			if (handRow.valid && v.size() >= 2 && !record.strings.empty() && v[0] >= 1 && v[0] <= MAX_NUMBER_OF_PLAYERS) {
+				handRow.handInt[v[0] - 1] = v[1];
+				handRow.handText[v[0] - 1] = record.strings[0];
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	if (ok && handRow.valid)
+		ok = insertHandRow(handStmt, handRow);
+
+	sqlite3_finalize(sessionStmt);
+	sqlite3_finalize(gameStmt);
+	sqlite3_finalize(playerStmt);
+	sqlite3_finalize(handStmt);
+	sqlite3_finalize(actionStmt);
+	sqlite3_exec(db, ok ? "COMMIT;" : "ROLLBACK;", 0, 0, NULL);
+	sqlite3_close(db);
+	return ok;
+}
@@ -0,0 +1,173 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Compact binary hand history format. */
+
+#ifndef HANDHISTORY_H
+#define HANDHISTORY_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <boost/cstdint.hpp>
+
+#define HAND_HISTORY_FILE_MAGIC			"PTHH"
+#define HAND_HISTORY_INDEX_MAGIC		"PTHI"
+#define HAND_HISTORY_FORMAT_VERSION		2
+#define HAND_HISTORY_FILE_EXTENSION		".pth"
+
+// The file starts with the magic and the format version (one byte each
+// character, version as varint). It is followed by records of the form
+// <type byte> <varint payload size> <payload>. The payload contains
+// varint counts of zigzag encoded integers and of length prefixed strings.
+// A clean close appends an index record followed by the fixed size trailer
+// <uint64 LE offset of index record> <HAND_HISTORY_INDEX_MAGIC>.
+//
+// Record layouts (values / strings):
+//   SESSION:     logVersion / version, date, time
+//   GAME:        uniqueGameID, gameID, startMoney, startSb, dealerPos / -
+//   PLAYER:      seat / name
+//   HAND:        handID, dealerSeat, sbAmount, sbSeat, bbAmount, bbSeat,
+//                cash of seat 1..MAX_NUMBER_OF_PLAYERS (-1 if inactive) / -
+//   ACTION:      round, seat, action (PlayerActionLog), amount / -
+//   BOARD_CARDS: round, card 1..5 (-1 if not yet dealt) / -
+//   HOLE_CARDS:  seat, card 1, card 2 / -
+//   HAND_VALUE:  seat, cardsValueInt / hand name
+//   INDEX:       varint count, then (uniqueGameID, handID, varint offset)
+//                triples, offsets are not zigzag encoded.
+// Seats are 1-based, matching the SQLite log.
+enum HandHistoryRecordType {
+	HAND_HISTORY_RECORD_SESSION = 1,
+	HAND_HISTORY_RECORD_GAME,
+	HAND_HISTORY_RECORD_PLAYER,
+	HAND_HISTORY_RECORD_HAND,
+	HAND_HISTORY_RECORD_ACTION,
+	HAND_HISTORY_RECORD_BOARD_CARDS,
+	HAND_HISTORY_RECORD_HOLE_CARDS,
+	HAND_HISTORY_RECORD_HAND_VALUE,
+	HAND_HISTORY_RECORD_INDEX
+};
+
+// Varint coding of the format. Signed values are zigzag encoded.
+void HandHistoryAppendVarint(std::string &buf, boost::uint64_t val);
+void HandHistoryAppendSigned(std::string &buf, int val);
+bool HandHistoryParseVarint(const std::string &buf, size_t &pos, boost::uint64_t &val);
+bool HandHistoryParseSigned(const std::string &buf, size_t &pos, int &val);
+
+struct HandHistoryRecord {
+	HandHistoryRecord() : type(HAND_HISTORY_RECORD_SESSION), uniqueGameID(0), handID(0), offset(0) {}
+	HandHistoryRecordType type;
+	// Context of the record, filled in by the reader.
+	int uniqueGameID;
+	int handID;
+	boost::uint64_t offset;
+	std::vector<int> values;
+	std::vector<std::string> strings;
+};
+
+// Index entry, handID is 0 for the start of a game.
+struct HandHistoryIndexEntry {
+	HandHistoryIndexEntry() : uniqueGameID(0), handID(0), offset(0) {}
+	HandHistoryIndexEntry(int g, int h, boost::uint64_t o) : uniqueGameID(g), handID(h), offset(o) {}
+	int uniqueGameID;
+	int handID;
+	boost::uint64_t offset;
+};
+
+class HandHistoryWriter
+{
+public:
+	HandHistoryWriter();
+	~HandHistoryWriter();
+
+	bool open(const std::string &fileName);
+	// Writes the index footer and closes the file.
+	void close();
+	bool isOpen() const {
+		return m_stream.is_open();
+	}
+	void flush();
+
+	void writeSession(const std::string &version, const std::string &date, const std::string &time, int logVersion);
+	void writeGame(int uniqueGameID, int gameID, int startMoney, int startSb, int dealerPos);
+	void writePlayer(int seat, const std::string &name);
+	void writeHand(int handID, int dealerSeat, int sbAmount, int sbSeat, int bbAmount, int bbSeat, const std::vector<int> &seatCash);
+	void writeAction(int round, int seat, int action, int amount);
+	void writeBoardCards(int round, const int boardCards[5]);
+	void writeHoleCards(int seat, int card1, int card2);
+	void writeHandValue(int seat, int cardsValueInt, const std::string &handName);
+
+protected:
+	void writeRecord(HandHistoryRecordType type, const std::vector<int> &values, const std::vector<std::string> &strings);
+	void writeRawRecord(HandHistoryRecordType type, const std::string &payload);
+
+private:
+	std::ofstream m_stream;
+	boost::uint64_t m_offset;
+	int m_uniqueGameID;
+	std::vector<HandHistoryIndexEntry> m_index;
+	std::string m_buf;
+	std::vector<int> m_values;
+	std::vector<std::string> m_strings;
+};
+
+class HandHistoryReader
+{
+public:
+	HandHistoryReader();
+	~HandHistoryReader();
+
+	bool open(const std::string &fileName);
+	void close();
+
+	// Read the next record in file order. Returns false at the end of the
+	// records (the index footer is skipped) or if the file is damaged.
+	bool next(HandHistoryRecord &record);
+
+	// Read the index footer. If the file was not closed properly, the
+	// index is rebuilt by scanning the records.
+	bool readIndex(std::vector<HandHistoryIndexEntry> &index);
+
+	// Continue reading at an entry of the index.
+	bool seek(const HandHistoryIndexEntry &entry);
+
+private:
+	std::ifstream m_stream;
+	boost::uint64_t m_offset;
+	boost::uint64_t m_dataStart;
+	int m_uniqueGameID;
+	int m_handID;
+	std::string m_buf;
+};
+
+// Convert a binary hand history to the SQLite log schema used by the log viewer.
+bool HandHistoryExportToSqlite(const std::string &historyFileName, const std::string &sqliteFileName);
+
+#endif
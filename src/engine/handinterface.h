@@ -38,6 +38,8 @@
 #include "berointerface.h"
 #include "log.h"
 
+class BoardOddsCache;
+
 class HandInterface
 {
 public:
@@ -58,6 +60,8 @@ public:
 	virtual GuiInterface* getGuiInterface() const =0;
 	virtual boost::shared_ptr<BeRoInterface> getCurrentBeRo() const =0;
 	virtual Log* getLog() const =0;
+	// NULL if the hand has no computer players.
+	virtual BoardOddsCache *getBoardOddsCache() =0;
 
 	virtual void setMyID(int theValue) =0;
 	virtual int getMyID() const =0;
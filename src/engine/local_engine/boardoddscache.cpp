@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include "boardoddscache.h"
+#include "cardsvalue.h"
+
+#include <algorithm>
+
+#define CARD_SET(cards, idx)	((cards)[(idx)/13] & (1 << ((idx)%13)))
+#define PAIR_TABLE_SIZE			(52*52)
+
+BoardOddsCache::BoardOddsCache()
+	: myBoardSize(0)
+{
+	std::fill(myBoardCards, myBoardCards + 5, -1);
+}
+
+double BoardOddsCache::calcOdds(const int boardCards[5], int boardSize, const int holeCards[2])
+{
+	prepare(boardCards, boardSize);
+
+	int myCards[4] = { 0,0,0,0 };
+	int i;
+	for(i=0; i<boardSize; i++) myCards[boardCards[i]/13] |= (1 << (boardCards[i]%13));
+	for(i=0; i<2; i++) myCards[holeCards[i]/13] |= (1 << (holeCards[i]%13));
+
+	int countAll = 0;
+	int countMy = 0;
+
+	if(boardSize == 5) {
+		countOpponentValues(myCards, CardsValue::cardsValue(myCards), &myOpponentValues[0], countAll, countMy);
+	} else {
+		for(int river=0; river<52; river++) {
+			if(!CARD_SET(myCards, river)) {
+				myCards[river/13] |= (1 << (river%13));
+				countOpponentValues(myCards, CardsValue::cardsValue(myCards), &myOpponentValues[river*PAIR_TABLE_SIZE], countAll, countMy);
+				myCards[river/13] &= ~(1 << (river%13));
+			}
+		}
+	}
+
+	return 100.0*(countMy*1.0)/(countAll*1.0);
+}
+
+void BoardOddsCache::prepare(const int boardCards[5], int boardSize)
+{
+	if(boardSize == myBoardSize && std::equal(boardCards, boardCards + boardSize, myBoardCards))
+		return;
+
+	myBoardSize = boardSize;
+	std::copy(boardCards, boardCards + boardSize, myBoardCards);
+
+	int cards[4] = { 0,0,0,0 };
+	for(int i=0; i<boardSize; i++) cards[boardCards[i]/13] |= (1 << (boardCards[i]%13));
+
+	if(boardSize == 5) {
+		myOpponentValues.assign(PAIR_TABLE_SIZE, 0);
+		fillOpponentValues(cards, &myOpponentValues[0]);
+	} else {
+		myOpponentValues.assign(52*PAIR_TABLE_SIZE, 0);
+		for(int river=0; river<52; river++) {
+			if(!CARD_SET(cards, river)) {
+				cards[river/13] |= (1 << (river%13));
+				fillOpponentValues(cards, &myOpponentValues[river*PAIR_TABLE_SIZE]);
+				cards[river/13] &= ~(1 << (river%13));
+			}
+		}
+	}
+}
+
+void BoardOddsCache::fillOpponentValues(const int cards[4], int *values)
+{
+	int opponentCards[4];
+	std::copy(cards, cards + 4, opponentCards);
+
+	for(int card_idx_1=0; card_idx_1<51; card_idx_1++) {
+		if(!CARD_SET(cards, card_idx_1)) {
+			opponentCards[card_idx_1/13] |= (1 << (card_idx_1%13));
+			for(int card_idx_2=card_idx_1+1; card_idx_2<52; card_idx_2++) {
+				if(!CARD_SET(cards, card_idx_2)) {
+					opponentCards[card_idx_2/13] |= (1 << (card_idx_2%13));
+					values[card_idx_1*52 + card_idx_2] = CardsValue::cardsValue(opponentCards);
+					opponentCards[card_idx_2/13] &= ~(1 << (card_idx_2%13));
+				}
+			}
+			opponentCards[card_idx_1/13] &= ~(1 << (card_idx_1%13));
+		}
+	}
+}
+
+void BoardOddsCache::countOpponentValues(const int myCards[4], int myValue, const int *values, int &countAll, int &countMy)
+{
+	// opponents can not hold any card known to this player
+	for(int card_idx_1=0; card_idx_1<51; card_idx_1++) {
+		if(!CARD_SET(myCards, card_idx_1)) {
+			for(int card_idx_2=card_idx_1+1; card_idx_2<52; card_idx_2++) {
+				if(!CARD_SET(myCards, card_idx_2)) {
+					countAll++;
+					if(myValue >= values[card_idx_1*52 + card_idx_2]) countMy++;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#ifndef BOARDODDSCACHE_H
+#define BOARDODDSCACHE_H
+
+#include <vector>
+
+// Hand values of all opponent hole cards for the current board, computed
+// once per street and shared by the computer players of a hand.
+class BoardOddsCache
+{
+public:
+	BoardOddsCache();
+
+	// Percentage of opponent hole cards which do not beat the given hole
+	// cards, over all river cards if the board has 4 cards.
+	double calcOdds(const int boardCards[5], int boardSize, const int holeCards[2]);
+
+private:
+	void prepare(const int boardCards[5], int boardSize);
+	void fillOpponentValues(const int cards[4], int *values);
+	static void countOpponentValues(const int myCards[4], int myValue, const int *values, int &countAll, int &countMy);
+
+	int myBoardCards[5];
+	int myBoardSize;
+	// Indexed by [river card *] first opponent card * 52 + second card.
+	std::vector<int> myOpponentValues;
+};
+
+#endif
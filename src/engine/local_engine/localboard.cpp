@@ -83,179 +83,124 @@ void LocalBoard::distributePot(unsigned dealerPosition)
 
 	winners.clear();
 
-	size_t i,j,k,l;
+	// seat state in fixed arrays, in seat order
+	PlayerInterface *seat[MAX_NUMBER_OF_PLAYERS];
+	unsigned playerSets[MAX_NUMBER_OF_PLAYERS];
+	int cardsValue[MAX_NUMBER_OF_PLAYERS];
+	bool contender[MAX_NUMBER_OF_PLAYERS];
+	bool levelWinner[MAX_NUMBER_OF_PLAYERS];
+	// seat indices sorted by player set asc
+	size_t sortedSeats[MAX_NUMBER_OF_PLAYERS];
+	size_t seatCount = 0;
+	size_t dealerSeat = 0;
+	bool dealerFound = false;
+
+	size_t i,j,k;
 	PlayerListIterator it;
-	PlayerListConstIterator it_c;
 
-	// filling player sets vector
-	std::vector<unsigned> playerSets;
 	for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
-		if((*it)->getMyActiveStatus()) {
-			playerSets.push_back( ( ((*it)->getMyRoundStartCash()) - ((*it)->getMyCash()) ) );
+		if(seatCount == MAX_NUMBER_OF_PLAYERS) {
+			LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: too many seats");
+			break;
+		}
+		PlayerInterface *player = it->get();
+		seat[seatCount] = player;
+		contender[seatCount] = player->getMyActiveStatus() && player->getMyAction() != PLAYER_ACTION_FOLD;
+		cardsValue[seatCount] = player->getMyCardsValueInt();
+		if(player->getMyActiveStatus()) {
+			playerSets[seatCount] = player->getMyRoundStartCash() - player->getMyCash();
 		} else {
-			playerSets.push_back(0);
+			playerSets[seatCount] = 0;
 		}
-		(*it)->setLastMoneyWon(0);
-	}
-
-	// sort player sets asc
-	std::vector<unsigned> playerSetsSort = playerSets;
-	sort(playerSetsSort.begin(), playerSetsSort.end());
+		if(!dealerFound && player->getMyUniqueID() == dealerPosition) {
+			dealerSeat = seatCount;
+			dealerFound = true;
+		}
+		player->setLastMoneyWon(0);
 
-	// potLevel[0] = amount, potLevel[1] = sum, potLevel[2..n] = winner
-	std::vector<unsigned> potLevel;
+		// insertion sort, stable for equal sets
+		for(k=seatCount; k>0 && playerSets[sortedSeats[k-1]] > playerSets[seatCount]; k--) {
+			sortedSeats[k] = sortedSeats[k-1];
+		}
+		sortedSeats[k] = seatCount;
+		seatCount++;
+	}
 
-	// temp var
-	int highestCardsValue;
-	size_t winnerCount;
-	bool finalPot;
-	int potCarryOver = 0;
-	size_t mod;
-	bool winnerHit;
+	// Every distinct player set ends a pot level. All players who paid more
+	// than the previous level contribute the difference, and the best hands
+	// among the contenders who paid up to this level win it.
+	unsigned levelStart = 0;
+	unsigned potCarryOver = 0;
 
 	// level loop
-	for(i=0; i<playerSetsSort.size(); i++) {
+	for(i=0; i<seatCount; i++) {
 
-		// restart levelHighestCardsValue
-		highestCardsValue = 0;
-
-		// level detection
-		if(playerSetsSort[i] > 0) {
-
-			// level amount
-			potLevel.push_back(playerSetsSort[i]);
+		unsigned levelEnd = playerSets[sortedSeats[i]];
+		if(levelEnd <= levelStart) {
+			continue;
+		}
 
-			// level sum
-			potLevel.push_back((playerSetsSort.size()-i)*potLevel[0] + potCarryOver);
+		// level sum, the seats from i on paid at least levelEnd
+		unsigned levelSum = (unsigned)(seatCount-i)*(levelEnd-levelStart) + potCarryOver;
 
-			// determine level highestCardsValue
-			for(it_c=seatsList->begin(), j=0; it_c!=seatsList->end(); ++it_c,j++) {
-				if((*it_c)->getMyActiveStatus() && (*it_c)->getMyCardsValueInt() > highestCardsValue && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && playerSets[j] >= potLevel[0]) {
-					highestCardsValue = (*it_c)->getMyCardsValueInt();
-				}
+		// determine level highestCardsValue
+		int highestCardsValue = 0;
+		for(j=i; j<seatCount; j++) {
+			k = sortedSeats[j];
+			if(contender[k] && cardsValue[k] > highestCardsValue) {
+				highestCardsValue = cardsValue[k];
 			}
+		}
 
-			// level winners
-			for(it_c=seatsList->begin(), j=0; it_c!=seatsList->end(); ++it_c,j++) {
-				if((*it_c)->getMyActiveStatus() && highestCardsValue == (*it_c)->getMyCardsValueInt() && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && playerSets[j] >= potLevel[0]) {
-					potLevel.push_back((*it_c)->getMyUniqueID());
+		// level winners, final pot level if it is the last one for at least one winner
+		size_t winnerCount = 0;
+		bool finalPot = false;
+		for(k=0; k<seatCount; k++) {
+			levelWinner[k] = contender[k] && playerSets[k] >= levelEnd && cardsValue[k] == highestCardsValue;
+			if(levelWinner[k]) {
+				winnerCount++;
+				if(playerSets[k] == levelEnd) {
+					finalPot = true;
 				}
 			}
+		}
+		if (!winnerCount) {
+			LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: no winner found");
+		}
 
-			// determine the number of level winners
-			winnerCount = potLevel.size()-2;
-			if (!winnerCount) {
-				LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: no winner found");
+		if(finalPot) {
+			// distribute the pot level sum to level winners, the
+			// remainder goes to the first winners after the dealer
+			unsigned share = levelSum/winnerCount;
+			size_t mod = levelSum%winnerCount;
+			if(mod && !dealerFound) {
+				LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: dealer position not found");
 			}
 
-			// check if this is the final pot level for at least one winner
-			finalPot = false;
-			for(j=2; j<potLevel.size(); j++) {
-				// find seat with potLevel[j]-ID
-				for(it=seatsList->begin(), k=0; it!=seatsList->end(); ++it, k++) {
-					if((*it)->getMyUniqueID() == potLevel[j] && potLevel[0] == playerSets[k]) {
-						finalPot = true;
-						break;
+			for(j=1; j<=seatCount; j++) {
+				k = (dealerSeat+j)%seatCount;
+				if(levelWinner[k]) {
+					unsigned amount = share;
+					if(mod) {
+						amount++;
+						mod--;
 					}
+					seat[k]->setMyCash(seat[k]->getMyCash() + (int)amount);
+					// filling winners vector
+					winners.push_back(seat[k]->getMyUniqueID());
+					seat[k]->setLastMoneyWon(seat[k]->getLastMoneyWon() + amount);
 				}
-				if(finalPot) break;
 			}
+			potCarryOver = 0;
 
-			if(finalPot && winnerCount>0) {
-				// distribute the pot level sum to level winners
-				mod = (potLevel[1])%winnerCount;
-				// pot level sum divisible by winnerCount
-				if(mod == 0) {
-
-					for(j=2; j<potLevel.size(); j++) {
-						// find seat with potLevel[j]-ID
-						for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
-							if((*it)->getMyUniqueID() == potLevel[j]) {
-								break;
-							}
-						}
-						if(it == seatsList->end()) {
-							LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: seat not found");
-						} else {
-							(*it)->setMyCash( (*it)->getMyCash() + ((potLevel[1])/winnerCount));
-							// filling winners vector
-							winners.push_back((*it)->getMyUniqueID());
-							(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + (potLevel[1])/winnerCount );
-						}
-					}
-
-				}
-				// pot level sum not divisible by winnerCount
-				// --> distribution after smallBlind
-				else {
-
-					// find Seat with dealerPosition
-					for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
-						if((*it)->getMyUniqueID() == dealerPosition) {
-							break;
-						}
-					}
-					if(it == seatsList->end()) {
-						it = seatsList->begin();
-						LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: dealer position not found");
-					}
-
-					for(j=0; j<winnerCount; j++) {
-
-						winnerHit = false;
-
-						for(k=0; k<MAX_NUMBER_OF_PLAYERS && !winnerHit; k++) {
-
-							++it;
-							if(it == seatsList->end())
-								it = seatsList->begin();
-
-							for(l=2; l<potLevel.size(); l++) {
-								if((*it)->getMyActiveStatus() && (*it)->getMyUniqueID() == potLevel[l])
-									winnerHit = true;
-							}
-
-						}
-
-						if(winnerHit) {
-							if(j<mod) {
-								(*it)->setMyCash( (*it)->getMyCash() + (int)((potLevel[1])/winnerCount) + 1);
-								// filling winners vector
-								winners.push_back((*it)->getMyUniqueID());
-								(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + ((potLevel[1])/winnerCount) + 1 );
-							} else {
-								(*it)->setMyCash( (*it)->getMyCash() + (int)((potLevel[1])/winnerCount));
-								// filling winners vector
-								winners.push_back((*it)->getMyUniqueID());
-								(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + (potLevel[1])/winnerCount );
-							}
-						}
-					}
-				}
-				potCarryOver = 0;
-
-				// pot refresh
-				pot -= potLevel[1];
-
-			} else {
-				potCarryOver = potLevel[1];
-			}
-
-			// reevaluate the player sets
-			for(j=0; j<playerSets.size(); j++) {
-				if(playerSets[j]>0) {
-					playerSets[j] -= potLevel[0];
-				}
-			}
-
-			// sort player sets asc
-			playerSetsSort = playerSets;
-			sort(playerSetsSort.begin(), playerSetsSort.end());
-
-			// clear potLevel
-			potLevel.clear();
+			// pot refresh
+			pot -= levelSum;
 
+		} else {
+			potCarryOver = levelSum;
 		}
+
+		levelStart = levelEnd;
 	}
 
 	// winners sort and unique
@@ -266,12 +211,6 @@ void LocalBoard::distributePot(unsigned dealerPosition)
 	// ERROR-Outputs
 
 	if(pot!=0) LOG_ERROR(__FILE__ << " (" << __LINE__ << "): distributePot-ERROR: Pot = " << pot);
-
-	/*int sum = 0;
-
-	for(it_c=activePlayerList->begin(); it_c!=activePlayerList->end(); ++it_c) {
-		sum += (*it_c)->getMyCash();
-	}*/
 }
 
 void LocalBoard::determinePlayerNeedToShowCards()
@@ -38,6 +38,7 @@
 #include <playerinterface.h>
 #include <handinterface.h>
 #include <berointerface.h>
+#include "boardoddscache.h"
 
 #include <vector>
 
@@ -86,6 +87,9 @@ public:
 	Log* getLog() const {
 		return myLog;
 	}
+	BoardOddsCache *getBoardOddsCache() {
+		return &myBoardOddsCache;
+	}
 
 	void setMyID(int theValue) {
 		myID = theValue;
@@ -175,6 +179,7 @@ private:
 	GuiInterface *myGui;
 	boost::shared_ptr<BoardInterface> myBoard;
 	Log *myLog;
+	BoardOddsCache myBoardOddsCache; // board dependent odds, shared by the computer players
 
 	PlayerList seatsList; // all player
 	PlayerList activePlayerList; // all player who are not out
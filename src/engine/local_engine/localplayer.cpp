@@ -33,6 +33,7 @@
 #include "handinterface.h"
 #include "tools.h"
 #include "cardsvalue.h"
+#include "boardoddscache.h"
 #include <configfile.h>
 #include <core/loghelper.h>
 
@@ -2884,42 +2885,8 @@ void LocalPlayer::calcMyOdds()
 		int boardCards[5];
 		currentHand->getBoard()->getMyCards(boardCards);
 
-		int card_idx_1;
-		int myCards[4] = { 0,0,0,0 };
-		int opponentCards[4] = { 0,0,0,0 };
-		for(card_idx_1=0; card_idx_1<4; card_idx_1++) myCards[boardCards[card_idx_1]/13] |= (1 << (boardCards[card_idx_1]%13));
-		std::copy(myCards,myCards+4,opponentCards);
-		for(card_idx_1=0; card_idx_1<2; card_idx_1++) myCards[myHoleCards[card_idx_1]/13] |= (1 << (myHoleCards[card_idx_1]%13));
-
-		int countAll = 0;
-		int countMy = 0;
-
-		for(card_idx_1=0; card_idx_1<52; card_idx_1++) {
-			if( (myCards[card_idx_1/13] & (1 << (card_idx_1%13)))==0 ) {
-				myCards[card_idx_1/13] |= (1<< (card_idx_1%13));
-				opponentCards[card_idx_1/13] |= (1<< (card_idx_1%13));
-				for(int card_idx_2=0; card_idx_2<51; card_idx_2++) {
-					if( (myCards[card_idx_2/13] & (1 << (card_idx_2%13)))==0 ) {
-						opponentCards[card_idx_2/13] |= (1<< (card_idx_2%13));
-						for(int card_idx_3=card_idx_2+1; card_idx_3<52; card_idx_3++) {
-							if( (myCards[card_idx_3/13] & (1 << (card_idx_3%13)))==0 ) {
-								opponentCards[card_idx_3/13] |= (1<< (card_idx_3%13));
-
-								countAll++;
-								if(CardsValue::cardsValue(myCards)>=CardsValue::cardsValue(opponentCards)) countMy++;
-
-								opponentCards[card_idx_3/13] &= ~(1<< (card_idx_3%13));
-							}
-						}
-						opponentCards[card_idx_2/13] &= ~(1<< (card_idx_2%13));
-					}
-				}
-				myCards[card_idx_1/13] &= ~(1<< (card_idx_1%13));
-				opponentCards[card_idx_1/13] &= ~(1<< (card_idx_1%13));
-			}
-		}
-
-		myOdds = 100.0*(countMy*1.0)/(countAll*1.0);
+		// opponent hand values are computed once per street for all players
+		myOdds = currentHand->getBoardOddsCache()->calcOdds(boardCards, 4, myHoleCards);
 
 	}
 	break;
@@ -2928,34 +2895,7 @@ void LocalPlayer::calcMyOdds()
 		int boardCards[5];
 		currentHand->getBoard()->getMyCards(boardCards);
 
-		int card_idx_1;
-		int myCards[4] = { 0,0,0,0 };
-		int opponentCards[4] = { 0,0,0,0 };
-		for(card_idx_1=0; card_idx_1<5; card_idx_1++) myCards[boardCards[card_idx_1]/13] |= (1 << (boardCards[card_idx_1]%13));
-		std::copy(myCards,myCards+4,opponentCards);
-		for(card_idx_1=0; card_idx_1<2; card_idx_1++) myCards[myHoleCards[card_idx_1]/13] |= (1 << (myHoleCards[card_idx_1]%13));
-
-		int countAll = 0;
-		int countMy = 0;
-
-		for(card_idx_1=0; card_idx_1<51; card_idx_1++) {
-			if( (myCards[card_idx_1/13] & (1 << (card_idx_1%13)))==0 ) {
-				opponentCards[card_idx_1/13] |= (1<< (card_idx_1%13));
-				for(int card_idx_2=card_idx_1+1; card_idx_2<52; card_idx_2++) {
-					if( (myCards[card_idx_2/13] & (1 << (card_idx_2%13)))==0 ) {
-						opponentCards[card_idx_2/13] |= (1<< (card_idx_2%13));
-
-						countAll++;
-						if(CardsValue::cardsValue(myCards)>=CardsValue::cardsValue(opponentCards)) countMy++;
-
-						opponentCards[card_idx_2/13] &= ~(1<< (card_idx_2%13));
-					}
-				}
-				opponentCards[card_idx_1/13] &= ~(1<< (card_idx_1%13));
-			}
-		}
-
-		myOdds = 100.0*(countMy*1.0)/(countAll*1.0);
+		myOdds = currentHand->getBoardOddsCache()->calcOdds(boardCards, 5, myHoleCards);
 
 	}
 	break;
@@ -110,7 +110,7 @@ int playerActionMatrix[][debug_mode_cntBeRo][MAX_NUMBER_OF_PLAYERS][debug_mode_c
 	}
 };
 
-Log::Log(ConfigFile *c) : mySqliteLogDb(0), mySqliteLogFileName(""), myConfig(c), uniqueGameID(0), currentHandID(0), currentRound(GAME_STATE_PREFLOP), sql(""), debug_mode(false)
+Log::Log(ConfigFile *c) : mySqliteLogDb(0), mySqliteLogFileName(""), myConfig(c), myLogOnOffKey(c->getConfigKey("LogOnOff")), myLogIntervalKey(c->getConfigKey("LogInterval")), uniqueGameID(0), currentHandID(0), currentRound(GAME_STATE_PREFLOP), sql(""), debug_mode(false)
 {
 	// check for debug_mode
 	ifstream debug_mode_test_file("enable_debug_mode");
@@ -120,6 +120,7 @@ Log::Log(ConfigFile *c) : mySqliteLogDb(0), mySqliteLogFileName(""), myConfig(c)
 Log::~Log()
 {
 	sqlite3_close(mySqliteLogDb);
+	myHandHistory.close();
 }
 
 void
@@ -127,7 +128,7 @@ Log::init()
 {
 
 	// logging activated
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 
 		DIR *logDir;
 		logDir = opendir((myConfig->readConfigString("LogDir")).c_str());
@@ -147,6 +148,19 @@ Log::init()
 			strftime(curDate,11,"%Y-%m-%d",z);
 			strftime(curTime,9,"%H:%M:%S",z);
 
+			if(myConfig->readConfigInt("LogHandHistoryBinary")) {
+				// compact binary hand history instead of sqlite-db
+				boost::filesystem::path handHistoryFileName(myConfig->readConfigString("LogDir"));
+				handHistoryFileName /= string("pokerth-log-") + curDateTime + HAND_HISTORY_FILE_EXTENSION;
+				if(myHandHistory.open(handHistoryFileName.directory_string())) {
+					myHandHistory.writeSession(POKERTH_BETA_RELEASE_STRING, curDate, curTime, SQLITE_LOG_VERSION);
+					// the log viewer converts the history to this sqlite-db
+					mySqliteLogFileName = handHistoryFileName;
+					mySqliteLogFileName.replace_extension(".pdb");
+				}
+				return;
+			}
+
 			mySqliteLogFileName.clear();
 			mySqliteLogFileName /= myConfig->readConfigString("LogDir");
 			mySqliteLogFileName /= string("pokerth-log-") + curDateTime + ".pdb";
@@ -155,14 +169,7 @@ Log::init()
 			sqlite3_open(mySqliteLogFileName.directory_string().c_str(), &mySqliteLogDb);
 			if( mySqliteLogDb != 0 ) {
 
-				int i;
-				// create session table
-				sql += "CREATE TABLE Session (";
-				sql += "PokerTH_Version TEXT NOT NULL";
-				sql += ",Date TEXT NOT NULL";
-				sql += ",Time TEXT NOT NULL";
-				sql += ",LogVersion INTEGER NOT NULL";
-				sql += ", PRIMARY KEY(Date,Time));";
+				sql += getSqliteLogSchema();
 
 				sql += "INSERT INTO Session (";
 				sql += "PokerTH_Version";
@@ -175,71 +182,114 @@ Log::init()
 				sql += "\"" + boost::lexical_cast<string>(curTime) + "\",";
 				sql += boost::lexical_cast<string>(SQLITE_LOG_VERSION) + ");";
 
-				// create game table
-				sql += "CREATE TABLE Game (";
-				sql += "UniqueGameID INTEGER PRIMARY KEY";
-				sql += ",GameID INTEGER NOT NULL";
-				sql += ",Startmoney INTEGER NOT NULL";
-				sql += ",StartSb INTEGER NOT NULL";
-				sql += ",DealerPos INTEGER NOT NULL";
-				sql += ",Winner_Seat INTEGER";
-				sql += ");";
-
-				// create player table
-				sql += "CREATE TABLE Player (";
-				sql += "UniqueGameID INTEGER NOT NULL";
-				sql += ",Seat INTEGER NOT NULL";
-				sql += ",Player TEXT NOT NULL";
-				sql += ",PRIMARY KEY(UniqueGameID,Seat));";
-
-				// create hand table
-				sql += "CREATE TABLE Hand (";
-				sql += "HandID INTEGER NOT NULL";
-				sql += ",UniqueGameID INTEGER NOT NULL";
-				sql += ",Dealer_Seat INTEGER";
-				sql += ",Sb_Amount INTEGER NOT NULL";
-				sql += ",Sb_Seat INTEGER NOT NULL";
-				sql += ",Bb_Amount INTEGER NOT NULL";
-				sql += ",Bb_Seat INTEGER NOT NULL";
-				for(i=1; i<=MAX_NUMBER_OF_PLAYERS; i++) {
-					sql += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Cash INTEGER";
-					sql += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Card_1 INTEGER";
-					sql += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Card_2 INTEGER";
-					sql += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Hand_text TEXT";
-					sql += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Hand_int INTEGER";
-				}
-				for(i=1; i<=5; i++) {
-					sql += ",BoardCard_" + boost::lexical_cast<std::string>(i) + " INTEGER";
-				}
-				sql += ",PRIMARY KEY(HandID,UniqueGameID));";
-
-				// create action table
-				sql += "CREATE TABLE Action (";
-				sql += "ActionID INTEGER PRIMARY KEY AUTOINCREMENT";
-				sql += ",HandID INTEGER NOT NULL";
-				sql += ",UniqueGameID INTEGER NOT NULL";
-				sql += ",BeRo INTEGER NOT NULL";
-				sql += ",Player INTEGER NOT NULL";
-				sql += ",Action TEXT NOT NULL";
-				sql += ",Amount INTEGER";
-				sql += ");";
-
 				exec_transaction();
 			}
 		}
 	}
 }
 
+string
+Log::getSqliteLogSchema()
+{
+	string schema;
+	int i;
+
+	// create session table
+	schema += "CREATE TABLE Session (";
+	schema += "PokerTH_Version TEXT NOT NULL";
+	schema += ",Date TEXT NOT NULL";
+	schema += ",Time TEXT NOT NULL";
+	schema += ",LogVersion INTEGER NOT NULL";
+	schema += ", PRIMARY KEY(Date,Time));";
+
+	// create game table
+	schema += "CREATE TABLE Game (";
+	schema += "UniqueGameID INTEGER PRIMARY KEY";
+	schema += ",GameID INTEGER NOT NULL";
+	schema += ",Startmoney INTEGER NOT NULL";
+	schema += ",StartSb INTEGER NOT NULL";
+	schema += ",DealerPos INTEGER NOT NULL";
+	schema += ",Winner_Seat INTEGER";
+	schema += ");";
+
+	// create player table
+	schema += "CREATE TABLE Player (";
+	schema += "UniqueGameID INTEGER NOT NULL";
+	schema += ",Seat INTEGER NOT NULL";
+	schema += ",Player TEXT NOT NULL";
+	schema += ",PRIMARY KEY(UniqueGameID,Seat));";
+
+	// create hand table
+	schema += "CREATE TABLE Hand (";
+	schema += "HandID INTEGER NOT NULL";
+	schema += ",UniqueGameID INTEGER NOT NULL";
+	schema += ",Dealer_Seat INTEGER";
+	schema += ",Sb_Amount INTEGER NOT NULL";
+	schema += ",Sb_Seat INTEGER NOT NULL";
+	schema += ",Bb_Amount INTEGER NOT NULL";
+	schema += ",Bb_Seat INTEGER NOT NULL";
+	for(i=1; i<=MAX_NUMBER_OF_PLAYERS; i++) {
+		schema += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Cash INTEGER";
+		schema += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Card_1 INTEGER";
+		schema += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Card_2 INTEGER";
+		schema += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Hand_text TEXT";
+		schema += ",Seat_" + boost::lexical_cast<std::string>(i) + "_Hand_int INTEGER";
+	}
+	for(i=1; i<=5; i++) {
+		schema += ",BoardCard_" + boost::lexical_cast<std::string>(i) + " INTEGER";
+	}
+	schema += ",PRIMARY KEY(HandID,UniqueGameID));";
+
+	// create action table
+	schema += "CREATE TABLE Action (";
+	schema += "ActionID INTEGER PRIMARY KEY AUTOINCREMENT";
+	schema += ",HandID INTEGER NOT NULL";
+	schema += ",UniqueGameID INTEGER NOT NULL";
+	schema += ",BeRo INTEGER NOT NULL";
+	schema += ",Player INTEGER NOT NULL";
+	schema += ",Action TEXT NOT NULL";
+	schema += ",Amount INTEGER";
+	schema += ");";
+
+	schema += getSqliteLogIndexes();
+
+	return schema;
+}
+
+string
+Log::getSqliteLogIndexes()
+{
+	// lookup indexes used by the log viewer, also added to older log files
+	string indexes;
+	indexes += "CREATE INDEX IF NOT EXISTS Hand_Game_Idx ON Hand(UniqueGameID,HandID);";
+	indexes += "CREATE INDEX IF NOT EXISTS Action_Hand_Idx ON Action(UniqueGameID,HandID,BeRo);";
+	return indexes;
+}
+
 void
 Log::logNewGameMsg(int gameID, int startCash, int startSmallBlind, unsigned dealerPosition, PlayerList seatsList)
 {
 	uniqueGameID++;
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
 		PlayerListConstIterator it_c;
 
+		if(myHandHistory.isOpen()) {
+			myHandHistory.writeGame(uniqueGameID, gameID, startCash, startSmallBlind, dealerPosition);
+			myHandHistorySeats.clear();
+			int i = 1;
+			for(it_c = seatsList->begin(); it_c!=seatsList->end(); ++it_c) {
+				if((*it_c)->getMyActiveStatus()) {
+					myHandHistory.writePlayer(i, (*it_c)->getMyName());
+					myHandHistorySeats[(*it_c)->getMyName()] = i;
+				}
+				i++;
+			}
+			flushHandHistory(0);
+		}
+
 		if( mySqliteLogDb != 0 ) {
 			// sqlite-db is open
 			int i;
@@ -290,10 +340,16 @@ Log::logNewHandMsg(int handID, unsigned dealerPosition, int smallBlind, unsigned
 		(*it_c)->setLogHoleCardsDone(false);
 	}
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
-		if( mySqliteLogDb != 0 ) {
+		if(myHandHistory.isOpen()) {
+			vector<int> seatCash;
+			for(it_c = seatsList->begin(); it_c!=seatsList->end(); ++it_c) {
+				seatCash.push_back((*it_c)->getMyActiveStatus() ? (*it_c)->getMyRoundStartCash() : -1);
+			}
+			myHandHistory.writeHand(currentHandID, dealerPosition, smallBlind, smallBlindPosition, bigBlind, bigBlindPosition, seatCash);
+		} else if( mySqliteLogDb != 0 ) {
 			// sqlite-db is open
 			int i;
 
@@ -324,9 +380,12 @@ Log::logNewHandMsg(int handID, unsigned dealerPosition, int smallBlind, unsigned
 				}
 			}
 			sql += ");";
-			if(myConfig->readConfigInt("LogInterval") == 0) {
+			if(myConfig->readConfigInt(myLogIntervalKey) == 0) {
 				exec_transaction();
 			}
+		}
+
+		if( mySqliteLogDb != 0 || myHandHistory.isOpen() ) {
 
 			// !! TODO !! Hack, weil Button-Regel noch falsch und dealerPosition noch teilweise falsche ID enthält (HeadsUp: dealerPosition=bigBlindPosition <-- falsch)
 			bool dealerButtonOnTable = false;
@@ -371,10 +430,17 @@ void
 Log::logPlayerAction(string playerName, PlayerActionLog action, int amount)
 {
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
-		if( mySqliteLogDb != 0 ) {
+		if(myHandHistory.isOpen()) {
+			map<string, int>::const_iterator pos = myHandHistorySeats.find(playerName);
+			if(pos != myHandHistorySeats.end()) {
+				logPlayerAction(pos->second, action, amount);
+			} else {
+				cout << "Implausible information about player " << playerName << " in hand history!" << endl;
+			}
+		} else if( mySqliteLogDb != 0 ) {
 			// sqlite-db is open
 
 			char **result_Player=0;
@@ -405,110 +471,122 @@ void
 Log::logPlayerAction(int seat, PlayerActionLog action, int amount)
 {
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
-		if( mySqliteLogDb != 0 ) {
+		if(action==LOG_ACTION_NONE) {
+			return;
+		}
+		string actionText;
+		bool hasAmount;
+		if(!getActionLogText(action, actionText, hasAmount)) {
+			return;
+		}
+
+		if(myHandHistory.isOpen()) {
+			myHandHistory.writeAction(currentRound, seat, action, hasAmount ? amount : -1);
+			flushHandHistory(0);
+		} else if( mySqliteLogDb != 0 ) {
 			// sqlite-db is open
 
-			if(action!=LOG_ACTION_NONE) {
-				sql += "INSERT INTO Action (";
-				sql += "HandID";
-				sql += ",UniqueGameID";
-				sql += ",BeRo";
-				sql += ",Player";
-				sql += ",Action";
-				sql += ",Amount";
-				sql += ") VALUES (";
-				sql += boost::lexical_cast<string>(currentHandID);
-				sql += "," + boost::lexical_cast<string>(uniqueGameID);
-				sql += "," + boost::lexical_cast<string>(currentRound);;
-				sql += "," + boost::lexical_cast<string>(seat);
-				switch(action) {
-				case LOG_ACTION_DEALER:
-					sql += ",'starts as dealer'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_SMALL_BLIND:
-					sql += ",'posts small blind'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_BIG_BLIND:
-					sql += ",'posts big blind'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_FOLD:
-					sql += ",'folds'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_CHECK:
-					sql += ",'checks'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_CALL:
-					sql += ",'calls'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_BET:
-					sql += ",'bets'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_ALL_IN:
-					sql += ",'is all in with'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_SHOW:
-					sql += ",'shows'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_HAS:
-					sql += ",'has'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_WIN:
-					sql += ",'wins'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_WIN_SIDE_POT:
-					sql += ",'wins (side pot)'";
-					sql += "," + boost::lexical_cast<string>(amount);
-					break;
-				case LOG_ACTION_SIT_OUT:
-					sql += ",'sits out'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_WIN_GAME:
-					sql += ",'wins game'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_LEFT:
-					sql += ",'has left the game'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_KICKED:
-					sql += ",'was kicked from the game'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_ADMIN:
-					sql += ",'is game admin now'";
-					sql += ",NULL";
-					break;
-				case LOG_ACTION_JOIN:
-					sql += ",'has joined the game'";
-					sql += ",NULL";
-					break;
-				default:
-					return;
-				}
-				sql += ");";
-				if(myConfig->readConfigInt("LogInterval") == 0) {
-					exec_transaction();
-				}
+			sql += "INSERT INTO Action (";
+			sql += "HandID";
+			sql += ",UniqueGameID";
+			sql += ",BeRo";
+			sql += ",Player";
+			sql += ",Action";
+			sql += ",Amount";
+			sql += ") VALUES (";
+			sql += boost::lexical_cast<string>(currentHandID);
+			sql += "," + boost::lexical_cast<string>(uniqueGameID);
+			sql += "," + boost::lexical_cast<string>(currentRound);;
+			sql += "," + boost::lexical_cast<string>(seat);
+			sql += ",'" + actionText + "'";
+			if(hasAmount) {
+				sql += "," + boost::lexical_cast<string>(amount);
+			} else {
+				sql += ",NULL";
+			}
+			sql += ");";
+			if(myConfig->readConfigInt(myLogIntervalKey) == 0) {
+				exec_transaction();
 			}
 		}
 	}
 }
 
+bool
+Log::getActionLogText(PlayerActionLog action, string &text, bool &hasAmount)
+{
+	hasAmount = false;
+	switch(action) {
+	case LOG_ACTION_DEALER:
+		text = "starts as dealer";
+		break;
+	case LOG_ACTION_SMALL_BLIND:
+		text = "posts small blind";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_BIG_BLIND:
+		text = "posts big blind";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_FOLD:
+		text = "folds";
+		break;
+	case LOG_ACTION_CHECK:
+		text = "checks";
+		break;
+	case LOG_ACTION_CALL:
+		text = "calls";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_BET:
+		text = "bets";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_ALL_IN:
+		text = "is all in with";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_SHOW:
+		text = "shows";
+		break;
+	case LOG_ACTION_HAS:
+		text = "has";
+		break;
+	case LOG_ACTION_WIN:
+		text = "wins";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_WIN_SIDE_POT:
+		text = "wins (side pot)";
+		hasAmount = true;
+		break;
+	case LOG_ACTION_SIT_OUT:
+		text = "sits out";
+		break;
+	case LOG_ACTION_WIN_GAME:
+		text = "wins game";
+		break;
+	case LOG_ACTION_LEFT:
+		text = "has left the game";
+		break;
+	case LOG_ACTION_KICKED:
+		text = "was kicked from the game";
+		break;
+	case LOG_ACTION_ADMIN:
+		text = "is game admin now";
+		break;
+	case LOG_ACTION_JOIN:
+		text = "has joined the game";
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
 PlayerActionLog
 Log::transformPlayerActionLog(PlayerAction action)
 {
@@ -538,10 +616,29 @@ void
 Log::logBoardCards(int boardCards[5])
 {
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
-		if( mySqliteLogDb != 0 ) {
+		if(myHandHistory.isOpen()) {
+			int newCards[5] = { -1, -1, -1, -1, -1 };
+			switch(currentRound) {
+			case GAME_STATE_FLOP:
+				newCards[0] = boardCards[0];
+				newCards[1] = boardCards[1];
+				newCards[2] = boardCards[2];
+				break;
+			case GAME_STATE_TURN:
+				newCards[3] = boardCards[3];
+				break;
+			case GAME_STATE_RIVER:
+				newCards[4] = boardCards[4];
+				break;
+			default:
+				return;
+			}
+			myHandHistory.writeBoardCards(currentRound, newCards);
+			flushHandHistory(0);
+		} else if( mySqliteLogDb != 0 ) {
 			// sqlite-db is open
 
 			switch(currentRound) {
@@ -569,7 +666,7 @@ Log::logBoardCards(int boardCards[5])
 			sql += "UniqueGameID=" + boost::lexical_cast<string>(uniqueGameID) + " AND ";
 			sql += "HandID=" + boost::lexical_cast<string>(currentHandID);
 			sql += ";";
-			if(myConfig->readConfigInt("LogInterval") == 0) {
+			if(myConfig->readConfigInt(myLogIntervalKey) == 0) {
 				exec_transaction();
 			}
 		}
@@ -595,10 +692,32 @@ void
 Log::logHoleCardsHandName(PlayerList activePlayerList, boost::shared_ptr<PlayerInterface> player, bool forceExecLog)
 {
 
-	if(myConfig->readConfigInt("LogOnOff")) {
+	if(myConfig->readConfigInt(myLogOnOffKey)) {
 		//if write logfiles is enabled
 
-		if( mySqliteLogDb != 0) {
+		if(myHandHistory.isOpen()) {
+
+			int myCards[2];
+			player->getMyHoleCards(myCards);
+			if(currentRound==GAME_STATE_POST_RIVER && player->getMyCardsValueInt()>0) {
+				myHandHistory.writeHandValue(player->getMyID()+1, player->getMyCardsValueInt(), CardsValue::determineHandName(player->getMyCardsValueInt(),activePlayerList));
+			}
+			if(!player->getLogHoleCardsDone()) {
+				myHandHistory.writeHoleCards(player->getMyID()+1, myCards[0], myCards[1]);
+			}
+			if(forceExecLog) {
+				myHandHistory.flush();
+			}
+
+			if(!player->getLogHoleCardsDone()) {
+				logPlayerAction(player->getMyName(),LOG_ACTION_SHOW);
+			} else {
+				logPlayerAction(player->getMyName(),LOG_ACTION_HAS);
+			}
+
+			player->setLogHoleCardsDone(true);
+
+		} else if( mySqliteLogDb != 0) {
 
 			int myCards[2];
 			player->getMyHoleCards(myCards);
@@ -618,7 +737,7 @@ Log::logHoleCardsHandName(PlayerList activePlayerList, boost::shared_ptr<PlayerI
 			sql += "UniqueGameID=" + boost::lexical_cast<string>(uniqueGameID) + " AND ";
 			sql += "HandID=" + boost::lexical_cast<string>(currentHandID);
 			sql += ";";
-			if(myConfig->readConfigInt("LogInterval") == 0 || forceExecLog) {
+			if(myConfig->readConfigInt(myLogIntervalKey) == 0 || forceExecLog) {
 				exec_transaction();
 			}
 
@@ -701,7 +820,9 @@ Log::logPlayerSitsOut(PlayerList activePlayerList)
 void
 Log::logAfterHand()
 {
-	if(myConfig->readConfigInt("LogInterval") == 1) {
+	if(myHandHistory.isOpen()) {
+		flushHandHistory(1);
+	} else if(myConfig->readConfigInt(myLogIntervalKey) == 1) {
 		exec_transaction();
 	}
 }
@@ -709,11 +830,22 @@ Log::logAfterHand()
 void
 Log::logAfterGame()
 {
-	if(myConfig->readConfigInt("LogInterval") == 2) {
+	if(myHandHistory.isOpen()) {
+		flushHandHistory(2);
+	} else if(myConfig->readConfigInt(myLogIntervalKey) == 2) {
 		exec_transaction();
 	}
 }
 
+void
+Log::flushHandHistory(int logInterval)
+{
+	// the binary hand history is buffered by the stream, LogInterval only controls the flushing
+	if(myConfig->readConfigInt(myLogIntervalKey) == logInterval) {
+		myHandHistory.flush();
+	}
+}
+
 void
 Log::exec_transaction()
 {
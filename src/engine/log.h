@@ -33,15 +33,16 @@
 #define LOG_H
 
 #include <string>
+#include <map>
 #include <boost/filesystem.hpp>
 
 #include "engine_defs.h"
 #include "game_defs.h"
+#include "handhistory.h"
+#include "configfile.h"
 
 struct sqlite3;
 
-class ConfigFile;
-
 class Log
 {
 
@@ -84,17 +85,28 @@ public:
 		return mySqliteLogFileName.directory_string();
 	}
 
+	// Table definitions of the SQLite log.
+	static std::string getSqliteLogSchema();
+	static std::string getSqliteLogIndexes();
+	// Text of an action in the SQLite log, and whether it has an amount.
+	static bool getActionLogText(PlayerActionLog action, std::string &text, bool &hasAmount);
+
 private:
 
 	void exec_transaction();
+	void flushHandHistory(int logInterval);
 
 	sqlite3 *mySqliteLogDb;
 	boost::filesystem::path mySqliteLogFileName;
 	ConfigFile *myConfig;
+	ConfigKey myLogOnOffKey;
+	ConfigKey myLogIntervalKey;
 	int uniqueGameID;
 	int currentHandID;
 	GameState currentRound;
 	std::string sql;
+	HandHistoryWriter myHandHistory;
+	std::map<std::string, int> myHandHistorySeats;
 
 	bool debug_mode;
 };
@@ -66,6 +66,9 @@ public:
 	Log* getLog() const {
 		return myLog;
 	}
+	BoardOddsCache *getBoardOddsCache() {
+		return NULL;
+	}
 
 	void setMyID ( int theValue );
 	int getMyID() const;
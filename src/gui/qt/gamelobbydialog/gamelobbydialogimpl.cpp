@@ -29,6 +29,7 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 #include "gamelobbydialogimpl.h"
+#include "mygamelistmodel.h"
 #include "mygamelistsortfilterproxymodel.h"
 #include "mynicklistsortfilterproxymodel.h"
 #include "startwindowimpl.h"
@@ -126,7 +127,7 @@ gameLobbyDialogImpl::gameLobbyDialogImpl(startWindowImpl *parent, ConfigFile *c)
 	autoStartTimerOverlay->setPalette(p);
 
 
-	myGameListModel = new QStandardItemModel(this);
+	myGameListModel = new MyGameListModel(this);
 	myGameListSortFilterProxyModel = new MyGameListSortFilterProxyModel(this);
 	myGameListSortFilterProxyModel->setSourceModel(myGameListModel);
 	myGameListSortFilterProxyModel->setDynamicSortFilter(true);
@@ -135,7 +136,7 @@ gameLobbyDialogImpl::gameLobbyDialogImpl(startWindowImpl *parent, ConfigFile *c)
 
 	QStringList headerList;
 	headerList << tr("Game") << tr("Players") << tr("State") << tr("T") << tr("P") << tr("Time");
-	myGameListModel->setHorizontalHeaderLabels(headerList);
+	myGameListModel->setHeaderLabels(headerList);
 
 #ifdef GUI_800x480
 	treeView_GameList->setColumnWidth(0,200); //484px alltogether
@@ -429,7 +430,7 @@ void gameLobbyDialogImpl::refresh(int actionID)
 
 		QStringList headerList;
 		headerList << tr("Game") << tr("Players") << tr("State") << tr("T") << tr("P") << tr("Time");;
-		myGameListModel->setHorizontalHeaderLabels(headerList);
+		myGameListModel->setHeaderLabels(headerList);
 
 #ifdef GUI_800x480
 		treeView_GameList->setColumnWidth(0,200); //484px alltogether
@@ -485,13 +486,14 @@ void gameLobbyDialogImpl::gameSelected(const QModelIndex &index)
 	if (!inGame && index.isValid() ) {
 		pushButton_JoinGame->setEnabled(true);
 
-		currentGameName = myGameListModel->item(myGameListSortFilterProxyModel->mapToSource(index).row(), 0)->text();
+		const MyGameListModel::GameEntry &game = myGameListModel->gameAt(myGameListSortFilterProxyModel->mapToSource(index).row());
+		currentGameName = game.name;
 
 		groupBox_GameInfo->setEnabled(true);
 		groupBox_GameInfo->setTitle(tr("Game Info") + " - " + currentGameName);
 
 		assert(mySession);
-		GameInfo info(mySession->getClientGameInfo(myGameListModel->item(myGameListSortFilterProxyModel->mapToSource(index).row(), 0)->data(Qt::UserRole).toUInt()));
+		GameInfo info(mySession->getClientGameInfo(game.gameId));
 
 		switch (info.data.gameType) {
 		case GAME_TYPE_NORMAL: {
@@ -551,43 +553,18 @@ void gameLobbyDialogImpl::gameSelected(const QModelIndex &index)
 	}
 }
 
-void gameLobbyDialogImpl::updateGameItem(QList <QStandardItem*> itemList, unsigned gameId)
+void gameLobbyDialogImpl::updateGameItem(unsigned gameId)
 {
 	assert(mySession);
 	GameInfo info(mySession->getClientGameInfo(gameId));
 
-	itemList.at(0)->setData(gameId, Qt::UserRole);
-	itemList.at(0)->setData(QString::fromUtf8(info.name.c_str()), Qt::DisplayRole);
-
+	bool meInThisGame = false;
 	PlayerIdList::const_iterator i = info.players.begin();
 	PlayerIdList::const_iterator end = info.players.end();
-
 	while (i != end) {
 		if(myPlayerId == *i) {
-			itemList.at(0)->setData( "MeInThisGame", 16);
-			itemList.at(0)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			itemList.at(1)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			itemList.at(2)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			itemList.at(3)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			itemList.at(4)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			itemList.at(5)->setBackground(QBrush(QColor(0, 255, 0, 127)));
-			break;
-		} else {
-			itemList.at(0)->setData( "", 16);
-			itemList.at(0)->setBackground(QBrush());
-			itemList.at(1)->setBackground(QBrush());
-			itemList.at(2)->setBackground(QBrush());
-			itemList.at(3)->setBackground(QBrush());
-			itemList.at(4)->setBackground(QBrush());
-			itemList.at(5)->setBackground(QBrush());
+			meInThisGame = true;
 		}
-		++i;
-	}
-
-	//reset players iterator
-	i = info.players.begin();
-	end = info.players.end();
-	while (i != end) {
 		//mark players as active
 		int it1 = 0;
 		while (myNickListModel->item(it1)) {
@@ -600,67 +577,7 @@ void gameLobbyDialogImpl::updateGameItem(QList <QStandardItem*> itemList, unsign
 		++i;
 	}
 
-	QString playerStr;
-	playerStr.sprintf("%u/%u", (unsigned)info.players.size(), (unsigned)info.data.maxNumberOfPlayers);
-	itemList.at(1)->setData(playerStr, Qt::DisplayRole);
-	if((unsigned)info.players.size() == (unsigned)info.data.maxNumberOfPlayers) {
-		itemList.at(1)->setData("totalfull", 16);
-	} else {
-		itemList.at(1)->setData("nonfull", 16);
-	}\
-
-	if (info.mode == GAME_MODE_STARTED) {
-		itemList.at(2)->setData(tr("running"), Qt::DisplayRole);
-		itemList.at(2)->setData("running", 16);
-	} else {
-		itemList.at(2)->setData(tr("open"), Qt::DisplayRole);
-		itemList.at(2)->setData("open", 16);
-	}
-
-	switch (info.data.gameType) {
-	case GAME_TYPE_NORMAL: {
-		itemList.at(3)->setIcon(QIcon(":/gfx/player_play.png"));
-		itemList.at(3)->setData("", Qt::DisplayRole);
-		itemList.at(3)->setData("standard", 16);
-	}
-	break;
-	case GAME_TYPE_REGISTERED_ONLY: {
-		itemList.at(3)->setIcon(QIcon(":/gfx/registered.png"));
-		itemList.at(3)->setData(" ", Qt::DisplayRole);
-		itemList.at(3)->setData("registered", 16);
-	}
-	break;
-	case GAME_TYPE_INVITE_ONLY: {
-		itemList.at(3)->setIcon(QIcon(":/gfx/list_add_user.png"));
-		itemList.at(3)->setData("  ", Qt::DisplayRole);
-		itemList.at(3)->setData("invited", 16);
-	}
-	break;
-	case GAME_TYPE_RANKING: {
-		itemList.at(3)->setIcon(QIcon(":/gfx/cup.png"));
-		itemList.at(3)->setData("   ", Qt::DisplayRole);
-		itemList.at(3)->setData("ranking", 16);
-	}
-	break;
-	}
-
-	if (info.isPasswordProtected) {
-		itemList.at(4)->setIcon(QIcon(":/gfx/lock.png"));
-		itemList.at(4)->setData(" ", Qt::DisplayRole);
-		itemList.at(4)->setData("private", 16);
-	} else {
-		itemList.at(4)->setData("", Qt::DisplayRole);
-		itemList.at(4)->setData("nonpriv", 16);
-	}
-
-	itemList.at(5)->setData(QString::number(info.data.playerActionTimeoutSec)+"s/"+QString::number(info.data.delayBetweenHandsSec)+"s", Qt::DisplayRole);
-	QString actionTimeOutString = QString::number(info.data.playerActionTimeoutSec);
-	if(info.data.playerActionTimeoutSec < 10) {
-		actionTimeOutString = "0"+actionTimeOutString;
-	}
-	itemList.at(5)->setData(actionTimeOutString, 16);
-
-	treeView_GameList->sortByColumn(myConfig->readConfigInt("DlgGameLobbyGameListSortingSection"), (Qt::SortOrder)myConfig->readConfigInt("DlgGameLobbyGameListSortingOrder") );
+	myGameListModel->setGame(gameId, info, meInThisGame);
 	refreshGameStats();
 
 	//mark spactators as active
@@ -682,31 +599,13 @@ void gameLobbyDialogImpl::updateGameItem(QList <QStandardItem*> itemList, unsign
 
 void gameLobbyDialogImpl::addGame(unsigned gameId)
 {
-	QList <QStandardItem*> itemList;
-	QStandardItem *item1 = new QStandardItem();
-	QStandardItem *item2 = new QStandardItem();
-	QStandardItem *item3 = new QStandardItem();
-	QStandardItem *item4 = new QStandardItem();
-	QStandardItem *item5 = new QStandardItem();
-	QStandardItem *item6 = new QStandardItem();
-	itemList << item1 << item2 << item3 << item4 << item5 << item6;
-
-	myGameListModel->appendRow(itemList);
-
-	updateGameItem(itemList, gameId);
+	updateGameItem(gameId);
 }
 
 void gameLobbyDialogImpl::updateGameMode(unsigned gameId, int /*newMode*/)
 {
-	int it = 0;
-	while (myGameListModel->item(it)) {
-		if (myGameListModel->item(it, 0)->data(Qt::UserRole) == gameId) {
-			QList <QStandardItem*> itemList;
-			itemList << myGameListModel->item(it, 0) << myGameListModel->item(it, 1) << myGameListModel->item(it, 2) << myGameListModel->item(it, 3) << myGameListModel->item(it, 4) << myGameListModel->item(it, 5);
-			updateGameItem(itemList, gameId);
-			break;
-		}
-		it++;
+	if (myGameListModel->hasGame(gameId)) {
+		updateGameItem(gameId);
 	}
 }
 
@@ -717,37 +616,15 @@ void gameLobbyDialogImpl::updateGameAdmin(unsigned /*gameId*/, unsigned adminPla
 
 void gameLobbyDialogImpl::removeGame(unsigned gameId)
 {
-	int it = 0;
-	while (myGameListModel->item(it)) {
-		if (myGameListModel->item(it, 0)->data(Qt::UserRole) == gameId) {
-			myGameListModel->removeRow(it);
-			break;
-		}
-		it++;
-	}
+	myGameListModel->removeGame(gameId);
 
 	refreshGameStats();
 }
 
 void gameLobbyDialogImpl::refreshGameStats()
 {
-
-	int runningGamesCounter = 0;
-	int openGamesCounter = 0;
-
-	int it = 0;
-	while (myGameListModel->item(it)) {
-		if (myGameListModel->item(it, 2)->data(16) == "running") {
-			runningGamesCounter++;
-		}
-		if (myGameListModel->item(it, 2)->data(16) == "open") {
-			openGamesCounter++;
-		}
-		++it;
-	}
-
-	label_openGamesCounter->setText(" | "+tr("running games: %1").arg(runningGamesCounter));
-	label_runningGamesCounter->setText(" | "+tr("open games: %1").arg(openGamesCounter));
+	label_openGamesCounter->setText(" | "+tr("running games: %1").arg(myGameListModel->runningGamesCount()));
+	label_runningGamesCounter->setText(" | "+tr("open games: %1").arg(myGameListModel->openGamesCount()));
 
 }
 
@@ -773,15 +650,8 @@ void gameLobbyDialogImpl::gameAddPlayer(unsigned gameId, unsigned playerId)
 		}
 	}
 
-	int it = 0;
-	while (myGameListModel->item(it)) {
-		if (myGameListModel->item(it, 0)->data(Qt::UserRole) == gameId) {
-			QList <QStandardItem*> itemList;
-			itemList << myGameListModel->item(it, 0) << myGameListModel->item(it, 1) << myGameListModel->item(it, 2) << myGameListModel->item(it, 3) << myGameListModel->item(it, 4)  << myGameListModel->item(it, 5);
-			updateGameItem(itemList, gameId);
-			break;
-		}
-		it++;
+	if (myGameListModel->hasGame(gameId)) {
+		updateGameItem(gameId);
 	}
 }
 
@@ -810,16 +680,8 @@ void gameLobbyDialogImpl::gameRemovePlayer(unsigned gameId, unsigned playerId)
 		}
 	}
 
-	int it = 0;
-	while (myGameListModel->item(it)) {
-		if (myGameListModel->item(it, 0)->data(Qt::UserRole) == gameId) {
-			QList <QStandardItem*> itemList;
-			itemList << myGameListModel->item(it, 0) << myGameListModel->item(it, 1) << myGameListModel->item(it, 2) << myGameListModel->item(it, 3) << myGameListModel->item(it, 4) << myGameListModel->item(it, 5);
-
-			updateGameItem(itemList, gameId);
-			break;
-		}
-		++it;
+	if (myGameListModel->hasGame(gameId)) {
+		updateGameItem(gameId);
 	}
 
 	//mark player as idle again
@@ -886,7 +748,7 @@ void gameLobbyDialogImpl::clearDialog()
 
 	QStringList headerList;
 	headerList << tr("Game") << tr("Players") << tr("State") << tr("T") << tr("P") << tr("Time");
-	myGameListModel->setHorizontalHeaderLabels(headerList);
+	myGameListModel->setHeaderLabels(headerList);
 
 #ifdef GUI_800x480
 	treeView_GameList->setColumnWidth(0,200); //484px alltogether
@@ -1532,58 +1394,32 @@ void gameLobbyDialogImpl::changeGameListFilter(int index)
 
 	switch(index) {
 	case 0: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(0);
 	}
 	break;
 	case 1: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp("open", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(MyGameListSortFilterProxyModel::FILTER_OPEN);
 	}
 	break;
 	case 2: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp("nonfull", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp("open", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(MyGameListSortFilterProxyModel::FILTER_OPEN | MyGameListSortFilterProxyModel::FILTER_NONFULL);
 	}
 	break;
 	case 3: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp("nonfull", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp("open", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp("nonpriv", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(MyGameListSortFilterProxyModel::FILTER_OPEN | MyGameListSortFilterProxyModel::FILTER_NONFULL | MyGameListSortFilterProxyModel::FILTER_NONPRIVATE);
 	}
 	break;
 	case 4: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp("nonfull", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp("open", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp("private", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(MyGameListSortFilterProxyModel::FILTER_OPEN | MyGameListSortFilterProxyModel::FILTER_NONFULL | MyGameListSortFilterProxyModel::FILTER_PRIVATE);
 	}
 	break;
 	case 5: {
-		myGameListSortFilterProxyModel->setColumn1RegExp(QRegExp("nonfull", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn2RegExp(QRegExp("open", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn3RegExp(QRegExp("ranking", Qt::CaseInsensitive, QRegExp::FixedString));
-		myGameListSortFilterProxyModel->setColumn4RegExp(QRegExp());
-		myGameListSortFilterProxyModel->setColumn5RegExp(QRegExp());
+		myGameListSortFilterProxyModel->setGameFilter(MyGameListSortFilterProxyModel::FILTER_OPEN | MyGameListSortFilterProxyModel::FILTER_NONFULL | MyGameListSortFilterProxyModel::FILTER_RANKING);
 	}
 	break;
 	default:
 		;
 	}
-	myGameListSortFilterProxyModel->setFilterRegExp(QString());
-	myGameListSortFilterProxyModel->setFilterKeyColumn(0);
 
 	writeDialogSettings(1);
 
@@ -49,6 +49,7 @@ class Session;
 class ConfigFile;
 class ChatTools;
 class startWindowImpl;
+class MyGameListModel;
 class MyGameListSortFilterProxyModel;
 class MyNickListSortFilterProxyModel;
 
@@ -85,7 +86,7 @@ public slots:
 	void createGame();
 	void joinGame();
 	void gameSelected(const QModelIndex &);
-	void updateGameItem(QList <QStandardItem*>, unsigned gameId);
+	void updateGameItem(unsigned gameId);
 	void addGame(unsigned gameId);
 	void updateGameMode(unsigned gameId, int newMode);
 	void updateGameAdmin(unsigned gameId, unsigned adminPlayerId);
@@ -196,7 +197,7 @@ private:
 	QColor disabledStartButtonTextColor;
 	ChatTools *myChat;
 	int keyUpCounter;
-	QStandardItemModel *myGameListModel;
+	MyGameListModel *myGameListModel;
 	QItemSelectionModel *myGameListSelectionModel;
 	MyGameListSortFilterProxyModel *myGameListSortFilterProxyModel;
 	QMenu *gameListContextMenu;
@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+#include "mygamelistmodel.h"
+#include <QtGui>
+#include <QtCore>
+#include <algorithm>
+
+MyGameListModel::MyGameListModel(QObject *parent)
+	: QAbstractTableModel(parent), runningGamesCounter(0)
+{
+	changeTimer = new QTimer(this);
+	changeTimer->setSingleShot(true);
+	changeTimer->setInterval(0);
+	connect(changeTimer, SIGNAL(timeout()), this, SLOT(emitPendingChanges()));
+
+	gameTypeIcons[GAME_TYPE_NORMAL] = QIcon(":/gfx/player_play.png");
+	gameTypeIcons[GAME_TYPE_REGISTERED_ONLY] = QIcon(":/gfx/registered.png");
+	gameTypeIcons[GAME_TYPE_INVITE_ONLY] = QIcon(":/gfx/list_add_user.png");
+	gameTypeIcons[GAME_TYPE_RANKING] = QIcon(":/gfx/cup.png");
+	privateGameIcon = QIcon(":/gfx/lock.png");
+}
+
+void MyGameListModel::setHeaderLabels(const QStringList &labels)
+{
+	headerLabels = labels;
+	emit headerDataChanged(Qt::Horizontal, 0, NUM_COLUMNS - 1);
+}
+
+void MyGameListModel::setGame(unsigned gameId, const GameInfo &info, bool meInThisGame)
+{
+	GameEntry entry;
+	entry.gameId = gameId;
+	entry.name = QString::fromUtf8(info.name.c_str());
+	entry.numPlayers = (unsigned)info.players.size();
+	entry.maxNumPlayers = (unsigned)info.data.maxNumberOfPlayers;
+	entry.running = info.mode == GAME_MODE_STARTED;
+	entry.gameType = info.data.gameType;
+	entry.passwordProtected = info.isPasswordProtected;
+	entry.actionTimeoutSec = info.data.playerActionTimeoutSec;
+	entry.handDelaySec = info.data.delayBetweenHandsSec;
+	entry.meInThisGame = meInThisGame;
+
+	QHash<unsigned, int>::const_iterator pos = rowIndex.constFind(gameId);
+	if (pos == rowIndex.constEnd()) {
+		int row = games.size();
+		beginInsertRows(QModelIndex(), row, row);
+		games.append(entry);
+		rowIndex.insert(gameId, row);
+		endInsertRows();
+	} else {
+		GameEntry &oldEntry = games[pos.value()];
+		if (oldEntry.running)
+			runningGamesCounter--;
+		oldEntry = entry;
+		changedGames.insert(gameId);
+		if (!changeTimer->isActive())
+			changeTimer->start();
+	}
+	if (entry.running)
+		runningGamesCounter++;
+}
+
+void MyGameListModel::removeGame(unsigned gameId)
+{
+	QHash<unsigned, int>::iterator pos = rowIndex.find(gameId);
+	if (pos != rowIndex.end()) {
+		int row = pos.value();
+		beginRemoveRows(QModelIndex(), row, row);
+		if (games.at(row).running)
+			runningGamesCounter--;
+		games.remove(row);
+		rowIndex.erase(pos);
+		// Only the rows behind the removed game need to be reindexed.
+		for (int i = row; i < games.size(); i++)
+			rowIndex[games.at(i).gameId] = i;
+		changedGames.remove(gameId);
+		endRemoveRows();
+	}
+}
+
+void MyGameListModel::clear()
+{
+	beginResetModel();
+	games.clear();
+	rowIndex.clear();
+	changedGames.clear();
+	runningGamesCounter = 0;
+	endResetModel();
+}
+
+int MyGameListModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : games.size();
+}
+
+int MyGameListModel::columnCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : NUM_COLUMNS;
+}
+
+QVariant MyGameListModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= games.size())
+		return QVariant();
+
+	const GameEntry &entry = games.at(index.row());
+	switch (role) {
+	case Qt::UserRole:
+		return entry.gameId;
+	case Qt::BackgroundRole:
+		if (entry.meInThisGame)
+			return QBrush(QColor(0, 255, 0, 127));
+		break;
+	case Qt::DisplayRole:
+		switch (index.column()) {
+		case COLUMN_NAME:
+			return entry.name;
+		case COLUMN_PLAYERS:
+			return QString("%1/%2").arg(entry.numPlayers).arg(entry.maxNumPlayers);
+		case COLUMN_STATE:
+			// Keep the translation context of the game lobby dialog.
+			return entry.running ? QCoreApplication::translate("gameLobbyDialogImpl", "running") : QCoreApplication::translate("gameLobbyDialogImpl", "open");
+		case COLUMN_TIME:
+			return QString::number(entry.actionTimeoutSec) + "s/" + QString::number(entry.handDelaySec) + "s";
+		}
+		break;
+	case Qt::DecorationRole:
+		if (index.column() == COLUMN_TYPE && entry.gameType >= GAME_TYPE_NORMAL && entry.gameType <= GAME_TYPE_RANKING)
+			return gameTypeIcons[entry.gameType];
+		else if (index.column() == COLUMN_PRIVATE && entry.passwordProtected)
+			return privateGameIcon;
+		break;
+	}
+	return QVariant();
+}
+
+QVariant MyGameListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < headerLabels.size())
+		return headerLabels.at(section);
+	return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void MyGameListModel::emitPendingChanges()
+{
+	QVector<int> rows;
+	rows.reserve(changedGames.size());
+	QSet<unsigned>::const_iterator i = changedGames.constBegin();
+	QSet<unsigned>::const_iterator end = changedGames.constEnd();
+	while (i != end) {
+		QHash<unsigned, int>::const_iterator pos = rowIndex.constFind(*i);
+		if (pos != rowIndex.constEnd())
+			rows.append(pos.value());
+		++i;
+	}
+	changedGames.clear();
+	std::sort(rows.begin(), rows.end());
+
+	// Report adjacent rows as one range.
+	int pos = 0;
+	while (pos < rows.size()) {
+		int first = rows.at(pos);
+		int last = first;
+		while (++pos < rows.size() && rows.at(pos) == last + 1)
+			last++;
+		emit dataChanged(index(first, 0), index(last, NUM_COLUMNS - 1));
+	}
+}
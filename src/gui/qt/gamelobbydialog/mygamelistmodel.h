@@ -0,0 +1,117 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+#ifndef MYGAMELISTMODEL_H
+#define MYGAMELISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QIcon>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+
+#include <gamedata.h>
+
+class QTimer;
+
+class MyGameListModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	enum Column {
+		COLUMN_NAME = 0,
+		COLUMN_PLAYERS,
+		COLUMN_STATE,
+		COLUMN_TYPE,
+		COLUMN_PRIVATE,
+		COLUMN_TIME,
+		NUM_COLUMNS
+	};
+
+	struct GameEntry {
+		GameEntry() : gameId(0), numPlayers(0), maxNumPlayers(0), running(false), gameType(GAME_TYPE_NORMAL),
+			passwordProtected(false), actionTimeoutSec(0), handDelaySec(0), meInThisGame(false) {}
+
+		unsigned gameId;
+		QString name;
+		unsigned numPlayers;
+		unsigned maxNumPlayers;
+		bool running;
+		GameType gameType;
+		bool passwordProtected;
+		unsigned actionTimeoutSec;
+		unsigned handDelaySec;
+		bool meInThisGame;
+	};
+
+	MyGameListModel(QObject *parent = 0);
+
+	void setHeaderLabels(const QStringList &labels);
+
+	// Adds the game or updates its row. Updates are reported once per event loop iteration.
+	void setGame(unsigned gameId, const GameInfo &info, bool meInThisGame);
+	void removeGame(unsigned gameId);
+	void clear();
+
+	bool hasGame(unsigned gameId) const {
+		return rowIndex.contains(gameId);
+	}
+	const GameEntry &gameAt(int row) const {
+		return games.at(row);
+	}
+	int runningGamesCount() const {
+		return runningGamesCounter;
+	}
+	int openGamesCount() const {
+		return games.size() - runningGamesCounter;
+	}
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private slots:
+	void emitPendingChanges();
+
+private:
+	QVector<GameEntry> games;
+	QHash<unsigned, int> rowIndex;
+	QSet<unsigned> changedGames;
+	QTimer *changeTimer;
+	int runningGamesCounter;
+	QStringList headerLabels;
+	QIcon gameTypeIcons[GAME_TYPE_RANKING + 1];
+	QIcon privateGameIcon;
+};
+
+#endif // MYGAMELISTMODEL_H
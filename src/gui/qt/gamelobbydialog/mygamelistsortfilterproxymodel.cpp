@@ -29,37 +29,59 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 #include "mygamelistsortfilterproxymodel.h"
+#include "mygamelistmodel.h"
 #include <QtGui>
 #include <QtCore>
 
 MyGameListSortFilterProxyModel::MyGameListSortFilterProxyModel(QObject *parent)
-	: QSortFilterProxyModel(parent)
+	: QSortFilterProxyModel(parent), gameFilter(0)
 {
 }
 
-bool MyGameListSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+void MyGameListSortFilterProxyModel::setGameFilter(int filter)
 {
+	gameFilter = filter;
+	invalidateFilter();
+}
+
+bool MyGameListSortFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &/*sourceParent*/) const
+{
+	const MyGameListModel *gameListModel = qobject_cast<const MyGameListModel *>(sourceModel());
+	if (!gameListModel)
+		return true;
 
-	QModelIndex index0 = sourceModel()->index(sourceRow, 0, sourceParent);
-	QModelIndex index1 = sourceModel()->index(sourceRow, 1, sourceParent);
-	QModelIndex index2 = sourceModel()->index(sourceRow, 2, sourceParent);
-	QModelIndex index3 = sourceModel()->index(sourceRow, 3, sourceParent);
-	QModelIndex index4 = sourceModel()->index(sourceRow, 4, sourceParent);
-	QModelIndex index5 = sourceModel()->index(sourceRow, 5, sourceParent);
+	const MyGameListModel::GameEntry &game = gameListModel->gameAt(sourceRow);
+	if (game.meInThisGame)
+		return true;
 
-	return ((sourceModel()->data(index1, 16).toString().contains(column1RegExp)
-			 && sourceModel()->data(index2, 16).toString().contains(column2RegExp)
-			 && sourceModel()->data(index3, 16).toString().contains(column3RegExp)
-			 && sourceModel()->data(index4, 16).toString().contains(column4RegExp)
-			 && sourceModel()->data(index5, 16).toString().contains(column5RegExp)) || sourceModel()->data(index0, 16) == "MeInThisGame");
+	return !(((gameFilter & FILTER_OPEN) && game.running)
+			 || ((gameFilter & FILTER_NONFULL) && game.numPlayers == game.maxNumPlayers)
+			 || ((gameFilter & FILTER_NONPRIVATE) && game.passwordProtected)
+			 || ((gameFilter & FILTER_PRIVATE) && !game.passwordProtected)
+			 || ((gameFilter & FILTER_RANKING) && game.gameType != GAME_TYPE_RANKING));
 }
 
 bool MyGameListSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
+	const MyGameListModel *gameListModel = qobject_cast<const MyGameListModel *>(sourceModel());
+	if (!gameListModel)
+		return QSortFilterProxyModel::lessThan(left, right);
+
+	const MyGameListModel::GameEntry &leftGame = gameListModel->gameAt(left.row());
+	const MyGameListModel::GameEntry &rightGame = gameListModel->gameAt(right.row());
+
 	switch(sortColumn()) {
 
-	case 5: {
-		return sourceModel()->data(left, 16).toString() < sourceModel()->data(right, 16).toString();
+	case MyGameListModel::COLUMN_TYPE: {
+		return leftGame.gameType < rightGame.gameType;
+	}
+	break;
+	case MyGameListModel::COLUMN_PRIVATE: {
+		return leftGame.passwordProtected < rightGame.passwordProtected;
+	}
+	break;
+	case MyGameListModel::COLUMN_TIME: {
+		return leftGame.actionTimeoutSec < rightGame.actionTimeoutSec;
 	}
 	break;
 	default: {
@@ -38,33 +38,23 @@ class MyGameListSortFilterProxyModel : public QSortFilterProxyModel
 	Q_OBJECT
 
 public:
+	enum GameFilter {
+		FILTER_OPEN			= 0x01,
+		FILTER_NONFULL		= 0x02,
+		FILTER_NONPRIVATE	= 0x04,
+		FILTER_PRIVATE		= 0x08,
+		FILTER_RANKING		= 0x10
+	};
+
 	MyGameListSortFilterProxyModel(QObject *parent = 0);
-	void setColumn1RegExp(QRegExp column1) {
-		column1RegExp = column1;
-	}
-	void setColumn2RegExp(QRegExp column2) {
-		column2RegExp = column2;
-	}
-	void setColumn3RegExp(QRegExp column3) {
-		column3RegExp = column3;
-	}
-	void setColumn4RegExp(QRegExp column4) {
-		column4RegExp = column4;
-	}
-	void setColumn5RegExp(QRegExp column5) {
-		column5RegExp = column5;
-	}
+	void setGameFilter(int filter);
 
 protected:
 	bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const;
 	bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
 
 private:
-	QRegExp column1RegExp;
-	QRegExp column2RegExp;
-	QRegExp column3RegExp;
-	QRegExp column4RegExp;
-	QRegExp column5RegExp;
+	int gameFilter;
 
 };
 
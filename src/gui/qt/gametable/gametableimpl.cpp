@@ -76,8 +76,30 @@
 
 using namespace std;
 
+// Decodes an avatar image in a worker thread and passes it to the game table.
+// Runs in the avatar loader pool of the table, which is drained before the table is destroyed.
+class AvatarImageLoader : public QRunnable
+{
+public:
+	AvatarImageLoader(gameTableImpl *table, const QString &fileName)
+		: myTable(table), myFileName(fileName) {}
+
+	void run() {
+		QImage image(myFileName);
+		//avatars are drawn at 50x50, keep only the size which is needed
+		if(image.width() > 50 || image.height() > 50) {
+			image = image.scaled(50, 50, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+		}
+		QMetaObject::invokeMethod(myTable, "avatarImageLoaded", Qt::QueuedConnection, Q_ARG(QString, myFileName), Q_ARG(QImage, image));
+	}
+
+private:
+	gameTableImpl *myTable;
+	QString myFileName;
+};
+
 gameTableImpl::gameTableImpl(ConfigFile *c, QMainWindow *parent)
-	: QMainWindow(parent), myChat(NULL), myConfig(c), gameSpeed(0), myActionIsBet(0), myActionIsRaise(0), pushButtonBetRaiseIsChecked(false), pushButtonCallCheckIsChecked(false), pushButtonFoldIsChecked(false), pushButtonAllInIsChecked(false), myButtonsAreCheckable(false), breakAfterCurrentHand(false), currentGameOver(false), betSliderChangedByInput(false), guestMode(false), myLastPreActionBetValue(0)
+	: QMainWindow(parent), myChat(NULL), myConfig(c), myAntiPeekModeKey(c->getConfigKey("AntiPeekMode")), myShowBlindButtonsKey(c->getConfigKey("ShowBlindButtons")), myPlayGameActionsKey(c->getConfigKey("PlayGameActions")), myShowFlipCardsAnimationKey(c->getConfigKey("ShowFlipCardsAnimation")), myAccidentallyCallBlockerKey(c->getConfigKey("AccidentallyCallBlocker")), myEnableBetInputFocusSwitchKey(c->getConfigKey("EnableBetInputFocusSwitch")), myShowFadeOutCardsAnimationKey(c->getConfigKey("ShowFadeOutCardsAnimation")), myPauseBetweenHandsKey(c->getConfigKey("PauseBetweenHands")), myAlternateFKeysUserActionModeKey(c->getConfigKey("AlternateFKeysUserActionMode")), myShowCardsChanceMonitorKey(c->getConfigKey("ShowCardsChanceMonitor")), gameSpeed(0), myActionIsBet(0), myActionIsRaise(0), pushButtonBetRaiseIsChecked(false), pushButtonCallCheckIsChecked(false), pushButtonFoldIsChecked(false), pushButtonAllInIsChecked(false), myButtonsAreCheckable(false), breakAfterCurrentHand(false), currentGameOver(false), betSliderChangedByInput(false), guestMode(false), myLastPreActionBetValue(0)
 {
 	int i;
 
@@ -125,11 +147,7 @@ gameTableImpl::gameTableImpl(ConfigFile *c, QMainWindow *parent)
 #endif
 
 	//Flipside festlegen;
-	if (myConfig->readConfigInt("FlipsideOwn") && myConfig->readConfigString("FlipsideOwnFile") != "") {
-		flipside = QPixmap::fromImage(QImage(QString::fromUtf8(myConfig->readConfigString("FlipsideOwnFile").c_str())));
-	} else {
-		flipside = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+"flipside.png"));
-	}
+	loadCardDeckPixmaps();
 
 	//Flipside Animation noch nicht erledigt
 	flipHolecardsAllInAlreadyDone = false;
@@ -144,7 +162,7 @@ gameTableImpl::gameTableImpl(ConfigFile *c, QMainWindow *parent)
 	}
 
 	//CardsChanceMonitor show/hide
-	if (!myConfig->readConfigInt("ShowCardsChanceMonitor")) {
+	if (!myConfig->readConfigInt(myShowCardsChanceMonitorKey)) {
 		tabWidget_Right->removeTab(2);
 		tabWidget_Right->setCurrentIndex(0);
 	}
@@ -694,7 +712,8 @@ gameTableImpl::gameTableImpl(ConfigFile *c, QMainWindow *parent)
 
 gameTableImpl::~gameTableImpl()
 {
-
+	//avatar loaders must not call back into a destroyed table
+	avatarLoaderPool.waitForDone();
 
 }
 
@@ -716,7 +735,7 @@ void gameTableImpl::applySettings(settingsDialogImpl* mySettingsDialog)
 
 #ifdef GUI_800x480
 	//cardschancemonitor show/hide
-	if (!myConfig->readConfigInt("ShowCardsChanceMonitor")) {
+	if (!myConfig->readConfigInt(myShowCardsChanceMonitorKey)) {
 		tabs.tabWidget_Right->removeTab(2);
 		tabs.tabWidget_Right->setCurrentIndex(0);
 	} else {
@@ -738,7 +757,7 @@ void gameTableImpl::applySettings(settingsDialogImpl* mySettingsDialog)
 	}
 
 	//cardschancemonitor show/hide
-	if (!myConfig->readConfigInt("ShowCardsChanceMonitor")) {
+	if (!myConfig->readConfigInt(myShowCardsChanceMonitorKey)) {
 		tabWidget_Right->removeTab(2);
 		tabWidget_Right->setCurrentIndex(0);
 	} else {
@@ -797,25 +816,21 @@ void gameTableImpl::applySettings(settingsDialogImpl* mySettingsDialog)
 		GameState currentState = myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getCurrentBeRo()->getMyBeRoID();
 		if(currentState >= GAME_STATE_FLOP && currentState <= GAME_STATE_POST_RIVER)
 			for(int i=0; i<3; i++) {
-				QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[i], 10)+".png"));
+				QPixmap card = getCardPixmap(boardCards[i]);
 				boardCardsArray[i]->setPixmap(card, false);
 			}
 		if(currentState >= GAME_STATE_TURN && currentState <= GAME_STATE_POST_RIVER) {
-			QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[3], 10)+".png"));
+			QPixmap card = getCardPixmap(boardCards[3]);
 			boardCardsArray[3]->setPixmap(card, false);
 		}
 		if(currentState == GAME_STATE_RIVER || currentState == GAME_STATE_POST_RIVER) {
-			QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[4], 10)+".png"));
+			QPixmap card = getCardPixmap(boardCards[4]);
 			boardCardsArray[4]->setPixmap(card, false);
 		}
 	}
 
 	//Flipside refresh
-	if (myConfig->readConfigInt("FlipsideOwn") && myConfig->readConfigString("FlipsideOwnFile") != "") {
-		flipside = QPixmap::fromImage(QImage(QString::fromUtf8(myConfig->readConfigString("FlipsideOwnFile").c_str())));
-	} else {
-		flipside = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+"flipside.png"));
-	}
+	loadCardDeckPixmaps();
 	int j,k;
 	for (j=1; j<MAX_NUMBER_OF_PLAYERS; j++ ) {
 		for ( k=0; k<=1; k++ ) {
@@ -835,17 +850,17 @@ void gameTableImpl::applySettings(settingsDialogImpl* mySettingsDialog)
 			int tempCardsIntArray[2];
 
 			humanPlayer->getMyHoleCards(tempCardsIntArray);
-			if(myConfig->readConfigInt("AntiPeekMode")) {
+			if(myConfig->readConfigInt(myAntiPeekModeKey)) {
 				holeCardsArray[0][0]->setPixmap(flipside, true);
-				tempCardsPixmapArray[0] = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[0], 10)+".png"));
+				tempCardsPixmapArray[0] = getCardPixmap(tempCardsIntArray[0]);
 				holeCardsArray[0][0]->setHiddenFrontPixmap(tempCardsPixmapArray[0]);
 				holeCardsArray[0][1]->setPixmap(flipside, true);
-				tempCardsPixmapArray[1]= QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[1], 10)+".png"));
+				tempCardsPixmapArray[1]= getCardPixmap(tempCardsIntArray[1]);
 				holeCardsArray[0][1]->setHiddenFrontPixmap(tempCardsPixmapArray[1]);
 			} else {
-				tempCardsPixmapArray[0]= QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[0], 10)+".png"));
+				tempCardsPixmapArray[0]= getCardPixmap(tempCardsIntArray[0]);
 				holeCardsArray[0][0]->setPixmap(tempCardsPixmapArray[0],false);
-				tempCardsPixmapArray[1]= QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[1], 10)+".png"));
+				tempCardsPixmapArray[1]= getCardPixmap(tempCardsIntArray[1]);
 				holeCardsArray[0][1]->setPixmap(tempCardsPixmapArray[1],false);
 			}
 		}
@@ -959,10 +974,10 @@ void gameTableImpl::refreshSet()
 void gameTableImpl::refreshButton()
 {
 
-	QPixmap dealerButton = QPixmap::fromImage(QImage(myGameTableStyle->getDealerPuck()));
-	QPixmap smallblindButton = QPixmap::fromImage(QImage(myGameTableStyle->getSmallBlindPuck()));
-	QPixmap bigblindButton = QPixmap::fromImage(QImage(myGameTableStyle->getBigBlindPuck()));
-	QPixmap onePix = QPixmap::fromImage(QImage(myAppDataPath +"gfx/gui/misc/1px.png"));
+	QPixmap dealerButton = getCachedPixmap(myGameTableStyle->getDealerPuck());
+	QPixmap smallblindButton = getCachedPixmap(myGameTableStyle->getSmallBlindPuck());
+	QPixmap bigblindButton = getCachedPixmap(myGameTableStyle->getBigBlindPuck());
+	QPixmap onePix = getCachedPixmap(myAppDataPath +"gfx/gui/misc/1px.png");
 
 	boost::shared_ptr<Game> currentGame = myStartWindow->getSession()->getCurrentGame();
 
@@ -978,14 +993,14 @@ void gameTableImpl::refreshButton()
 					buttonLabelArray[(*it_c)->getMyID()]->setPixmap(dealerButton);
 					break;
 				case 2 : {
-					if(myConfig->readConfigInt("ShowBlindButtons"))
+					if(myConfig->readConfigInt(myShowBlindButtonsKey))
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(smallblindButton);
 					else
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(onePix);
 				}
 				break;
 				case 3 : {
-					if(myConfig->readConfigInt("ShowBlindButtons"))
+					if(myConfig->readConfigInt(myShowBlindButtonsKey))
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(bigblindButton);
 					else
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(onePix);
@@ -1002,7 +1017,7 @@ void gameTableImpl::refreshButton()
 					buttonLabelArray[(*it_c)->getMyID()]->setPixmap(dealerButton);
 					break;
 				case 3 : {
-					if(myConfig->readConfigInt("ShowBlindButtons"))
+					if(myConfig->readConfigInt(myShowBlindButtonsKey))
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(bigblindButton);
 					else
 						buttonLabelArray[(*it_c)->getMyID()]->setPixmap(onePix);
@@ -1067,12 +1082,68 @@ void gameTableImpl::refreshPlayerName()
 	playerAvatarLabelArray[0]->refreshTooltips();
 }
 
+void gameTableImpl::loadCardDeckPixmaps()
+{
+	//decode all cards once per card deck style
+	if(cardPixmapsDir != myCardDeckStyle->getCurrentDir()) {
+		cardPixmapsDir = myCardDeckStyle->getCurrentDir();
+		for(int i=0; i<52; i++) {
+			cardPixmaps[i] = QPixmap::fromImage(QImage(cardPixmapsDir+QString::number(i, 10)+".png"));
+		}
+	}
+
+	if (myConfig->readConfigInt("FlipsideOwn") && myConfig->readConfigString("FlipsideOwnFile") != "") {
+		flipside = getCachedPixmap(QString::fromUtf8(myConfig->readConfigString("FlipsideOwnFile").c_str()));
+	} else {
+		flipside = getCachedPixmap(cardPixmapsDir+"flipside.png");
+	}
+}
+
+QPixmap gameTableImpl::getCardPixmap(int card) const
+{
+	if(card >= 0 && card < 52) {
+		return cardPixmaps[card];
+	}
+	return QPixmap();
+}
+
+QPixmap gameTableImpl::getCachedPixmap(const QString &fileName)
+{
+	QPixmap pixmap;
+	if(!QPixmapCache::find(fileName, &pixmap)) {
+		pixmap = QPixmap::fromImage(QImage(fileName));
+		QPixmapCache::insert(fileName, pixmap);
+	}
+	return pixmap;
+}
+
+QPixmap gameTableImpl::getAvatarPixmap(const QString &fileName)
+{
+	//avatar files are named by their MD5 sum, so the file name is a stable cache key.
+	//they are not kept in QPixmapCache, which rejects images larger than its limit.
+	QPixmap pixmap;
+	if(!fileName.isEmpty()) {
+		QHash<QString, QPixmap>::const_iterator pos = avatarPixmaps.constFind(fileName);
+		if(pos != avatarPixmaps.constEnd()) {
+			pixmap = pos.value();
+		} else if(!pendingAvatarFiles.contains(fileName) && !failedAvatarFiles.contains(fileName) && QFile::exists(fileName)) {
+			//decode in the background, refreshPlayerAvatar() is called when done
+			pendingAvatarFiles.insert(fileName);
+			avatarLoaderPool.start(new AvatarImageLoader(this, fileName));
+		}
+	}
+	if(pixmap.isNull()) {
+		pixmap = getCachedPixmap(myGameTableStyle->getDefaultAvatar());
+	}
+	return pixmap;
+}
+
 void gameTableImpl::refreshPlayerAvatar()
 {
 
 	if(myStartWindow->getSession()->getCurrentGame()) {
 
-		QPixmap onePix = QPixmap::fromImage(QImage(myAppDataPath +"gfx/gui/misc/1px.png"));
+		QPixmap onePix = getCachedPixmap(myAppDataPath +"gfx/gui/misc/1px.png");
 
 		boost::shared_ptr<Game> currentGame = myStartWindow->getSession()->getCurrentGame();
 		int seatPlace;
@@ -1088,13 +1159,7 @@ void gameTableImpl::refreshPlayerAvatar()
 			countryString = QString(":/cflags/cflags/%1.png").arg(countryString);
 
 			//get AvatarPic
-			QFile myAvatarFile(QString::fromUtf8((*it_c)->getMyAvatar().c_str()));
-			QPixmap avatarPic;
-			if((*it_c)->getMyAvatar() == "" || !myAvatarFile.exists()) {
-				avatarPic = QPixmap::fromImage(QImage(myGameTableStyle->getDefaultAvatar()));
-			} else {
-				avatarPic = QPixmap::fromImage(QImage(QString::fromUtf8((*it_c)->getMyAvatar().c_str())));
-			}
+			QPixmap avatarPic(getAvatarPixmap(QString::fromUtf8((*it_c)->getMyAvatar().c_str())));
 
 			//check SeatStates and refresh
 			switch(getCurrentSeatState((*it_c))) {
@@ -1125,6 +1190,18 @@ void gameTableImpl::refreshPlayerAvatar()
 	}
 }
 
+void gameTableImpl::avatarImageLoaded(QString fileName, QImage image)
+{
+	pendingAvatarFiles.remove(fileName);
+	if(image.isNull()) {
+		//do not try to decode a broken file again
+		failedAvatarFiles.insert(fileName);
+		return;
+	}
+	avatarPixmaps.insert(fileName, QPixmap::fromImage(image));
+	refreshPlayerAvatar();
+}
+
 void gameTableImpl::setPlayerAvatar(int myID, QString myAvatar)
 {
 
@@ -1135,10 +1212,10 @@ void gameTableImpl::setPlayerAvatar(int myID, QString myAvatar)
 
 			QFile myAvatarFile(myAvatar);
 			if(myAvatarFile.exists()) {
-				playerAvatarLabelArray[tmpPlayer->getMyID()]->setPixmap(myAvatar);
+				playerAvatarLabelArray[tmpPlayer->getMyID()]->setPixmap(getAvatarPixmap(myAvatar));
 				tmpPlayer->setMyAvatar(myAvatar.toUtf8().constData());
 			} else {
-				playerAvatarLabelArray[tmpPlayer->getMyID()]->setPixmap(QPixmap::fromImage(QImage(myGameTableStyle->getDefaultAvatar())));
+				playerAvatarLabelArray[tmpPlayer->getMyID()]->setPixmap(getCachedPixmap(myGameTableStyle->getDefaultAvatar()));
 				tmpPlayer->setMyAvatar("");
 			}
 		}
@@ -1148,7 +1225,7 @@ void gameTableImpl::setPlayerAvatar(int myID, QString myAvatar)
 void gameTableImpl::refreshAction(int playerID, int playerAction)
 {
 
-	QPixmap onePix = QPixmap::fromImage(QImage(myAppDataPath +"gfx/gui/misc/1px.png"));
+	QPixmap onePix = getCachedPixmap(myAppDataPath +"gfx/gui/misc/1px.png");
 	QPixmap action;
 
 	QStringList actionArray;
@@ -1167,7 +1244,7 @@ void gameTableImpl::refreshAction(int playerID, int playerAction)
 				actionLabelArray[(*it_c)->getMyID()]->setPixmap(onePix);
 			} else {
 				//paint action pixmap
-				actionLabelArray[(*it_c)->getMyID()]->setPixmap(QPixmap::fromImage(QImage(myGameTableStyle->getActionPic((*it_c)->getMyAction()))));
+				actionLabelArray[(*it_c)->getMyID()]->setPixmap(getCachedPixmap(myGameTableStyle->getActionPic((*it_c)->getMyAction())));
 			}
 
 			if ((*it_c)->getMyAction()==1) {
@@ -1185,10 +1262,10 @@ void gameTableImpl::refreshAction(int playerID, int playerAction)
 		} else {
 
 			// 		paint action pixmap and raise
-			actionLabelArray[playerID]->setPixmap(QPixmap::fromImage(QImage(myGameTableStyle->getActionPic(playerAction))));
+			actionLabelArray[playerID]->setPixmap(getCachedPixmap(myGameTableStyle->getActionPic(playerAction)));
 
 			//play sounds if exist
-			if(myConfig->readConfigInt("PlayGameActions"))
+			if(myConfig->readConfigInt(myPlayGameActionsKey))
 				mySoundEventHandler->playSound(actionArray[playerAction].toStdString(), playerID);
 		}
 
@@ -1425,7 +1502,7 @@ void gameTableImpl::dealHoleCards()
 		}
 	}
 
-	QPixmap onePix = QPixmap::fromImage(QImage(myAppDataPath +"gfx/gui/misc/1px.png"));
+	QPixmap onePix = getCachedPixmap(myAppDataPath +"gfx/gui/misc/1px.png");
 
 	//TempArrays
 	QPixmap tempCardsPixmapArray[2];
@@ -1442,8 +1519,8 @@ void gameTableImpl::dealHoleCards()
 		for(j=0; j<2; j++) {
 			if((*it_c)->getMyActiveStatus()) {
 				if (( (*it_c)->getMyID() == 0) || (currentGame->getCurrentHand()->getLog() && currentGame->getCurrentHand()->getLog()->getDebugMode()) ) {
-					tempCardsPixmapArray[j].load(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[j], 10)+".png");
-					if(myConfig->readConfigInt("AntiPeekMode")) {
+					tempCardsPixmapArray[j] = getCardPixmap(tempCardsIntArray[j]);
+					if(myConfig->readConfigInt(myAntiPeekModeKey)) {
 						holeCardsArray[(*it_c)->getMyID()][j]->setPixmap(flipside, true);
 						holeCardsArray[(*it_c)->getMyID()][j]->setFront(flipside);
 						holeCardsArray[(*it_c)->getMyID()][j]->setHiddenFrontPixmap(tempCardsPixmapArray[j]);
@@ -1533,10 +1610,10 @@ void gameTableImpl::dealFlopCards4()
 	int boardCards[5];
 
 	myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getBoard()->getMyCards(boardCards);
-	QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[0], 10)+".png"));
+	QPixmap card = getCardPixmap(boardCards[0]);
 
 	//Config? mit oder ohne Eye-Candy?
-	if(myConfig->readConfigInt("ShowFlipCardsAnimation")) {
+	if(myConfig->readConfigInt(myShowFlipCardsAnimationKey)) {
 		//with Eye-Candy
 		boardCardsArray[0]->startFlipCards(guiGameSpeed, card, flipside);
 	} else {
@@ -1552,10 +1629,10 @@ void gameTableImpl::dealFlopCards5()
 
 	int boardCards[5];
 	myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getBoard()->getMyCards(boardCards);
-	QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[1], 10)+".png"));
+	QPixmap card = getCardPixmap(boardCards[1]);
 
 	//Config? mit oder ohne Eye-Candy?
-	if(myConfig->readConfigInt("ShowFlipCardsAnimation")) {
+	if(myConfig->readConfigInt(myShowFlipCardsAnimationKey)) {
 		//with Eye-Candy
 		boardCardsArray[1]->startFlipCards(guiGameSpeed, card, flipside);
 	} else {
@@ -1571,10 +1648,10 @@ void gameTableImpl::dealFlopCards6()
 
 	int boardCards[5];
 	myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getBoard()->getMyCards(boardCards);
-	QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[2], 10)+".png"));
+	QPixmap card = getCardPixmap(boardCards[2]);
 
 	//Config? mit oder ohne Eye-Candy?
-	if(myConfig->readConfigInt("ShowFlipCardsAnimation")) {
+	if(myConfig->readConfigInt(myShowFlipCardsAnimationKey)) {
 		//with Eye-Candy
 		boardCardsArray[2]->startFlipCards(guiGameSpeed, card, flipside);
 	} else {
@@ -1615,10 +1692,10 @@ void gameTableImpl::dealTurnCards2()
 
 	int boardCards[5];
 	myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getBoard()->getMyCards(boardCards);
-	QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[3], 10)+".png"));
+	QPixmap card = getCardPixmap(boardCards[3]);
 
 	//Config? mit oder ohne Eye-Candy?
-	if(myConfig->readConfigInt("ShowFlipCardsAnimation")) {
+	if(myConfig->readConfigInt(myShowFlipCardsAnimationKey)) {
 		//with Eye-Candy
 		boardCardsArray[3]->startFlipCards(guiGameSpeed, card, flipside);
 	} else {
@@ -1660,10 +1737,10 @@ void gameTableImpl::dealRiverCards2()
 
 	int boardCards[5];
 	myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getBoard()->getMyCards(boardCards);
-	QPixmap card = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(boardCards[4], 10)+".png"));
+	QPixmap card = getCardPixmap(boardCards[4]);
 
 	//Config? mit oder ohne Eye-Candy?
-	if(myConfig->readConfigInt("ShowFlipCardsAnimation")) {
+	if(myConfig->readConfigInt(myShowFlipCardsAnimationKey)) {
 		//with Eye-Candy
 		boardCardsArray[4]->startFlipCards(guiGameSpeed, card, flipside);
 	} else {
@@ -1791,7 +1868,7 @@ void gameTableImpl::provideMyActions(int mode)
 				resetMyButtonsCheckStateMemory();
 			}
 			//disable button to prevent unwanted clicks (e.g. call allin)
-			if(myConfig->readConfigInt("AccidentallyCallBlocker")) {
+			if(myConfig->readConfigInt(myAccidentallyCallBlockerKey)) {
 				pushButton_CallCheck->setEatMyEvents(true);
 				enableCallCheckPushButtonTimer->start(1000);
 			}
@@ -1845,12 +1922,12 @@ void gameTableImpl::provideMyActions(int mode)
 		}
 
 #ifdef GUI_800x480
-		if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && !tabs.lineEdit_ChatInput->hasFocus() && myConfig->readConfigInt("EnableBetInputFocusSwitch")) {
+		if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && !tabs.lineEdit_ChatInput->hasFocus() && myConfig->readConfigInt(myEnableBetInputFocusSwitchKey)) {
 			spinBox_betValue->setFocus();
 			spinBox_betValue->selectAll();
 		}
 #else
-		if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && !lineEdit_ChatInput->hasFocus() && myConfig->readConfigInt("EnableBetInputFocusSwitch")) {
+		if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && !lineEdit_ChatInput->hasFocus() && myConfig->readConfigInt(myEnableBetInputFocusSwitchKey)) {
 			spinBox_betValue->setFocus();
 			spinBox_betValue->selectAll();
 		}
@@ -1873,12 +1950,12 @@ void gameTableImpl::meInAction()
 	spinBox_betValue->setEnabled(true);
 
 #ifdef GUI_800x480
-	if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && tabs.lineEdit_ChatInput->text() == "" && myConfig->readConfigInt("EnableBetInputFocusSwitch")) {
+	if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && tabs.lineEdit_ChatInput->text() == "" && myConfig->readConfigInt(myEnableBetInputFocusSwitchKey)) {
 		spinBox_betValue->setFocus();
 		spinBox_betValue->selectAll();
 	}
 #else
-	if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && lineEdit_ChatInput->text() == "" && myConfig->readConfigInt("EnableBetInputFocusSwitch")) {
+	if((myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_INTERNET || myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_NETWORK) && lineEdit_ChatInput->text() == "" && myConfig->readConfigInt(myEnableBetInputFocusSwitchKey)) {
 		spinBox_betValue->setFocus();
 		spinBox_betValue->selectAll();
 	}
@@ -2585,10 +2662,10 @@ void gameTableImpl::postRiverRunAnimation3()
 		if((*it_c)->getMyAction() != PLAYER_ACTION_FOLD && (*it_c)->getMyCardsValueInt() == currentHand->getCurrentBeRo()->getHighestCardsValue() ) {
 
 			//Show "Winner" label
-			actionLabelArray[(*it_c)->getMyID()]->setPixmap(QPixmap::fromImage(QImage(myGameTableStyle->getActionPic(7))));
+			actionLabelArray[(*it_c)->getMyID()]->setPixmap(getCachedPixmap(myGameTableStyle->getActionPic(7)));
 
 			//show winnercards if more than one player is active TODO
-			if ( nonfoldPlayerCounter != 1 && myConfig->readConfigInt("ShowFadeOutCardsAnimation")) {
+			if ( nonfoldPlayerCounter != 1 && myConfig->readConfigInt(myShowFadeOutCardsAnimationKey)) {
 
 				int j;
 				int bestHandPos[5];
@@ -2677,7 +2754,7 @@ void gameTableImpl::postRiverRunAnimation3()
 			// 			}
 		} else {
 
-			if( activePlayerList->size() != 1 && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && myConfig->readConfigInt("ShowFadeOutCardsAnimation")
+			if( activePlayerList->size() != 1 && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && myConfig->readConfigInt(myShowFadeOutCardsAnimationKey)
 			  ) {
 
 				//aufgedeckte Gegner auch ausblenden
@@ -2830,7 +2907,7 @@ void gameTableImpl::showHoleCards(unsigned playerId, bool allIn)
 	//TempArrays
 	QPixmap tempCardsPixmapArray[2];
 	int tempCardsIntArray[2];
-	int showFlipcardAnimation = myConfig->readConfigInt("ShowFlipCardsAnimation");
+	int showFlipcardAnimation = myConfig->readConfigInt(myShowFlipCardsAnimationKey);
 	int j;
 	PlayerListConstIterator it_c;
 	PlayerList activePlayerList = currentHand->getActivePlayerList();
@@ -2842,9 +2919,9 @@ void gameTableImpl::showHoleCards(unsigned playerId, bool allIn)
 			for(j=0; j<2; j++) {
 
 				if(showFlipcardAnimation) { // with Eye-Candy
-					holeCardsArray[(*it_c)->getMyID()][j]->startFlipCards(guiGameSpeed, QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[j], 10)+".png")), flipside);
+					holeCardsArray[(*it_c)->getMyID()][j]->startFlipCards(guiGameSpeed, getCardPixmap(tempCardsIntArray[j]), flipside);
 				} else { //without Eye-Candy
-					tempCardsPixmapArray[j] = QPixmap::fromImage(QImage(myCardDeckStyle->getCurrentDir()+QString::number(tempCardsIntArray[j], 10)+".png"));
+					tempCardsPixmapArray[j] = getCardPixmap(tempCardsIntArray[j]);
 					holeCardsArray[(*it_c)->getMyID()][j]->setPixmap(tempCardsPixmapArray[j], false);
 				}
 			}
@@ -2930,7 +3007,7 @@ void gameTableImpl::nextRoundCleanGui()
 	int i,j;
 
 	// GUI bereinigen - Bilder löschen, Animationen unterbrechen
-	QPixmap onePix = QPixmap::fromImage(QImage(myAppDataPath +"gfx/gui/misc/1px.png"));
+	QPixmap onePix = getCachedPixmap(myAppDataPath +"gfx/gui/misc/1px.png");
 	for (i=0; i<5; i++ ) {
 		boardCardsArray[i]->setPixmap(onePix, false);
 		boardCardsArray[i]->setFadeOutAction(false);
@@ -2957,7 +3034,7 @@ void gameTableImpl::nextRoundCleanGui()
 	flipHolecardsAllInAlreadyDone = false;
 
 	//Wenn Pause zwischen den Hands in der Konfiguration steht den Stop Button drücken!
-	if (myConfig->readConfigInt("PauseBetweenHands") /*&& blinkingStartButtonAnimationTimer->isActive() == false*/ && myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_LOCAL) {
+	if (myConfig->readConfigInt(myPauseBetweenHandsKey) /*&& blinkingStartButtonAnimationTimer->isActive() == false*/ && myStartWindow->getSession()->getGameType() == Session::GAME_TYPE_LOCAL) {
 #ifdef GUI_800x480
 		tabs.pushButton_break->click();
 #else
@@ -3125,14 +3202,14 @@ void gameTableImpl::keyPressEvent ( QKeyEvent * event )
 		}
 	}
 	if (event->key() == Qt::Key_F1) {
-		if (myConfig->readConfigInt("AlternateFKeysUserActionMode") == 0) {
+		if (myConfig->readConfigInt(myAlternateFKeysUserActionModeKey) == 0) {
 			pushButton_Fold->click();
 		} else {
 			pushButton_AllIn->click();
 		}
 	}
 	if (event->key() == Qt::Key_F2) {
-		if (myConfig->readConfigInt("AlternateFKeysUserActionMode") == 0) {
+		if (myConfig->readConfigInt(myAlternateFKeysUserActionModeKey) == 0) {
 			pushButton_CallCheck->click();
 		} else {
 			pushButton_BetRaise->click();
@@ -3140,14 +3217,14 @@ void gameTableImpl::keyPressEvent ( QKeyEvent * event )
 
 	}
 	if (event->key() == Qt::Key_F3 ) {
-		if (myConfig->readConfigInt("AlternateFKeysUserActionMode") == 0) {
+		if (myConfig->readConfigInt(myAlternateFKeysUserActionModeKey) == 0) {
 			pushButton_BetRaise->click();
 		} else {
 			pushButton_CallCheck->click();
 		}
 	}
 	if (event->key() == Qt::Key_F4) {
-		if (myConfig->readConfigInt("AlternateFKeysUserActionMode") == 0) {
+		if (myConfig->readConfigInt(myAlternateFKeysUserActionModeKey) == 0) {
 			pushButton_AllIn->click();
 		} else {
 			pushButton_Fold->click();
@@ -3630,7 +3707,7 @@ void gameTableImpl::mouseOverFlipCards(bool front)
 {
 
 	if(myStartWindow->getSession()->getCurrentGame()) {
-		if(myConfig->readConfigInt("AntiPeekMode") && myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getSeatsList()->front()->getMyActiveStatus()/* && myStartWindow->getSession()->getCurrentGame()->getSeatsList()->front()->getMyAction() != PLAYER_ACTION_FOLD*/) {
+		if(myConfig->readConfigInt(myAntiPeekModeKey) && myStartWindow->getSession()->getCurrentGame()->getCurrentHand()->getSeatsList()->front()->getMyActiveStatus()/* && myStartWindow->getSession()->getCurrentGame()->getSeatsList()->front()->getMyAction() != PLAYER_ACTION_FOLD*/) {
 			holeCardsArray[0][0]->signalFastFlipCards(front);
 			holeCardsArray[0][1]->signalFastFlipCards(front);
 		}
@@ -4001,7 +4078,7 @@ void gameTableImpl::refreshVotesMonitor(int currentVotes, int numVotesNeededToKi
 
 void gameTableImpl::refreshCardsChance(GameState bero)
 {
-	if(myConfig->readConfigInt("ShowCardsChanceMonitor")) {
+	if(myConfig->readConfigInt(myShowCardsChanceMonitorKey)) {
 
 		boost::shared_ptr<PlayerInterface> humanPlayer = myStartWindow->getSession()->getCurrentGame()->getSeatsList()->front();
 		if(humanPlayer->getMyActiveStatus()) {
@@ -4043,7 +4120,7 @@ void gameTableImpl::refreshActionButtonFKeyIndicator(bool clear)
 		pushButton_Fold->setFKeyText("");
 	} else {
 #ifndef GUI_800x480
-		if(myConfig->readConfigInt("AlternateFKeysUserActionMode") == 0 ) {
+		if(myConfig->readConfigInt(myAlternateFKeysUserActionModeKey) == 0 ) {
 			if(!pushButton_AllIn->text().isEmpty()) pushButton_AllIn->setFKeyText("F4");
 			if(!pushButton_BetRaise->text().isEmpty()) pushButton_BetRaise->setFKeyText("F3");
 			if(!pushButton_CallCheck->text().isEmpty()) pushButton_CallCheck->setFKeyText("F2");
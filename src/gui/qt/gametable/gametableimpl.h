@@ -43,6 +43,7 @@
 
 #ifndef Q_MOC_RUN
 #include <boost/shared_ptr.hpp>
+#include "configfile.h"
 #endif
 
 #include <QtGui>
@@ -195,6 +196,7 @@ public slots:
 	void refreshPlayerAvatar();
 	void refreshActionButtonFKeyIndicator(bool =0);
 	void setPlayerAvatar(int myID, QString myAvatar);
+	void avatarImageLoaded(QString fileName, QImage image);
 
 	SeatState getCurrentSeatState(boost::shared_ptr<PlayerInterface> );
 
@@ -381,10 +383,26 @@ public slots:
 
 private:
 
+	void loadCardDeckPixmaps();
+	QPixmap getCardPixmap(int card) const;
+	QPixmap getCachedPixmap(const QString &fileName);
+	QPixmap getAvatarPixmap(const QString &fileName);
+
 	boost::shared_ptr<GuiInterface> myServerGuiInterface;
 	guiLog *myGuiLog;
 	ChatTools *myChat;
 	ConfigFile *myConfig;
+	// Settings which are read on every hand or action.
+	ConfigKey myAntiPeekModeKey;
+	ConfigKey myShowBlindButtonsKey;
+	ConfigKey myPlayGameActionsKey;
+	ConfigKey myShowFlipCardsAnimationKey;
+	ConfigKey myAccidentallyCallBlockerKey;
+	ConfigKey myEnableBetInputFocusSwitchKey;
+	ConfigKey myShowFadeOutCardsAnimationKey;
+	ConfigKey myPauseBetweenHandsKey;
+	ConfigKey myAlternateFKeysUserActionModeKey;
+	ConfigKey myShowCardsChanceMonitorKey;
 
 	//Timer
 	QTimer *potDistributeTimer;
@@ -444,6 +462,14 @@ private:
 
 	QLabel *playerTipLabelArray[MAX_NUMBER_OF_PLAYERS];
 	QPixmap flipside;
+	//decoded card images of the current card deck style
+	QPixmap cardPixmaps[52];
+	QString cardPixmapsDir;
+	//decoded avatars by file name, and files which are being decoded or could not be decoded
+	QHash<QString, QPixmap> avatarPixmaps;
+	QSet<QString> pendingAvatarFiles;
+	QSet<QString> failedAvatarFiles;
+	QThreadPool avatarLoaderPool;
 	QLabel *spectatorIcon;
 	QLabel *spectatorNumberLabel;
 
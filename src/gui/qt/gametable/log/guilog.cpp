@@ -37,12 +37,176 @@
 #include <cardsvalue.h>
 #include <game_defs.h>
 #include "gametablestylereader.h"
+#include "log.h"
 
 using namespace std;
 
-guiLog::guiLog(gameTableImpl* w, ConfigFile *c) : myW(w), myConfig(c), myLogDir(0), myHtmlLogFile(0), myHtmlLogFile_old(0), myTxtLogFile(0), tb(0)
+namespace
+{
+
+// Log database connection, closed when leaving scope. The lookup indexes are
+// added to logs written by older versions, which fails silently for
+// read-only files.
+class LogDatabase
+{
+public:
+	LogDatabase(const QString &fileName) : myDb(0) {
+		sqlite3_open(fileName.toStdString().c_str(), &myDb);
+		if(myDb != 0) {
+			sqlite3_exec(myDb, Log::getSqliteLogIndexes().c_str(), 0, 0, 0);
+		}
+	}
+	~LogDatabase() {
+		sqlite3_close(myDb);
+	}
+	sqlite3 *get() const {
+		return myDb;
+	}
+
+private:
+	sqlite3 *myDb;
+};
+
+// Prepared statement of the log export. The result has the layout of
+// sqlite3_get_table(): column names first, then the rows, NULL for NULL.
+class LogQuery
+{
+public:
+	LogQuery(sqlite3 *db, const string &sql) : myDb(db), mySql(sql), myStmt(0), myFailed(false) {
+		if(sqlite3_prepare_v2(myDb, mySql.c_str(), -1, &myStmt, 0) != SQLITE_OK) {
+			sqlite3_finalize(myStmt);
+			myStmt = 0;
+		}
+	}
+	~LogQuery() {
+		sqlite3_finalize(myStmt);
+	}
+
+	const string &getSql() const {
+		return mySql;
+	}
+	const char *getErrorMsg() const {
+		return sqlite3_errmsg(myDb);
+	}
+
+	// Binds the parameters and reads all rows.
+	bool exec(const char **&table, int &nRow, int &nCol, int param1 = 0, int param2 = 0, int param3 = 0) {
+		if(!start(param1, param2, param3)) {
+			return false;
+		}
+		int rows = 0;
+		while(readRow()) {
+			rows++;
+		}
+		return finish(table, nRow, nCol, rows);
+	}
+
+	// Binds the parameters, the rows are then read one by one with next().
+	bool start(int param1 = 0, int param2 = 0, int param3 = 0) {
+		myFailed = true;
+		if(!myStmt) {
+			return false;
+		}
+		sqlite3_reset(myStmt);
+		myValues.clear();
+		myNull.clear();
+		const int params[3] = { param1, param2, param3 };
+		int count = sqlite3_bind_parameter_count(myStmt);
+		for(int i = 0; i < count && i < 3; i++) {
+			sqlite3_bind_int(myStmt, i + 1, params[i]);
+		}
+		myFailed = false;
+		return true;
+	}
+
+	// Provides the next row as single row table, false at the end.
+	bool next(const char **&table, int &nRow, int &nCol) {
+		if(myFailed) {
+			return false;
+		}
+		myValues.clear();
+		myNull.clear();
+		readHeader();
+		return readRow() && finish(table, nRow, nCol, 1);
+	}
+
+	bool failed() const {
+		return myFailed;
+	}
+
+private:
+	void readHeader() {
+		int count = sqlite3_column_count(myStmt);
+		for(int i = 0; i < count; i++) {
+			myValues.push_back(sqlite3_column_name(myStmt, i));
+			myNull.push_back(false);
+		}
+	}
+
+	bool readRow() {
+		if(myValues.empty()) {
+			readHeader();
+		}
+		int rc = sqlite3_step(myStmt);
+		if(rc != SQLITE_ROW) {
+			if(rc != SQLITE_DONE) {
+				myFailed = true;
+			}
+			return false;
+		}
+		int count = sqlite3_column_count(myStmt);
+		for(int i = 0; i < count; i++) {
+			const unsigned char *text = sqlite3_column_text(myStmt, i);
+			myValues.push_back(text ? reinterpret_cast<const char *>(text) : "");
+			myNull.push_back(text == 0);
+		}
+		return true;
+	}
+
+	bool finish(const char **&table, int &nRow, int &nCol, int rows) {
+		myTable.clear();
+		for(size_t i = 0; i < myValues.size(); i++) {
+			myTable.push_back(myNull[i] ? 0 : myValues[i].c_str());
+		}
+		table = myTable.empty() ? 0 : &myTable[0];
+		nRow = rows;
+		nCol = sqlite3_column_count(myStmt);
+		return !myFailed;
+	}
+
+	sqlite3 *myDb;
+	string mySql;
+	sqlite3_stmt *myStmt;
+	bool myFailed;
+	vector<string> myValues;
+	vector<bool> myNull;
+	vector<const char *> myTable;
+};
+
+} // anonymous namespace
+
+// Renders the log preview of a game in the background.
+class ShowLogLoader : public QRunnable
+{
+public:
+	ShowLogLoader(guiLog *log, const QString &fileStringPdb, int uniqueGameID, int generation)
+		: myLog(log), myFileStringPdb(fileStringPdb), myUniqueGameID(uniqueGameID), myGeneration(generation) {}
+
+	virtual void run() {
+		myLog->loadShowLog(myFileStringPdb, myUniqueGameID, myGeneration);
+	}
+
+private:
+	guiLog *myLog;
+	QString myFileStringPdb;
+	int myUniqueGameID;
+	int myGeneration;
+};
+
+guiLog::guiLog(gameTableImpl* w, ConfigFile *c) : myW(w), myConfig(c), myLogDir(0), myHtmlLogFile(0), myHtmlLogFile_old(0), myTxtLogFile(0), tb(0), showLogGeneration(0), showLogRunGeneration(0)
 {
 	newVersion = true;
+	showLogPool.setMaxThreadCount(1);
 
 	myW->setGuiLog(this);
 	myStyle = myW->getMyGameTableStyle();
@@ -62,6 +226,7 @@ guiLog::guiLog(gameTableImpl* w, ConfigFile *c) : myW(w), myConfig(c), myLogDir(
 	connect(this, SIGNAL(signalLogSpectatorLeftMsg(QString, int)), this, SLOT(logSpectatorLeftMsg(QString, int)));
 	connect(this, SIGNAL(signalLogSpectatorJoinedMsg(QString)), this, SLOT(logSpectatorJoinedMsg(QString)));
 	connect(this, SIGNAL(signalLogPlayerWinGame(QString, int)), this, SLOT(logPlayerWinGame(QString, int)));
+	connect(this, SIGNAL(signalShowLogPage(QStringList, int)), this, SLOT(appendShowLogPage(QStringList, int)), Qt::QueuedConnection);
 
 	logFileStreamString = "";
 	lastGameID = 0;
@@ -113,6 +278,11 @@ guiLog::guiLog(gameTableImpl* w, ConfigFile *c) : myW(w), myConfig(c), myLogDir(
 
 guiLog::~guiLog()
 {
+	showLogMutex.lock();
+	showLogGeneration++;
+	showLogMutex.unlock();
+	showLogPool.waitForDone();
+
 	delete myLogDir;
 	delete myHtmlLogFile;
 	delete myHtmlLogFile_old;
@@ -420,7 +590,10 @@ void guiLog::writeLog(string log_string, int modus)
 		writeLogFileStream(log_string,myTxtLogFile);
 		break;
 	case 3:
-		tb->append(log_string.c_str());
+		showLogPage.append(log_string.c_str());
+		if(showLogPage.count() >= SHOW_LOG_PAGE_SIZE) {
+			flushShowLogPage();
+		}
 		break;
 	default:
 		;
@@ -465,8 +638,55 @@ void guiLog::showLog(QString fileStringPdb, QTextBrowser *tb_tmp, int uniqueGame
 {
 	tb = tb_tmp;
 	tb->clear();
-	exportLog(fileStringPdb,3,uniqueGameID);
 
+	// a preview which is still loading is canceled
+	showLogMutex.lock();
+	int generation = ++showLogGeneration;
+	showLogMutex.unlock();
+	showLogPool.start(new ShowLogLoader(this, fileStringPdb, uniqueGameID, generation));
+
+}
+
+void guiLog::loadShowLog(QString fileStringPdb, int uniqueGameID, int generation)
+{
+	showLogRunGeneration = generation;
+	showLogPage.clear();
+	if(!showLogCanceled()) {
+		exportLog(fileStringPdb,3,uniqueGameID);
+	}
+	flushShowLogPage();
+}
+
+bool guiLog::showLogCanceled()
+{
+	QMutexLocker locker(&showLogMutex);
+	return showLogRunGeneration != showLogGeneration;
+}
+
+void guiLog::flushShowLogPage()
+{
+	if(!showLogPage.isEmpty()) {
+		emit signalShowLogPage(showLogPage, showLogRunGeneration);
+		showLogPage.clear();
+	}
+}
+
+void guiLog::appendShowLogPage(QStringList page, int generation)
+{
+	showLogMutex.lock();
+	bool current = (generation == showLogGeneration);
+	showLogMutex.unlock();
+	if(!current || !tb) {
+		return;
+	}
+
+	// keep the reader's position while further pages arrive
+	QScrollBar *scrollBar = tb->verticalScrollBar();
+	int scrollPos = scrollBar->value();
+	for(int i = 0; i < page.count(); i++) {
+		tb->append(page.at(i));
+	}
+	scrollBar->setValue(scrollPos);
 }
 
 int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
@@ -476,18 +696,16 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 	results.result_Game = 0;
 	results.result_Player = 0;
 	results.result_Hand = 0;
-	results.result_Hand_ID = 0;
 	results.result_Action = 0;
 
-	string sql = "";
 	string log_string = "";
 	string round_string = "";
 	string action_string = "";
 	bool data_found = false;
-	int nRow_Session=0, nRow_Game=0, nRow_Player=0, nRow_Hand=0, nRow_Hand_ID=0, nRow_Action=0;
+	int nRow_Session=0, nRow_Game=0, nRow_Player=0, nRow_Hand=0, nRow_Action=0;
 	int nCol_Session=0, nCol_Game=0, nCol_Player=0, nCol_Hand=0, nCol_Action=0;
-	char *errmsg = 0;
-	int game_ctr = 0, hand_ctr = 0, round_ctr = 0, action_ctr = 0;
+	int game_ctr = 0, round_ctr = 0, action_ctr = 0;
+	int handID = 0;
 	int i = 0, j = 0;
 	int gameID = 0;
 	int uniqueGameID = 0;
@@ -498,20 +716,28 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 	}
 
 	// open sqlite log-db
-	sqlite3 *mySqliteLogDb;
-	sqlite3_open(fileStringPdb.toStdString().c_str(), &mySqliteLogDb);
+	LogDatabase logDb(fileStringPdb);
+	sqlite3 *mySqliteLogDb = logDb.get();
 	if( mySqliteLogDb != 0 ) {
 
+		// prepare the statements once for all games and hands
+		LogQuery sessionQuery(mySqliteLogDb, "SELECT * FROM Session");
+		LogQuery gameQuery(mySqliteLogDb, uniqueGameID_req > 0 ? "SELECT * FROM Game WHERE UniqueGameID=?" : "SELECT * FROM Game");
+		LogQuery playerQuery(mySqliteLogDb, "SELECT Player,Seat FROM Player WHERE UniqueGameID=? ORDER BY Seat");
+		LogQuery handQuery(mySqliteLogDb, "SELECT * FROM Hand WHERE UniqueGameID=? ORDER BY HandID");
+		LogQuery dealerAndBlindsQuery(mySqliteLogDb, "SELECT Player,Action,Amount FROM Action WHERE UniqueGameID=? AND HandID=? AND BeRo=? AND (Action='posts small blind' OR Action='posts big blind' OR Action='starts as dealer') ORDER BY ActionID");
+		LogQuery smallBlindQuery(mySqliteLogDb, "SELECT Player,Amount FROM Action WHERE UniqueGameID=? AND HandID=? AND BeRo=0 AND Action='posts small blind' ORDER BY ActionID");
+		LogQuery bigBlindQuery(mySqliteLogDb, "SELECT Player,Amount FROM Action WHERE UniqueGameID=? AND HandID=? AND BeRo=0 AND Action='posts big blind' ORDER BY ActionID");
+		LogQuery dealerQuery(mySqliteLogDb, "SELECT Player,Amount FROM Action WHERE UniqueGameID=? AND HandID=? AND BeRo=0 AND Action='starts as dealer' ORDER BY ActionID");
+		LogQuery roundActionQuery(mySqliteLogDb, "SELECT Player,Action,Amount FROM Action WHERE UniqueGameID=? AND HandID=? AND BeRo=? AND Action<>'starts as dealer' AND Action<>'posts big blind' AND Action<>'posts small blind' ORDER BY ActionID");
+
 		// read session
-		sql = "SELECT * FROM Session";
-		if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Session,&nRow_Session,&nCol_Session,&errmsg) != SQLITE_OK) {
-			cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-			cleanUp(results, mySqliteLogDb);
+		if(!sessionQuery.exec(results.result_Session,nRow_Session,nCol_Session)) {
+			cout << "Error in statement: " << sessionQuery.getSql() << "[" << sessionQuery.getErrorMsg() << "]." << endl;
 			return 1;
 		}
 		if(nRow_Session != 1) {
 			cout << "Number of Sessions implausible!" << endl;
-			cleanUp(results, mySqliteLogDb);
 			return 1;
 		}
 
@@ -527,7 +753,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 		}
 		if(!data_found) {
 			cout << "Missing PokerTH version information!" << endl;
-			cleanUp(results, mySqliteLogDb);
 			return 1;
 		}
 
@@ -543,7 +768,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 		}
 		if(!data_found) {
 			cout << "Missing date information!" << endl;
-			cleanUp(results, mySqliteLogDb);
 			return 1;
 		}
 
@@ -559,7 +783,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 		}
 		if(!data_found) {
 			cout << "Missing time information!" << endl;
-			cleanUp(results, mySqliteLogDb);
 			return 1;
 		}
 
@@ -581,14 +804,8 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 		log_string = "";
 
 		// read game
-		if(uniqueGameID_req > 0) {
-			sql = "SELECT * FROM Game WHERE UniqueGameID=" + boost::lexical_cast<std::string>(uniqueGameID_req);
-		} else {
-			sql = "SELECT * FROM Game";
-		}
-		if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Game,&nRow_Game,&nCol_Game,&errmsg) != SQLITE_OK) {
-			cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-			cleanUp(results, mySqliteLogDb);
+		if(!gameQuery.exec(results.result_Game,nRow_Game,nCol_Game,uniqueGameID_req)) {
+			cout << "Error in statement: " << gameQuery.getSql() << "[" << gameQuery.getErrorMsg() << "]." << endl;
 			return 1;
 		}
 
@@ -605,7 +822,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 			}
 
 			if(!data_found) {
-				cleanUp(results, mySqliteLogDb);
 				return 1;
 			}
 
@@ -619,40 +835,45 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 			}
 
 			if(!data_found) {
-				cleanUp(results, mySqliteLogDb);
 				return 1;
 			}
 
 			// read player
-			sql  = "SELECT Player,Seat FROM Player WHERE UniqueGameID=";
-			sql += boost::lexical_cast<std::string>(uniqueGameID);
-			sql += " ORDER BY Seat;";
-			if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Player,&nRow_Player,&nCol_Player,&errmsg) != SQLITE_OK) {
-				cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-				cleanUp(results, mySqliteLogDb);
+			if(!playerQuery.exec(results.result_Player,nRow_Player,nCol_Player,uniqueGameID)) {
+				cout << "Error in statement: " << playerQuery.getSql() << "[" << playerQuery.getErrorMsg() << "]." << endl;
 				return 1;
 			}
 			for(i=1; i<=nRow_Player; i++) {
 				player[i-1] = boost::lexical_cast<std::string>(results.result_Player[nCol_Player*i]);
 			}
 
-			// read all hand id
-			sql = "SELECT HandID FROM Hand WHERE UniqueGameID=";
-			sql+= boost::lexical_cast<std::string>(uniqueGameID);
-			if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Hand_ID,&nRow_Hand_ID,&nCol_Hand,&errmsg) != SQLITE_OK) {
-				cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-				cleanUp(results, mySqliteLogDb);
-				return 1;
-			}
+			// run through all hands, reading them one by one
+			handQuery.start(uniqueGameID);
+			while(handQuery.next(results.result_Hand,nRow_Hand,nCol_Hand)) {
+
+				// stop rendering a preview which is no longer shown
+				if(modus == 3 && showLogCanceled()) {
+					return 1;
+				}
 
-			// run through all hands
-			for(hand_ctr=1; hand_ctr<=nRow_Hand_ID; hand_ctr++) {
+				// hand id
+				data_found = false;
+				for(i=0; i<nCol_Hand; i++) {
+					if(boost::lexical_cast<std::string>(results.result_Hand[i]) == "HandID") {
+						handID = boost::lexical_cast<int>(results.result_Hand[i+nCol_Hand]);
+						data_found = true;
+					}
+				}
+				if(!data_found) {
+					cout << "Missing hand id in uniqueGame " << uniqueGameID << "!" << endl;
+					return 1;
+				}
 
 				// log game and hand id
 				log_string += "Game: ";
 				log_string += boost::lexical_cast<std::string>(gameID);
 				log_string += " | Hand: ";
-				log_string += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
+				log_string += boost::lexical_cast<std::string>(handID);
 
 				switch(modus) {
 				case 1:
@@ -672,17 +893,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					;
 				}
 
-				// read current hand
-				sql = "SELECT * FROM Hand WHERE UniqueGameID=";
-				sql+= boost::lexical_cast<std::string>(uniqueGameID);
-				sql+= " AND HandID=";
-				sql+= boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-				if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Hand,&nRow_Hand,&nCol_Hand,&errmsg) != SQLITE_OK) {
-					cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-					cleanUp(results, mySqliteLogDb);
-					return 1;
-				}
-
 
 				// log blind level
 				log_string += "BLIND LEVEL: $";
@@ -697,7 +907,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 				}
 				if(!data_found) {
 					cout << "Missing small blind information!" << endl;
-					cleanUp(results, mySqliteLogDb);
 					return 1;
 				}
 
@@ -713,7 +922,6 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 				}
 				if(!data_found) {
 					cout << "Missing big blind information!" << endl;
-					cleanUp(results, mySqliteLogDb);
 					return 1;
 				}
 
@@ -774,8 +982,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 						}
 					}
 					if(!data_found) {
-						cout << "Missing seat information in uniqueGame " << uniqueGameID << " and hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-						cleanUp(results, mySqliteLogDb);
+						cout << "Missing seat information in uniqueGame " << uniqueGameID << " and hand " << handID << "!" << endl;
 						return 1;
 					}
 				}
@@ -785,22 +992,12 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					if(modus == 1) log_string += "<br />";
 
 					// read dealer and blinds
-					sql = "SELECT Player,Action,Amount FROM Action WHERE UniqueGameID=";
-					sql += boost::lexical_cast<std::string>(uniqueGameID);
-					sql += " AND HandID=";
-					sql += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-					sql += " AND BeRo=";
-					sql += boost::lexical_cast<std::string>(GAME_STATE_PREFLOP);
-					sql += " AND (Action='posts small blind' OR Action='posts big blind' OR Action='starts as dealer')";
-
-					if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Action,&nRow_Action,&nCol_Action,&errmsg) != SQLITE_OK) {
-						cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-						cleanUp(results, mySqliteLogDb);
+					if(!dealerAndBlindsQuery.exec(results.result_Action,nRow_Action,nCol_Action,uniqueGameID,handID,GAME_STATE_PREFLOP)) {
+						cout << "Error in statement: " << dealerAndBlindsQuery.getSql() << "[" << dealerAndBlindsQuery.getErrorMsg() << "]." << endl;
 						return 1;
 					}
 					if(nRow_Action<1) {
-						cout << "Missing information about dealer and blinds in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-						cleanUp(results, mySqliteLogDb);
+						cout << "Missing information about dealer and blinds in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 						return 1;
 					}
 					// log dealer and blind setting
@@ -834,20 +1031,12 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					log_string += "BLINDS: ";
 
 					// read small blind
-					sql = "SELECT Player,Amount FROM Action WHERE UniqueGameID=";
-					sql += boost::lexical_cast<std::string>(uniqueGameID);
-					sql += " AND HandID=";
-					sql += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-					sql += " AND BeRo=0 AND Action='posts small blind'";
-
-					if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Action,&nRow_Action,&nCol_Action,&errmsg) != SQLITE_OK) {
-						cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-						cleanUp(results, mySqliteLogDb);
+					if(!smallBlindQuery.exec(results.result_Action,nRow_Action,nCol_Action,uniqueGameID,handID)) {
+						cout << "Error in statement: " << smallBlindQuery.getSql() << "[" << smallBlindQuery.getErrorMsg() << "]." << endl;
 						return 1;
 					}
 					if(nRow_Action<1 || nRow_Action>1) {
-						cout << "Wrong information about small blind in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-						cleanUp(results, mySqliteLogDb);
+						cout << "Wrong information about small blind in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 						return 1;
 					}
 
@@ -858,20 +1047,12 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					log_string += "), ";
 
 					// read big blind
-					sql = "SELECT Player,Amount FROM Action WHERE UniqueGameID=";
-					sql += boost::lexical_cast<std::string>(uniqueGameID);
-					sql += " AND HandID=";
-					sql += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-					sql += " AND BeRo=0 AND Action='posts big blind'";
-
-					if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Action,&nRow_Action,&nCol_Action,&errmsg) != SQLITE_OK) {
-						cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-						cleanUp(results, mySqliteLogDb);
+					if(!bigBlindQuery.exec(results.result_Action,nRow_Action,nCol_Action,uniqueGameID,handID)) {
+						cout << "Error in statement: " << bigBlindQuery.getSql() << "[" << bigBlindQuery.getErrorMsg() << "]." << endl;
 						return 1;
 					}
 					if(nRow_Action<1 || nRow_Action>1) {
-						cout << "Wrong information about big blind in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-						cleanUp(results, mySqliteLogDb);
+						cout << "Wrong information about big blind in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 						return 1;
 					}
 
@@ -882,20 +1063,12 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					log_string += ")";
 
 					// read dealer
-					sql = "SELECT Player,Amount FROM Action WHERE UniqueGameID=";
-					sql += boost::lexical_cast<std::string>(uniqueGameID);
-					sql += " AND HandID=";
-					sql += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-					sql += " AND BeRo=0 AND Action='starts as dealer'";
-
-					if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Action,&nRow_Action,&nCol_Action,&errmsg) != SQLITE_OK) {
-						cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-						cleanUp(results, mySqliteLogDb);
+					if(!dealerQuery.exec(results.result_Action,nRow_Action,nCol_Action,uniqueGameID,handID)) {
+						cout << "Error in statement: " << dealerQuery.getSql() << "[" << dealerQuery.getErrorMsg() << "]." << endl;
 						return 1;
 					}
 					if(nRow_Action>1) {
-						cout << "Implausible information about dealer in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-						cleanUp(results, mySqliteLogDb);
+						cout << "Implausible information about dealer in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 						return 1;
 					}
 
@@ -977,8 +1150,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 											if(modus == 1 || modus == 3) round_string += "<b>";
 											string_tmp = convertCardIntToString(boost::lexical_cast<int>(results.result_Hand[j+nCol_Hand]),modus);
 											if(string_tmp == "") {
-												cout << "Implausible board card in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-												cleanUp(results, mySqliteLogDb);
+												cout << "Implausible board card in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 												return 1;
 											}
 											round_string += boost::lexical_cast<std::string>(string_tmp.at(0));
@@ -1001,17 +1173,8 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 					}
 
 					// read round action
-					sql = "SELECT Player,Action,Amount FROM Action WHERE UniqueGameID=";
-					sql += boost::lexical_cast<std::string>(uniqueGameID);
-					sql += " AND HandID=";
-					sql += boost::lexical_cast<std::string>(results.result_Hand_ID[hand_ctr]);
-					sql += " AND BeRo=";
-					sql += boost::lexical_cast<std::string>(round_ctr);
-					sql += " AND Action<>'starts as dealer' AND Action<>'posts big blind' AND Action<>'posts small blind'";
-
-					if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Action,&nRow_Action,&nCol_Action,&errmsg) != SQLITE_OK) {
-						cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
-						cleanUp(results, mySqliteLogDb);
+					if(!roundActionQuery.exec(results.result_Action,nRow_Action,nCol_Action,uniqueGameID,handID,round_ctr)) {
+						cout << "Error in statement: " << roundActionQuery.getSql() << "[" << roundActionQuery.getErrorMsg() << "]." << endl;
 						return 1;
 					}
 
@@ -1134,8 +1297,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 								if(boost::lexical_cast<std::string>(results.result_Hand[i]) == cmpString) {
 									string_tmp = convertCardIntToString(boost::lexical_cast<int>(results.result_Hand[i+nCol_Hand]),modus);
 									if(string_tmp == "") {
-										cout << "Hole card information implausible in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-										cleanUp(results, mySqliteLogDb);
+										cout << "Hole card information implausible in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 										return 1;
 									}
 									log_string += boost::lexical_cast<std::string>(string_tmp.at(0));
@@ -1147,8 +1309,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 								}
 							}
 							if(!data_found) {
-								cout << "Missing hole card information in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-								cleanUp(results, mySqliteLogDb);
+								cout << "Missing hole card information in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 								return 1;
 							}
 
@@ -1161,8 +1322,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 								if(boost::lexical_cast<std::string>(results.result_Hand[i]) == cmpString) {
 									string_tmp = convertCardIntToString(boost::lexical_cast<int>(results.result_Hand[i+nCol_Hand]),modus);
 									if(string_tmp == "") {
-										cout << "Hole card information implausible in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-										cleanUp(results, mySqliteLogDb);
+										cout << "Hole card information implausible in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 										return 1;
 									}
 									log_string += boost::lexical_cast<std::string>(string_tmp.at(0));
@@ -1173,8 +1333,7 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 								}
 							}
 							if(!data_found) {
-								cout << "Missing hole card information in uniqueGame " << uniqueGameID << " hand " << results.result_Hand_ID[hand_ctr] << "!" << endl;
-								cleanUp(results, mySqliteLogDb);
+								cout << "Missing hole card information in uniqueGame " << uniqueGameID << " hand " << handID << "!" << endl;
 								return 1;
 							}
 
@@ -1209,13 +1368,15 @@ int guiLog::exportLog(QString fileStringPdb,int modus,int uniqueGameID_req)
 
 
 			}
+			if(handQuery.failed()) {
+				cout << "Error in statement: " << handQuery.getSql() << "[" << handQuery.getErrorMsg() << "]." << endl;
+				return 1;
+			}
 
 		}
 
 	}
 
-	cleanUp(results, mySqliteLogDb);
-
 	return 0;
 
 }
@@ -1228,25 +1389,23 @@ QList<int> guiLog::getGameList(QString fileStringPdb)
 	results.result_Game = 0;
 	results.result_Player = 0;
 	results.result_Hand = 0;
-	results.result_Hand_ID = 0;
 	results.result_Action = 0;
 
 	int nRow_Game=0;
 	int nCol_Game=0;
-	char *errmsg = 0;
 	int game_ctr = 0;
 	int i = 0;
 
 	QList<int> gameList;
 
 	// open sqlite log-db
-	sqlite3 *mySqliteLogDb;
-	sqlite3_open(fileStringPdb.toStdString().c_str(), &mySqliteLogDb);
+	LogDatabase logDb(fileStringPdb);
+	sqlite3 *mySqliteLogDb = logDb.get();
 	if( mySqliteLogDb != 0 ) {
 
-		string sql = "SELECT * FROM Game";
-		if(sqlite3_get_table(mySqliteLogDb,sql.c_str(),&results.result_Game,&nRow_Game,&nCol_Game,&errmsg) != SQLITE_OK) {
-			cout << "Error in statement: " << sql.c_str() << "[" << errmsg << "]." << endl;
+		LogQuery gameQuery(mySqliteLogDb, "SELECT UniqueGameID FROM Game");
+		if(!gameQuery.exec(results.result_Game,nRow_Game,nCol_Game)) {
+			cout << "Error in statement: " << gameQuery.getSql() << "[" << gameQuery.getErrorMsg() << "]." << endl;
 		} else {
 			for(game_ctr=1; game_ctr<=nRow_Game; game_ctr++) {
 				for(i=0; i<nCol_Game; i++) {
@@ -1258,23 +1417,10 @@ QList<int> guiLog::getGameList(QString fileStringPdb)
 		}
 	}
 
-	cleanUp(results, mySqliteLogDb);
-
 	return gameList;
 
 }
 
-void guiLog::cleanUp(result_struct &results, sqlite3 *mySqliteLogDb)
-{
-
-	sqlite3_free_table(results.result_Session);
-	sqlite3_free_table(results.result_Game);
-	sqlite3_free_table(results.result_Hand);
-	sqlite3_free_table(results.result_Hand_ID);
-	sqlite3_free_table(results.result_Action);
-	sqlite3_close(mySqliteLogDb);
-}
-
 int guiLog::convertCardStringToInt(string val, string col)
 {
 
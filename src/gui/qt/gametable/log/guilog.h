@@ -45,13 +45,14 @@
 #include <QtWidgets>
 #endif
 
+#define SHOW_LOG_PAGE_SIZE		25
+
 struct result_struct {
-	char **result_Session;
-	char **result_Game;
-	char **result_Player;
-	char **result_Hand;
-	char **result_Hand_ID;
-	char **result_Action;
+	const char **result_Session;
+	const char **result_Game;
+	const char **result_Player;
+	const char **result_Hand;
+	const char **result_Action;
 };
 
 class gameTableImpl;
@@ -86,6 +87,7 @@ public slots:
 	void showLog(QString fileStringPdb, QTextBrowser *tb, int uniqueGameID = 0);
 	int exportLog(QString fileStringPdb, int modus, int uniqueGameID = 0);
 	QList<int> getGameList(QString fileStringPdb);
+	void appendShowLogPage(QStringList page, int generation);
 
 public:
 	QStringList translateCardCode(int cardCode);
@@ -113,13 +115,16 @@ signals:
 	void signalLogSpectatorJoinedMsg(QString playerName);
 	void signalLogNewGameAdminMsg(QString playerName);
 	void signalLogPlayerWinGame(QString playerName, int gameID);
+	void signalShowLogPage(QStringList page, int generation);
 
 
 private:
 
 	void writeLogFileStream(std::string log_string, QFile *LogFile);
 	void writeLog(std::string log_string, int modus);
-	void cleanUp(result_struct &results, sqlite3 *mySqliteLogDb);
+	void loadShowLog(QString fileStringPdb, int uniqueGameID, int generation);
+	bool showLogCanceled();
+	void flushShowLogPage();
 	int convertCardStringToInt(std::string val, std::string col);
 	std::string convertCardIntToString(int code, int modus);
 
@@ -139,7 +144,15 @@ private:
 	std::string mySqliteLogFileName;
 	bool newVersion;
 
+	// The log preview is rendered on showLogPool and appended page by page.
+	QThreadPool showLogPool;
+	QMutex showLogMutex;
+	int showLogGeneration;
+	int showLogRunGeneration;
+	QStringList showLogPage;
+
 	friend class GuiWrapper;
+	friend class ShowLogLoader;
 
 };
 
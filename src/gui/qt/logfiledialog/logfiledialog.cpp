@@ -41,6 +41,7 @@
 #include "configfile.h"
 #include "mymessagebox.h"
 #include <game_defs.h>
+#include <handhistory.h>
 #include <net/uploaderthread.h>
 
 LogFileDialog::LogFileDialog(QWidget *parent, ConfigFile *c) :
@@ -76,8 +77,11 @@ int LogFileDialog::exec()
 	uploader->Run();
 	refreshLogFileList();
 	int ret	= QDialog::exec();
+	//the dialog is closed, do not report the uploads which are aborted
+	blockSignals(true);
 	uploader->SignalTermination();
 	uploader->Join(THREAD_WAIT_INFINITE);
+	blockSignals(false);
 	return ret;
 }
 
@@ -95,6 +99,7 @@ void LogFileDialog::refreshLogFileList()
 {
 	QDir logFileDir;
 	logFileDir.setPath(QString::fromUtf8(myConfig->readConfigString("LogDir").c_str()));
+	convertHandHistories(logFileDir);
 	QStringList filters;
 	filters << "*.pdb";
 	QFileInfoList dbFilesList = logFileDir.entryInfoList(filters, QDir::Files, QDir::Time);
@@ -125,6 +130,24 @@ void LogFileDialog::refreshLogFileList()
 	ui->treeWidget_logFiles->setCurrentItem(ui->treeWidget_logFiles->topLevelItem(0));
 }
 
+void LogFileDialog::convertHandHistories(const QDir &logFileDir)
+{
+	// Binary hand histories are shown and exported as sqlite-db with the same name.
+	QStringList filters;
+	filters << QString("*") + HAND_HISTORY_FILE_EXTENSION;
+	QFileInfoList historyFilesList = logFileDir.entryInfoList(filters, QDir::Files);
+	for (int i = 0; i < historyFilesList.size(); i++) {
+		const QFileInfo &historyFile = historyFilesList.at(i);
+		QFileInfo dbFile(logFileDir.absoluteFilePath(historyFile.completeBaseName() + ".pdb"));
+		if(!dbFile.exists() || dbFile.lastModified() < historyFile.lastModified()) {
+			QFile::remove(dbFile.absoluteFilePath());
+			if(!HandHistoryExportToSqlite(historyFile.absoluteFilePath().toUtf8().constData(), dbFile.absoluteFilePath().toUtf8().constData())) {
+				QFile::remove(dbFile.absoluteFilePath());
+			}
+		}
+	}
+}
+
 void LogFileDialog::deleteLogFile()
 {
 	QList<QTreeWidgetItem*> selectedItemsList = ui->treeWidget_logFiles->selectedItems();
@@ -139,8 +162,12 @@ void LogFileDialog::deleteLogFile()
 			for (int i = 0; i < selectedItemsList.size(); ++i) {
 				if(selectedItemsList.at(i)->data(0, Qt::UserRole+1).toString() != "current") {
 
-					if(!QFile::remove(selectedItemsList.at(i)->data(0, Qt::UserRole).toString())) {
+					QFileInfo fi(selectedItemsList.at(i)->data(0, Qt::UserRole).toString());
+					if(!QFile::remove(fi.absoluteFilePath())) {
 						MyMessageBox::warning(this, tr("Remove log file"), tr("PokerTH cannot remove this log file, please verify that you have write access to this file!"), QMessageBox::Close );
+					} else {
+						// also remove the binary hand history it was converted from
+						QFile::remove(fi.absoluteDir().absoluteFilePath(fi.completeBaseName() + HAND_HISTORY_FILE_EXTENSION));
 					}
 				}
 			}
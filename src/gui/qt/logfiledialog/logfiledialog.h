@@ -33,6 +33,7 @@
 #define LOGFILEDIALOG_H
 
 #include <QDialog>
+#include <QDir>
 #include <QFile>
 #include <net/uploadcallback.h>
 #include <boost/shared_ptr.hpp>
@@ -92,6 +93,8 @@ public slots:
 	void showUploadError(QString filename, QString errorMessage);
 
 private:
+	void convertHandHistories(const QDir &logFileDir);
+
 	ConfigFile *myConfig;
 	guiLog *myGuiLog;
 	Ui::LogFileDialog *ui;
@@ -34,6 +34,8 @@
 #define _ASIOSENDBUFFER_H_
 
 #include <net/sendbuffer.h>
+#include <boost/atomic.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <cstdlib>
 
 
@@ -45,6 +47,8 @@ class AsioSendBuffer : public SendBuffer
 {
 public:
 	AsioSendBuffer();
+	// Coalesce all packets stored during one handler into a single write.
+	AsioSendBuffer(boost::asio::io_service &ioService);
 	virtual ~AsioSendBuffer();
 
 	inline size_t GetSendBufLeft() const
@@ -83,15 +87,27 @@ public:
 	}
 
 	virtual void SetCloseAfterSend();
+	virtual void SetFlushDelay(unsigned delayMsec);
 
 	virtual void AsyncSendNextPacket(boost::shared_ptr<SessionData> session);
 	void AsyncSendNextPacket(boost::shared_ptr<boost::asio::ip::tcp::socket> socket);
 	virtual void InternalStorePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet);
+	virtual void InternalStoreSerialized(boost::shared_ptr<SessionData> session, const std::string &data);
 	int EncodeToBuf(const void *data, size_t size);
 
 	virtual void HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code &error);
 
+	// Number of socket writes started by all send buffers.
+	static unsigned long GetNumWrites();
+
+protected:
+	void HandleUncork(boost::shared_ptr<boost::asio::ip::tcp::socket> socket);
+
 private:
+	boost::asio::io_service *ioService;
+	boost::shared_ptr<boost::asio::steady_timer> flushTimer;
+	unsigned flushDelayMsec;
+	bool uncorkPosted;
 	char *sendBuf;
 	char *curWriteBuf;
 	size_t sendBufAllocated;
@@ -99,6 +115,8 @@ private:
 	size_t curWriteBufAllocated;
 	size_t curWriteBufUsed;
 	bool closeAfterSend;
+
+	static boost::atomic<unsigned long> numWrites;
 };
 
 #endif
@@ -35,15 +35,21 @@
 
 #include <boost/asio.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+#include <deque>
 #include <string>
 #include <net/chatcleanercallback.h>
 
 #define CLEANER_NET_HEADER_SIZE		4
 #define MAX_CLEANER_PACKET_SIZE		512
 #define CLEANER_PROTOCOL_VERSION	2
+// Number of requests to the chatcleaner process which are kept for latency measurement.
+#define CLEANER_MAX_PENDING_REQUESTS	256
 
 class AsioSendBuffer;
 class ChatCleanerMessage;
+class ChatFilterThread;
 
 class ChatCleanerManager : public boost::enable_shared_from_this<ChatCleanerManager>
 {
@@ -53,11 +59,24 @@ public:
 
 	void Init(const std::string &serverAddr, int port, bool ipv6,
 			  const std::string &clientSecret, const std::string &serverSecret);
+	// Use the message filter within the server process instead of a chatcleaner process.
+	void InitLocal();
 	void ReInit();
+	void Stop();
 	void HandleLobbyChatText(unsigned playerId, const std::string &name, const std::string &text);
 	void HandleGameChatText(unsigned gameId, unsigned playerId, const std::string &name, const std::string &text);
 
+	// Called by the local filter thread (via io service).
+	void HandleLocalReply(boost::shared_ptr<ChatCleanerMessage> msg);
+
+	// Time from receiving a chat text until the verdict, in microseconds.
+	// Using a chatcleaner process, only replies with an action are measured.
+	void AddVerdictLatency(unsigned latencyUsec);
+	// Retrieves and resets the latency statistics.
+	void GetVerdictLatencyStats(unsigned &numVerdicts, unsigned &avgLatencyUsec, unsigned &maxLatencyUsec);
+
 protected:
+	typedef std::deque<std::pair<unsigned, boost::chrono::steady_clock::time_point> > PendingRequestList;
 
 	void HandleResolve(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
 	void HandleConnect(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::iterator endpoint_iterator);
@@ -74,6 +93,7 @@ private:
 	boost::shared_ptr<boost::asio::ip::tcp::resolver> m_resolver;
 	boost::shared_ptr<boost::asio::ip::tcp::socket> m_socket;
 	boost::shared_ptr<AsioSendBuffer> m_sendManager;
+	boost::shared_ptr<ChatFilterThread> m_filterThread;
 
 	bool m_connected;
 	unsigned m_curRequestId;
@@ -84,6 +104,12 @@ private:
 	std::string m_serverSecret;
 	unsigned char m_recvBuf[2*MAX_CLEANER_PACKET_SIZE];
 	size_t m_recvBufUsed;
+
+	PendingRequestList m_pendingRequests;
+	mutable boost::mutex m_latencyMutex;
+	unsigned m_numVerdicts;
+	boost::uint64_t m_sumLatencyUsec;
+	unsigned m_maxLatencyUsec;
 };
 
 #endif
@@ -0,0 +1,94 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Thread running the chat filter within the server process. */
+
+#ifndef _CHATFILTERTHREAD_H_
+#define _CHATFILTERTHREAD_H_
+
+#include <boost/asio.hpp>
+#include <boost/chrono.hpp>
+#include <boost/interprocess/sync/interprocess_semaphore.hpp>
+#include <core/thread.h>
+#include <deque>
+#include <string>
+#include <ctime>
+
+#define CHAT_FILTER_MAX_QUEUE_SIZE				1024
+#define CHAT_FILTER_CONFIG_CHECK_INTERVAL_SEC	10
+
+class ChatCleanerManager;
+class CleanerConfig;
+class MessageFilter;
+
+// Runs the chatcleaner message filter without the external process.
+// Replies are passed to the chat cleaner manager using the io service.
+class ChatFilterThread : public Thread
+{
+public:
+	ChatFilterThread(ChatCleanerManager &manager, boost::shared_ptr<boost::asio::io_service> ioService);
+	virtual ~ChatFilterThread();
+
+	virtual void SignalTermination();
+
+	void AddChatText(unsigned requestId, unsigned gameId, unsigned playerId, const std::string &name, const std::string &text);
+
+protected:
+	struct ChatRequest {
+		unsigned requestId;
+		unsigned gameId;
+		unsigned playerId;
+		std::string name;
+		std::string text;
+		boost::chrono::steady_clock::time_point queueTime;
+	};
+	typedef std::deque<ChatRequest> ChatRequestQueue;
+
+	// Main function of the thread.
+	virtual void Main();
+
+	bool GetNextRequest(ChatRequest &request);
+	void HandleRequest(const ChatRequest &request);
+	void CheckConfig(bool forceRefresh);
+
+private:
+	ChatCleanerManager &m_manager;
+	boost::shared_ptr<boost::asio::io_service> m_ioService;
+	boost::interprocess::interprocess_semaphore m_semaphore;
+	mutable boost::mutex m_requestQueueMutex;
+	ChatRequestQueue m_requestQueue;
+
+	boost::shared_ptr<CleanerConfig> m_config;
+	boost::shared_ptr<MessageFilter> m_filter;
+	std::time_t m_configFileTime;
+	boost::chrono::steady_clock::time_point m_lastConfigCheck;
+};
+
+#endif
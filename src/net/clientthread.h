@@ -151,6 +151,10 @@ public:
 	virtual void SessionError(boost::shared_ptr<SessionData> /*session*/, int /*errorCode*/) {}
 	virtual void SessionTimeoutWarning(boost::shared_ptr<SessionData> /*session*/, unsigned /*remainingSec*/) {}
 	virtual void HandlePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet);
+	virtual unsigned GetSpectatorFlushDelayMsec() const
+	{
+		return 0;
+	}
 
 	void SelectServer(unsigned serverId);
 	void SetLogin(const std::string &userName, const std::string &password, bool isGuest);
@@ -187,8 +191,6 @@ protected:
 
 	// Main function of the thread.
 	virtual void Main();
-	void RegisterTimers();
-	void CancelTimers();
 
 	void InitAuthContext();
 	void ClearAuthContext();
@@ -212,7 +214,8 @@ protected:
 	void PassAvatarFileToManager(unsigned playerId, boost::shared_ptr<AvatarFile> AvatarFile);
 	void SetUnknownAvatar(unsigned playerId);
 
-	void TimerCheckAvatarDownloads(const boost::system::error_code& ec);
+	void SignalAvatarDownloadResult();
+	void HandleAvatarDownloadResults();
 
 	void UnsubscribeLobbyMsg();
 	void ResubscribeLobbyMsg();
@@ -348,7 +351,6 @@ private:
 	PingData m_pingData;
 
 	boost::asio::steady_timer m_stateTimer;
-	boost::asio::steady_timer m_avatarTimer;
 
 	friend class AbstractClientStateReceiving;
 	friend class ClientStateInit;
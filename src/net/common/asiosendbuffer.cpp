@@ -39,9 +39,23 @@
 
 using namespace std;
 
+#ifdef BOOST_ASIO_HAS_STD_CHRONO
+using namespace std::chrono;
+#else
+using namespace boost::chrono;
+#endif
+
+boost::atomic<unsigned long> AsioSendBuffer::numWrites(0);
+
 
 AsioSendBuffer::AsioSendBuffer()
-	: sendBuf(NULL), curWriteBuf(NULL), sendBufAllocated(0), sendBufUsed(0),
+	: ioService(NULL), flushDelayMsec(0), uncorkPosted(false), sendBuf(NULL), curWriteBuf(NULL), sendBufAllocated(0), sendBufUsed(0),
+	  curWriteBufAllocated(0), curWriteBufUsed(0), closeAfterSend(false)
+{
+}
+
+AsioSendBuffer::AsioSendBuffer(boost::asio::io_service &ioService)
+	: ioService(&ioService), flushDelayMsec(0), uncorkPosted(false), sendBuf(NULL), curWriteBuf(NULL), sendBufAllocated(0), sendBufUsed(0),
 	  curWriteBufAllocated(0), curWriteBufUsed(0), closeAfterSend(false)
 {
 }
@@ -58,6 +72,12 @@ AsioSendBuffer::SetCloseAfterSend()
 	closeAfterSend = true;
 }
 
+void
+AsioSendBuffer::SetFlushDelay(unsigned delayMsec)
+{
+	flushDelayMsec = delayMsec;
+}
+
 void
 AsioSendBuffer::HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code &error)
 {
@@ -73,7 +93,34 @@ AsioSendBuffer::HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> sock
 void
 AsioSendBuffer::AsyncSendNextPacket(boost::shared_ptr<SessionData> session)
 {
-	AsyncSendNextPacket(session->GetAsioSocket());
+	if (!ioService) {
+		AsyncSendNextPacket(session->GetAsioSocket());
+	} else if (!uncorkPosted && !curWriteBufUsed) {
+		// Wait for the current handler to finish, more packets may follow.
+		// If a write is pending, HandleWrite will send the data.
+		uncorkPosted = true;
+		if (flushDelayMsec) {
+			if (!flushTimer) {
+				flushTimer.reset(new boost::asio::steady_timer(*ioService));
+			}
+			flushTimer->expires_from_now(milliseconds(flushDelayMsec));
+			flushTimer->async_wait(boost::bind(&AsioSendBuffer::HandleUncork,
+											   boost::static_pointer_cast<AsioSendBuffer>(shared_from_this()),
+											   session->GetAsioSocket()));
+		} else {
+			ioService->post(boost::bind(&AsioSendBuffer::HandleUncork,
+										boost::static_pointer_cast<AsioSendBuffer>(shared_from_this()),
+										session->GetAsioSocket()));
+		}
+	}
+}
+
+void
+AsioSendBuffer::HandleUncork(boost::shared_ptr<boost::asio::ip::tcp::socket> socket)
+{
+	boost::mutex::scoped_lock lock(dataMutex);
+	uncorkPosted = false;
+	AsyncSendNextPacket(socket);
 }
 
 void
@@ -85,6 +132,7 @@ AsioSendBuffer::AsyncSendNextPacket(boost::shared_ptr<boost::asio::ip::tcp::sock
 		boost::swap(curWriteBufAllocated, sendBufAllocated);
 		boost::swap(curWriteBufUsed, sendBufUsed);
 		if (curWriteBufUsed) {
+			++numWrites;
 			boost::asio::async_write(
 				*socket,
 				boost::asio::buffer(curWriteBuf, curWriteBufUsed),
@@ -109,6 +157,12 @@ AsioSendBuffer::InternalStorePacket(boost::shared_ptr<SessionData> /*session*/,
 	delete[] buf;
 }
 
+void
+AsioSendBuffer::InternalStoreSerialized(boost::shared_ptr<SessionData> /*session*/, const std::string &data)
+{
+	EncodeToBuf(data.data(), data.size());
+}
+
 int
 AsioSendBuffer::EncodeToBuf(const void *data, size_t size)
 {
@@ -124,3 +178,8 @@ AsioSendBuffer::EncodeToBuf(const void *data, size_t size)
 	return 0;
 }
 
+unsigned long
+AsioSendBuffer::GetNumWrites()
+{
+	return numWrites;
+}
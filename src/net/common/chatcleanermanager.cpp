@@ -31,6 +31,7 @@
 
 #include <net/chatcleanermanager.h>
 #include <net/asiosendbuffer.h>
+#include <net/chatfilterthread.h>
 #include <boost/bind.hpp>
 #include <core/loghelper.h>
 #include <third_party/protobuf/chatcleaner.pb.h>
@@ -39,11 +40,12 @@
 
 using namespace std;
 using boost::asio::ip::tcp;
+using boost::chrono::steady_clock;
 
 
 ChatCleanerManager::ChatCleanerManager(ChatCleanerCallback &cb, boost::shared_ptr<boost::asio::io_service> ioService)
 	: m_callback(cb), m_ioService(ioService), m_connected(false), m_curRequestId(0), m_serverPort(0), m_useIpv6(false),
-	  m_recvBufUsed(0)
+	  m_recvBufUsed(0), m_numVerdicts(0), m_sumLatencyUsec(0), m_maxLatencyUsec(0)
 {
 	m_recvBuf[0] = 0;
 	m_resolver.reset(
@@ -68,9 +70,22 @@ ChatCleanerManager::Init(const string &serverAddr, int port, bool ipv6,
 	ReInit();
 }
 
+void
+ChatCleanerManager::InitLocal()
+{
+	if (!m_filterThread) {
+		m_filterThread.reset(new ChatFilterThread(*this, m_ioService));
+		m_filterThread->Run();
+		LOG_MSG("Using chat filter within the server process.");
+	}
+}
+
 void
 ChatCleanerManager::ReInit()
 {
+	if (m_filterThread)
+		return; // Nothing to reconnect.
+
 	if (m_useIpv6)
 		m_socket.reset(new boost::asio::ip::tcp::socket(*m_ioService, tcp::v6()));
 	else
@@ -88,6 +103,16 @@ ChatCleanerManager::ReInit()
 					boost::asio::placeholders::iterator));
 }
 
+void
+ChatCleanerManager::Stop()
+{
+	if (m_filterThread) {
+		m_filterThread->SignalTermination();
+		m_filterThread->Join(THREAD_WAIT_INFINITE);
+		m_filterThread.reset();
+	}
+}
+
 void
 ChatCleanerManager::HandleLobbyChatText(unsigned playerId, const std::string &name, const std::string &text)
 {
@@ -97,7 +122,9 @@ ChatCleanerManager::HandleLobbyChatText(unsigned playerId, const std::string &na
 void
 ChatCleanerManager::HandleGameChatText(unsigned gameId, unsigned playerId, const std::string &name, const std::string &text)
 {
-	if (m_connected) {
+	if (m_filterThread) {
+		m_filterThread->AddChatText(GetNextRequestId(), gameId, playerId, name, text);
+	} else if (m_connected) {
 		boost::shared_ptr<ChatCleanerMessage> tmpChat(ChatCleanerMessage::default_instance().New());
 		tmpChat->set_messagetype(ChatCleanerMessage::Type_CleanerChatRequestMessage);
 		CleanerChatRequestMessage *netRequest = tmpChat->mutable_cleanerchatrequestmessage();
@@ -112,9 +139,41 @@ ChatCleanerManager::HandleGameChatText(unsigned gameId, unsigned playerId, const
 		netRequest->set_playername(name);
 		netRequest->set_chatmessage(text);
 		SendMessageToServer(*tmpChat);
+
+		m_pendingRequests.push_back(make_pair(netRequest->requestid(), steady_clock::now()));
+		if (m_pendingRequests.size() > CLEANER_MAX_PENDING_REQUESTS)
+			m_pendingRequests.pop_front();
 	}
 }
 
+void
+ChatCleanerManager::HandleLocalReply(boost::shared_ptr<ChatCleanerMessage> msg)
+{
+	HandleMessage(*msg);
+}
+
+void
+ChatCleanerManager::AddVerdictLatency(unsigned latencyUsec)
+{
+	boost::mutex::scoped_lock lock(m_latencyMutex);
+	m_numVerdicts++;
+	m_sumLatencyUsec += latencyUsec;
+	if (latencyUsec > m_maxLatencyUsec)
+		m_maxLatencyUsec = latencyUsec;
+}
+
+void
+ChatCleanerManager::GetVerdictLatencyStats(unsigned &numVerdicts, unsigned &avgLatencyUsec, unsigned &maxLatencyUsec)
+{
+	boost::mutex::scoped_lock lock(m_latencyMutex);
+	numVerdicts = m_numVerdicts;
+	avgLatencyUsec = m_numVerdicts ? static_cast<unsigned>(m_sumLatencyUsec / m_numVerdicts) : 0;
+	maxLatencyUsec = m_maxLatencyUsec;
+	m_numVerdicts = 0;
+	m_sumLatencyUsec = 0;
+	m_maxLatencyUsec = 0;
+}
+
 void
 ChatCleanerManager::HandleResolve(const boost::system::error_code& ec,
 								  boost::asio::ip::tcp::resolver::iterator endpoint_iterator)
@@ -248,6 +307,16 @@ ChatCleanerManager::HandleMessage(ChatCleanerMessage &msg)
 			LOG_ERROR("Chat cleaner handshake failed.");
 	} else if (msg.messagetype() == ChatCleanerMessage::Type_CleanerChatReplyMessage) {
 		const CleanerChatReplyMessage &netReply = msg.cleanerchatreplymessage();
+		PendingRequestList::iterator pos = m_pendingRequests.begin();
+		while (pos != m_pendingRequests.end()) {
+			if (pos->first == netReply.requestid()) {
+				AddVerdictLatency(static_cast<unsigned>(
+									  boost::chrono::duration_cast<boost::chrono::microseconds>(steady_clock::now() - pos->second).count()));
+				m_pendingRequests.erase(pos);
+				break;
+			}
+			++pos;
+		}
 		if (!netReply.cleanertext().empty()) {
 			if (netReply.cleanerchattype() == cleanerChatTypeLobby) {
 				m_callback.SignalChatBotMessage(netReply.cleanertext());
@@ -0,0 +1,168 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <net/chatfilterthread.h>
+#include <net/chatcleanermanager.h>
+#include <chatcleaner/cleanerconfig.h>
+#include <chatcleaner/messagefilter.h>
+#include <core/loghelper.h>
+#include <third_party/protobuf/chatcleaner.pb.h>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+using namespace std;
+using boost::chrono::steady_clock;
+
+
+ChatFilterThread::ChatFilterThread(ChatCleanerManager &manager, boost::shared_ptr<boost::asio::io_service> ioService)
+	: m_manager(manager), m_ioService(ioService), m_semaphore(0), m_configFileTime(0)
+{
+}
+
+ChatFilterThread::~ChatFilterThread()
+{
+}
+
+void
+ChatFilterThread::SignalTermination()
+{
+	Thread::SignalTermination();
+	m_semaphore.post();
+}
+
+void
+ChatFilterThread::AddChatText(unsigned requestId, unsigned gameId, unsigned playerId, const string &name, const string &text)
+{
+	ChatRequest tmpRequest;
+	tmpRequest.requestId = requestId;
+	tmpRequest.gameId = gameId;
+	tmpRequest.playerId = playerId;
+	tmpRequest.name = name;
+	tmpRequest.text = text;
+	tmpRequest.queueTime = steady_clock::now();
+	{
+		boost::mutex::scoped_lock lock(m_requestQueueMutex);
+		if (m_requestQueue.size() >= CHAT_FILTER_MAX_QUEUE_SIZE) {
+			LOG_ERROR("Chat filter queue is full, dropping chat message.");
+			return;
+		}
+		m_requestQueue.push_back(tmpRequest);
+	}
+	m_semaphore.post();
+}
+
+void
+ChatFilterThread::Main()
+{
+	m_config.reset(new CleanerConfig);
+	m_filter.reset(new MessageFilter(m_config.get()));
+	CheckConfig(true);
+
+	while (!ShouldTerminate()) {
+		// Wake up regularly to check for config changes.
+		boost::posix_time::ptime timeout(boost::posix_time::microsec_clock::universal_time()
+										 + boost::posix_time::seconds(CHAT_FILTER_CONFIG_CHECK_INTERVAL_SEC));
+		m_semaphore.timed_wait(timeout);
+
+		ChatRequest tmpRequest;
+		while (!ShouldTerminate() && GetNextRequest(tmpRequest)) {
+			HandleRequest(tmpRequest);
+		}
+		CheckConfig(false);
+	}
+	m_filter.reset();
+	m_config.reset();
+}
+
+bool
+ChatFilterThread::GetNextRequest(ChatRequest &request)
+{
+	boost::mutex::scoped_lock lock(m_requestQueueMutex);
+	if (m_requestQueue.empty())
+		return false;
+	request = m_requestQueue.front();
+	m_requestQueue.pop_front();
+	return true;
+}
+
+void
+ChatFilterThread::HandleRequest(const ChatRequest &request)
+{
+	string checkMessage;
+	MessageFilterAction checkAction = m_filter->check(request.gameId, request.playerId, request.name, request.text, checkMessage);
+	m_manager.AddVerdictLatency(static_cast<unsigned>(
+									boost::chrono::duration_cast<boost::chrono::microseconds>(steady_clock::now() - request.queueTime).count()));
+
+	if (checkAction != FILTER_ACTION_NOTHING) {
+		// Same reply as the chatcleaner process would send.
+		boost::shared_ptr<ChatCleanerMessage> tmpReply(ChatCleanerMessage::default_instance().New());
+		tmpReply->set_messagetype(ChatCleanerMessage::Type_CleanerChatReplyMessage);
+		CleanerChatReplyMessage *netReply = tmpReply->mutable_cleanerchatreplymessage();
+		netReply->set_requestid(request.requestId);
+		netReply->set_gameid(request.gameId);
+		netReply->set_cleanerchattype(request.gameId ? cleanerChatTypeGame : cleanerChatTypeLobby);
+		netReply->set_playerid(request.playerId);
+
+		if (checkAction == FILTER_ACTION_WARN) {
+			netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionWarning);
+		} else if (checkAction == FILTER_ACTION_KICK) {
+			netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionKick);
+		} else if (checkAction == FILTER_ACTION_KICKBAN) {
+			netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionBan);
+		} else if (checkAction == FILTER_ACTION_MUTE) {
+			netReply->set_cleaneractiontype(CleanerChatReplyMessage_CleanerActionType_cleanerActionMute);
+		}
+		netReply->set_cleanertext(checkMessage);
+
+		m_ioService->post(boost::bind(&ChatCleanerManager::HandleLocalReply, m_manager.shared_from_this(), tmpReply));
+	}
+}
+
+void
+ChatFilterThread::CheckConfig(bool forceRefresh)
+{
+	steady_clock::time_point now = steady_clock::now();
+	if (!forceRefresh && now - m_lastConfigCheck < boost::chrono::seconds(CHAT_FILTER_CONFIG_CHECK_INTERVAL_SEC))
+		return;
+	m_lastConfigCheck = now;
+
+	// Only reload and recompile the filter lists if the config file has changed.
+	boost::system::error_code ec;
+	time_t fileTime = boost::filesystem::last_write_time(m_config->getConfigFileName(), ec);
+	if (ec)
+		fileTime = 0;
+	if (forceRefresh || fileTime != m_configFileTime) {
+		if (!forceRefresh)
+			m_config->fillBuffer();
+		m_filter->refreshConfig();
+		m_configFileTime = fileTime;
+	}
+}
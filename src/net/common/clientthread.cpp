@@ -56,10 +56,8 @@
 #include <cassert>
 #include <gsasl.h>
 
-#define TEMP_AVATAR_FILENAME	"avatar.tmp"
 #define TEMP_GUID_FILENAME		"guid.tmp"
 #define CLIENT_GUID_SIZE		16
-#define CLIENT_AVATAR_LOOP_MSEC	100
 #define CLIENT_SEND_LOOP_MSEC	50
 
 using namespace std;
@@ -76,7 +74,7 @@ ClientThread::ClientThread(GuiInterface &gui, AvatarManager &avatarManager, Log
 	: m_ioService(new boost::asio::io_service), m_clientLog(myLog), m_curState(NULL), m_gui(gui),
 	  m_avatarManager(avatarManager), m_isServerSelected(false),
 	  m_curGameId(0), m_curGameNum(1), m_guiPlayerId(0), m_sessionEstablished(false),
-	  m_stateTimer(*m_ioService), m_avatarTimer(*m_ioService)
+	  m_stateTimer(*m_ioService)
 {
 	m_context.reset(new ClientContext);
 	myQtToolsInterface.reset(CreateQtToolsWrapper());
@@ -632,10 +630,10 @@ ClientThread::Main()
 	try {
 		InitAuthContext();
 		// Start sub-threads.
-		m_avatarDownloader.reset(new DownloaderThread);
+		m_avatarDownloader.reset(new DownloaderThread(
+			boost::bind(&ClientThread::SignalAvatarDownloadResult, this)));
 		m_avatarDownloader->Run();
 		SetState(CLIENT_INITIAL_STATE::Instance());
-		RegisterTimers();
 
 		boost::asio::io_service::work ioWork(*m_ioService);
 		m_ioService->run(); // Will only be aborted asynchronously.
@@ -655,30 +653,14 @@ ClientThread::Main()
 	SetState(CLIENT_FINAL_STATE::Instance());
 	// Cancel timers.
 	GetStateTimer().cancel();
-	CancelTimers();
-	// Terminate sub-threads.
+	// Terminate sub-threads. Results are no longer handled, the io service has stopped.
+	m_avatarDownloader->CancelResultNotifier();
 	m_avatarDownloader->SignalTermination();
 	m_avatarDownloader->Join(DOWNLOADER_THREAD_TERMINATE_TIMEOUT);
 
 	ClearAuthContext();
 }
 
-void
-ClientThread::RegisterTimers()
-{
-	m_avatarTimer.expires_from_now(
-		milliseconds(CLIENT_AVATAR_LOOP_MSEC));
-	m_avatarTimer.async_wait(
-		boost::bind(
-			&ClientThread::TimerCheckAvatarDownloads, shared_from_this(), boost::asio::placeholders::error));
-}
-
-void
-ClientThread::CancelTimers()
-{
-	m_avatarTimer.cancel();
-}
-
 void
 ClientThread::InitAuthContext()
 {
@@ -886,7 +868,7 @@ ClientThread::RetrieveAvatarIfNeeded(unsigned id, const PlayerInfo &info)
 			if (!avatarServerAddress.empty() && m_avatarDownloader) {
 				string serverFileName(info.avatar.ToString() + AvatarManager::GetAvatarFileExtension(info.avatarType));
 				m_avatarDownloader->QueueDownload(
-					id, avatarServerAddress + serverFileName, GetContext().GetCacheDir() + TEMP_AVATAR_FILENAME);
+					id, avatarServerAddress + serverFileName);
 			} else {
 				boost::shared_ptr<NetPacket> packet(new NetPacket);
 				packet->GetMsg()->set_messagetype(PokerTHMessage::Type_LobbyMessage);
@@ -984,21 +966,26 @@ ClientThread::SetUnknownAvatar(unsigned playerId)
 }
 
 void
-ClientThread::TimerCheckAvatarDownloads(const boost::system::error_code& ec)
+ClientThread::SignalAvatarDownloadResult()
+{
+	// Called by the downloader thread. The handler only runs within Main(), so
+	// it must not hold a reference which would keep this object alive.
+	m_ioService->post(boost::bind(&ClientThread::HandleAvatarDownloadResults, this));
+}
+
+void
+ClientThread::HandleAvatarDownloadResults()
 {
-	if (!ec) {
-		if (m_avatarDownloader && m_avatarDownloader->HasDownloadResult()) {
-			unsigned playerId;
-			boost::shared_ptr<AvatarFile> tmpAvatar(new AvatarFile);
-			m_avatarDownloader->GetDownloadResult(playerId, tmpAvatar->fileData);
-			tmpAvatar->reportedSize = tmpAvatar->fileData.size();
-			PassAvatarFileToManager(playerId, tmpAvatar);
+	if (m_avatarDownloader) {
+		unsigned playerId;
+		boost::shared_ptr<AvatarFile> tmpAvatar(new AvatarFile);
+		while (m_avatarDownloader->GetDownloadResult(playerId, tmpAvatar->fileData)) {
+			if (!tmpAvatar->fileData.empty()) {
+				tmpAvatar->reportedSize = tmpAvatar->fileData.size();
+				PassAvatarFileToManager(playerId, tmpAvatar);
+			}
+			tmpAvatar.reset(new AvatarFile);
 		}
-		m_avatarTimer.expires_from_now(
-			milliseconds(CLIENT_AVATAR_LOOP_MSEC));
-		m_avatarTimer.async_wait(
-			boost::bind(
-				&ClientThread::TimerCheckAvatarDownloads, shared_from_this(), boost::asio::placeholders::error));
 	}
 }
 
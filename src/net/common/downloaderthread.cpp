@@ -29,25 +29,41 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 
+#include <net/socket_helper.h>
 #include <net/downloaderthread.h>
-#include <net/downloadhelper.h>
-#include <net/netexception.h>
-#include <boost/filesystem.hpp>
 #include <core/loghelper.h>
 
-#include <fstream>
-#include <algorithm>
+#include <curl/curl.h>
+#include <map>
 
-#define DOWNLOAD_DELAY_MSEC					20
+#define DOWNLOAD_SELECT_TIMEOUT_MSEC		50
 
 using namespace std;
-using namespace boost::filesystem;
 
 
-DownloaderThread::DownloaderThread()
-	: m_downloadInProgress(false)
+struct DownloaderThread::TransferContext {
+	struct ActiveTransfer {
+		ActiveTransfer(unsigned id, const std::string &a)
+			: result(id), address(a) {}
+
+		ResultData result;
+		std::string address;
+	};
+	typedef std::map<CURL *, boost::shared_ptr<ActiveTransfer> > ActiveTransferMap;
+
+	TransferContext() : multiHandle(NULL) {}
+
+	CURLM *multiHandle;
+	ActiveTransferMap activeTransfers;
+	// Easy handles are reused, so that they keep their DNS cache and
+	// connections to the avatar server can be kept alive.
+	std::vector<CURL *> idleHandles;
+};
+
+DownloaderThread::DownloaderThread(ResultNotifier notifier, unsigned maxParallelTransfers, unsigned transferTimeoutSec)
+	: m_terminate(false), m_notifier(notifier), m_maxParallelTransfers(maxParallelTransfers ? maxParallelTransfers : 1),
+	  m_transferTimeoutSec(transferTimeoutSec)
 {
-	m_downloadHelper.reset(new DownloadHelper());
 }
 
 DownloaderThread::~DownloaderThread()
@@ -55,10 +71,31 @@ DownloaderThread::~DownloaderThread()
 }
 
 void
-DownloaderThread::QueueDownload(unsigned downloadId, const std::string &url, const std::string &filename)
+DownloaderThread::SignalTermination()
+{
+	{
+		boost::mutex::scoped_lock lock(m_downloadQueueMutex);
+		m_terminate = true;
+	}
+	m_downloadQueueCond.notify_all();
+	Thread::SignalTermination();
+}
+
+void
+DownloaderThread::CancelResultNotifier()
+{
+	boost::mutex::scoped_lock lock(m_notifierMutex);
+	m_notifier.clear();
+}
+
+void
+DownloaderThread::QueueDownload(unsigned downloadId, const std::string &url)
 {
-	boost::mutex::scoped_lock lock(m_downloadQueueMutex);
-	m_downloadQueue.push(DownloadData(downloadId, url, filename));
+	{
+		boost::mutex::scoped_lock lock(m_downloadQueueMutex);
+		m_downloadQueue.push(DownloadData(downloadId, url));
+	}
+	m_downloadQueueCond.notify_one();
 }
 
 bool
@@ -74,9 +111,9 @@ DownloaderThread::GetDownloadResult(unsigned &downloadId, std::vector<unsigned c
 	bool result = false;
 	boost::mutex::scoped_lock lock(m_downloadDoneQueueMutex);
 	if (!m_downloadDoneQueue.empty()) {
-		const ResultData &d = m_downloadDoneQueue.front();
+		ResultData &d = m_downloadDoneQueue.front();
 		downloadId = d.id;
-		filedata = d.data;
+		filedata.swap(d.data);
 		m_downloadDoneQueue.pop();
 		result = true;
 	}
@@ -86,61 +123,173 @@ DownloaderThread::GetDownloadResult(unsigned &downloadId, std::vector<unsigned c
 void
 DownloaderThread::Main()
 {
-	while (!ShouldTerminate()) {
-		try {
-			if (m_downloadInProgress) {
-				m_downloadInProgress = !m_downloadHelper->Process();
-			}
+	TransferContext context;
+	context.multiHandle = curl_multi_init();
+	if (!context.multiHandle) {
+		LOG_ERROR("Download failed: Could not initialise curl.");
+		return;
+	}
+
+	while (true) {
+		{
+			boost::mutex::scoped_lock lock(m_downloadQueueMutex);
+			// Sleep until there is something to do.
+			while (!m_terminate && context.activeTransfers.empty() && m_downloadQueue.empty())
+				m_downloadQueueCond.wait(lock);
+			if (m_terminate)
+				break;
+		}
+		InternalStartTransfers(context);
+		InternalProcessTransfers(context);
+	}
+
+	// Abort running transfers.
+	TransferContext::ActiveTransferMap::iterator i = context.activeTransfers.begin();
+	TransferContext::ActiveTransferMap::iterator end = context.activeTransfers.end();
+	while (i != end) {
+		curl_multi_remove_handle(context.multiHandle, i->first);
+		curl_easy_cleanup(i->first);
+		++i;
+	}
+	context.activeTransfers.clear();
+	vector<CURL *>::iterator h = context.idleHandles.begin();
+	vector<CURL *>::iterator hEnd = context.idleHandles.end();
+	while (h != hEnd) {
+		curl_easy_cleanup(*h);
+		++h;
+	}
+	context.idleHandles.clear();
+	curl_multi_cleanup(context.multiHandle);
+}
+
+void
+DownloaderThread::InternalStartTransfers(TransferContext &context)
+{
+	while (context.activeTransfers.size() < m_maxParallelTransfers) {
+		DownloadData download;
+		{
+			boost::mutex::scoped_lock lock(m_downloadQueueMutex);
+			if (m_downloadQueue.empty())
+				break;
+			download = m_downloadQueue.front();
+			m_downloadQueue.pop();
+		}
 
-			if (!m_downloadInProgress) {
-				// Previous download was finished.
-				if (m_curDownloadData) {
-					path filepath(m_curDownloadData->filename);
-					std::ifstream instream(filepath.file_string().c_str(), ios_base::in | ios_base::binary);
-					// Find out file size.
-					// Not fully portable, but works on win/linux/mac.
-					instream.seekg(0, ios_base::beg);
-					std::streampos startPos = instream.tellg();
-					instream.seekg(0, ios_base::end);
-					std::streampos endPos = instream.tellg();
-					instream.seekg(0, ios_base::beg);
-					std::streamoff posDiff(endPos - startPos);
-					unsigned fileSize = (unsigned)posDiff;
-
-					vector<unsigned char> fileData(fileSize);
-					instream.read((char *)&fileData[0], fileSize);
-					instream.close();
-					remove(filepath);
-
-					{
-						boost::mutex::scoped_lock lock(m_downloadDoneQueueMutex);
-						m_downloadDoneQueue.push(ResultData(m_curDownloadData->id, fileData));
-					}
-					m_curDownloadData.reset();
-				}
-
-				// Take a break.
-				Msleep(DOWNLOAD_DELAY_MSEC);
-
-				// Start next download.
-				{
-					boost::mutex::scoped_lock lock(m_downloadQueueMutex);
-					if (!m_downloadQueue.empty()) {
-						m_curDownloadData.reset(new DownloadData(m_downloadQueue.front()));
-						m_downloadQueue.pop();
-					}
-				}
-				if (m_curDownloadData && !m_curDownloadData->filename.empty()) {
-					path filepath(m_curDownloadData->filename);
-					m_downloadHelper->Init(m_curDownloadData->address, filepath.file_string());
-					m_downloadInProgress = true;
-				}
+		CURL *handle;
+		if (!context.idleHandles.empty()) {
+			handle = context.idleHandles.back();
+			context.idleHandles.pop_back();
+		} else {
+			handle = curl_easy_init();
+			if (!handle) {
+				LOG_ERROR("Download failed: Could not initialise curl.");
+				continue;
 			}
-		} catch (const NetException &e) {
-			LOG_ERROR("Download failed: " << e.what());
-			m_downloadInProgress = false;
-			m_curDownloadData.reset();
 		}
+		// Use a copy of the url string, because some curl versions require a copy.
+		boost::shared_ptr<TransferContext::ActiveTransfer> transfer(new TransferContext::ActiveTransfer(download.id, download.address));
+		if (curl_easy_setopt(handle, CURLOPT_URL, transfer->address.c_str()) != CURLE_OK
+				|| curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &DownloaderThread::WriteCallback) != CURLE_OK
+				|| curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->result.data) != CURLE_OK
+				|| curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L) != CURLE_OK
+				|| curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L) != CURLE_OK
+				|| curl_easy_setopt(handle, CURLOPT_TIMEOUT, (long)m_transferTimeoutSec) != CURLE_OK
+				|| curl_multi_add_handle(context.multiHandle, handle) != CURLM_OK) {
+			LOG_ERROR("Download failed: Invalid url " << download.address);
+			curl_easy_cleanup(handle);
+			continue;
+		}
+		context.activeTransfers[handle] = transfer;
+	}
+}
+
+void
+DownloaderThread::InternalProcessTransfers(TransferContext &context)
+{
+	if (context.activeTransfers.empty())
+		return;
+
+	int runningHandles = 0;
+	CURLMcode curlResult;
+	do {
+		curlResult = curl_multi_perform(context.multiHandle, &runningHandles);
+	} while (curlResult == CURLM_CALL_MULTI_PERFORM);
+
+	// Collect finished transfers.
+	int numMsgs;
+	CURLMsg *tmpMsg;
+	while ((tmpMsg = curl_multi_info_read(context.multiHandle, &numMsgs)) != NULL) {
+		if (tmpMsg->msg == CURLMSG_DONE)
+			InternalFinishTransfer(context, tmpMsg->easy_handle, tmpMsg->data.result == CURLE_OK);
+	}
+	if (curlResult != CURLM_OK) {
+		LOG_ERROR("Download failed: curl error " << curlResult);
+		while (!context.activeTransfers.empty())
+			InternalFinishTransfer(context, context.activeTransfers.begin()->first, false);
+	}
+
+	if (!context.activeTransfers.empty()) {
+		// Wait for socket activity, but wake up regularly to start queued downloads.
+		struct timeval timeout;
+		fd_set readSet;
+		fd_set writeSet;
+		fd_set exceptSet;
+		int maxfd = -1;
+
+		FD_ZERO(&readSet);
+		FD_ZERO(&writeSet);
+		FD_ZERO(&exceptSet);
+
+		long curlTimeout = -1;
+		curl_multi_timeout(context.multiHandle, &curlTimeout);
+		if (curlTimeout < 0 || curlTimeout > DOWNLOAD_SELECT_TIMEOUT_MSEC)
+			curlTimeout = DOWNLOAD_SELECT_TIMEOUT_MSEC;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = curlTimeout * 1000;
+
+		curl_multi_fdset(context.multiHandle, &readSet, &writeSet, &exceptSet, &maxfd);
+
+		if (maxfd >= 0)
+			select(maxfd+1, &readSet, &writeSet, &exceptSet, &timeout);
+		else if (curlTimeout > 0)
+			Msleep(curlTimeout);
+	}
+}
+
+void
+DownloaderThread::InternalFinishTransfer(TransferContext &context, void *easyHandle, bool success)
+{
+	CURL *handle = static_cast<CURL *>(easyHandle);
+	TransferContext::ActiveTransferMap::iterator pos = context.activeTransfers.find(handle);
+	if (pos == context.activeTransfers.end())
+		return;
+	boost::shared_ptr<TransferContext::ActiveTransfer> transfer(pos->second);
+	context.activeTransfers.erase(pos);
+
+	curl_multi_remove_handle(context.multiHandle, handle);
+	curl_easy_reset(handle);
+	context.idleHandles.push_back(handle);
+
+	if (success) {
+		{
+			boost::mutex::scoped_lock lock(m_downloadDoneQueueMutex);
+			m_downloadDoneQueue.push(ResultData(transfer->result.id));
+			m_downloadDoneQueue.back().data.swap(transfer->result.data);
+		}
+		// Keep the lock while notifying, so that the notifier cannot be cancelled during the call.
+		boost::mutex::scoped_lock lock(m_notifierMutex);
+		if (m_notifier)
+			m_notifier();
+	} else {
+		LOG_ERROR("Download failed: " << transfer->address);
 	}
 }
 
+size_t
+DownloaderThread::WriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	vector<unsigned char> *data = static_cast<vector<unsigned char> *>(userdata);
+	size_t numBytes = size * nmemb;
+	data->insert(data->end(), ptr, ptr + numBytes);
+	return numBytes;
+}
@@ -0,0 +1,179 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <net/ipaddresstrie.h>
+#include <boost/asio/ip/address.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+
+using namespace std;
+
+#define IP_ADDRESS_NUM_BYTES	16
+#define IP_ADDRESS_NUM_BITS		(IP_ADDRESS_NUM_BYTES * 8)
+#define IP_ADDRESS_V4_OFFSET	12
+
+
+IPAddressTrie::IPAddressTrie()
+	: m_nodes(1)
+{
+}
+
+void
+IPAddressTrie::Add(const std::string &ipRange)
+{
+	unsigned char addrBytes[IP_ADDRESS_NUM_BYTES];
+	unsigned prefixLen;
+	if (ParseRange(ipRange, addrBytes, prefixLen)) {
+		unsigned curNode = 0;
+		for (unsigned bitIndex = 0; bitIndex < prefixLen; bitIndex++) {
+			unsigned bit = GetBit(addrBytes, bitIndex);
+			if (!m_nodes[curNode].child[bit]) {
+				m_nodes[curNode].child[bit] = (unsigned)m_nodes.size();
+				m_nodes.push_back(TrieNode());
+			}
+			curNode = m_nodes[curNode].child[bit];
+		}
+		m_nodes[curNode].numEntries++;
+	} else {
+		m_unparsedEntries[ipRange]++;
+	}
+}
+
+bool
+IPAddressTrie::Remove(const std::string &ipRange)
+{
+	bool retVal = false;
+	unsigned char addrBytes[IP_ADDRESS_NUM_BYTES];
+	unsigned prefixLen;
+	if (ParseRange(ipRange, addrBytes, prefixLen)) {
+		// Nodes are not released, they are reused if the range is banned again.
+		unsigned curNode = 0;
+		bool found = true;
+		for (unsigned bitIndex = 0; bitIndex < prefixLen && found; bitIndex++) {
+			curNode = m_nodes[curNode].child[GetBit(addrBytes, bitIndex)];
+			found = curNode != 0;
+		}
+		if (found && m_nodes[curNode].numEntries) {
+			m_nodes[curNode].numEntries--;
+			retVal = true;
+		}
+	} else {
+		StringMap::iterator pos = m_unparsedEntries.find(ipRange);
+		if (pos != m_unparsedEntries.end()) {
+			if (--pos->second == 0)
+				m_unparsedEntries.erase(pos);
+			retVal = true;
+		}
+	}
+	return retVal;
+}
+
+void
+IPAddressTrie::Clear()
+{
+	m_nodes.clear();
+	m_nodes.push_back(TrieNode());
+	m_unparsedEntries.clear();
+}
+
+bool
+IPAddressTrie::IsMatch(const std::string &ipAddress) const
+{
+	if (!m_unparsedEntries.empty() && m_unparsedEntries.find(ipAddress) != m_unparsedEntries.end())
+		return true;
+
+	unsigned char addrBytes[IP_ADDRESS_NUM_BYTES];
+	if (!ParseAddress(ipAddress, addrBytes))
+		return false;
+
+	unsigned curNode = 0;
+	for (unsigned bitIndex = 0; bitIndex < IP_ADDRESS_NUM_BITS; bitIndex++) {
+		if (m_nodes[curNode].numEntries)
+			return true;
+		curNode = m_nodes[curNode].child[GetBit(addrBytes, bitIndex)];
+		if (!curNode)
+			return false;
+	}
+	return m_nodes[curNode].numEntries != 0;
+}
+
+bool
+IPAddressTrie::ParseAddress(const std::string &ipAddress, unsigned char *addrBytes)
+{
+	boost::system::error_code ec;
+	boost::asio::ip::address addr(boost::asio::ip::address::from_string(ipAddress, ec));
+	if (ec)
+		return false;
+
+	if (addr.is_v4()) {
+		boost::asio::ip::address_v4::bytes_type v4Bytes(addr.to_v4().to_bytes());
+		memset(addrBytes, 0, IP_ADDRESS_V4_OFFSET);
+		addrBytes[10] = addrBytes[11] = 0xFF;
+		memcpy(addrBytes + IP_ADDRESS_V4_OFFSET, v4Bytes.data(), v4Bytes.size());
+	} else {
+		boost::asio::ip::address_v6::bytes_type v6Bytes(addr.to_v6().to_bytes());
+		memcpy(addrBytes, v6Bytes.data(), IP_ADDRESS_NUM_BYTES);
+	}
+	return true;
+}
+
+bool
+IPAddressTrie::ParseRange(const std::string &ipRange, unsigned char *addrBytes, unsigned &prefixLen)
+{
+	string::size_type slashPos = ipRange.find('/');
+	if (!ParseAddress(ipRange.substr(0, slashPos), addrBytes))
+		return false;
+
+	prefixLen = IP_ADDRESS_NUM_BITS;
+	if (slashPos != string::npos) {
+		try {
+			prefixLen = boost::lexical_cast<unsigned>(ipRange.substr(slashPos + 1));
+		} catch (...) {
+			return false;
+		}
+		// IPv4 prefix lengths refer to the mapped part of the address.
+		bool isV4 = ipRange.find(':') == string::npos;
+		if (isV4) {
+			if (prefixLen > 32)
+				return false;
+			prefixLen += IP_ADDRESS_V4_OFFSET * 8;
+		} else if (prefixLen > IP_ADDRESS_NUM_BITS) {
+			return false;
+		}
+	}
+	return true;
+}
+
+unsigned
+IPAddressTrie::GetBit(const unsigned char *addrBytes, unsigned bitIndex)
+{
+	return (addrBytes[bitIndex / 8] >> (7 - bitIndex % 8)) & 1;
+}
@@ -0,0 +1,177 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <net/namepatternmatcher.h>
+#include <boost/algorithm/string/case_conv.hpp>
+
+using namespace std;
+
+#define NAME_PATTERN_REGEX_FLAGS	(boost::regex::extended | boost::regex::icase)
+// The alternatives of the combined regex do not need to mark sub-expressions.
+#define NAME_PATTERN_COMBINED_REGEX_FLAGS	(NAME_PATTERN_REGEX_FLAGS | boost::regex::nosubs)
+
+
+NamePatternMatcher::NamePatternMatcher()
+	: m_dirty(false)
+{
+}
+
+void
+NamePatternMatcher::Add(unsigned id, const std::string &pattern)
+{
+	Remove(id);
+	if (IsLiteralPattern(pattern)) {
+		string lowerPattern(boost::algorithm::to_lower_copy(pattern));
+		m_literals[lowerPattern]++;
+		m_literalPatterns[id] = lowerPattern;
+	} else {
+		// Validate the pattern before adding it. Back references would refer
+		// to the wrong group after combining the patterns.
+		if (HasBackReference(pattern))
+			throw boost::regex_error(boost::regex_constants::error_backref);
+		boost::regex tmpRegex(pattern, NAME_PATTERN_REGEX_FLAGS);
+		m_regexPatterns[id] = pattern;
+		m_dirty = true;
+	}
+}
+
+bool
+NamePatternMatcher::Remove(unsigned id)
+{
+	bool retVal = false;
+	PatternMap::iterator posLiteral = m_literalPatterns.find(id);
+	if (posLiteral != m_literalPatterns.end()) {
+		LiteralMap::iterator pos = m_literals.find(posLiteral->second);
+		if (pos != m_literals.end() && --pos->second == 0)
+			m_literals.erase(pos);
+		m_literalPatterns.erase(posLiteral);
+		retVal = true;
+	} else {
+		PatternMap::iterator posRegex = m_regexPatterns.find(id);
+		if (posRegex != m_regexPatterns.end()) {
+			m_regexPatterns.erase(posRegex);
+			m_dirty = true;
+			retVal = true;
+		}
+	}
+	return retVal;
+}
+
+void
+NamePatternMatcher::Clear()
+{
+	m_literals.clear();
+	m_literalPatterns.clear();
+	m_regexPatterns.clear();
+	m_combinedRegex.clear();
+	m_dirty = false;
+}
+
+bool
+NamePatternMatcher::IsMatch(const std::string &name) const
+{
+	if (!m_literals.empty() && m_literals.find(boost::algorithm::to_lower_copy(name)) != m_literals.end())
+		return true;
+
+	if (m_dirty)
+		Rebuild();
+	RegexVector::const_iterator i = m_combinedRegex.begin();
+	RegexVector::const_iterator end = m_combinedRegex.end();
+	while (i != end) {
+		if (regex_match(name, *i))
+			return true;
+		++i;
+	}
+	return false;
+}
+
+bool
+NamePatternMatcher::IsLiteralPattern(const std::string &pattern)
+{
+	return !pattern.empty() && pattern.find_first_of(".[]()*+?{}|^$\\") == string::npos;
+}
+
+bool
+NamePatternMatcher::HasBackReference(const std::string &pattern)
+{
+	string::size_type i = 0;
+	while (i < pattern.size()) {
+		if (pattern[i] == '[') {
+			// Skip the bracket expression, '\' is not special inside.
+			i++;
+			if (i < pattern.size() && pattern[i] == '^')
+				i++;
+			if (i < pattern.size() && pattern[i] == ']')
+				i++;
+			while (i < pattern.size() && pattern[i] != ']') {
+				if (pattern[i] == '[' && i + 1 < pattern.size()
+						&& (pattern[i + 1] == ':' || pattern[i + 1] == '.' || pattern[i + 1] == '=')) {
+					// Character class like [:alpha:].
+					string::size_type classEnd = pattern.find(string(1, pattern[i + 1]) + "]", i + 2);
+					if (classEnd == string::npos)
+						return false;
+					i = classEnd + 2;
+				} else
+					i++;
+			}
+		} else if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+			if (pattern[i + 1] >= '1' && pattern[i + 1] <= '9')
+				return true;
+			i++;
+		}
+		i++;
+	}
+	return false;
+}
+
+void
+NamePatternMatcher::Rebuild() const
+{
+	m_combinedRegex.clear();
+	string combinedPattern;
+	unsigned numPatterns = 0;
+	PatternMap::const_iterator i = m_regexPatterns.begin();
+	PatternMap::const_iterator end = m_regexPatterns.end();
+	while (i != end) {
+		if (numPatterns)
+			combinedPattern += "|";
+		combinedPattern += "(" + i->second + ")";
+		if (++numPatterns == NAME_PATTERN_REGEX_CHUNK_SIZE) {
+			m_combinedRegex.push_back(boost::regex(combinedPattern, NAME_PATTERN_COMBINED_REGEX_FLAGS));
+			combinedPattern.clear();
+			numPatterns = 0;
+		}
+		++i;
+	}
+	if (numPatterns)
+		m_combinedRegex.push_back(boost::regex(combinedPattern, NAME_PATTERN_COMBINED_REGEX_FLAGS));
+	m_dirty = false;
+}
@@ -34,12 +34,16 @@
 #include <net/webreceivebuffer.h>
 #include <net/websocketdata.h>
 
+#include <algorithm>
+
 using namespace std;
 
 ServerAcceptWebHelper::ServerAcceptWebHelper(ServerCallback &serverCallback, boost::shared_ptr<boost::asio::io_service> ioService,
-		const string &webSocketResource, const string &webSocketOrigin)
+		const string &webSocketResource, const string &webSocketOrigin,
+		const WebSocketDeflateSettings &deflateSettings, bool batchFrames)
 	: m_ioService(ioService), m_serverCallback(serverCallback),
-	  m_webSocketResource(webSocketResource), m_webSocketOrigin(webSocketOrigin)
+	  m_webSocketResource(webSocketResource), m_webSocketOrigin(webSocketOrigin),
+	  m_deflateSettings(deflateSettings), m_batchFrames(batchFrames)
 {
 	m_webSocketServer.reset(new server);
 }
@@ -56,6 +60,9 @@ ServerAcceptWebHelper::Listen(unsigned serverPort, bool /*ipv6*/, const std::str
 	m_webSocketServer->set_access_channels(websocketpp::log::alevel::all);
 #endif
 
+	// Compression is negotiated per connection, using these settings.
+	GetWebSocketDeflateSettings() = m_deflateSettings;
+
 	m_webSocketServer->init_asio(m_ioService.get());
 
 	m_webSocketServer->set_validate_handler(boost::bind(boost::mem_fn(&ServerAcceptWebHelper::validate), this, _1));
@@ -82,6 +89,12 @@ ServerAcceptWebHelper::validate(websocketpp::connection_hdl hdl)
 				(con->get_origin() != "null" &&
 				 (con->get_origin() == "http://" + m_webSocketOrigin || con->get_origin() == "http://www." + m_webSocketOrigin)))) {
 		retVal = true;
+		if (m_batchFrames) {
+			const vector<string> &subProtocols = con->get_requested_subprotocols();
+			if (find(subProtocols.begin(), subProtocols.end(), WEBSOCKET_BATCH_SUBPROTOCOL) != subProtocols.end()) {
+				con->select_subprotocol(WEBSOCKET_BATCH_SUBPROTOCOL);
+			}
+		}
 	}
 	return retVal;
 }
@@ -92,6 +105,7 @@ ServerAcceptWebHelper::on_open(websocketpp::connection_hdl hdl)
 	boost::shared_ptr<WebSocketData> webData(new WebSocketData);
 	webData->webSocketServer = m_webSocketServer;
 	webData->webHandle = hdl;
+	webData->batchFrames = m_webSocketServer->get_con_from_hdl(hdl)->get_subprotocol() == WEBSOCKET_BATCH_SUBPROTOCOL;
 	boost::shared_ptr<SessionData> sessionData(new SessionData(webData, m_lobbyThread->GetNextSessionId(), m_lobbyThread->GetSessionDataCallback(), *m_ioService, 0));
 	m_sessionMap.insert(make_pair(hdl, sessionData));
 	m_lobbyThread->AddConnection(sessionData);
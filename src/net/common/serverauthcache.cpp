@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <net/serverauthcache.h>
+#include <core/crypthelper.h>
+
+using namespace std;
+
+
+ServerAuthCache::ServerAuthCache(unsigned timeoutSec)
+	: m_timeoutSec(timeoutSec)
+{
+}
+
+string
+ServerAuthCache::GetSecretHash(const std::string &salt, const std::string &secret)
+{
+	SHA1Buf tmpHash;
+	CryptHelper::HMACSha1((const unsigned char *)salt.c_str(), (unsigned)salt.length(), (const unsigned char *)secret.c_str(), (unsigned)secret.length(), tmpHash);
+	return tmpHash.ToString();
+}
+
+string
+ServerAuthCache::GetSalt(const std::string &playerName) const
+{
+	string salt;
+	boost::mutex::scoped_lock lock(m_cacheMutex);
+	CacheMap::const_iterator pos = m_cacheMap.find(playerName);
+	if (pos != m_cacheMap.end() && !IsExpired(pos->second))
+		salt = pos->second.salt;
+	return salt;
+}
+
+bool
+ServerAuthCache::Get(const std::string &playerName, const std::string &salt, const std::string &secretHash, std::string &outSaltedPassword) const
+{
+	bool retVal = false;
+	boost::mutex::scoped_lock lock(m_cacheMutex);
+	CacheMap::const_iterator pos = m_cacheMap.find(playerName);
+	// The key is only valid for the salt which was sent to the client,
+	// and only as long as the password in the database is the same.
+	if (pos != m_cacheMap.end() && !IsExpired(pos->second) && pos->second.salt == salt
+			&& pos->second.secretHash == secretHash) {
+		outSaltedPassword = pos->second.saltedPassword;
+		retVal = true;
+	}
+	return retVal;
+}
+
+void
+ServerAuthCache::Store(const std::string &playerName, const std::string &salt, const std::string &secretHash, const std::string &saltedPassword)
+{
+	CacheEntry tmpEntry;
+	tmpEntry.salt = salt;
+	tmpEntry.secretHash = secretHash;
+	tmpEntry.saltedPassword = saltedPassword;
+
+	boost::mutex::scoped_lock lock(m_cacheMutex);
+	CacheMap::iterator pos = m_cacheMap.find(playerName);
+	if (pos != m_cacheMap.end()) {
+		// Keep the timeout of the first login, the entry should expire even for
+		// players who log in all the time.
+		if (IsExpired(pos->second) || pos->second.salt != salt || pos->second.secretHash != secretHash)
+			pos->second = tmpEntry;
+	} else {
+		m_cacheMap.insert(CacheMap::value_type(playerName, tmpEntry));
+	}
+}
+
+void
+ServerAuthCache::Remove(const std::string &playerName)
+{
+	boost::mutex::scoped_lock lock(m_cacheMutex);
+	m_cacheMap.erase(playerName);
+}
+
+void
+ServerAuthCache::RemoveExpired()
+{
+	boost::mutex::scoped_lock lock(m_cacheMutex);
+	CacheMap::iterator i = m_cacheMap.begin();
+	CacheMap::iterator end = m_cacheMap.end();
+	while (i != end) {
+		CacheMap::iterator next = i;
+		++next;
+		if (IsExpired(i->second))
+			m_cacheMap.erase(i);
+		i = next;
+	}
+}
+
+bool
+ServerAuthCache::IsExpired(const CacheEntry &entry) const
+{
+	return entry.timer.elapsed().total_seconds() >= (int)m_timeoutSec;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <boost/bind.hpp>
+
+#include <net/serverauthpool.h>
+#include <net/sessiondata.h>
+
+using namespace std;
+
+
+ServerAuthPool::ServerAuthPool(boost::shared_ptr<boost::asio::io_service> ioService, unsigned numThreads, unsigned maxPerAddress)
+	: m_ioService(ioService), m_numThreads(numThreads), m_maxPerAddress(maxPerAddress),
+	  m_curQueued(0), m_maxQueued(0), m_numSteps(0)
+{
+}
+
+ServerAuthPool::~ServerAuthPool()
+{
+	Stop();
+}
+
+void
+ServerAuthPool::Start()
+{
+	if (!m_work) {
+		m_workService.reset();
+		m_work.reset(new boost::asio::io_service::work(m_workService));
+		for (unsigned i = 0; i < m_numThreads; i++) {
+			m_threads.create_thread(boost::bind(&ServerAuthPool::RunThread, this));
+		}
+	}
+}
+
+void
+ServerAuthPool::Stop()
+{
+	if (m_work) {
+		m_work.reset();
+		m_workService.stop();
+		m_threads.join_all();
+	}
+}
+
+bool
+ServerAuthPool::AsyncAuthStep(boost::shared_ptr<SessionData> session, int stepNum, const std::string &inData, ResultHandler handler)
+{
+	{
+		boost::mutex::scoped_lock lock(m_queueMutex);
+		unsigned &addressCount = m_addressCount[session->GetClientAddr()];
+		if (m_maxPerAddress && addressCount >= m_maxPerAddress)
+			return false;
+		++addressCount;
+		++m_curQueued;
+		if (m_curQueued > m_maxQueued)
+			m_maxQueued = m_curQueued;
+	}
+	m_workService.post(boost::bind(&ServerAuthPool::InternalAuthStep, this, session, stepNum, inData, handler));
+	return true;
+}
+
+void
+ServerAuthPool::GetQueueStats(unsigned &curQueued, unsigned &maxQueued, unsigned &numSteps)
+{
+	boost::mutex::scoped_lock lock(m_queueMutex);
+	curQueued = m_curQueued;
+	maxQueued = m_maxQueued;
+	numSteps = m_numSteps;
+	m_maxQueued = m_curQueued;
+	m_numSteps = 0;
+}
+
+void
+ServerAuthPool::InternalAuthStep(boost::shared_ptr<SessionData> session, int stepNum, const std::string &inData, ResultHandler handler)
+{
+	bool result = session->AuthStep(stepNum, inData);
+	{
+		boost::mutex::scoped_lock lock(m_queueMutex);
+		AddressCountMap::iterator pos = m_addressCount.find(session->GetClientAddr());
+		if (pos != m_addressCount.end() && --pos->second == 0)
+			m_addressCount.erase(pos);
+		--m_curQueued;
+		++m_numSteps;
+	}
+	m_ioService->post(boost::bind(handler, session, result));
+}
+
+void
+ServerAuthPool::RunThread()
+{
+	m_workService.run();
+}
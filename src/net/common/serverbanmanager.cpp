@@ -68,6 +68,7 @@ ServerBanManager::BanPlayerName(const std::string &playerName, unsigned duration
 	tmpBan.timer = InternalRegisterTimedBan(banId, durationHours);
 	tmpBan.nameStr = playerName;
 	m_banPlayerNameMap[banId] = tmpBan;
+	m_banPlayerNames[playerName]++;
 }
 
 void
@@ -76,9 +77,11 @@ ServerBanManager::BanPlayerRegex(const string &playerRegex, unsigned durationHou
 	boost::mutex::scoped_lock lock(m_banMutex);
 	unsigned banId = GetNextBanId();
 
+	// Throws on invalid regex before the ban is registered.
+	m_banPlayerRegex.Add(banId, playerRegex);
 	TimedPlayerBan tmpBan;
 	tmpBan.timer = InternalRegisterTimedBan(banId, durationHours);
-	tmpBan.nameRegex = boost::regex(playerRegex, boost::regex::extended | boost::regex::icase);
+	tmpBan.nameRegex = playerRegex;
 	m_banPlayerNameMap[banId] = tmpBan;
 }
 
@@ -92,6 +95,7 @@ ServerBanManager::BanIPAddress(const string &ipAddress, unsigned durationHours)
 	tmpBan.timer = InternalRegisterTimedBan(banId, durationHours);
 	tmpBan.ipAddress = ipAddress;
 	m_banIPAddressMap[banId] = tmpBan;
+	m_banIPAddresses.Add(ipAddress);
 }
 
 bool
@@ -103,6 +107,13 @@ ServerBanManager::UnBan(unsigned banId)
 	if (posNick != m_banPlayerNameMap.end()) {
 		if (posNick->second.timer)
 			posNick->second.timer->cancel();
+		if (posNick->second.nameStr.empty()) {
+			m_banPlayerRegex.Remove(banId);
+		} else {
+			NameCountMap::iterator posName = m_banPlayerNames.find(posNick->second.nameStr);
+			if (posName != m_banPlayerNames.end() && --posName->second == 0)
+				m_banPlayerNames.erase(posName);
+		}
 		m_banPlayerNameMap.erase(posNick);
 		retVal = true;
 	} else {
@@ -110,6 +121,7 @@ ServerBanManager::UnBan(unsigned banId)
 		if (posIP != m_banIPAddressMap.end()) {
 			if (posIP->second.timer)
 				posIP->second.timer->cancel();
+			m_banIPAddresses.Remove(posIP->second.ipAddress);
 			m_banIPAddressMap.erase(posIP);
 			retVal = true;
 		}
@@ -126,7 +138,7 @@ ServerBanManager::GetBanList(list<string> &list) const
 	while (i_nick != end_nick) {
 		ostringstream banText;
 		if ((*i_nick).second.nameStr.empty())
-			banText << (*i_nick).first << ": (nickRegex) - " << (*i_nick).second.nameRegex.str();
+			banText << (*i_nick).first << ": (nickRegex) - " << (*i_nick).second.nameRegex;
 		else
 			banText << (*i_nick).first << ": (nickStr) - " << (*i_nick).second.nameStr;
 
@@ -152,7 +164,10 @@ ServerBanManager::ClearBanList()
 {
 	boost::mutex::scoped_lock lock(m_banMutex);
 	m_banPlayerNameMap.clear();
+	m_banPlayerNames.clear();
+	m_banPlayerRegex.Clear();
 	m_banIPAddressMap.clear();
+	m_banIPAddresses.Clear();
 }
 
 bool
@@ -172,72 +187,36 @@ ServerBanManager::IsAdminPlayer(DB_id playerId) const
 bool
 ServerBanManager::IsPlayerBanned(const std::string &name) const
 {
-	bool retVal = false;
 	boost::mutex::scoped_lock lock(m_banMutex);
-	RegexMap::const_iterator i = m_banPlayerNameMap.begin();
-	RegexMap::const_iterator end = m_banPlayerNameMap.end();
-	while (i != end) {
-		// Use regex only if name not set.
-		if ((*i).second.nameStr.empty()) {
-			if (regex_match(name, (*i).second.nameRegex)) {
-				retVal = true;
-				break;
-			}
-		} else {
-			if (name == (*i).second.nameStr) {
-				retVal = true;
-				break;
-			}
-		}
-		++i;
-	}
-
-	return retVal;
+	return m_banPlayerNames.find(name) != m_banPlayerNames.end()
+		   || m_banPlayerRegex.IsMatch(name);
 }
 
 bool
 ServerBanManager::IsIPAddressBanned(const std::string &ipAddress) const
 {
-	bool retVal = false;
 	boost::mutex::scoped_lock lock(m_banMutex);
-	IPAddressMap::const_iterator i = m_banIPAddressMap.begin();
-	IPAddressMap::const_iterator end = m_banIPAddressMap.end();
-	while (i != end) {
-		if (ipAddress == (*i).second.ipAddress) {
-			retVal = true;
-			break;
-		}
-		++i;
-	}
-
-	return retVal;
+	return m_banIPAddresses.IsMatch(ipAddress);
 }
 
 void
 ServerBanManager::InitGameNameBadWordList(const std::list<string> &badWordList)
 {
+	unsigned patternId = 0;
 	list<string>::const_iterator i = badWordList.begin();
 	list<string>::const_iterator end = badWordList.end();
 	while (i != end) {
-		m_gameNameBadWordFilter.push_back(boost::regex(*i, boost::regex::extended | boost::regex::icase));
+		m_gameNameBadWordFilter.Add(patternId++, *i);
 		++i;
 	}
+	// Compile the combined patterns now, lookups are done without lock.
+	m_gameNameBadWordFilter.IsMatch(string());
 }
 
 bool
 ServerBanManager::IsBadGameName(const std::string &name) const
 {
-	bool retVal = false;
-	RegexList::const_iterator i = m_gameNameBadWordFilter.begin();
-	RegexList::const_iterator end = m_gameNameBadWordFilter.end();
-	while (i != end) {
-		if (regex_match(name, *i)) {
-			retVal = true;
-			break;
-		}
-		++i;
-	}
-	return retVal;
+	return m_gameNameBadWordFilter.IsMatch(name);
 }
 
 boost::shared_ptr<boost::asio::steady_timer>
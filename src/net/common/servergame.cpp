@@ -38,6 +38,7 @@
 #include <net/serverlobbythread.h>
 #include <net/serverexception.h>
 #include <net/senderhelper.h>
+#include <net/serverspectatorfanout.h>
 #include <net/socket_msg.h>
 #include <core/loghelper.h>
 #include <db/serverdbinterface.h>
@@ -74,6 +75,8 @@ ServerGame::ServerGame(boost::shared_ptr<ServerLobbyThread> lobbyThread, u_int32
 	  m_stateTimer1(lobbyThread->GetIOService()), m_stateTimer2(lobbyThread->GetIOService()),
 	  m_isNameReported(false)
 {
+	if (lobbyThread->GetSpectatorFanout())
+		m_spectatorChannel = lobbyThread->GetSpectatorFanout()->CreateChannel();
 	LOG_VERBOSE("Game object " << GetId() << " created.");
 }
 
@@ -185,13 +188,49 @@ ServerGame::GetCurRound() const
 void
 ServerGame::SendToAllPlayers(boost::shared_ptr<NetPacket> packet, int state)
 {
-	GetSessionManager().SendToAllSessions(GetLobbyThread().GetSender(), packet, state);
+	if (m_spectatorChannel && (state & SessionData::Spectating) != 0) {
+		// Players are served directly, spectators by the fan-out threads.
+		GetSessionManager().SendToAllSessions(GetLobbyThread().GetSender(), packet, state & ~SessionData::Spectating);
+		m_spectatorChannel->Publish(GetSessionManager().GetSessionList(SessionData::Spectating), packet);
+	} else {
+		GetSessionManager().SendToAllSessions(GetLobbyThread().GetSender(), packet, state);
+	}
 }
 
 void
 ServerGame::SendToAllButOnePlayers(boost::shared_ptr<NetPacket> packet, SessionId except, int state)
 {
-	GetSessionManager().SendToAllButOneSessions(GetLobbyThread().GetSender(), packet, except, state);
+	if (m_spectatorChannel && (state & SessionData::Spectating) != 0) {
+		// Use the same path as SendToAllPlayers, to keep the packet order for spectators.
+		GetSessionManager().SendToAllButOneSessions(GetLobbyThread().GetSender(), packet, except, state & ~SessionData::Spectating);
+		SessionDataList spectatorList(GetSessionManager().GetSessionList(SessionData::Spectating));
+		SessionDataList::iterator i = spectatorList.begin();
+		while (i != spectatorList.end()) {
+			if ((*i)->GetId() == except)
+				i = spectatorList.erase(i);
+			else
+				++i;
+		}
+		m_spectatorChannel->Publish(spectatorList, packet);
+	} else {
+		GetSessionManager().SendToAllButOneSessions(GetLobbyThread().GetSender(), packet, except, state);
+	}
+}
+
+void
+ServerGame::SendToSession(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet)
+{
+	// Spectators need to receive the packets of the fan-out threads first.
+	if (session->GetState() == SessionData::Spectating || session->GetState() == SessionData::SpectatorWaiting)
+		FlushSpectatorData();
+	GetLobbyThread().GetSender().Send(session, packet);
+}
+
+void
+ServerGame::FlushSpectatorData()
+{
+	if (m_spectatorChannel)
+		m_spectatorChannel->Flush();
 }
 
 void
@@ -429,6 +468,53 @@ ServerGame::ReplaceRankingPlayer(unsigned oldPlayerId, unsigned newPlayerId)
 	}
 }
 
+boost::shared_ptr<NetPacket>
+ServerGame::GetGameSnapshot() const
+{
+	return m_gameSnapshot;
+}
+
+void
+ServerGame::SetGameSnapshot(boost::shared_ptr<NetPacket> packet)
+{
+	m_gameSnapshot = packet;
+}
+
+void
+ServerGame::ReplaceGameSnapshotPlayer(unsigned oldPlayerId, unsigned newPlayerId)
+{
+	// Patch a copy of the cached snapshot instead of building it again for every rejoin.
+	// The cached packet may still be referenced by a send queue, so it is never modified.
+	if (m_gameSnapshot) {
+		m_gameSnapshot = CopyGameSnapshotReplacePlayer(*m_gameSnapshot, oldPlayerId, newPlayerId);
+	}
+}
+
+boost::shared_ptr<NetPacket>
+ServerGame::CopyGameSnapshotReplacePlayer(const NetPacket &snapshot, unsigned oldPlayerId, unsigned newPlayerId)
+{
+	boost::shared_ptr<NetPacket> packet(new NetPacket);
+	packet->GetMsg()->CopyFrom(*snapshot.GetMsg());
+	GameStartRejoinMessage *netGameStart =
+		packet->GetMsg()->mutable_gamemessage()->mutable_gamemanagementmessage()->mutable_gamestartrejoinmessage();
+	if (netGameStart->startdealerplayerid() == oldPlayerId) {
+		netGameStart->set_startdealerplayerid(newPlayerId);
+	}
+	for (int i = 0; i < netGameStart->rejoinplayerdata_size(); i++) {
+		GameStartRejoinMessage::RejoinPlayerData *playerSlot = netGameStart->mutable_rejoinplayerdata(i);
+		if (playerSlot->playerid() == oldPlayerId) {
+			playerSlot->set_playerid(newPlayerId);
+		}
+	}
+	return packet;
+}
+
+void
+ServerGame::InvalidateGameSnapshot()
+{
+	m_gameSnapshot.reset();
+}
+
 void
 ServerGame::StoreAndResetRanking()
 {
@@ -555,7 +641,7 @@ ServerGame::InternalDenyAskVoteKick(boost::shared_ptr<SessionData> byWhom, unsig
 	AskKickDeniedMessage *netKickDenied = netManage->mutable_askkickdeniedmessage();
 	netKickDenied->set_playerid(playerIdWho);
 	netKickDenied->set_kickdeniedreason(static_cast<AskKickDeniedMessage::KickDeniedReason>(reason));
-	GetLobbyThread().GetSender().Send(byWhom, packet);
+	SendToSession(byWhom, packet);
 }
 
 void
@@ -614,7 +700,7 @@ ServerGame::InternalDenyVoteKick(boost::shared_ptr<SessionData> byWhom, unsigned
 		netVoteReply->set_votekickreplytype(VoteKickReplyMessage::voteKickDeniedInvalid);
 		break;
 	}
-	GetLobbyThread().GetSender().Send(byWhom, packet);
+	SendToSession(byWhom, packet);
 }
 
 PlayerDataList
@@ -890,6 +976,9 @@ ServerGame::RemoveSession(boost::shared_ptr<SessionData> session, int reason)
 	if (!session)
 		throw ServerException(__FILE__, __LINE__, ERR_NET_INVALID_SESSION, 0);
 
+	// The session may still have pending game data, which needs to be sent
+	// before the notifications about leaving the game.
+	FlushSpectatorData();
 	if (GetSessionManager().RemoveSession(session->GetId())) {
 		boost::shared_ptr<PlayerData> tmpPlayerData = session->GetPlayerData();
 		if (tmpPlayerData && !tmpPlayerData->GetName().empty()) {
@@ -957,7 +1046,7 @@ ServerGame::RemovePlayerData(boost::shared_ptr<PlayerData> player, int reason, b
 		netPlayerLeft->set_playerid(player->GetUniqueId());
 		netPlayerLeft->set_gameplayerleftreason(netReason);
 	}
-	GetSessionManager().SendToAllSessions(GetLobbyThread().GetSender(), thisPlayerLeft, SessionData::Game | SessionData::Spectating | SessionData::SpectatorWaiting);
+	SendToAllPlayers(thisPlayerLeft, SessionData::Game | SessionData::Spectating | SessionData::SpectatorWaiting);
 
 	GetState().NotifySessionRemoved(shared_from_this());
 	if (spectateOnly) {
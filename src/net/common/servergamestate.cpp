@@ -66,7 +66,6 @@ using namespace boost::chrono;
 #define SERVER_GAME_FORCED_TIMEOUT_FACTOR			60
 #define SERVER_VOTE_KICK_TIMEOUT_SEC				30
 #define SERVER_LOOP_DELAY_MSEC						50
-#define SERVER_MAX_NUM_SPECTATORS_PER_GAME			100
 
 // Helper functions
 
@@ -310,7 +309,7 @@ AbstractServerGameStateReceiving::HandleGameManagementMsg(boost::shared_ptr<Serv
 			netManage->set_messagetype(GameManagementMessage::Type_ChatRejectMessage);
 			ChatRejectMessage *netReject = netManage->mutable_chatrejectmessage();
 			netReject->set_chattext(netChatRequest.chattext());
-			server->GetLobbyThread().GetSender().Send(session, packet);
+			server->SendToSession(session, packet);
 		}
 	} else {
 		// Message processing in subclass.
@@ -415,14 +414,14 @@ AbstractServerGameStateReceiving::AcceptNewSession(boost::shared_ptr<ServerGame>
 	session->GetPlayerData()->SetGameAdmin(session->GetPlayerData()->GetUniqueId() == server->GetAdminPlayerId());
 
 	// Send ack to client.
-	server->GetLobbyThread().GetSender().Send(session, CreateNetPacketJoinGameAck(*server, *session->GetPlayerData(), spectateOnly));
+	server->SendToSession(session, CreateNetPacketJoinGameAck(*server, *session->GetPlayerData(), spectateOnly));
 
 	// Send notifications for connected players to client.
 	PlayerDataList tmpPlayerList(server->GetFullPlayerDataList());
 	PlayerDataList::iterator player_i = tmpPlayerList.begin();
 	PlayerDataList::iterator player_end = tmpPlayerList.end();
 	while (player_i != player_end) {
-		server->GetLobbyThread().GetSender().Send(session, CreateNetPacketPlayerJoined(server->GetId(), *(*player_i)));
+		server->SendToSession(session, CreateNetPacketPlayerJoined(server->GetId(), *(*player_i)));
 		++player_i;
 	}
 
@@ -431,7 +430,7 @@ AbstractServerGameStateReceiving::AcceptNewSession(boost::shared_ptr<ServerGame>
 	PlayerDataList::iterator spectator_i = tmpSpectatorList.begin();
 	PlayerDataList::iterator spectator_end = tmpSpectatorList.end();
 	while (spectator_i != spectator_end) {
-		server->GetLobbyThread().GetSender().Send(session, CreateNetPacketSpectatorJoined(server->GetId(), *(*spectator_i)));
+		server->SendToSession(session, CreateNetPacketSpectatorJoined(server->GetId(), *(*spectator_i)));
 		++spectator_i;
 	}
 
@@ -521,7 +520,7 @@ void
 ServerGameStateInit::HandleNewSpectator(boost::shared_ptr<ServerGame> server, boost::shared_ptr<SessionData> session)
 {
 	if (session && session->GetPlayerData()) {
-		if (server->GetSpectatorIdList().size() >= SERVER_MAX_NUM_SPECTATORS_PER_GAME) {
+		if (server->GetSpectatorIdList().size() >= server->GetLobbyThread().GetMaxSpectatorsPerGame()) {
 			server->MoveSessionToLobby(session, NTF_NET_REMOVED_GAME_FULL);
 		} else {
 			AcceptNewSession(server, session, true);
@@ -593,7 +592,7 @@ ServerGameStateInit::TimerAdminWarning(const boost::system::error_code &ec, boos
 			TimeoutWarningMessage *netWarning = netManage->mutable_timeoutwarningmessage();
 			netWarning->set_timeoutreason(TimeoutWarningMessage::timeoutInactiveGame);
 			netWarning->set_remainingseconds(SERVER_GAME_ADMIN_WARNING_REMAINING_SEC);
-			server->GetLobbyThread().GetSender().Send(session, packet);
+			server->SendToSession(session, packet);
 		}
 		// Start timeout timer.
 		server->GetStateTimer1().expires_from_now(
@@ -865,7 +864,7 @@ AbstractServerGameStateRunning::HandleNewPlayer(boost::shared_ptr<ServerGame> se
 			netStartEvent->set_starteventtype(StartEventMessage::rejoinEvent);
 
 			// Wait for rejoining player to confirm start of game.
-			server->GetLobbyThread().GetSender().Send(session, packet);
+			server->SendToSession(session, packet);
 		} else {
 			// Do not accept "new" sessions in this state, only rejoin is allowed.
 			server->MoveSessionToLobby(session, NTF_NET_REMOVED_ALREADY_RUNNING);
@@ -1230,6 +1229,9 @@ ServerGameStateHand::StartNewHand(boost::shared_ptr<ServerGame> server)
 {
 	Game &curGame = server->GetGame();
 
+	// The game data of the previous hand is no longer valid.
+	server->InvalidateGameSnapshot();
+
 	// Reactivate players which were previously inactive.
 	ReactivatePlayers(server);
 
@@ -1294,7 +1296,7 @@ ServerGameStateHand::StartNewHand(boost::shared_ptr<ServerGame> server)
 			}
 
 			if (!errorFlag) {
-				server->GetLobbyThread().GetSender().Send(tmpSession, notifyCards);
+				server->SendToSession(tmpSession, notifyCards);
 			}
 		}
 		++i;
@@ -1388,7 +1390,7 @@ ServerGameStateHand::CheckPlayerTimeouts(boost::shared_ptr<ServerGame> server)
 						TimeoutWarningMessage *netWarning = netManage->mutable_timeoutwarningmessage();
 						netWarning->set_timeoutreason(TimeoutWarningMessage::timeoutKickAfterAutofold);
 						netWarning->set_remainingseconds(actionTimeout * SERVER_GAME_FORCED_TIMEOUT_FACTOR - tmpPlayer->getTimeSecSinceLastRemoteAction());
-						server->GetLobbyThread().GetSender().Send(session, packet);
+						server->SendToSession(session, packet);
 					}
 				}
 				if ((int)tmpPlayer->getTimeSecSinceLastRemoteAction() >= actionTimeout * SERVER_GAME_FORCED_TIMEOUT_FACTOR) {
@@ -1471,6 +1473,8 @@ ServerGameStateHand::PerformRejoin(boost::shared_ptr<ServerGame> server, boost::
 		curGame.replaceDealer(rejoinPlayer->getMyUniqueID(), session->GetPlayerData()->GetUniqueId());
 		// Update the ranking map.
 		server->ReplaceRankingPlayer(rejoinPlayer->getMyUniqueID(), session->GetPlayerData()->GetUniqueId());
+		// Update the cached game data.
+		server->ReplaceGameSnapshotPlayer(rejoinPlayer->getMyUniqueID(), session->GetPlayerData()->GetUniqueId());
 		// Change the Id in the poker engine.
 		rejoinPlayer->setMyUniqueID(session->GetPlayerData()->GetUniqueId());
 		rejoinPlayer->setMyGuid(session->GetPlayerData()->GetGuid());
@@ -1485,12 +1489,24 @@ ServerGameStateHand::PerformRejoin(boost::shared_ptr<ServerGame> server, boost::
 void
 ServerGameStateHand::SendGameData(boost::shared_ptr<ServerGame> server, boost::shared_ptr<SessionData> session)
 {
-	Game &curGame = server->GetGame();
-	// Send game start notification to rejoining client.
+	// All rejoining players and new spectators of a hand receive the same data, build it only once.
+	boost::shared_ptr<NetPacket> packet(server->GetGameSnapshot());
+	if (!packet) {
+		packet = CreateNetPacketGameSnapshot(*server);
+		server->SetGameSnapshot(packet);
+	}
+	server->SendToSession(session, packet);
+}
+
+boost::shared_ptr<NetPacket>
+ServerGameStateHand::CreateNetPacketGameSnapshot(ServerGame &server)
+{
+	Game &curGame = server.GetGame();
+	// Game start notification for rejoining clients.
 	boost::shared_ptr<NetPacket> packet(new NetPacket);
 	packet->GetMsg()->set_messagetype(PokerTHMessage::Type_GameMessage);
 	GameMessage *netGame = packet->GetMsg()->mutable_gamemessage();
-	netGame->set_gameid(server->GetId());
+	netGame->set_gameid(server.GetId());
 	netGame->set_messagetype(GameMessage::Type_GameManagementMessage);
 	GameManagementMessage *netManage = netGame->mutable_gamemanagementmessage();
 	netManage->set_messagetype(GameManagementMessage::Type_GameStartRejoinMessage);
@@ -1500,7 +1516,7 @@ ServerGameStateHand::SendGameData(boost::shared_ptr<ServerGame> server, boost::s
 	PlayerListIterator player_i = curGame.getSeatsList()->begin();
 	PlayerListIterator player_end = curGame.getSeatsList()->end();
 	int player_count = 0;
-	while (player_i != player_end && player_count < server->GetStartData().numberOfPlayers) {
+	while (player_i != player_end && player_count < server.GetStartData().numberOfPlayers) {
 		boost::shared_ptr<PlayerInterface> tmpPlayer = *player_i;
 		GameStartRejoinMessage::RejoinPlayerData *playerSlot = netGameStart->add_rejoinplayerdata();
 		playerSlot->set_playerid(tmpPlayer->getMyUniqueID());
@@ -1508,8 +1524,7 @@ ServerGameStateHand::SendGameData(boost::shared_ptr<ServerGame> server, boost::s
 		++player_i;
 		++player_count;
 	}
-
-	server->GetLobbyThread().GetSender().Send(session, packet);
+	return packet;
 }
 
 //-----------------------------------------------------------------------------
@@ -1621,7 +1636,7 @@ ServerGameStateWaitPlayerAction::InternalHandleGameEngineMsg(boost::shared_ptr<S
 			netActionRejected->set_youraction(netMyAction.myaction());
 			netActionRejected->set_yourrelativebet(netMyAction.myrelativebet());
 			netActionRejected->set_rejectionreason(static_cast<YourActionRejectedMessage::RejectionReason>(code));
-			server->GetLobbyThread().GetSender().Send(session, reject);
+			server->SendToSession(session, reject);
 		}
 	}
 }
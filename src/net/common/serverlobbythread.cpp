@@ -38,6 +38,9 @@
 #include <net/serverircbotcallback.h>
 #include <net/socket_msg.h>
 #include <net/chatcleanermanager.h>
+#include <net/serverspectatorfanout.h>
+#include <net/serverauthpool.h>
+#include <net/serverauthcache.h>
 #include <net/net_helper.h>
 #include <db/serverdbinterface.h>
 #ifdef POKERTH_OFFICIAL_SERVER
@@ -63,8 +66,16 @@
 #include <boost/algorithm/string.hpp>
 #include <gsasl.h>
 
-#define SERVER_MAX_NUM_LOBBY_SESSIONS				512		// Maximum number of idle users in lobby.
-#define SERVER_MAX_NUM_TOTAL_SESSIONS				2000	// Total maximum of sessions, fitting a 2048 handle limit
+#define SERVER_MAX_NUM_LOBBY_SESSIONS				512		// Default maximum number of idle users in lobby.
+#define SERVER_MAX_NUM_TOTAL_SESSIONS				2000	// Default total maximum of sessions, fitting a 2048 handle limit
+#define SERVER_SPECTATOR_TICK_MSEC					100		// Default interval for sending data to spectators.
+#define SERVER_MAX_NUM_SPECTATORS_PER_GAME			1000	// Default maximum number of spectators per game.
+#define SERVER_SPECTATOR_FANOUT_THREADS				1		// Default number of threads sending data to spectators.
+#define SERVER_AUTH_THREADS							2		// Default number of threads for authentication steps.
+#define SERVER_AUTH_MAX_PER_ADDRESS					4		// Default maximum of queued authentication steps per client address.
+#define SERVER_AUTH_CACHE_TIMEOUT_SEC				900		// Default lifetime of cached login keys.
+#define SERVER_SCRAM_ITERATIONS						"4096"
+#define SERVER_SCRAM_SALT_SIZE						12
 
 #define SERVER_SAVE_STATISTICS_INTERVAL_SEC			60
 #define SERVER_CHECK_SESSION_TIMEOUTS_INTERVAL_MSEC	500
@@ -101,6 +112,37 @@ using namespace std::chrono;
 using namespace boost::chrono;
 #endif
 
+// Provide the SCRAM parameters, so that the derived key can be cached.
+static int
+AuthPropertyCallback(Gsasl *ctx, Gsasl_session *sctx, Gsasl_property prop)
+{
+	int retVal = GSASL_NO_CALLBACK;
+	ServerAuthCache *authCache = static_cast<ServerAuthCache *>(gsasl_callback_hook_get(ctx));
+	if (prop == GSASL_SCRAM_ITER) {
+		gsasl_property_set(sctx, GSASL_SCRAM_ITER, SERVER_SCRAM_ITERATIONS);
+		retVal = GSASL_OK;
+	} else if (prop == GSASL_SCRAM_SALT && authCache) {
+		// Reuse the salt of a cached login, otherwise create a new one.
+		const char *authId = gsasl_property_fast(sctx, GSASL_AUTHID);
+		string salt(authCache->GetSalt(authId ? authId : ""));
+		if (salt.empty()) {
+			char nonce[SERVER_SCRAM_SALT_SIZE];
+			char *base64Salt = NULL;
+			size_t base64Size = 0;
+			if (gsasl_nonce(nonce, sizeof(nonce)) == GSASL_OK
+					&& gsasl_base64_to(nonce, sizeof(nonce), &base64Salt, &base64Size) == GSASL_OK) {
+				salt = string(base64Salt, base64Size);
+			}
+			gsasl_free(base64Salt);
+		}
+		if (!salt.empty()) {
+			gsasl_property_set(sctx, GSASL_SCRAM_SALT, salt.c_str());
+			retVal = GSASL_OK;
+		}
+	}
+	return retVal;
+}
+
 class InternalServerCallback : public SessionDataCallback, public ChatCleanerCallback, public ServerDBCallback
 {
 public:
@@ -127,6 +169,11 @@ public:
 		m_server.DispatchPacket(session, packet);
 	}
 
+	virtual unsigned GetSpectatorFlushDelayMsec() const
+	{
+		return m_server.m_spectatorTickMsec;
+	}
+
 	virtual void SignalChatBotMessage(const string &msg)
 	{
 		m_server.SendChatBotMsg(msg);
@@ -251,6 +298,8 @@ ServerLobbyThread::ServerLobbyThread(GuiInterface &gui, ServerMode mode, ServerI
 									 AvatarManager &avatarManager, boost::shared_ptr<boost::asio::io_service> ioService)
 	: m_ioService(ioService), m_authContext(NULL), m_gui(gui), m_ircBotCb(ircBotCb), m_avatarManager(avatarManager),
 	  m_mode(mode), m_serverConfig(serverConfig), m_curGameId(0), m_curUniquePlayerId(0), m_curSessionId(INVALID_SESSION + 1),
+	  m_maxLobbySessions(SERVER_MAX_NUM_LOBBY_SESSIONS), m_maxTotalSessions(SERVER_MAX_NUM_TOTAL_SESSIONS),
+	  m_spectatorTickMsec(SERVER_SPECTATOR_TICK_MSEC), m_maxSpectatorsPerGame(SERVER_MAX_NUM_SPECTATORS_PER_GAME),
 	  m_statDataChanged(false), m_removeGameTimer(*ioService),
 	  m_saveStatisticsTimer(*ioService), m_loginLockTimer(*ioService),
 	  m_startTime(boost::posix_time::second_clock::local_time())
@@ -287,6 +336,41 @@ ServerLobbyThread::Init(const string &logDir)
 		m_serverConfig.readConfigString("DBServerEncryptionKey"));
 	m_database->AsyncQueryAdminPlayers(0);
 
+	// Session limits, 0 means default.
+	int maxLobbySessions = m_serverConfig.readConfigInt("ServerMaxLobbySessions");
+	int maxTotalSessions = m_serverConfig.readConfigInt("ServerMaxSessions");
+	if (maxLobbySessions > 0)
+		m_maxLobbySessions = maxLobbySessions;
+	if (maxTotalSessions > 0)
+		m_maxTotalSessions = maxTotalSessions;
+	// Spectators receive their data in ticks, 0 means no delay.
+	int spectatorTickMsec = m_serverConfig.readConfigInt("ServerSpectatorTickMsec");
+	if (spectatorTickMsec >= 0)
+		m_spectatorTickMsec = spectatorTickMsec;
+	int maxSpectatorsPerGame = m_serverConfig.readConfigInt("ServerMaxSpectatorsPerGame");
+	if (maxSpectatorsPerGame > 0)
+		m_maxSpectatorsPerGame = maxSpectatorsPerGame;
+	// Data for spectators is copied by separate threads, 0 threads means the game thread copies it.
+	int spectatorThreads = m_serverConfig.readConfigInt("ServerSpectatorThreads");
+	if (spectatorThreads < 0)
+		spectatorThreads = SERVER_SPECTATOR_FANOUT_THREADS;
+	m_spectatorFanout.reset(new ServerSpectatorFanout(spectatorThreads));
+	// Authentication steps are performed by separate threads, 0 threads means the lobby thread does it.
+	int authThreads = m_serverConfig.readConfigInt("ServerAuthThreads");
+	int authMaxPerAddress = m_serverConfig.readConfigInt("ServerAuthMaxPerAddress");
+	if (authThreads < 0)
+		authThreads = SERVER_AUTH_THREADS;
+	if (authMaxPerAddress < 0)
+		authMaxPerAddress = SERVER_AUTH_MAX_PER_ADDRESS;
+	if (authThreads > 0)
+		m_authPool.reset(new ServerAuthPool(m_ioService, authThreads, authMaxPerAddress));
+	// Login keys of registered players are cached, 0 disables the cache.
+	int authCacheTimeoutSec = m_serverConfig.readConfigInt("ServerAuthCacheTimeoutSec");
+	if (authCacheTimeoutSec < 0)
+		authCacheTimeoutSec = SERVER_AUTH_CACHE_TIMEOUT_SEC;
+	if (authCacheTimeoutSec > 0)
+		m_authCache.reset(new ServerAuthCache(authCacheTimeoutSec));
+
 	GetBanManager().InitGameNameBadWordList(m_serverConfig.readConfigStringList("GameNameBadWordList"));
 }
 
@@ -311,8 +395,8 @@ ServerLobbyThread::AddConnection(boost::shared_ptr<SessionData> sessionData)
 
 	unsigned numLobbySessions = m_sessionManager.GetRawSessionCount();
 	unsigned numGameSessions = m_gameSessionManager.GetRawSessionCount();
-	if (numLobbySessions <= SERVER_MAX_NUM_LOBBY_SESSIONS
-			&& numLobbySessions + numGameSessions <= SERVER_MAX_NUM_TOTAL_SESSIONS) {
+	if (numLobbySessions <= m_maxLobbySessions
+			&& numLobbySessions + numGameSessions <= m_maxTotalSessions) {
 		string ipAddress = sessionData->GetRemoteIPAddressFromSocket();
 		if (!ipAddress.empty()) {
 			sessionData->SetClientAddr(ipAddress);
@@ -801,6 +885,18 @@ ServerLobbyThread::GetSessionDataCallback()
 	return *m_internalServerCallback;
 }
 
+boost::shared_ptr<ServerSpectatorFanout>
+ServerLobbyThread::GetSpectatorFanout()
+{
+	return m_spectatorFanout;
+}
+
+unsigned
+ServerLobbyThread::GetMaxSpectatorsPerGame() const
+{
+	return m_maxSpectatorsPerGame;
+}
+
 u_int32_t
 ServerLobbyThread::GetNextSessionId()
 {
@@ -837,6 +933,12 @@ ServerLobbyThread::Main()
 		InitChatCleaner();
 		// Start database engine.
 		m_database->Start();
+		// Start spectator threads.
+		if (m_spectatorFanout)
+			m_spectatorFanout->Start();
+		// Start authentication threads.
+		if (m_authPool)
+			m_authPool->Start();
 		// Register all timers.
 		RegisterTimers();
 
@@ -858,6 +960,12 @@ ServerLobbyThread::Main()
 	CancelTimers();
 	// Stop database engine.
 	m_database->Stop();
+	m_chatCleanerManager->Stop();
+	if (m_spectatorFanout)
+		m_spectatorFanout->Stop();
+	// Authentication threads use the auth context.
+	if (m_authPool)
+		m_authPool->Stop();
 
 	ClearAuthContext();
 }
@@ -904,6 +1012,10 @@ ServerLobbyThread::InitAuthContext()
 		gsasl_done(m_authContext);
 		throw ServerException(__FILE__, __LINE__, ERR_NET_GSASL_NO_SCRAM, 0);
 	}
+	if (m_authCache) {
+		gsasl_callback_hook_set(m_authContext, m_authCache.get());
+		gsasl_callback_set(m_authContext, AuthPropertyCallback);
+	}
 }
 
 void
@@ -916,7 +1028,11 @@ ServerLobbyThread::ClearAuthContext()
 void
 ServerLobbyThread::InitChatCleaner()
 {
-	if (m_serverConfig.readConfigInt("UseChatCleaner") != 0) {
+	// 1: Use chatcleaner process, 2: Filter chat within the server process.
+	int chatCleanerMode = m_serverConfig.readConfigInt("UseChatCleaner");
+	if (chatCleanerMode == 2) {
+		m_chatCleanerManager->InitLocal();
+	} else if (chatCleanerMode != 0) {
 		m_chatCleanerManager->Init(
 			m_serverConfig.readConfigString("ChatCleanerHostAddress"),
 			m_serverConfig.readConfigInt("ChatCleanerPort"),
@@ -1158,9 +1274,28 @@ ServerLobbyThread::HandleNetPacketAuthClientRequest(boost::shared_ptr<SessionDat
 void
 ServerLobbyThread::HandleNetPacketAuthClientResponse(boost::shared_ptr<SessionData> session, const AuthClientResponseMessage &clientResponse)
 {
-	if (session && session->GetPlayerData() && session->AuthGetCurStepNum() == 1) {
+	// Ignore duplicate responses while the step is performed.
+	if (session && session->GetPlayerData() && session->AuthGetCurStepNum() == 1 && session->AuthStartStep()) {
 		string authData = clientResponse.clientresponse();
-		if (session->AuthStep(2, authData)) {
+		if (m_authPool) {
+			if (!m_authPool->AsyncAuthStep(session, 2, authData,
+										   boost::bind(&ServerLobbyThread::AuthClientResponseResult, shared_from_this(), _1, _2))) {
+				session->AuthEndStep();
+				SessionError(session, ERR_NET_INIT_BLOCKED);
+			}
+		} else {
+			AuthClientResponseResult(session, session->AuthStep(2, authData));
+		}
+	}
+}
+
+void
+ServerLobbyThread::AuthClientResponseResult(boost::shared_ptr<SessionData> session, bool authOk)
+{
+	if (session)
+		session->AuthEndStep();
+	if (session && session->GetPlayerData() && session->GetState() != SessionData::Closed) {
+		if (authOk) {
 			string outVerification(session->AuthGetNextOutMsg());
 
 			boost::shared_ptr<NetPacket> packet(new NetPacket);
@@ -1176,9 +1311,17 @@ ServerLobbyThread::HandleNetPacketAuthClientResponse(boost::shared_ptr<SessionDa
 			if (GetBanManager().IsAdminPlayer(tmpPlayerData->GetDBId())) {
 				session->GetPlayerData()->SetRights(PLAYER_RIGHTS_ADMIN);
 			}
+			if (m_authCache && !session->AuthGetSaltedPassword().empty()) {
+				m_authCache->Store(tmpPlayerData->GetName(), session->AuthGetSalt(),
+								   ServerAuthCache::GetSecretHash(session->AuthGetSalt(), session->AuthGetPassword()), session->AuthGetSaltedPassword());
+			}
 			CheckAvatarBlacklist(session);
-		} else
+		} else {
+			// The password may have changed, do not use the cached key again.
+			if (m_authCache)
+				m_authCache->Remove(session->GetPlayerData()->GetName());
 			SessionError(session, ERR_NET_INVALID_PASSWORD);
+		}
 	}
 }
 
@@ -1316,7 +1459,7 @@ ServerLobbyThread::HandleNetPacketRetrieveAvatar(boost::shared_ptr<SessionData>
 	memcpy(tmpMD5.GetData(), retrieveAvatar.avatarhash().data(), MD5_DATA_SIZE);
 	if (GetAvatarManager().GetAvatarFileName(tmpMD5, tmpFile)) {
 		NetPacketList tmpPackets;
-		if (GetAvatarManager().AvatarFileToNetPackets(tmpFile, retrieveAvatar.requestid(), tmpPackets) == 0) {
+		if (GetAvatarManager().CachedAvatarToNetPackets(tmpMD5, tmpFile, retrieveAvatar.requestid(), tmpPackets) == 0) {
 			avatarFound = true;
 			GetSender().Send(session, tmpPackets);
 		} else
@@ -1757,10 +1900,9 @@ ServerLobbyThread::IsAvatarReported(unsigned playerId) const
 }
 
 void
-ServerLobbyThread::AuthChallenge(boost::shared_ptr<SessionData> session, const string &secret)
+ServerLobbyThread::AuthChallenge(boost::shared_ptr<SessionData> session)
 {
 	if (session && session->GetPlayerData() && session->AuthGetCurStepNum() == 1) {
-		session->AuthSetPassword(secret); // For this auth session.
 		string outChallenge(session->AuthGetNextOutMsg());
 
 		boost::shared_ptr<NetPacket> packet(new NetPacket);
@@ -1902,6 +2044,7 @@ void
 ServerLobbyThread::AuthenticatePlayer(boost::shared_ptr<SessionData> session)
 {
 	if(session->GetPlayerData()) {
+		// Always ask the database, it rejects blocked and inactive players.
 		m_database->AsyncPlayerLogin(session->GetPlayerData()->GetUniqueId(), session->GetPlayerData()->GetName());
 	}
 }
@@ -1913,7 +2056,17 @@ ServerLobbyThread::UserValid(unsigned playerId, const DBPlayerData &dbPlayerData
 	if (tmpSession && tmpSession->GetPlayerData()) {
 		tmpSession->GetPlayerData()->SetDBId(dbPlayerData.id);
 		tmpSession->GetPlayerData()->SetCountry(dbPlayerData.country);
-		this->AuthChallenge(tmpSession, dbPlayerData.secret);
+		if (m_authCache) {
+			// Repeated login with the same password, skip the key derivation.
+			string saltedPassword;
+			const string &playerName = tmpSession->GetPlayerData()->GetName();
+			if (m_authCache->Get(playerName, tmpSession->AuthGetSalt(), ServerAuthCache::GetSecretHash(tmpSession->AuthGetSalt(), dbPlayerData.secret), saltedPassword))
+				tmpSession->AuthSetSaltedPassword(saltedPassword);
+			else
+				m_authCache->Remove(playerName);
+		}
+		tmpSession->AuthSetPassword(dbPlayerData.secret); // For this auth session.
+		this->AuthChallenge(tmpSession);
 	}
 }
 
@@ -1980,6 +2133,9 @@ ServerLobbyThread::SendAdminBanPlayerResult(unsigned byPlayerId, unsigned report
 void
 ServerLobbyThread::UserBlocked(unsigned playerId)
 {
+	boost::shared_ptr<SessionData> tmpSession = m_sessionManager.GetSessionByUniquePlayerId(playerId, true);
+	if (m_authCache && tmpSession && tmpSession->GetPlayerData())
+		m_authCache->Remove(tmpSession->GetPlayerData()->GetName());
 	SessionError(m_sessionManager.GetSessionByUniquePlayerId(playerId, true), ERR_NET_PLAYER_BLOCKED);
 }
 
@@ -2032,6 +2188,9 @@ ServerLobbyThread::TimerUpdateClientLoginLock(const boost::system::error_code &e
 	if (!ec) {
 		boost::mutex::scoped_lock lock(m_timerClientAddressMapMutex);
 
+		if (m_authCache)
+			m_authCache->RemoveExpired();
+
 		TimerClientAddressMap::iterator i = m_timerClientAddressMap.begin();
 		TimerClientAddressMap::iterator end = m_timerClientAddressMap.end();
 
@@ -2180,7 +2339,7 @@ ServerLobbyThread::HandleReAddedSession(boost::shared_ptr<SessionData> session)
 	// Remove session from game session list.
 	m_gameSessionManager.RemoveSession(session->GetId());
 
-	if (m_sessionManager.GetRawSessionCount() <= SERVER_MAX_NUM_LOBBY_SESSIONS) {
+	if (m_sessionManager.GetRawSessionCount() <= m_maxLobbySessions) {
 		// Set state (back) to established.
 		session->SetState(SessionData::Established);
 		session->SetGame(boost::shared_ptr<ServerGame>());
@@ -2415,6 +2574,25 @@ ServerLobbyThread::TimerSaveStatisticsFile(const boost::system::error_code &ec)
 				m_statDataChanged = false;
 			}
 		}
+		unsigned avatarCacheHits, avatarCacheMisses, avatarCacheEntries;
+		GetAvatarManager().GetPacketCacheStats(avatarCacheHits, avatarCacheMisses, avatarCacheEntries);
+		if (avatarCacheHits || avatarCacheMisses) {
+			LOG_VERBOSE("Avatar packet cache: " << avatarCacheEntries << " entries, hit ratio "
+						<< (100 * static_cast<boost::uint64_t>(avatarCacheHits)) / (static_cast<boost::uint64_t>(avatarCacheHits) + avatarCacheMisses) << "%.");
+		}
+		if (m_authPool) {
+			unsigned curAuthQueued, maxAuthQueued, numAuthSteps;
+			m_authPool->GetQueueStats(curAuthQueued, maxAuthQueued, numAuthSteps);
+			if (numAuthSteps || curAuthQueued) {
+				LOG_VERBOSE("Authentication: " << numAuthSteps << " steps, queued " << curAuthQueued << ", max " << maxAuthQueued << ".");
+			}
+		}
+		unsigned numChatVerdicts, avgChatLatency, maxChatLatency;
+		m_chatCleanerManager->GetVerdictLatencyStats(numChatVerdicts, avgChatLatency, maxChatLatency);
+		if (numChatVerdicts) {
+			LOG_VERBOSE("Chat cleaner: " << numChatVerdicts << " verdicts, latency avg "
+						<< avgChatLatency << "us, max " << maxChatLatency << "us.");
+		}
 		// Restart timer
 		m_saveStatisticsTimer.expires_from_now(
 			seconds(SERVER_SAVE_STATISTICS_INTERVAL_SEC));
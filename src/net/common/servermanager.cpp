@@ -40,6 +40,7 @@
 #include <net/socket_startup.h>
 #include <net/serverircbotcallback.h>
 #include <core/loghelper.h>
+#include <config/configfile.h>
 
 #include <boost/bind.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -95,8 +96,20 @@ ServerManager::Init(unsigned serverPort, unsigned websocketPort, bool ipv6, int
 			m_acceptHelperPool.push_back(sctpAcceptHelper);
 		}*/
 	if (proto & TRANSPORT_PROTOCOL_WEBSOCKET) {
+		WebSocketDeflateSettings deflateSettings;
+		deflateSettings.enabled = GetConfig().readConfigInt("ServerWebSocketCompression") == 1;
+		deflateSettings.contextTakeover = GetConfig().readConfigInt("ServerWebSocketContextTakeover") == 1;
+		int windowBits = GetConfig().readConfigInt("ServerWebSocketCompressionWindowBits");
+		if (windowBits >= 9 && windowBits <= 15) {
+			deflateSettings.maxWindowBits = windowBits;
+		}
+		int threshold = GetConfig().readConfigInt("ServerWebSocketCompressionThreshold");
+		if (threshold >= 0) {
+			deflateSettings.compressThreshold = threshold;
+		}
 		boost::shared_ptr<ServerAcceptInterface> webAcceptHelper(
-			new ServerAcceptWebHelper(GetGui(), m_ioService, webSocketResource, webSocketOrigin));
+			new ServerAcceptWebHelper(GetGui(), m_ioService, webSocketResource, webSocketOrigin,
+									  deflateSettings, GetConfig().readConfigInt("ServerWebSocketBatchFrames") == 1));
 		webAcceptHelper->Listen(websocketPort, ipv6, logDir, m_lobbyThread);
 		m_acceptHelperPool.push_back(webAcceptHelper);
 	}
@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
+#include <net/serverspectatorfanout.h>
+#include <net/sessiondata.h>
+#include <net/sendbuffer.h>
+#include <net/netpacket.h>
+#include <cstring>
+
+using namespace std;
+
+
+ServerSpectatorChannel::ServerSpectatorChannel(boost::asio::io_service &ioService, bool direct)
+	: m_strand(ioService), m_direct(direct), m_deliverPosted(false)
+{
+}
+
+void
+ServerSpectatorChannel::Publish(const SessionDataList &recipients, boost::shared_ptr<NetPacket> packet)
+{
+	if (recipients.empty() || !packet)
+		return;
+
+	boost::mutex::scoped_lock lock(m_pendingMutex);
+	// Packets for the same spectators are delivered together. The recipients are
+	// stored with the data, so new spectators do not receive older packets.
+	if (m_pending.empty() || m_pending.back().recipients != recipients) {
+		m_pending.push_back(PendingData());
+		m_pending.back().recipients = recipients;
+	}
+	string &data = m_pending.back().data;
+	uint32_t packetSize = packet->GetMsg()->ByteSize();
+	size_t offset = data.size();
+	data.resize(offset + packetSize + NET_HEADER_SIZE);
+	uint32_t nativeVal = htonl(packetSize);
+	memcpy(&data[offset], &nativeVal, sizeof(uint32_t));
+	packet->GetMsg()->SerializeWithCachedSizesToArray((google::protobuf::uint8 *)&data[offset + NET_HEADER_SIZE]);
+
+	if (m_direct) {
+		lock.unlock();
+		Deliver();
+	} else if (!m_deliverPosted) {
+		m_deliverPosted = true;
+		// The strand keeps the packet order if more than one thread is used.
+		m_strand.post(boost::bind(&ServerSpectatorChannel::Deliver, shared_from_this()));
+	}
+}
+
+void
+ServerSpectatorChannel::Flush()
+{
+	Deliver();
+}
+
+void
+ServerSpectatorChannel::Deliver()
+{
+	// Wait for a delivery by another thread, its packets were published first.
+	boost::mutex::scoped_lock deliverLock(m_deliverMutex);
+	PendingList tmpPending;
+	{
+		boost::mutex::scoped_lock lock(m_pendingMutex);
+		tmpPending.swap(m_pending);
+		m_deliverPosted = false;
+	}
+	PendingList::const_iterator i = tmpPending.begin();
+	PendingList::const_iterator end = tmpPending.end();
+	while (i != end) {
+		SessionDataList::const_iterator session_i = i->recipients.begin();
+		SessionDataList::const_iterator session_end = i->recipients.end();
+		while (session_i != session_end) {
+			SendBuffer &tmpBuffer = (*session_i)->GetSendBuffer();
+			boost::mutex::scoped_lock lock(tmpBuffer.dataMutex);
+			tmpBuffer.InternalStoreSerialized(*session_i, i->data);
+			tmpBuffer.AsyncSendNextPacket(*session_i);
+			++session_i;
+		}
+		++i;
+	}
+}
+
+ServerSpectatorFanout::ServerSpectatorFanout(unsigned numThreads)
+	: m_numThreads(numThreads)
+{
+}
+
+ServerSpectatorFanout::~ServerSpectatorFanout()
+{
+	Stop();
+}
+
+void
+ServerSpectatorFanout::Start()
+{
+	if (!m_ioWork) {
+		m_ioService.reset();
+		m_ioWork.reset(new boost::asio::io_service::work(m_ioService));
+		for (unsigned i = 0; i < m_numThreads; i++) {
+			m_threads.create_thread(boost::bind(&ServerSpectatorFanout::RunThread, this));
+		}
+	}
+}
+
+void
+ServerSpectatorFanout::Stop()
+{
+	if (m_ioWork) {
+		m_ioWork.reset();
+		m_ioService.stop();
+		m_threads.join_all();
+	}
+}
+
+void
+ServerSpectatorFanout::RunThread()
+{
+	m_ioService.run();
+}
+
+boost::shared_ptr<ServerSpectatorChannel>
+ServerSpectatorFanout::CreateChannel()
+{
+	return boost::shared_ptr<ServerSpectatorChannel>(new ServerSpectatorChannel(m_ioService, m_numThreads == 0));
+}
@@ -36,7 +36,9 @@
 #include <net/websendbuffer.h>
 #include <net/socket_msg.h>
 #include <net/websocketdata.h>
+#include <core/crypthelper.h>
 #include <gsasl.h>
+#include <cstdlib>
 
 using namespace std;
 using boost::asio::ip::tcp;
@@ -47,19 +49,23 @@ using namespace std::chrono;
 using namespace boost::chrono;
 #endif
 
+#define SCRAM_DEFAULT_ITERATIONS	4096
+
 SessionData::SessionData(boost::shared_ptr<boost::asio::ip::tcp::socket> sock, SessionId id, SessionDataCallback &cb, boost::asio::io_service &ioService)
 	: m_socket(sock), m_id(id), m_state(SessionData::Auth), m_readyFlag(false), m_wantsLobbyMsg(true),
 	  m_activityTimeoutSec(0), m_activityWarningRemainingSec(0), m_initTimeoutTimer(ioService), m_globalTimeoutTimer(ioService),
-	  m_activityTimeoutTimer(ioService), m_callback(cb), m_authSession(NULL), m_curAuthStep(0)
+	  m_activityTimeoutTimer(ioService), m_callback(cb), m_authSession(NULL), m_curAuthStep(0),
+	  m_authStepPending(false), m_authIterations(SCRAM_DEFAULT_ITERATIONS)
 {
 	m_receiveBuffer.reset(new AsioReceiveBuffer);
-	m_sendBuffer.reset(new AsioSendBuffer);
+	m_sendBuffer.reset(new AsioSendBuffer(ioService));
 }
 
 SessionData::SessionData(boost::shared_ptr<WebSocketData> webData, SessionId id, SessionDataCallback &cb, boost::asio::io_service &ioService, int /*filler*/)
 	: m_webData(webData), m_id(id), m_state(SessionData::Auth), m_readyFlag(false), m_wantsLobbyMsg(true),
 	  m_activityTimeoutSec(0), m_activityWarningRemainingSec(0), m_initTimeoutTimer(ioService), m_globalTimeoutTimer(ioService),
-	  m_activityTimeoutTimer(ioService), m_callback(cb), m_authSession(NULL), m_curAuthStep(0)
+	  m_activityTimeoutTimer(ioService), m_callback(cb), m_authSession(NULL), m_curAuthStep(0),
+	  m_authStepPending(false), m_authIterations(SCRAM_DEFAULT_ITERATIONS)
 {
 	m_receiveBuffer.reset(new WebReceiveBuffer);
 	m_sendBuffer.reset(new WebSendBuffer);
@@ -103,8 +109,13 @@ SessionData::GetState() const
 void
 SessionData::SetState(SessionData::State state)
 {
-	boost::mutex::scoped_lock lock(m_dataMutex);
-	m_state = state;
+	{
+		boost::mutex::scoped_lock lock(m_dataMutex);
+		m_state = state;
+	}
+	// Spectators do not need every packet immediately, send them in ticks.
+	boost::mutex::scoped_lock lock(m_sendBuffer->dataMutex);
+	m_sendBuffer->SetFlushDelay(state == SessionData::Spectating ? m_callback.GetSpectatorFlushDelayMsec() : 0);
 }
 
 boost::shared_ptr<boost::asio::ip::tcp::socket>
@@ -122,7 +133,7 @@ SessionData::GetWebData()
 bool
 SessionData::CreateServerAuthSession(Gsasl *context)
 {
-	boost::mutex::scoped_lock lock(m_dataMutex);
+	boost::mutex::scoped_lock lock(m_authMutex);
 	InternalClearAuthSession();
 	int errorCode;
 	errorCode = gsasl_server_start(context, "SCRAM-SHA-1", &m_authSession);
@@ -133,7 +144,7 @@ bool
 SessionData::CreateClientAuthSession(Gsasl *context, const string &userName, const string &password)
 {
 	bool retVal = false;
-	boost::mutex::scoped_lock lock(m_dataMutex);
+	boost::mutex::scoped_lock lock(m_authMutex);
 	InternalClearAuthSession();
 	int errorCode;
 	errorCode = gsasl_client_start(context, "SCRAM-SHA-1", &m_authSession);
@@ -149,13 +160,49 @@ SessionData::CreateClientAuthSession(Gsasl *context, const string &userName, con
 bool
 SessionData::AuthStep(int stepNum, const std::string &inData)
 {
+	if (stepNum == 2) {
+		// Derive the key here, so that it can be cached for the next login.
+		// This takes long, do it without holding the lock.
+		string tmpPassword;
+		string tmpSalt;
+		unsigned tmpIterations = 0;
+		bool needsKey = false;
+		{
+			boost::mutex::scoped_lock lock(m_authMutex);
+			if (m_authSession && m_curAuthStep == 1 && m_saltedPassword.empty() && !m_password.empty() && !m_authSalt.empty()) {
+				tmpPassword = m_password;
+				tmpSalt = m_authSalt;
+				tmpIterations = m_authIterations;
+				needsKey = true;
+			}
+		}
+		if (needsKey) {
+			string tmpSaltedPassword(InternalDeriveSaltedPassword(tmpPassword, tmpSalt, tmpIterations));
+			boost::mutex::scoped_lock lock(m_authMutex);
+			// Only use the key if the input did not change in the meantime.
+			if (!tmpSaltedPassword.empty() && m_authSession && m_saltedPassword.empty()
+					&& m_password == tmpPassword && m_authSalt == tmpSalt && m_authIterations == tmpIterations) {
+				m_saltedPassword = tmpSaltedPassword;
+				gsasl_property_set(m_authSession, GSASL_SCRAM_SALTED_PASSWORD, m_saltedPassword.c_str());
+			}
+		}
+	}
 	bool retVal = false;
-	boost::mutex::scoped_lock lock(m_dataMutex);
+	boost::mutex::scoped_lock lock(m_authMutex);
 	if (m_authSession && stepNum == m_curAuthStep + 1) {
 		m_curAuthStep = stepNum;
 		char *tmpOut;
 		size_t tmpOutSize;
 		int errorCode = gsasl_step(m_authSession, inData.c_str(), inData.length(), &tmpOut, &tmpOutSize);
+		if (stepNum == 1) {
+			// The server chose salt and iterations in the first step.
+			const char *tmpSalt = gsasl_property_fast(m_authSession, GSASL_SCRAM_SALT);
+			const char *tmpIter = gsasl_property_fast(m_authSession, GSASL_SCRAM_ITER);
+			if (tmpSalt)
+				m_authSalt = tmpSalt;
+			if (tmpIter && atoi(tmpIter) > 0)
+				m_authIterations = atoi(tmpIter);
+		}
 		if (errorCode == GSASL_NEEDS_MORE) {
 			m_nextGsaslMsg = string(tmpOut, tmpOutSize);
 			retVal = true;
@@ -169,10 +216,27 @@ SessionData::AuthStep(int stepNum, const std::string &inData)
 	return retVal;
 }
 
+bool
+SessionData::AuthStartStep()
+{
+	boost::mutex::scoped_lock lock(m_authMutex);
+	bool retVal = !m_authStepPending;
+	m_authStepPending = true;
+	return retVal;
+}
+
+void
+SessionData::AuthEndStep()
+{
+	boost::mutex::scoped_lock lock(m_authMutex);
+	m_authStepPending = false;
+}
+
 string
 SessionData::AuthGetUser() const
 {
 	string retStr;
+	boost::mutex::scoped_lock lock(m_authMutex);
 	if (m_authSession) {
 		const char *tmpUser = gsasl_property_fast(m_authSession, GSASL_AUTHID);
 		if (tmpUser)
@@ -184,6 +248,7 @@ SessionData::AuthGetUser() const
 void
 SessionData::AuthSetPassword(const std::string &password)
 {
+	boost::mutex::scoped_lock lock(m_authMutex);
 	if (m_authSession)
 		gsasl_property_set(m_authSession, GSASL_PASSWORD, password.c_str());
 	m_password = password;
@@ -192,21 +257,66 @@ SessionData::AuthSetPassword(const std::string &password)
 string
 SessionData::AuthGetPassword() const
 {
+	boost::mutex::scoped_lock lock(m_authMutex);
 	return m_password;
 }
 
+void
+SessionData::AuthSetSaltedPassword(const std::string &saltedPassword)
+{
+	boost::mutex::scoped_lock lock(m_authMutex);
+	if (m_authSession)
+		gsasl_property_set(m_authSession, GSASL_SCRAM_SALTED_PASSWORD, saltedPassword.c_str());
+	m_saltedPassword = saltedPassword;
+}
+
+string
+SessionData::AuthGetSaltedPassword() const
+{
+	boost::mutex::scoped_lock lock(m_authMutex);
+	return m_saltedPassword;
+}
+
+string
+SessionData::AuthGetSalt() const
+{
+	boost::mutex::scoped_lock lock(m_authMutex);
+	return m_authSalt;
+}
+
 string
 SessionData::AuthGetNextOutMsg() const
 {
+	boost::mutex::scoped_lock lock(m_authMutex);
 	return m_nextGsaslMsg;
 }
 
 int
 SessionData::AuthGetCurStepNum() const
 {
+	boost::mutex::scoped_lock lock(m_authMutex);
 	return m_curAuthStep;
 }
 
+string
+SessionData::InternalDeriveSaltedPassword(const string &password, const string &salt, unsigned iterations)
+{
+	// Same as gsasl: SaltedPassword := Hi(Normalize(password), salt, i)
+	string retStr;
+	char *prepPassword = NULL;
+	char *rawSalt = NULL;
+	size_t saltSize = 0;
+	if (gsasl_saslprep(password.c_str(), GSASL_ALLOW_UNASSIGNED, &prepPassword, NULL) == GSASL_OK
+			&& gsasl_base64_from(salt.c_str(), salt.length(), &rawSalt, &saltSize) == GSASL_OK) {
+		SHA1Buf saltedPassword;
+		if (CryptHelper::PBKDF2Sha1(prepPassword, (const unsigned char *)rawSalt, static_cast<unsigned>(saltSize), iterations, saltedPassword))
+			retStr = saltedPassword.ToString();
+	}
+	gsasl_free(prepPassword);
+	gsasl_free(rawSalt);
+	return retStr;
+}
+
 void
 SessionData::InternalClearAuthSession()
 {
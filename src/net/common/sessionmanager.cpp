@@ -204,6 +204,24 @@ SessionManager::GetPlayerIdList(int state) const
 	return playerList;
 }
 
+SessionDataList
+SessionManager::GetSessionList(int state) const
+{
+	SessionDataList sessionList;
+	boost::recursive_mutex::scoped_lock lock(m_sessionMapMutex);
+
+	SessionMap::const_iterator session_i = m_sessionMap.begin();
+	SessionMap::const_iterator session_end = m_sessionMap.end();
+
+	while (session_i != session_end) {
+		if ((session_i->second->GetState() & state) != 0) {
+			sessionList.push_back(session_i->second);
+		}
+		++session_i;
+	}
+	return sessionList;
+}
+
 bool
 SessionManager::IsPlayerConnected(const string &playerName) const
 {
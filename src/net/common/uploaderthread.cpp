@@ -29,82 +29,379 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 
+#include <net/socket_helper.h>
 #include <net/uploaderthread.h>
-#include <net/uploadhelper.h>
 #include <net/uploadcallback.h>
-#include <net/netexception.h>
 #include <boost/filesystem.hpp>
 #include <core/loghelper.h>
 
-#define UPLOAD_DELAY_MSEC					100
+#include <curl/curl.h>
+#include <cstdio>
+#include <list>
+#include <map>
+
+#define UPLOAD_SELECT_TIMEOUT_MSEC			50
 
 using namespace std;
 using namespace boost::filesystem;
 
 
-UploaderThread::UploaderThread(UploadCallback *callback)
-	: m_uploadInProgress(false), m_callback(callback)
+struct UploaderThread::TransferContext {
+	struct ActiveTransfer {
+		ActiveTransfer(const UploadData &d)
+			: data(d), file(NULL), post(NULL) {}
+		~ActiveTransfer()
+		{
+			if (post)
+				curl_formfree(post);
+			if (file)
+				fclose(file);
+		}
+
+		UploadData data;
+		std::string url;
+		std::string userCredentials;
+		FILE *file;
+		struct curl_httppost *post;
+		std::string returnMessage;
+	};
+	typedef std::map<CURL *, boost::shared_ptr<ActiveTransfer> > ActiveTransferMap;
+	typedef std::list<UploadData> RetryList;
+
+	TransferContext() : multiHandle(NULL) {}
+
+	CURLM *multiHandle;
+	ActiveTransferMap activeTransfers;
+	// Failed uploads, ordered by retry time.
+	RetryList retryList;
+	// Easy handles are reused to keep connections alive.
+	std::vector<CURL *> idleHandles;
+};
+
+static size_t
+readFunction(char *bufptr, size_t size, size_t nitems, void *userp)
+{
+	return fread(bufptr, size, nitems, (FILE *)userp);
+}
+
+static size_t
+writeFunction(char *bufptr, size_t size, size_t nitems, void *userp)
+{
+	((string *)userp)->append(bufptr, size * nitems);
+	return size * nitems;
+}
+
+UploaderThread::UploaderThread(UploadCallback *callback, unsigned maxParallelTransfers, unsigned retryDelayMsec, unsigned transferTimeoutSec)
+	: m_terminate(false), m_callback(callback), m_maxParallelTransfers(maxParallelTransfers ? maxParallelTransfers : 1),
+	  m_retryDelayMsec(retryDelayMsec), m_transferTimeoutSec(transferTimeoutSec)
 {
-	m_uploadHelper.reset(new UploadHelper());
 }
 
 UploaderThread::~UploaderThread()
 {
 }
 
+void
+UploaderThread::SignalTermination()
+{
+	{
+		boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+		m_terminate = true;
+	}
+	m_uploadQueueCond.notify_all();
+	Thread::SignalTermination();
+}
+
 void
 UploaderThread::QueueUpload(const string &url, const string &user, const string &pwd, const string &filename, size_t filesize, const string &httpPost)
 {
-	boost::mutex::scoped_lock lock(m_uploadQueueMutex);
-	m_uploadQueue.push(UploadData(url, user, pwd, filename, filesize, httpPost));
+	if (filename.empty() || !filesize)
+		return;
+	UploadData data(url, user, pwd, filename, filesize, httpPost);
+	// Avatar files are named by their MD5 sum, so the target url identifies them.
+	data.key = GetUploadUrl(data);
+	if (!httpPost.empty())
+		data.key += " " + filename;
+	{
+		boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+		if (!m_uploadKeys.insert(data.key).second)
+			return;
+		m_uploadQueue.push(data);
+	}
+	m_uploadQueueCond.notify_one();
 }
 
 void
 UploaderThread::Main()
 {
-	string lastfile;
-	while (!ShouldTerminate()) {
-		try {
-			if (m_uploadInProgress) {
-				m_uploadInProgress = !m_uploadHelper->Process();
-			}
+	TransferContext context;
+	context.multiHandle = curl_multi_init();
+	if (!context.multiHandle) {
+		LOG_ERROR("Upload failed: Could not initialise curl.");
+		return;
+	}
 
-			if (!m_uploadInProgress) {
-				string lastMsg(m_uploadHelper->ResetLastMessage());
-				if (!lastMsg.empty() && m_callback) {
-					m_callback->UploadCompleted(lastfile, lastMsg);
-				}
-				Msleep(UPLOAD_DELAY_MSEC);
-				UploadData data;
-				{
-					boost::mutex::scoped_lock lock(m_uploadQueueMutex);
-					if (!m_uploadQueue.empty()) {
-						data = m_uploadQueue.front();
-						lastfile = data.filename;
-						m_uploadQueue.pop();
-					}
-				}
-				if (!data.filename.empty() && data.filesize > 0) {
-					path filepath(data.filename);
-					string url(data.address);
-					if (data.httpPost.empty()) {
-#if BOOST_FILESYSTEM_VERSION != 3
-						url += filepath.leaf();
-#else
-						url += filepath.filename().string();
-#endif
-					}
-					m_uploadHelper->Init(url, filepath.file_string(), data.user, data.pwd, data.filesize, data.httpPost);
-					m_uploadInProgress = true;
-				}
+	while (true) {
+		{
+			boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+			// Sleep until there is something to do.
+			while (!m_terminate && context.activeTransfers.empty() && m_uploadQueue.empty()) {
+				if (context.retryList.empty())
+					m_uploadQueueCond.wait(lock);
+				else if (!m_uploadQueueCond.timed_wait(lock, context.retryList.front().retryTime))
+					break;
 			}
-		} catch (const NetException &e) {
-			LOG_ERROR("Upload failed: " << e.what());
-			m_uploadInProgress = false;
-			if (m_callback) {
-				m_callback->UploadError(lastfile, e.what());
+			if (m_terminate)
+				break;
+		}
+		InternalStartTransfers(context);
+		InternalProcessTransfers(context);
+	}
+
+	InternalAbortTransfers(context);
+	vector<CURL *>::iterator h = context.idleHandles.begin();
+	vector<CURL *>::iterator hEnd = context.idleHandles.end();
+	while (h != hEnd) {
+		curl_easy_cleanup(*h);
+		++h;
+	}
+	context.idleHandles.clear();
+	curl_multi_cleanup(context.multiHandle);
+}
+
+void
+UploaderThread::InternalStartTransfers(TransferContext &context)
+{
+	boost::system_time now(boost::get_system_time());
+	while (context.activeTransfers.size() < m_maxParallelTransfers) {
+		UploadData data;
+		if (!context.retryList.empty() && context.retryList.front().retryTime <= now) {
+			data = context.retryList.front();
+			context.retryList.pop_front();
+		} else {
+			boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+			if (m_uploadQueue.empty())
+				break;
+			data = m_uploadQueue.front();
+			m_uploadQueue.pop();
+		}
+		if (!InternalStartTransfer(context, data)) {
+			{
+				boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+				m_uploadKeys.erase(data.key);
 			}
+			if (m_callback)
+				m_callback->UploadError(data.filename, "Failed to initialise upload.");
 		}
 	}
 }
 
+bool
+UploaderThread::InternalStartTransfer(TransferContext &context, const UploadData &data)
+{
+	boost::shared_ptr<TransferContext::ActiveTransfer> transfer(new TransferContext::ActiveTransfer(data));
+	transfer->url = GetUploadUrl(data);
+	if (data.httpPost.empty()) {
+		// Open target file for reading.
+		transfer->file = fopen(data.filename.c_str(), "rb");
+		if (!transfer->file) {
+			LOG_ERROR("Upload failed: Could not open " << data.filename);
+			return false;
+		}
+	}
+
+	CURL *handle;
+	if (!context.idleHandles.empty()) {
+		handle = context.idleHandles.back();
+		context.idleHandles.pop_back();
+	} else {
+		handle = curl_easy_init();
+		if (!handle) {
+			LOG_ERROR("Upload failed: Could not initialise curl.");
+			return false;
+		}
+	}
+
+	bool retVal = curl_easy_setopt(handle, CURLOPT_URL, transfer->url.c_str()) == CURLE_OK;
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_TIMEOUT, (long)m_transferTimeoutSec);
+	curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+	curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+	if (!data.user.empty() || !data.pwd.empty()) {
+		transfer->userCredentials = data.user + ":" + data.pwd;
+		curl_easy_setopt(handle, CURLOPT_USERPWD, transfer->userCredentials.c_str());
+	}
+	if (data.httpPost.empty()) {
+		curl_easy_setopt(handle, CURLOPT_READFUNCTION, readFunction);
+		curl_easy_setopt(handle, CURLOPT_READDATA, transfer->file);
+		curl_easy_setopt(handle, CURLOPT_UPLOAD, 1L);
+		curl_easy_setopt(handle, CURLOPT_INFILESIZE, (long)data.filesize);
+	} else {
+		// Curl will handle file I/O.
+		struct curl_httppost *last = NULL;
+		curl_formadd(&transfer->post, &last,
+					 CURLFORM_COPYNAME, data.httpPost.c_str(),
+					 CURLFORM_FILE, data.filename.c_str(),
+					 CURLFORM_END);
+		curl_easy_setopt(handle, CURLOPT_HTTPPOST, transfer->post);
+	}
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, writeFunction);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer->returnMessage);
+
+	if (!retVal || curl_multi_add_handle(context.multiHandle, handle) != CURLM_OK) {
+		LOG_ERROR("Upload failed: Invalid url " << transfer->url);
+		curl_easy_cleanup(handle);
+		return false;
+	}
+	context.activeTransfers[handle] = transfer;
+	return true;
+}
+
+void
+UploaderThread::InternalProcessTransfers(TransferContext &context)
+{
+	if (context.activeTransfers.empty())
+		return;
+
+	int runningHandles = 0;
+	CURLMcode curlResult;
+	do {
+		curlResult = curl_multi_perform(context.multiHandle, &runningHandles);
+	} while (curlResult == CURLM_CALL_MULTI_PERFORM);
+
+	// Collect finished transfers.
+	int numMsgs;
+	CURLMsg *tmpMsg;
+	while ((tmpMsg = curl_multi_info_read(context.multiHandle, &numMsgs)) != NULL) {
+		if (tmpMsg->msg == CURLMSG_DONE)
+			InternalFinishTransfer(context, tmpMsg->easy_handle, tmpMsg->data.result == CURLE_OK, curl_easy_strerror(tmpMsg->data.result));
+	}
+	if (curlResult != CURLM_OK) {
+		while (!context.activeTransfers.empty())
+			InternalFinishTransfer(context, context.activeTransfers.begin()->first, false, curl_multi_strerror(curlResult));
+	}
+
+	if (!context.activeTransfers.empty()) {
+		// Wait for socket activity, but wake up regularly to start queued uploads.
+		struct timeval timeout;
+		fd_set readSet;
+		fd_set writeSet;
+		fd_set exceptSet;
+		int maxfd = -1;
+
+		FD_ZERO(&readSet);
+		FD_ZERO(&writeSet);
+		FD_ZERO(&exceptSet);
+
+		long curlTimeout = -1;
+		curl_multi_timeout(context.multiHandle, &curlTimeout);
+		if (curlTimeout < 0 || curlTimeout > UPLOAD_SELECT_TIMEOUT_MSEC)
+			curlTimeout = UPLOAD_SELECT_TIMEOUT_MSEC;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = curlTimeout * 1000;
+
+		curl_multi_fdset(context.multiHandle, &readSet, &writeSet, &exceptSet, &maxfd);
+
+		if (maxfd >= 0)
+			select(maxfd+1, &readSet, &writeSet, &exceptSet, &timeout);
+		else if (curlTimeout > 0)
+			Msleep(curlTimeout);
+	}
+}
+
+void
+UploaderThread::InternalFinishTransfer(TransferContext &context, void *easyHandle, bool success, const std::string &errorMsg)
+{
+	CURL *handle = static_cast<CURL *>(easyHandle);
+	TransferContext::ActiveTransferMap::iterator pos = context.activeTransfers.find(handle);
+	if (pos == context.activeTransfers.end())
+		return;
+	boost::shared_ptr<TransferContext::ActiveTransfer> transfer(pos->second);
+	context.activeTransfers.erase(pos);
+
+	curl_multi_remove_handle(context.multiHandle, handle);
+	curl_easy_reset(handle);
+	context.idleHandles.push_back(handle);
+
+	UploadData &data = transfer->data;
+	if (!success && data.numRetries < UPLOADER_MAX_RETRIES) {
+		// Retry with exponential backoff.
+		data.retryTime = boost::get_system_time() + boost::posix_time::milliseconds(m_retryDelayMsec << data.numRetries);
+		data.numRetries++;
+		TransferContext::RetryList::iterator i = context.retryList.begin();
+		TransferContext::RetryList::iterator end = context.retryList.end();
+		while (i != end && i->retryTime <= data.retryTime)
+			++i;
+		context.retryList.insert(i, data);
+		LOG_MSG("Upload failed, retrying: " << transfer->url << " (" << errorMsg << ")");
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+		m_uploadKeys.erase(data.key);
+	}
+	if (success) {
+		if (m_callback && !transfer->returnMessage.empty())
+			m_callback->UploadCompleted(data.filename, transfer->returnMessage);
+	} else {
+		LOG_ERROR("Upload failed: " << transfer->url << " (" << errorMsg << ")");
+		if (m_callback)
+			m_callback->UploadError(data.filename, errorMsg);
+	}
+}
+
+void
+UploaderThread::InternalAbortTransfers(TransferContext &context)
+{
+	// Running, retried and queued uploads are reported as failed.
+	list<string> abortedFiles;
+	TransferContext::ActiveTransferMap::iterator i = context.activeTransfers.begin();
+	TransferContext::ActiveTransferMap::iterator end = context.activeTransfers.end();
+	while (i != end) {
+		curl_multi_remove_handle(context.multiHandle, i->first);
+		curl_easy_cleanup(i->first);
+		abortedFiles.push_back(i->second->data.filename);
+		++i;
+	}
+	context.activeTransfers.clear();
+	TransferContext::RetryList::iterator r = context.retryList.begin();
+	TransferContext::RetryList::iterator rEnd = context.retryList.end();
+	while (r != rEnd) {
+		abortedFiles.push_back(r->filename);
+		++r;
+	}
+	context.retryList.clear();
+	{
+		boost::mutex::scoped_lock lock(m_uploadQueueMutex);
+		while (!m_uploadQueue.empty()) {
+			abortedFiles.push_back(m_uploadQueue.front().filename);
+			m_uploadQueue.pop();
+		}
+		m_uploadKeys.clear();
+	}
+	if (m_callback) {
+		list<string>::const_iterator f = abortedFiles.begin();
+		list<string>::const_iterator fEnd = abortedFiles.end();
+		while (f != fEnd) {
+			m_callback->UploadError(*f, "Upload aborted.");
+			++f;
+		}
+	}
+}
+
+string
+UploaderThread::GetUploadUrl(const UploadData &data)
+{
+	string url(data.address);
+	if (data.httpPost.empty()) {
+		path filepath(data.filename);
+#if BOOST_FILESYSTEM_VERSION != 3
+		url += filepath.leaf();
+#else
+		url += filepath.filename().string();
+#endif
+	}
+	return url;
+}
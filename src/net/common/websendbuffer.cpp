@@ -29,6 +29,9 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
 #include <net/websendbuffer.h>
 #include <net/websocketdata.h>
 #include <net/netpacket.h>
@@ -36,9 +39,15 @@
 
 using namespace std;
 
+#ifdef BOOST_ASIO_HAS_STD_CHRONO
+using namespace std::chrono;
+#else
+using namespace boost::chrono;
+#endif
+
 
 WebSendBuffer::WebSendBuffer()
-	: closeAfterSend(false)
+	: flushDelayMsec(0), closeAfterSend(false), flushPosted(false)
 {
 }
 
@@ -48,6 +57,12 @@ WebSendBuffer::SetCloseAfterSend()
 	closeAfterSend = true;
 }
 
+void
+WebSendBuffer::SetFlushDelay(unsigned delayMsec)
+{
+	flushDelayMsec = delayMsec;
+}
+
 void
 WebSendBuffer::HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> /*socket*/, const boost::system::error_code &/*error*/)
 {
@@ -56,11 +71,22 @@ WebSendBuffer::HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> /*soc
 void
 WebSendBuffer::AsyncSendNextPacket(boost::shared_ptr<SessionData> session)
 {
-	if (closeAfterSend) {
-//		boost::system::error_code ec;
-        std::error_code std_ec;
+	// Defer the actual send until the current handler is done, so that all
+	// packets generated by one event end up in a single write.
+	if (!flushPosted && (closeAfterSend || pendingBatch || !pendingMsgs.empty())) {
+		flushPosted = true;
 		boost::shared_ptr<WebSocketData> webData = session->GetWebData();
-        webData->webSocketServer->close(webData->webHandle, websocketpp::close::status::normal, "PokerTH server closed the connection.", std_ec);
+		if (flushDelayMsec) {
+			if (!flushTimer) {
+				flushTimer.reset(new boost::asio::steady_timer(webData->webSocketServer->get_io_service()));
+			}
+			flushTimer->expires_from_now(milliseconds(flushDelayMsec));
+			flushTimer->async_wait(
+				boost::bind(&WebSendBuffer::FlushPending, boost::static_pointer_cast<WebSendBuffer>(shared_from_this()), session));
+		} else {
+			webData->webSocketServer->get_io_service().post(
+				boost::bind(&WebSendBuffer::FlushPending, boost::static_pointer_cast<WebSendBuffer>(shared_from_this()), session));
+		}
 	}
 }
 
@@ -68,17 +94,94 @@ void
 WebSendBuffer::InternalStorePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet)
 {
 	uint32_t packetSize = packet->GetMsg()->ByteSize();
-	google::protobuf::uint8 *buf = new google::protobuf::uint8[packetSize];
-	packet->GetMsg()->SerializeWithCachedSizesToArray(buf);
+	boost::shared_ptr<WebSocketData> webData = session->GetWebData();
+
+	// Serialize directly into the websocket message payload.
+	if (webData->batchFrames) {
+		if (!pendingBatch) {
+			pendingBatch = CreateMessage(MAX_PACKET_SIZE + NET_HEADER_SIZE);
+		}
+		string &payload = pendingBatch->get_raw_payload();
+		size_t offset = payload.size();
+		payload.resize(offset + packetSize + NET_HEADER_SIZE);
+		uint32_t nativeVal = htonl(packetSize);
+		memcpy(&payload[offset], &nativeVal, sizeof(uint32_t));
+		packet->GetMsg()->SerializeWithCachedSizesToArray((google::protobuf::uint8 *)&payload[offset + NET_HEADER_SIZE]);
+	} else {
+		server::message_ptr msg(CreateMessage(packetSize));
+		string &payload = msg->get_raw_payload();
+		payload.resize(packetSize);
+		if (packetSize) {
+			packet->GetMsg()->SerializeWithCachedSizesToArray((google::protobuf::uint8 *)&payload[0]);
+		}
+		pendingMsgs.push_back(msg);
+	}
+}
 
-//	boost::system::error_code ec;
-    std::error_code std_ec;
+void
+WebSendBuffer::InternalStoreSerialized(boost::shared_ptr<SessionData> session, const std::string &data)
+{
 	boost::shared_ptr<WebSocketData> webData = session->GetWebData();
-    webData->webSocketServer->send(webData->webHandle, string((const char *)buf, packetSize), websocketpp::frame::opcode::BINARY, std_ec);
-    if (std_ec) {
+
+	if (webData->batchFrames) {
+		// The batch format is the same as the serialized data.
+		if (!pendingBatch) {
+			pendingBatch = CreateMessage(data.size());
+		}
+		pendingBatch->get_raw_payload().append(data);
+	} else {
+		// One message per packet, without the length prefix.
+		size_t offset = 0;
+		while (offset + NET_HEADER_SIZE <= data.size()) {
+			uint32_t nativeVal;
+			memcpy(&nativeVal, &data[offset], sizeof(uint32_t));
+			uint32_t packetSize = ntohl(nativeVal);
+			offset += NET_HEADER_SIZE;
+			if (offset + packetSize > data.size()) {
+				break;
+			}
+			server::message_ptr msg(CreateMessage(packetSize));
+			msg->get_raw_payload().assign(data, offset, packetSize);
+			pendingMsgs.push_back(msg);
+			offset += packetSize;
+		}
+	}
+}
+
+void
+WebSendBuffer::FlushPending(boost::shared_ptr<SessionData> session)
+{
+	boost::mutex::scoped_lock lock(dataMutex);
+	flushPosted = false;
+	if (pendingBatch) {
+		pendingMsgs.push_back(pendingBatch);
+		pendingBatch.reset();
+	}
+
+	std::error_code std_ec;
+	boost::shared_ptr<WebSocketData> webData = session->GetWebData();
+	// Tiny messages are not worth compressing.
+	const size_t compressThreshold = GetWebSocketDeflateSettings().compressThreshold;
+	MessageList::iterator i = pendingMsgs.begin();
+	MessageList::iterator end = pendingMsgs.end();
+	while (i != end && !std_ec) {
+		(*i)->set_compressed((*i)->get_payload().size() >= compressThreshold);
+		webData->webSocketServer->send(webData->webHandle, *i, std_ec);
+		++i;
+	}
+	pendingMsgs.clear();
+	if (std_ec) {
 		SetCloseAfterSend();
 	}
 
-	delete[] buf;
+	if (closeAfterSend) {
+		webData->webSocketServer->close(webData->webHandle, websocketpp::close::status::normal, "PokerTH server closed the connection.", std_ec);
+	}
 }
 
+server::message_ptr
+WebSendBuffer::CreateMessage(size_t reserveSize) const
+{
+	return websocketpp::lib::make_shared<websocket_config::message_type>(
+			   websocket_config::message_type::con_msg_man_ptr(), websocketpp::frame::opcode::BINARY, reserveSize);
+}
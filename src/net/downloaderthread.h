@@ -34,43 +34,53 @@
 #define _DOWNLOADERTHREAD_H_
 
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
 #include <queue>
 #include <vector>
 
 #include <core/thread.h>
 
 #define DOWNLOADER_THREAD_TERMINATE_TIMEOUT		THREAD_WAIT_INFINITE
-class DownloadHelper;
+#define DOWNLOADER_MAX_PARALLEL_TRANSFERS		6
+#define DOWNLOADER_TRANSFER_TIMEOUT_SEC			30
 
 class DownloaderThread : public Thread
 {
 public:
+	// Called by the downloader thread whenever a new result is available.
+	typedef boost::function<void ()> ResultNotifier;
 
-	DownloaderThread();
+	DownloaderThread(ResultNotifier notifier = ResultNotifier(), unsigned maxParallelTransfers = DOWNLOADER_MAX_PARALLEL_TRANSFERS,
+					 unsigned transferTimeoutSec = DOWNLOADER_TRANSFER_TIMEOUT_SEC);
 	virtual ~DownloaderThread();
 
-	void QueueDownload(unsigned downloadId, const std::string &url, const std::string &filename);
+	virtual void SignalTermination();
+	// The notifier will not be called anymore after this returns.
+	void CancelResultNotifier();
+
+	void QueueDownload(unsigned downloadId, const std::string &url);
 	bool HasDownloadResult() const;
 	bool GetDownloadResult(unsigned &downloadId, std::vector<unsigned char> &filedata);
 
 protected:
 	struct DownloadData {
 		DownloadData() : id(0) {}
-		DownloadData(unsigned i, const std::string &a, const std::string &f)
-			: id(i), address(a), filename(f) {}
+		DownloadData(unsigned i, const std::string &a)
+			: id(i), address(a) {}
 
 		unsigned id;
 		std::string address;
-		std::string filename;
 	};
 	struct ResultData {
 		ResultData() : id(0) {}
-		ResultData(unsigned i, const std::vector<unsigned char> &d)
-			: id(i), data(d) {}
+		ResultData(unsigned i)
+			: id(i) {}
 
 		unsigned id;
 		std::vector<unsigned char> data;
 	};
+	struct TransferContext;
 
 	typedef std::queue<DownloadData> DownloadDataQueue;
 	typedef std::queue<ResultData> DownloadDoneQueue;
@@ -78,19 +88,26 @@ protected:
 	// Main function of the thread.
 	virtual void Main();
 
+	void InternalStartTransfers(TransferContext &context);
+	void InternalProcessTransfers(TransferContext &context);
+	void InternalFinishTransfer(TransferContext &context, void *handle, bool success);
+
+	static size_t WriteCallback(char *ptr, size_t size, size_t nmemb, void *userdata);
+
 private:
 
 	DownloadDataQueue m_downloadQueue;
 	mutable boost::mutex m_downloadQueueMutex;
+	boost::condition_variable m_downloadQueueCond;
+	bool m_terminate;
 
 	DownloadDoneQueue m_downloadDoneQueue;
 	mutable boost::mutex m_downloadDoneQueueMutex;
 
-	boost::shared_ptr<DownloadHelper> m_downloadHelper;
-	bool m_downloadInProgress;
-
-	boost::shared_ptr<DownloadData> m_curDownloadData;
+	ResultNotifier m_notifier;
+	boost::mutex m_notifierMutex;
+	const unsigned m_maxParallelTransfers;
+	const unsigned m_transferTimeoutSec;
 };
 
 #endif
-
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Prefix tree of IP address ranges. */
+
+#ifndef _IPADDRESSTRIE_H_
+#define _IPADDRESSTRIE_H_
+
+#include <boost/unordered_map.hpp>
+#include <vector>
+#include <string>
+
+// Stores single addresses ("1.2.3.4", "2001:db8::1") and CIDR ranges
+// ("1.2.3.0/24", "2001:db8::/32"). IPv4 addresses are stored as IPv4 mapped
+// IPv6 addresses, so that both notations of a client address match.
+// Entries which cannot be parsed are compared as plain strings.
+// This class is not thread safe.
+class IPAddressTrie
+{
+public:
+	IPAddressTrie();
+
+	void Add(const std::string &ipRange);
+	bool Remove(const std::string &ipRange);
+	void Clear();
+
+	bool IsMatch(const std::string &ipAddress) const;
+
+protected:
+	struct TrieNode {
+		TrieNode() : numEntries(0) {
+			child[0] = child[1] = 0;
+		}
+		unsigned child[2];
+		unsigned numEntries;
+	};
+	typedef std::vector<TrieNode> NodeVector;
+	typedef boost::unordered_map<std::string, unsigned> StringMap;
+
+	static bool ParseAddress(const std::string &ipAddress, unsigned char *addrBytes);
+	static bool ParseRange(const std::string &ipRange, unsigned char *addrBytes, unsigned &prefixLen);
+	static unsigned GetBit(const unsigned char *addrBytes, unsigned bitIndex);
+
+private:
+	NodeVector m_nodes;
+	StringMap m_unparsedEntries;
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Matches names against a set of patterns with one lookup. */
+
+#ifndef _NAMEPATTERNMATCHER_H_
+#define _NAMEPATTERNMATCHER_H_
+
+#include <boost/regex.hpp>
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <vector>
+#include <string>
+
+// Number of patterns which are combined into a single regex.
+#define NAME_PATTERN_REGEX_CHUNK_SIZE	256
+
+// Patterns are POSIX extended regular expressions, matched case
+// insensitive against the full name. Patterns without special characters
+// are kept in a hash table, all others are combined into few alternations
+// which are compiled when the set has changed. Each pattern is a group of
+// the alternation, groups of the combined regex do not capture. Back
+// references are therefore rejected.
+// This class is not thread safe.
+class NamePatternMatcher
+{
+public:
+	NamePatternMatcher();
+
+	// Throws boost::regex_error if the pattern is invalid or contains a
+	// back reference.
+	void Add(unsigned id, const std::string &pattern);
+	bool Remove(unsigned id);
+	void Clear();
+
+	bool IsMatch(const std::string &name) const;
+
+	static bool IsLiteralPattern(const std::string &pattern);
+	static bool HasBackReference(const std::string &pattern);
+
+protected:
+	void Rebuild() const;
+
+private:
+	typedef boost::unordered_map<std::string, unsigned> LiteralMap;
+	typedef std::map<unsigned, std::string> PatternMap;
+	typedef std::vector<boost::regex> RegexVector;
+
+	LiteralMap m_literals;
+	PatternMap m_literalPatterns;
+	PatternMap m_regexPatterns;
+
+	mutable RegexVector m_combinedRegex;
+	mutable bool m_dirty;
+};
+
+#endif
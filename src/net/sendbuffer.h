@@ -36,6 +36,7 @@
 #include <net/websocket_defs.h>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/thread.hpp>
+#include <string>
 
 class SessionData;
 class NetPacket;
@@ -46,9 +47,13 @@ public:
 	virtual ~SendBuffer();
 
 	virtual void SetCloseAfterSend() = 0;
+	// Collect packets for the given time before sending them (0 = end of handler).
+	virtual void SetFlushDelay(unsigned delayMsec) = 0;
 
 	virtual void AsyncSendNextPacket(boost::shared_ptr<SessionData> session) = 0;
 	virtual void InternalStorePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet) = 0;
+	// Store packets which were already serialized, each with a NET_HEADER_SIZE length prefix.
+	virtual void InternalStoreSerialized(boost::shared_ptr<SessionData> session, const std::string &data) = 0;
 
 	virtual void HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code &error) = 0;
 
@@ -44,7 +44,8 @@ class ServerAcceptWebHelper : public ServerAcceptInterface
 {
 public:
 	ServerAcceptWebHelper(ServerCallback &serverCallback, boost::shared_ptr<boost::asio::io_service> ioService,
-						  const std::string &webSocketResource, const std::string &webSocketOrigin);
+						  const std::string &webSocketResource, const std::string &webSocketOrigin,
+						  const WebSocketDeflateSettings &deflateSettings, bool batchFrames);
 
 	virtual void Listen(unsigned serverPort, bool ipv6, const std::string &logDir,
 						boost::shared_ptr<ServerLobbyThread> lobbyThread);
@@ -67,6 +68,8 @@ private:
 	SessionMap m_sessionMap;
 	std::string m_webSocketResource;
 	std::string m_webSocketOrigin;
+	WebSocketDeflateSettings m_deflateSettings;
+	bool m_batchFrames;
 
 	boost::shared_ptr<ServerLobbyThread> m_lobbyThread;
 };
@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Cache of derived login keys. */
+
+#ifndef _SERVERAUTHCACHE_H_
+#define _SERVERAUTHCACHE_H_
+
+#include <boost/thread.hpp>
+#include <third_party/boost/timers.hpp>
+#include <string>
+#include <map>
+
+// Stores the SCRAM salted password of registered players after a successful
+// login. The database is still asked on every login, so that blocked or
+// deactivated players are rejected, but a repeated login within the timeout
+// does not derive the key again. Entries are bound to a hash of the database
+// secret, a changed password invalidates them. The data is kept in memory only.
+class ServerAuthCache
+{
+public:
+	ServerAuthCache(unsigned timeoutSec);
+
+	// Identifies the database secret of a cached login key without keeping it.
+	static std::string GetSecretHash(const std::string &salt, const std::string &secret);
+
+	// Salt of a cached entry, empty if there is none.
+	std::string GetSalt(const std::string &playerName) const;
+	bool Get(const std::string &playerName, const std::string &salt, const std::string &secretHash, std::string &outSaltedPassword) const;
+	void Store(const std::string &playerName, const std::string &salt, const std::string &secretHash, const std::string &saltedPassword);
+	void Remove(const std::string &playerName);
+	void RemoveExpired();
+
+protected:
+	struct CacheEntry {
+		std::string salt;
+		std::string secretHash;
+		std::string saltedPassword;
+		boost::timers::portable::microsec_timer timer;
+	};
+	typedef std::map<std::string, CacheEntry> CacheMap;
+
+	bool IsExpired(const CacheEntry &entry) const;
+
+private:
+	const unsigned m_timeoutSec;
+	CacheMap m_cacheMap;
+	mutable boost::mutex m_cacheMutex;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Worker threads for the authentication of players. */
+
+#ifndef _SERVERAUTHPOOL_H_
+#define _SERVERAUTHPOOL_H_
+
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <string>
+#include <map>
+
+class SessionData;
+
+// The SCRAM steps include a key derivation, which is too expensive
+// to be run on the lobby thread if many players log in at once.
+class ServerAuthPool
+{
+public:
+	typedef boost::function<void (boost::shared_ptr<SessionData>, bool)> ResultHandler;
+
+	ServerAuthPool(boost::shared_ptr<boost::asio::io_service> ioService, unsigned numThreads, unsigned maxPerAddress);
+	~ServerAuthPool();
+
+	void Start();
+	void Stop();
+
+	// Perform an authentication step on a worker thread. The handler is called
+	// by the lobby io service. Returns false if too many steps of the client
+	// address are queued.
+	bool AsyncAuthStep(boost::shared_ptr<SessionData> session, int stepNum, const std::string &inData, ResultHandler handler);
+
+	// Number of queued steps, the maximum is reset by this call.
+	void GetQueueStats(unsigned &curQueued, unsigned &maxQueued, unsigned &numSteps);
+
+protected:
+	typedef std::map<std::string, unsigned> AddressCountMap;
+
+	void InternalAuthStep(boost::shared_ptr<SessionData> session, int stepNum, const std::string &inData, ResultHandler handler);
+	void RunThread();
+
+private:
+	boost::shared_ptr<boost::asio::io_service> m_ioService;
+	const unsigned m_numThreads;
+	const unsigned m_maxPerAddress;
+	boost::asio::io_service m_workService;
+	boost::scoped_ptr<boost::asio::io_service::work> m_work;
+	boost::thread_group m_threads;
+
+	AddressCountMap m_addressCount;
+	unsigned m_curQueued;
+	unsigned m_maxQueued;
+	unsigned m_numSteps;
+	mutable boost::mutex m_queueMutex;
+};
+
+#endif
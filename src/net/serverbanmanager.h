@@ -34,11 +34,14 @@
 #define _SERVERBANMANAGER_H_
 
 #include <db/dbdefs.h>
+#include <net/namepatternmatcher.h>
+#include <net/ipaddresstrie.h>
 #include <boost/asio.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/regex.hpp>
 #include <boost/thread.hpp>
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/unordered_map.hpp>
 #include <map>
 #include <list>
 #include <string>
@@ -70,7 +73,7 @@ protected:
 	struct TimedPlayerBan {
 		boost::shared_ptr<boost::asio::steady_timer> timer;
 		std::string nameStr;
-		boost::regex nameRegex;
+		std::string nameRegex;
 	};
 	struct TimedIPBan {
 		boost::shared_ptr<boost::asio::steady_timer> timer;
@@ -79,7 +82,7 @@ protected:
 
 	typedef std::map<unsigned, TimedPlayerBan> RegexMap;
 	typedef std::map<unsigned, TimedIPBan> IPAddressMap;
-	typedef std::list<boost::regex> RegexList;
+	typedef boost::unordered_map<std::string, unsigned> NameCountMap;
 	typedef std::vector<DB_id> DBPlayerIdList;
 
 	boost::shared_ptr<boost::asio::steady_timer> InternalRegisterTimedBan(unsigned timerId, unsigned durationHours);
@@ -91,8 +94,11 @@ protected:
 
 private:
 	RegexMap m_banPlayerNameMap;
-	RegexList m_gameNameBadWordFilter;
+	NameCountMap m_banPlayerNames;
+	NamePatternMatcher m_banPlayerRegex;
+	NamePatternMatcher m_gameNameBadWordFilter;
 	IPAddressMap m_banIPAddressMap;
+	IPAddressTrie m_banIPAddresses;
 	DBPlayerIdList m_adminPlayers;
 	unsigned m_curBanId;
 	mutable boost::mutex m_banMutex;
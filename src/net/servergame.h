@@ -48,6 +48,7 @@
 class ServerLobbyThread;
 class ServerGameState;
 class ServerDBInterface;
+class ServerSpectatorChannel;
 class PlayerInterface;
 class ConfigFile;
 struct GameData;
@@ -80,14 +81,18 @@ public:
 	ServerCallback &GetCallback();
 	GameState GetCurRound() const;
 
+	// Game data needs to be sent by these functions, to keep the order of the spectator data.
 	void SendToAllPlayers(boost::shared_ptr<NetPacket> packet, int state);
 	void SendToAllButOnePlayers(boost::shared_ptr<NetPacket> packet, SessionId except, int state);
+	void SendToSession(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet);
+	void FlushSpectatorData();
 	void RemoveAllSessions();
 	void MoveSpectatorsToLobby();
 
 	bool IsPasswordProtected() const;
 	bool CheckPassword(const std::string &password) const;
 	static bool CheckSettings(const GameData &data, const std::string &password, ServerMode mode);
+	static boost::shared_ptr<NetPacket> CopyGameSnapshotReplacePlayer(const NetPacket &snapshot, unsigned oldPlayerId, unsigned newPlayerId);
 	const GameData &GetGameData() const;
 
 	boost::shared_ptr<PlayerData> GetPlayerDataByUniqueId(unsigned playerId) const;
@@ -147,6 +152,11 @@ protected:
 	void SetPlayerPlace(unsigned playerId, int place);
 	void ReplaceRankingPlayer(unsigned oldPlayerId, unsigned newPlayerId);
 	void StoreAndResetRanking();
+
+	boost::shared_ptr<NetPacket> GetGameSnapshot() const;
+	void SetGameSnapshot(boost::shared_ptr<NetPacket> packet);
+	void ReplaceGameSnapshotPlayer(unsigned oldPlayerId, unsigned newPlayerId);
+	void InvalidateGameSnapshot();
 	void RemoveAutoLeavePlayers();
 	void InternalEndGame();
 
@@ -230,6 +240,8 @@ private:
 	StartData			m_startData;
 	boost::shared_ptr<Game>	 m_game;
 	ServerGameState			*m_curState;
+	boost::shared_ptr<NetPacket> m_gameSnapshot;
+	boost::shared_ptr<ServerSpectatorChannel> m_spectatorChannel;
 
 	const u_int32_t		m_id;
 	const std::string	m_name;
@@ -202,6 +202,7 @@ protected:
 	static void InitNewSpectators(boost::shared_ptr<ServerGame> server);
 	static void PerformRejoin(boost::shared_ptr<ServerGame> server, boost::shared_ptr<SessionData> session);
 	static void SendGameData(boost::shared_ptr<ServerGame> server, boost::shared_ptr<SessionData> session);
+	static boost::shared_ptr<NetPacket> CreateNetPacketGameSnapshot(ServerGame &server);
 
 private:
 	static ServerGameStateHand s_state;
@@ -57,6 +57,9 @@ class ConfigFile;
 class AvatarManager;
 class ChatCleanerManager;
 class ServerDBInterface;
+class ServerSpectatorFanout;
+class ServerAuthPool;
+class ServerAuthCache;
 struct GameData;
 class Game;
 struct Gsasl;
@@ -123,6 +126,8 @@ public:
 	ServerBanManager &GetBanManager();
 
 	SessionDataCallback &GetSessionDataCallback();
+	boost::shared_ptr<ServerSpectatorFanout> GetSpectatorFanout();
+	unsigned GetMaxSpectatorsPerGame() const;
 
 protected:
 
@@ -145,6 +150,7 @@ protected:
 	void HandlePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet);
 	void HandleNetPacketAuthClientRequest(boost::shared_ptr<SessionData> session, const AuthClientRequestMessage &clientRequest);
 	void HandleNetPacketAuthClientResponse(boost::shared_ptr<SessionData> session, const AuthClientResponseMessage &clientResponse);
+	void AuthClientResponseResult(boost::shared_ptr<SessionData> session, bool authOk);
 	void HandleNetPacketAvatarHeader(boost::shared_ptr<SessionData> session, const AvatarHeaderMessage &avatarHeader);
 	void HandleNetPacketUnknownAvatar(boost::shared_ptr<SessionData> session, const UnknownAvatarMessage &unknownAvatar);
 	void HandleNetPacketAvatarFile(boost::shared_ptr<SessionData> session, const AvatarDataMessage &avatarData);
@@ -166,7 +172,7 @@ protected:
 	bool IsAvatarReported(unsigned playerId) const;
 
 	// TODO would be better to use state pattern here.
-	void AuthChallenge(boost::shared_ptr<SessionData> session, const std::string &secret);
+	void AuthChallenge(boost::shared_ptr<SessionData> session);
 	void CheckAvatarBlacklist(boost::shared_ptr<SessionData> session);
 	void AvatarBlacklisted(unsigned playerId);
 	void AvatarOK(unsigned playerId);
@@ -258,6 +264,10 @@ private:
 	const ServerMode m_mode;
 	std::string m_statisticsFileName;
 	ConfigFile &m_serverConfig;
+	unsigned m_maxLobbySessions;
+	unsigned m_maxTotalSessions;
+	unsigned m_spectatorTickMsec;
+	unsigned m_maxSpectatorsPerGame;
 	u_int32_t m_curGameId;
 
 	u_int32_t m_curUniquePlayerId;
@@ -271,6 +281,9 @@ private:
 	boost::shared_ptr<ServerBanManager> m_banManager;
 	boost::shared_ptr<ChatCleanerManager> m_chatCleanerManager;
 	boost::shared_ptr<ServerDBInterface> m_database;
+	boost::shared_ptr<ServerSpectatorFanout> m_spectatorFanout;
+	boost::shared_ptr<ServerAuthPool> m_authPool;
+	boost::shared_ptr<ServerAuthCache> m_authCache;
 
 	boost::asio::steady_timer m_removeGameTimer;
 	boost::asio::steady_timer m_saveStatisticsTimer;
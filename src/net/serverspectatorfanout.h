@@ -0,0 +1,100 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Fan-out of game data to spectators. */
+
+#ifndef _SERVERSPECTATORFANOUT_H_
+#define _SERVERSPECTATORFANOUT_H_
+
+#include <boost/asio.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <string>
+#include <list>
+#include <net/sessionmanager.h>
+
+class NetPacket;
+
+// Packets for the spectators of one game. Each packet is serialized once,
+// copying the data to the sessions is done by the fan-out threads, or by
+// the publishing thread if the channel is direct.
+// All game data for spectators needs to pass this channel or call Flush
+// first, otherwise the order of the packets is not kept.
+class ServerSpectatorChannel : public boost::enable_shared_from_this<ServerSpectatorChannel>
+{
+public:
+	ServerSpectatorChannel(boost::asio::io_service &ioService, bool direct);
+
+	void Publish(const SessionDataList &recipients, boost::shared_ptr<NetPacket> packet);
+	// Deliver the pending packets on the calling thread. This needs to be done
+	// before other packets are sent to spectators directly, to keep the order.
+	void Flush();
+
+protected:
+	struct PendingData {
+		SessionDataList recipients;
+		std::string data;
+	};
+	typedef std::list<PendingData> PendingList;
+
+	void Deliver();
+
+private:
+	boost::asio::io_service::strand m_strand;
+	const bool m_direct;
+	PendingList m_pending;
+	bool m_deliverPosted;
+	mutable boost::mutex m_pendingMutex;
+	boost::mutex m_deliverMutex;
+};
+
+class ServerSpectatorFanout
+{
+public:
+	ServerSpectatorFanout(unsigned numThreads);
+	~ServerSpectatorFanout();
+
+	void Start();
+	void Stop();
+
+	boost::shared_ptr<ServerSpectatorChannel> CreateChannel();
+
+protected:
+	void RunThread();
+
+private:
+	const unsigned m_numThreads;
+	boost::asio::io_service m_ioService;
+	boost::scoped_ptr<boost::asio::io_service::work> m_ioWork;
+	boost::thread_group m_threads;
+};
+
+#endif
@@ -80,9 +80,15 @@ public:
 	bool CreateServerAuthSession(Gsasl *context);
 	bool CreateClientAuthSession(Gsasl *context, const std::string &userName, const std::string &password);
 	bool AuthStep(int stepNum, const std::string &inData);
+	// Mark a step as queued for a worker thread, false if one is already queued.
+	bool AuthStartStep();
+	void AuthEndStep();
 	std::string AuthGetUser() const;
 	void AuthSetPassword(const std::string &password);
 	std::string AuthGetPassword() const;
+	void AuthSetSaltedPassword(const std::string &saltedPassword);
+	std::string AuthGetSaltedPassword() const;
+	std::string AuthGetSalt() const;
 	std::string AuthGetNextOutMsg() const;
 	int AuthGetCurStepNum() const;
 
@@ -131,6 +137,7 @@ public:
 protected:
 	SessionData(const SessionData &other);
 	SessionData &operator=(const SessionData &other);
+	static std::string InternalDeriveSaltedPassword(const std::string &password, const std::string &salt, unsigned iterations);
 	void InternalClearAuthSession();
 	void TimerInitTimeout(const boost::system::error_code &ec);
 	void TimerSessionTimeout(const boost::system::error_code &ec);
@@ -155,11 +162,17 @@ private:
 	SessionDataCallback				&m_callback;
 	Gsasl_session					*m_authSession;
 	int								m_curAuthStep;
+	bool							m_authStepPending;
 	std::string						m_nextGsaslMsg;
 	std::string						m_password;
+	std::string						m_authSalt;
+	unsigned						m_authIterations;
+	std::string						m_saltedPassword;
 	boost::shared_ptr<PlayerData>	m_playerData;
 
 	mutable boost::mutex			m_dataMutex;
+	// The auth data is separate, so that the lobby thread is not blocked by auth steps.
+	mutable boost::mutex			m_authMutex;
 };
 
 #endif
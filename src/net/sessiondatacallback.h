@@ -48,6 +48,7 @@ public:
 	virtual void SessionError(boost::shared_ptr<SessionData> session, int errorCode) = 0;
 	virtual void SessionTimeoutWarning(boost::shared_ptr<SessionData> session, unsigned remainingSec) = 0;
 	virtual void HandlePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet) = 0;
+	virtual unsigned GetSpectatorFlushDelayMsec() const = 0;
 };
 
 #endif
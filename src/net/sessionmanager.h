@@ -35,6 +35,7 @@
 
 #include <boost/function.hpp>
 #include <map>
+#include <vector>
 
 #include <net/sessiondata.h>
 #include <playerdata.h>
@@ -44,6 +45,8 @@
 class NetPacket;
 class SenderHelper;
 
+typedef std::vector<boost::shared_ptr<SessionData> > SessionDataList;
+
 class SessionManager
 {
 public:
@@ -61,6 +64,7 @@ public:
 	PlayerDataList GetPlayerDataList() const;
 	PlayerDataList GetSpectatorDataList() const;
 	PlayerIdList GetPlayerIdList(int state) const;
+	SessionDataList GetSessionList(int state) const;
 	bool IsPlayerConnected(const std::string &playerName) const;
 	bool IsPlayerConnected(unsigned uniqueId) const;
 	bool IsClientAddressConnected(const std::string &clientAddress) const;
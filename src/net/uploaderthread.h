@@ -34,28 +34,37 @@
 #define _UPLOADERTHREAD_H_
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
 #include <queue>
+#include <set>
 #include <core/thread.h>
 
 
 #define UPLOADER_THREAD_TERMINATE_TIMEOUT		THREAD_WAIT_INFINITE
-class UploadHelper;
+#define UPLOADER_MAX_PARALLEL_TRANSFERS			4
+#define UPLOADER_MAX_RETRIES					3
+#define UPLOADER_RETRY_DELAY_MSEC				1000
+#define UPLOADER_TRANSFER_TIMEOUT_SEC			30
 class UploadCallback;
 
 class UploaderThread : public Thread
 {
 public:
 
-	UploaderThread(UploadCallback *callback = NULL);
+	UploaderThread(UploadCallback *callback = NULL, unsigned maxParallelTransfers = UPLOADER_MAX_PARALLEL_TRANSFERS,
+				   unsigned retryDelayMsec = UPLOADER_RETRY_DELAY_MSEC, unsigned transferTimeoutSec = UPLOADER_TRANSFER_TIMEOUT_SEC);
 	virtual ~UploaderThread();
 
+	virtual void SignalTermination();
+
+	// Uploads which are already queued or in progress for the same target are ignored.
 	void QueueUpload(const std::string &url, const std::string &user, const std::string &pwd, const std::string &filename, size_t filesize, const std::string &httpPost = "");
 
 protected:
 	struct UploadData {
-		UploadData() : filesize(0) {}
+		UploadData() : filesize(0), numRetries(0) {}
 		UploadData(const std::string &a, const std::string &u, const std::string &p, const std::string &f, size_t s, const std::string &h)
-			: address(a), user(u), pwd(p), filename(f), filesize(s), httpPost(h) {}
+			: address(a), user(u), pwd(p), filename(f), filesize(s), httpPost(h), numRetries(0) {}
 
 		std::string address;
 		std::string user;
@@ -63,22 +72,38 @@ protected:
 		std::string filename;
 		size_t filesize;
 		std::string httpPost;
+		std::string key;
+		unsigned numRetries;
+		boost::system_time retryTime;
 	};
+	struct TransferContext;
 
 	typedef std::queue<UploadData> UploadDataQueue;
+	typedef std::set<std::string> UploadKeySet;
 
 	// Main function of the thread.
 	virtual void Main();
 
+	void InternalStartTransfers(TransferContext &context);
+	bool InternalStartTransfer(TransferContext &context, const UploadData &data);
+	void InternalProcessTransfers(TransferContext &context);
+	void InternalFinishTransfer(TransferContext &context, void *handle, bool success, const std::string &errorMsg);
+	void InternalAbortTransfers(TransferContext &context);
+
+	static std::string GetUploadUrl(const UploadData &data);
+
 private:
 
 	UploadDataQueue m_uploadQueue;
+	UploadKeySet m_uploadKeys;
 	mutable boost::mutex m_uploadQueueMutex;
+	boost::condition_variable m_uploadQueueCond;
+	bool m_terminate;
 
-	boost::shared_ptr<UploadHelper> m_uploadHelper;
-	bool m_uploadInProgress;
 	UploadCallback *m_callback;
+	const unsigned m_maxParallelTransfers;
+	const unsigned m_retryDelayMsec;
+	const unsigned m_transferTimeoutSec;
 };
 
 #endif
-
@@ -34,7 +34,9 @@
 #define _WEBSENDBUFFER_H_
 
 #include <net/sendbuffer.h>
+#include <boost/asio/steady_timer.hpp>
 #include <cstdlib>
+#include <list>
 
 class WebSendBuffer : public SendBuffer
 {
@@ -42,14 +44,28 @@ public:
 	WebSendBuffer();
 
 	virtual void SetCloseAfterSend();
+	virtual void SetFlushDelay(unsigned delayMsec);
 
 	virtual void AsyncSendNextPacket(boost::shared_ptr<SessionData> session);
 	virtual void InternalStorePacket(boost::shared_ptr<SessionData> session, boost::shared_ptr<NetPacket> packet);
+	virtual void InternalStoreSerialized(boost::shared_ptr<SessionData> session, const std::string &data);
 
 	virtual void HandleWrite(boost::shared_ptr<boost::asio::ip::tcp::socket> socket, const boost::system::error_code &error);
 
+protected:
+	typedef std::list<server::message_ptr> MessageList;
+
+	// Packets stored while handling one event are sent together.
+	void FlushPending(boost::shared_ptr<SessionData> session);
+	server::message_ptr CreateMessage(size_t reserveSize) const;
+
 private:
+	boost::shared_ptr<boost::asio::steady_timer> flushTimer;
+	unsigned flushDelayMsec;
 	bool closeAfterSend;
+	bool flushPosted;
+	MessageList pendingMsgs;
+	server::message_ptr pendingBatch;
 };
 
 #endif
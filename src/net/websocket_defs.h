@@ -35,7 +35,19 @@
 
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
+#include <net/websocketdeflate.h>
 
-typedef websocketpp::server<websocketpp::config::asio> server;
+// Subprotocol which allows the server to put several length prefixed
+// messages into one binary frame (same framing as TCP).
+#define WEBSOCKET_BATCH_SUBPROTOCOL		"pokerth-batch"
+
+struct websocket_config : public websocketpp::config::asio {
+	typedef websocket_config type;
+	typedef websocketpp::config::asio base;
+
+	typedef WebSocketDeflate<base::permessage_deflate_config> permessage_deflate_type;
+};
+
+typedef websocketpp::server<websocket_config> server;
 
 #endif
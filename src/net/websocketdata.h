@@ -37,8 +37,10 @@
 
 
 struct WebSocketData {
+	WebSocketData() : batchFrames(false) {}
 	boost::shared_ptr<server> webSocketServer;
 	websocketpp::connection_hdl webHandle;
+	bool batchFrames;
 };
 
 #endif
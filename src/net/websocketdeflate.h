@@ -0,0 +1,264 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2013 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Server side permessage-deflate (RFC 7692) extension for websocketpp. */
+
+#ifndef _WEBSOCKETDEFLATE_H_
+#define _WEBSOCKETDEFLATE_H_
+
+#include <websocketpp/common/cpp11.hpp>
+#include <websocketpp/common/system_error.hpp>
+#include <websocketpp/error.hpp>
+#include <websocketpp/http/constants.hpp>
+
+#include <boost/lexical_cast.hpp>
+#include <zlib.h>
+#include <cstring>
+#include <string>
+#include <utility>
+
+// Upper limit for the size of an inflated client message.
+#define WEBSOCKET_MAX_INFLATED_SIZE		(256 * 1024)
+#define WEBSOCKET_DEFLATE_MEM_LEVEL		5
+
+struct WebSocketDeflateSettings {
+	WebSocketDeflateSettings()
+		: enabled(false), contextTakeover(true), maxWindowBits(15), compressThreshold(128) {}
+	bool enabled;
+	bool contextTakeover;
+	unsigned maxWindowBits;
+	unsigned compressThreshold;
+};
+
+// Process wide settings, set once before the websocket server starts listening.
+inline WebSocketDeflateSettings &GetWebSocketDeflateSettings()
+{
+	static WebSocketDeflateSettings settings;
+	return settings;
+}
+
+// The permessage-deflate extension shipped with websocketpp 0.5.0 implements
+// an old draft (s2c_/c2s_ parameter names) and is therefore not accepted by
+// browsers. This class implements the same interface following RFC 7692.
+// zlib streams are created lazily, so connections which never send or
+// receive a compressed message do not pay for the compression state.
+template <typename config>
+class WebSocketDeflate
+{
+public:
+	typedef std::pair<websocketpp::lib::error_code, std::string> err_str_pair;
+
+	WebSocketDeflate()
+		: m_enabled(false), m_deflateInit(false), m_inflateInit(false),
+		  m_serverNoContextTakeover(false), m_serverMaxWindowBits(15)
+	{
+		memset(&m_deflate, 0, sizeof(m_deflate));
+		memset(&m_inflate, 0, sizeof(m_inflate));
+	}
+
+	~WebSocketDeflate()
+	{
+		if (m_deflateInit)
+			deflateEnd(&m_deflate);
+		if (m_inflateInit)
+			inflateEnd(&m_inflate);
+	}
+
+	bool is_implemented() const
+	{
+		return true;
+	}
+
+	bool is_enabled() const
+	{
+		return m_enabled;
+	}
+
+	err_str_pair negotiate(websocketpp::http::attribute_list const &offer)
+	{
+		const WebSocketDeflateSettings &settings = GetWebSocketDeflateSettings();
+		// Accept only the first acceptable offer.
+		if (!settings.enabled || m_enabled) {
+			return Decline();
+		}
+		bool serverNoContextTakeover = !settings.contextTakeover;
+		unsigned serverMaxWindowBits = settings.maxWindowBits;
+
+		websocketpp::http::attribute_list::const_iterator i = offer.begin();
+		websocketpp::http::attribute_list::const_iterator end = offer.end();
+		while (i != end) {
+			if (i->first == "server_no_context_takeover") {
+				if (!i->second.empty()) {
+					return Decline();
+				}
+				serverNoContextTakeover = true;
+			} else if (i->first == "client_no_context_takeover") {
+				if (!i->second.empty()) {
+					return Decline();
+				}
+				// We keep the inflate context, this is correct in any case.
+			} else if (i->first == "server_max_window_bits") {
+				unsigned bits = ParseWindowBits(i->second);
+				// zlib does not support raw deflate with a window of 2^8.
+				if (bits < 9) {
+					return Decline();
+				}
+				if (bits < serverMaxWindowBits) {
+					serverMaxWindowBits = bits;
+				}
+			} else if (i->first == "client_max_window_bits") {
+				// Value is optional. We always inflate with the maximum window.
+				if (!i->second.empty() && ParseWindowBits(i->second) < 8) {
+					return Decline();
+				}
+			} else {
+				return Decline();
+			}
+			++i;
+		}
+
+		m_enabled = true;
+		m_serverNoContextTakeover = serverNoContextTakeover;
+		m_serverMaxWindowBits = serverMaxWindowBits;
+
+		std::string response("permessage-deflate");
+		if (m_serverNoContextTakeover) {
+			response += "; server_no_context_takeover";
+		}
+		if (m_serverMaxWindowBits < 15) {
+			response += "; server_max_window_bits=" + boost::lexical_cast<std::string>(m_serverMaxWindowBits);
+		}
+		return std::make_pair(websocketpp::lib::error_code(), response);
+	}
+
+	websocketpp::lib::error_code compress(std::string const &in, std::string &out)
+	{
+		if (!m_deflateInit) {
+			if (deflateInit2(&m_deflate, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -static_cast<int>(m_serverMaxWindowBits),
+							 WEBSOCKET_DEFLATE_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+				return websocketpp::error::make_error_code(websocketpp::error::general);
+			}
+			m_deflateInit = true;
+		}
+		const size_t offset = out.size();
+		m_deflate.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in.data()));
+		m_deflate.avail_in = static_cast<uInt>(in.size());
+		const size_t chunkSize = in.size() / 2 + 64;
+		do {
+			size_t pos = out.size();
+			out.resize(pos + chunkSize);
+			m_deflate.next_out = reinterpret_cast<Bytef *>(&out[pos]);
+			m_deflate.avail_out = static_cast<uInt>(chunkSize);
+			int ret = deflate(&m_deflate, Z_SYNC_FLUSH);
+			out.resize(pos + chunkSize - m_deflate.avail_out);
+			if (ret != Z_OK && ret != Z_BUF_ERROR) {
+				return websocketpp::error::make_error_code(websocketpp::error::general);
+			}
+		} while (m_deflate.avail_out == 0);
+
+		// Strip the empty block which terminates the sync flush (RFC 7692 7.2.1).
+		if (out.size() - offset >= 4 && memcmp(&out[out.size() - 4], "\x00\x00\xff\xff", 4) == 0) {
+			out.resize(out.size() - 4);
+		}
+		if (out.size() == offset) {
+			out.push_back('\0');
+		}
+		if (m_serverNoContextTakeover) {
+			deflateReset(&m_deflate);
+		}
+		return websocketpp::lib::error_code();
+	}
+
+	websocketpp::lib::error_code decompress(uint8_t const *buf, size_t len, std::string &out)
+	{
+		if (!m_inflateInit) {
+			if (inflateInit2(&m_inflate, -15) != Z_OK) {
+				return websocketpp::error::make_error_code(websocketpp::error::general);
+			}
+			m_inflateInit = true;
+		}
+		m_inflate.next_in = const_cast<Bytef *>(buf);
+		m_inflate.avail_in = static_cast<uInt>(len);
+		do {
+			size_t pos = out.size();
+			size_t chunkSize = len * 4 + 64;
+			// Allow one byte beyond the limit, so that input which does not
+			// produce further output (e.g. the trailer) is still accepted.
+			if (pos + chunkSize > WEBSOCKET_MAX_INFLATED_SIZE + 1) {
+				chunkSize = WEBSOCKET_MAX_INFLATED_SIZE + 1 - pos;
+			}
+			out.resize(pos + chunkSize);
+			m_inflate.next_out = reinterpret_cast<Bytef *>(&out[pos]);
+			m_inflate.avail_out = static_cast<uInt>(chunkSize);
+			int ret = inflate(&m_inflate, Z_SYNC_FLUSH);
+			out.resize(pos + chunkSize - m_inflate.avail_out);
+			if (out.size() > WEBSOCKET_MAX_INFLATED_SIZE) {
+				out.resize(WEBSOCKET_MAX_INFLATED_SIZE);
+				return websocketpp::error::make_error_code(websocketpp::error::payload_violation);
+			}
+			if (ret == Z_STREAM_END) {
+				// The client terminated the stream with a final block.
+				inflateReset(&m_inflate);
+			} else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+				return websocketpp::error::make_error_code(websocketpp::error::payload_violation);
+			} else if (ret == Z_BUF_ERROR && m_inflate.avail_out != 0) {
+				// No progress possible, input is incomplete.
+				break;
+			}
+		} while (m_inflate.avail_in > 0 || m_inflate.avail_out == 0);
+		return websocketpp::lib::error_code();
+	}
+
+protected:
+	static err_str_pair Decline()
+	{
+		return std::make_pair(websocketpp::error::make_error_code(websocketpp::error::general), std::string());
+	}
+
+	static unsigned ParseWindowBits(const std::string &value)
+	{
+		unsigned bits = 0;
+		if (value.size() > 0 && value.size() <= 2 && value.find_first_not_of("0123456789") == std::string::npos) {
+			bits = boost::lexical_cast<unsigned>(value);
+		}
+		return bits >= 8 && bits <= 15 ? bits : 0;
+	}
+
+private:
+	z_stream m_deflate;
+	z_stream m_inflate;
+	bool m_enabled;
+	bool m_deflateInit;
+	bool m_inflateInit;
+	bool m_serverNoContextTakeover;
+	unsigned m_serverMaxWindowBits;
+};
+
+#endif
@@ -187,6 +187,7 @@ main(int argc, char *argv[])
 	myConfig.reset();
 
 	LOG_MSG("Terminating PokerTH dedicated server." << endl);
+	loghelper_cleanup();
 	socket_cleanup();
 	return 0;
 }
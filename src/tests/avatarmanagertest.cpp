@@ -0,0 +1,307 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <core/avatarmanager.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+using namespace boost::filesystem;
+
+#define AVATAR_TEST_WAIT_MSEC		10000
+
+// Gives access to the index functions.
+class AvatarManagerIndexTest : public AvatarManager
+{
+public:
+	typedef AvatarManager::AvatarIndexMap IndexMap;
+	typedef AvatarManager::AvatarIndexEntry IndexEntry;
+
+	using AvatarManager::InternalLoadIndex;
+	using AvatarManager::InternalSaveIndex;
+};
+
+// A temp directory which is removed with its contents.
+class AvatarTestDir
+{
+public:
+	AvatarTestDir() : m_tmpName("")
+	{
+		create_directory(m_tmpName.GetName());
+	}
+	~AvatarTestDir()
+	{
+		boost::system::error_code ec;
+		remove_all(m_tmpName.GetName(), ec);
+	}
+	string GetFileName(const string &name) const
+	{
+		return (path(m_tmpName.GetName()) / name).string();
+	}
+	const string &GetName() const
+	{
+		return m_tmpName.GetName();
+	}
+
+private:
+	UnitTestTempFile m_tmpName;
+};
+
+static string
+CreateTestAvatarData(unsigned seed, size_t size)
+{
+	string data("\x89\x50\x4e\x47\x0d\x0a\x1a\x0a", 8);
+	while (data.size() < size)
+		data += static_cast<char>((data.size() * 7 + seed * 13) & 0xff);
+	return data;
+}
+
+static bool
+WriteTestAvatarFile(const string &fileName, const string &data)
+{
+	std::ofstream o(fileName.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+	o.write(data.data(), data.size());
+	return !o.fail();
+}
+
+// Returns the MD5 sum of the data, as the file name in the cache.
+static MD5Buf
+GetTestAvatarMD5(const AvatarTestDir &dir, const string &data)
+{
+	string tmpFileName(dir.GetFileName("md5.tmp"));
+	MD5Buf md5buf;
+	UNITTEST_CHECK(WriteTestAvatarFile(tmpFileName, data));
+	UNITTEST_CHECK(CryptHelper::MD5Sum(tmpFileName, md5buf));
+	remove(tmpFileName);
+	return md5buf;
+}
+
+static MD5Buf
+CreateTestMD5(unsigned num)
+{
+	ostringstream md5sum;
+	md5sum << hex << setw(32) << setfill('0') << num;
+	MD5Buf md5buf;
+	UNITTEST_CHECK(md5buf.FromString(md5sum.str()));
+	return md5buf;
+}
+
+static bool
+WaitForRevalidation(const AvatarManager &manager)
+{
+	boost::system_time deadline(boost::get_system_time() + boost::posix_time::milliseconds(AVATAR_TEST_WAIT_MSEC));
+	while (!manager.IsCacheRevalidated()) {
+		if (boost::get_system_time() > deadline)
+			return false;
+		boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+	}
+	return true;
+}
+
+void
+TestAvatarPacketCache()
+{
+	AvatarTestDir testDir;
+	const string avatarData(CreateTestAvatarData(1, 1000));
+	const string avatarFileName(testDir.GetFileName("avatar.png"));
+	UNITTEST_CHECK(WriteTestAvatarFile(avatarFileName, avatarData));
+
+	AvatarManager manager;
+	NetPacketList packets;
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(0), avatarFileName, 5, packets) == 0);
+	// Header, data blocks and end.
+	UNITTEST_CHECK(packets.size() == 2 + (avatarData.size() + MAX_FILE_DATA_SIZE - 1) / MAX_FILE_DATA_SIZE);
+	UNITTEST_CHECK(packets.front()->GetMsg()->lobbymessage().avatarheadermessage().avatarsize() == avatarData.size());
+	string blocks;
+	NetPacketList::const_iterator i = packets.begin();
+	while (i != packets.end()) {
+		const LobbyMessage &netLobby = (*i)->GetMsg()->lobbymessage();
+		if (netLobby.messagetype() == LobbyMessage::Type_AvatarDataMessage) {
+			UNITTEST_CHECK(netLobby.avatardatamessage().requestid() == 5);
+			blocks += netLobby.avatardatamessage().avatarblock();
+		}
+		++i;
+	}
+	UNITTEST_CHECK(blocks == avatarData);
+
+	// The same request id shares the packets, another one gets copies.
+	NetPacketList samePackets;
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(0), avatarFileName, 5, samePackets) == 0);
+	UNITTEST_CHECK(samePackets == packets);
+	NetPacketList otherPackets;
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(0), avatarFileName, 6, otherPackets) == 0);
+	UNITTEST_CHECK(otherPackets.size() == packets.size());
+	UNITTEST_CHECK(otherPackets.front() != packets.front());
+	UNITTEST_CHECK(otherPackets.back()->GetMsg()->lobbymessage().avatarendmessage().requestid() == 6);
+	UNITTEST_CHECK(packets.back()->GetMsg()->lobbymessage().avatarendmessage().requestid() == 5);
+
+	unsigned hits, misses, numEntries;
+	manager.GetPacketCacheStats(hits, misses, numEntries);
+	UNITTEST_CHECK(hits == 2 && misses == 1 && numEntries == 1);
+
+	// Fill the cache, entry 0 is used again and entry 1 is the oldest.
+	for (unsigned n = 1; n < MAX_AVATAR_PACKET_CACHE_ENTRIES; n++) {
+		NetPacketList tmpPackets;
+		UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(n), avatarFileName, 5, tmpPackets) == 0);
+	}
+	packets.clear();
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(0), avatarFileName, 5, packets) == 0);
+	manager.GetPacketCacheStats(hits, misses, numEntries);
+	UNITTEST_CHECK(hits == 3 && misses == MAX_AVATAR_PACKET_CACHE_ENTRIES && numEntries == MAX_AVATAR_PACKET_CACHE_ENTRIES);
+
+	// Cached entries do not read the file, the oldest entry is evicted.
+	remove(avatarFileName);
+	packets.clear();
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(MAX_AVATAR_PACKET_CACHE_ENTRIES), avatarFileName, 5, packets) != 0);
+	UNITTEST_CHECK(packets.empty());
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(0), avatarFileName, 5, packets) == 0);
+	UNITTEST_CHECK(!packets.empty());
+	UNITTEST_CHECK(WriteTestAvatarFile(avatarFileName, avatarData));
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(MAX_AVATAR_PACKET_CACHE_ENTRIES), avatarFileName, 5, packets) == 0);
+	remove(avatarFileName);
+	packets.clear();
+	UNITTEST_CHECK(manager.CachedAvatarToNetPackets(CreateTestMD5(1), avatarFileName, 5, packets) != 0);
+	manager.GetPacketCacheStats(hits, misses, numEntries);
+	UNITTEST_CHECK(numEntries == MAX_AVATAR_PACKET_CACHE_ENTRIES);
+}
+
+void
+TestAvatarCacheIndex()
+{
+	AvatarTestDir testDir;
+	const string indexFileName(testDir.GetFileName(AVATAR_CACHE_INDEX_FILE_NAME));
+
+	AvatarManagerIndexTest::IndexMap index;
+	AvatarManagerIndexTest::IndexEntry entry;
+	entry.md5buf = CreateTestMD5(1);
+	entry.size = 1234;
+	entry.lastWriteTime = 1400000000;
+	index[testDir.GetFileName("00000000000000000000000000000001.png")] = entry;
+	entry.md5buf = CreateTestMD5(2);
+	entry.size = MAX_AVATAR_FILE_SIZE;
+	entry.lastWriteTime = 1;
+	index[testDir.GetFileName("file name with spaces.gif")] = entry;
+
+	AvatarManagerIndexTest::IndexMap loadedIndex;
+	UNITTEST_CHECK(!AvatarManagerIndexTest::InternalLoadIndex(indexFileName, loadedIndex));
+	UNITTEST_CHECK(AvatarManagerIndexTest::InternalSaveIndex(indexFileName, index));
+	UNITTEST_CHECK(!exists(indexFileName + ".tmp"));
+	UNITTEST_CHECK(AvatarManagerIndexTest::InternalLoadIndex(indexFileName, loadedIndex));
+	UNITTEST_CHECK(loadedIndex.size() == index.size());
+	AvatarManagerIndexTest::IndexMap::const_iterator i = index.begin();
+	while (i != index.end()) {
+		AvatarManagerIndexTest::IndexMap::const_iterator pos = loadedIndex.find(i->first);
+		UNITTEST_CHECK(pos != loadedIndex.end());
+		if (pos != loadedIndex.end()) {
+			UNITTEST_CHECK(pos->second.md5buf == i->second.md5buf);
+			UNITTEST_CHECK(pos->second.size == i->second.size);
+			UNITTEST_CHECK(pos->second.lastWriteTime == i->second.lastWriteTime);
+		}
+		++i;
+	}
+
+	// A damaged index is not used.
+	{
+		std::ofstream o(indexFileName.c_str(), ios_base::out | ios_base::app);
+		o << "nomd5 12 34 " << testDir.GetFileName("x.png") << "\n";
+	}
+	loadedIndex.clear();
+	UNITTEST_CHECK(!AvatarManagerIndexTest::InternalLoadIndex(indexFileName, loadedIndex));
+}
+
+void
+TestAvatarCacheRevalidation()
+{
+	AvatarTestDir testDir;
+	const string removedData(CreateTestAvatarData(1, 500));
+	const string changedData(CreateTestAvatarData(2, 600));
+	const string keptData(CreateTestAvatarData(3, 700));
+	const string newData(CreateTestAvatarData(4, 800));
+	const MD5Buf removedMD5(GetTestAvatarMD5(testDir, removedData));
+	const MD5Buf changedMD5(GetTestAvatarMD5(testDir, changedData));
+	const MD5Buf keptMD5(GetTestAvatarMD5(testDir, keptData));
+	const MD5Buf newMD5(GetTestAvatarMD5(testDir, newData));
+	const string indexFileName(testDir.GetFileName(AVATAR_CACHE_INDEX_FILE_NAME));
+	AvatarManagerIndexTest::IndexMap index;
+
+	{
+		AvatarManager manager;
+		manager.Init(testDir.GetName(), testDir.GetName());
+		UNITTEST_CHECK(WaitForRevalidation(manager));
+		UNITTEST_CHECK(manager.StoreAvatarInCache(removedMD5, AVATAR_FILE_TYPE_PNG, (const unsigned char *)removedData.data(), removedData.size(), false));
+		UNITTEST_CHECK(manager.StoreAvatarInCache(changedMD5, AVATAR_FILE_TYPE_PNG, (const unsigned char *)changedData.data(), changedData.size(), false));
+		UNITTEST_CHECK(manager.StoreAvatarInCache(keptMD5, AVATAR_FILE_TYPE_PNG, (const unsigned char *)keptData.data(), keptData.size(), false));
+	}
+	// The index is written on destruction.
+	UNITTEST_CHECK(AvatarManagerIndexTest::InternalLoadIndex(indexFileName, index));
+	UNITTEST_CHECK(index.size() == 3);
+
+	string removedFileName, changedFileName;
+	{
+		AvatarManager manager;
+		manager.Init(testDir.GetName(), testDir.GetName());
+		UNITTEST_CHECK(WaitForRevalidation(manager));
+		UNITTEST_CHECK(manager.GetAvatarFileName(removedMD5, removedFileName));
+		UNITTEST_CHECK(manager.GetAvatarFileName(changedMD5, changedFileName));
+		UNITTEST_CHECK(manager.HasAvatar(keptMD5));
+	}
+
+	// Modify the cache directory while the server is not running.
+	remove(removedFileName);
+	UNITTEST_CHECK(WriteTestAvatarFile(changedFileName, CreateTestAvatarData(5, 650)));
+	UNITTEST_CHECK(WriteTestAvatarFile(testDir.GetFileName(newMD5.ToString() + ".png"), newData));
+	UNITTEST_CHECK(WriteTestAvatarFile(testDir.GetFileName("notanmd5.png"), newData));
+
+	{
+		AvatarManager manager;
+		manager.Init(testDir.GetName(), testDir.GetName());
+		UNITTEST_CHECK(WaitForRevalidation(manager));
+		UNITTEST_CHECK(!manager.HasAvatar(removedMD5));
+		UNITTEST_CHECK(!manager.HasAvatar(changedMD5));
+		UNITTEST_CHECK(manager.HasAvatar(keptMD5));
+		UNITTEST_CHECK(manager.HasAvatar(newMD5));
+	}
+	index.clear();
+	UNITTEST_CHECK(AvatarManagerIndexTest::InternalLoadIndex(indexFileName, index));
+	UNITTEST_CHECK(index.size() == 2);
+	UNITTEST_CHECK(index.find(changedFileName) == index.end());
+	AvatarManagerIndexTest::IndexMap::const_iterator pos = index.find(testDir.GetFileName(newMD5.ToString() + ".png"));
+	UNITTEST_CHECK(pos != index.end());
+	if (pos != index.end()) {
+		UNITTEST_CHECK(pos->second.md5buf == newMD5);
+		UNITTEST_CHECK(pos->second.size == newData.size());
+	}
+}
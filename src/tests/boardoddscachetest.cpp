@@ -0,0 +1,122 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <engine/local_engine/boardoddscache.h>
+#include <engine/local_engine/cardsvalue.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <algorithm>
+
+using namespace std;
+
+#define BOARD_ODDS_SEED				4711
+#define BOARD_ODDS_NUM_BOARDS		8
+#define BOARD_ODDS_NUM_PLAYERS		4
+
+#define CARD_SET(cards, idx)	((cards)[(idx)/13] & (1 << ((idx)%13)))
+#define CARD_ADD(cards, idx)	((cards)[(idx)/13] |= (1 << ((idx)%13)))
+#define CARD_DEL(cards, idx)	((cards)[(idx)/13] &= ~(1 << ((idx)%13)))
+
+// The turn and river loops of LocalPlayer::calcMyOdds before the cache,
+// kept as reference. Every opponent hand is evaluated for every player.
+static double
+ReferenceCalcOdds(const int boardCards[5], int boardSize, const int holeCards[2])
+{
+	int myCards[4] = { 0,0,0,0 };
+	int opponentCards[4] = { 0,0,0,0 };
+	int i;
+	for(i=0; i<boardSize; i++) CARD_ADD(myCards, boardCards[i]);
+	copy(myCards, myCards + 4, opponentCards);
+	for(i=0; i<2; i++) CARD_ADD(myCards, holeCards[i]);
+
+	int countAll = 0;
+	int countMy = 0;
+	for(int river=0; river<52; river++) {
+		if(boardSize == 4) {
+			if(CARD_SET(myCards, river))
+				continue;
+			CARD_ADD(myCards, river);
+			CARD_ADD(opponentCards, river);
+		} else if(river > 0) {
+			break;
+		}
+		for(int card1=0; card1<51; card1++) {
+			if(CARD_SET(myCards, card1))
+				continue;
+			CARD_ADD(opponentCards, card1);
+			for(int card2=card1+1; card2<52; card2++) {
+				if(CARD_SET(myCards, card2))
+					continue;
+				CARD_ADD(opponentCards, card2);
+				countAll++;
+				if(CardsValue::cardsValue(myCards) >= CardsValue::cardsValue(opponentCards))
+					countMy++;
+				CARD_DEL(opponentCards, card2);
+			}
+			CARD_DEL(opponentCards, card1);
+		}
+		if(boardSize == 4) {
+			CARD_DEL(myCards, river);
+			CARD_DEL(opponentCards, river);
+		}
+	}
+	return 100.0*(countMy*1.0)/(countAll*1.0);
+}
+
+void
+TestBoardOddsCacheReference()
+{
+	boost::random::mt19937 rng(BOARD_ODDS_SEED);
+	BoardOddsCache cache;
+	int deck[52];
+
+	for(int run=0; run<BOARD_ODDS_NUM_BOARDS; run++) {
+		for(int i=0; i<52; i++)
+			deck[i] = i;
+		for(int i=0; i<5+2*BOARD_ODDS_NUM_PLAYERS; i++) {
+			boost::random::uniform_int_distribution<> dist(i, 51);
+			swap(deck[i], deck[dist(rng)]);
+		}
+		const int *boardCards = deck;
+
+		// Turn and river of the same board, the cache is shared by all players.
+		for(int boardSize=4; boardSize<=5; boardSize++) {
+			for(int player=0; player<BOARD_ODDS_NUM_PLAYERS; player++) {
+				const int *holeCards = &deck[5 + 2*player];
+				UNITTEST_CHECK(cache.calcOdds(boardCards, boardSize, holeCards) == ReferenceCalcOdds(boardCards, boardSize, holeCards));
+			}
+		}
+		// Back to the turn, the cache is prepared again.
+		UNITTEST_CHECK(cache.calcOdds(boardCards, 4, &deck[5]) == ReferenceCalcOdds(boardCards, 4, &deck[5]));
+	}
+}
@@ -0,0 +1,463 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <chatcleaner/ahocorasick.h>
+#include <chatcleaner/badwordcheck.h>
+#include <chatcleaner/urlcheck.h>
+#include <chatcleaner/flathashmap.h>
+#include <chatcleaner/textfloodcheck.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <list>
+#include <map>
+
+using namespace std;
+
+#define CHAT_CLEANER_TEST_SEED			4711
+#define CHAT_CLEANER_TEST_ITERATIONS	2000
+
+// Bad word check as it is specified: a message is bad if it contains a bad
+// word for which no exception containing this bad word is part of the message.
+static bool
+ReferenceBadWordCheck(const list<string> &badWords, const list<string> &exceptions, const string &msg)
+{
+	string foldedMsg(AhoCorasick::foldCase(msg));
+	list<string>::const_iterator it = badWords.begin();
+	while (it != badWords.end()) {
+		string bw(AhoCorasick::foldCase(*it));
+		if (!bw.empty() && foldedMsg.find(bw) != string::npos) {
+			bool exception = false;
+			list<string>::const_iterator it2 = exceptions.begin();
+			while (it2 != exceptions.end()) {
+				string bwe(AhoCorasick::foldCase(*it2));
+				if (bwe.find(bw) != string::npos && foldedMsg.find(bwe) != string::npos)
+					exception = true;
+				++it2;
+			}
+			if (!exception)
+				return true;
+		}
+		++it;
+	}
+	return false;
+}
+
+static string
+RandomChatText(boost::random::mt19937 &gen, size_t maxLen)
+{
+	// Few distinct letters, so that patterns occur and overlap often.
+	static const char *const letters[] = { "a", "b", "A", "B", " ", "\xc3\xbc", "\xc3\x9c", "\xd0\xb6", "\xd0\x96" };
+	boost::random::uniform_int_distribution<size_t> lenDist(0, maxLen);
+	boost::random::uniform_int_distribution<size_t> letterDist(0, sizeof(letters) / sizeof(letters[0]) - 1);
+	string text;
+	size_t len = lenDist(gen);
+	for (size_t i = 0; i < len; i++)
+		text += letters[letterDist(gen)];
+	return text;
+}
+
+void
+TestAhoCorasickOverlapping()
+{
+	AhoCorasick matcher;
+	unsigned he = matcher.addPattern("he");
+	unsigned she = matcher.addPattern("she");
+	unsigned his = matcher.addPattern("his");
+	unsigned hers = matcher.addPattern("hers");
+	unsigned empty = matcher.addPattern("");
+	unsigned sheAgain = matcher.addPattern("she");
+	matcher.build();
+	UNITTEST_CHECK(matcher.getNumPatterns() == 6);
+
+	vector<char> found;
+	// Patterns ending at the same position and patterns within patterns.
+	UNITTEST_CHECK(matcher.scan("ushers", found));
+	UNITTEST_CHECK(found[he] && found[she] && found[hers] && found[sheAgain]);
+	UNITTEST_CHECK(!found[his] && !found[empty]);
+
+	// The failure links must continue the match after a mismatch.
+	UNITTEST_CHECK(matcher.scan("shhis", found));
+	UNITTEST_CHECK(found[his] && !found[he] && !found[she] && !found[hers]);
+
+	UNITTEST_CHECK(!matcher.scan("", found));
+	UNITTEST_CHECK(found.size() == 6);
+	UNITTEST_CHECK(!matcher.scan("sh e", found));
+
+	// Adding patterns after build() requires another build().
+	matcher.addPattern("xyz");
+	UNITTEST_CHECK(!matcher.scan("xyz", found));
+	matcher.build();
+	UNITTEST_CHECK(matcher.scan("xyz", found) && found[6]);
+
+	// Compare with a naive search.
+	boost::random::mt19937 gen(CHAT_CLEANER_TEST_SEED);
+	for (unsigned n = 0; n < CHAT_CLEANER_TEST_ITERATIONS / 10; n++) {
+		AhoCorasick randomMatcher;
+		vector<string> patterns;
+		for (unsigned p = 0; p < 10; p++) {
+			patterns.push_back(RandomChatText(gen, 4));
+			randomMatcher.addPattern(patterns.back());
+		}
+		randomMatcher.build();
+		for (unsigned t = 0; t < 10; t++) {
+			string text(RandomChatText(gen, 30));
+			bool any = randomMatcher.scan(text, found);
+			bool expectedAny = false;
+			for (unsigned p = 0; p < patterns.size(); p++) {
+				bool expected = !patterns[p].empty() && text.find(patterns[p]) != string::npos;
+				UNITTEST_CHECK((found[p] != 0) == expected);
+				expectedAny |= expected;
+			}
+			UNITTEST_CHECK(any == expectedAny);
+		}
+	}
+}
+
+void
+TestAhoCorasickCaseFolding()
+{
+	// Latin-1, Latin Extended-A, Greek and Cyrillic upper case letters.
+	UNITTEST_CHECK(AhoCorasick::foldCase("HeLLo") == "hello");
+	UNITTEST_CHECK(AhoCorasick::foldCase("\xc3\x9c" "BEL") == "\xc3\xbc" "bel");
+	UNITTEST_CHECK(AhoCorasick::foldCase("\xc5\x81\xc3\x93\xc5\xbb") == "\xc5\x82\xc3\xb3\xc5\xbc");
+	UNITTEST_CHECK(AhoCorasick::foldCase("\xce\xa3\xce\x9f\xce\xa6") == "\xcf\x83\xce\xbf\xcf\x86");
+	UNITTEST_CHECK(AhoCorasick::foldCase("\xd0\x9f\xd0\xa0\xd0\x98\xd0\x81") == "\xd0\xbf\xd1\x80\xd0\xb8\xd1\x91");
+	// Characters without case and the multiplication sign are kept.
+	UNITTEST_CHECK(AhoCorasick::foldCase("1+\xc3\x97!") == "1+\xc3\x97!");
+	// Three byte sequences and truncated sequences are kept.
+	UNITTEST_CHECK(AhoCorasick::foldCase("\xe2\x82\xac") == "\xe2\x82\xac");
+	UNITTEST_CHECK(AhoCorasick::foldCase("A\xc3") == "a\xc3");
+
+	AhoCorasick matcher;
+	unsigned uebel = matcher.addPattern(AhoCorasick::foldCase("\xc3\xbc" "bel"));
+	unsigned privet = matcher.addPattern(AhoCorasick::foldCase("\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82"));
+	matcher.build();
+	vector<char> found;
+	UNITTEST_CHECK(matcher.scan("So \xc3\x9c" "BEL!", found, true) && found[uebel]);
+	UNITTEST_CHECK(!matcher.scan("So \xc3\x9c" "BEL!", found, false));
+	UNITTEST_CHECK(matcher.scan("\xd0\x9f\xd0\xa0\xd0\x98\xd0\x92\xd0\x95\xd0\xa2", found, true) && found[privet] && !found[uebel]);
+
+	// Folding while scanning gives the same result as folding first.
+	boost::random::mt19937 gen(CHAT_CLEANER_TEST_SEED);
+	for (unsigned n = 0; n < CHAT_CLEANER_TEST_ITERATIONS; n++) {
+		AhoCorasick randomMatcher;
+		for (unsigned p = 0; p < 5; p++)
+			randomMatcher.addPattern(AhoCorasick::foldCase(RandomChatText(gen, 3)));
+		randomMatcher.build();
+		string text(RandomChatText(gen, 20));
+		vector<char> foundFolded;
+		bool any = randomMatcher.scan(text, found, true);
+		bool anyFolded = randomMatcher.scan(AhoCorasick::foldCase(text), foundFolded);
+		UNITTEST_CHECK(any == anyFolded && found == foundFolded);
+	}
+}
+
+void
+TestBadWordCheckExceptions()
+{
+	list<string> badWords;
+	badWords.push_back("ass");
+	badWords.push_back("\xc3\xbc" "bel");
+	list<string> exceptions;
+	exceptions.push_back("class");
+	exceptions.push_back("pass");
+	exceptions.push_back("\xc3\x9c" "belkeit");
+
+	BadWordCheck check;
+	check.setBadWords(badWords, exceptions);
+	UNITTEST_CHECK(check.run("you ASS"));
+	UNITTEST_CHECK(!check.run("first CLASS"));
+	UNITTEST_CHECK(!check.run("pass the ball"));
+	// An exception excuses only the bad words it contains, but it does so
+	// for the whole message, as before.
+	UNITTEST_CHECK(!check.run("pass the ass"));
+	UNITTEST_CHECK(check.run("class \xc3\x9c" "BEL"));
+	UNITTEST_CHECK(!check.run("\xc3\xbc" "belkeit"));
+	UNITTEST_CHECK(!check.run("nice game"));
+
+	// Compare with the reference on random words and messages.
+	boost::random::mt19937 gen(CHAT_CLEANER_TEST_SEED);
+	for (unsigned n = 0; n < CHAT_CLEANER_TEST_ITERATIONS / 10; n++) {
+		list<string> randomBadWords;
+		list<string> randomExceptions;
+		for (unsigned i = 0; i < 4; i++)
+			randomBadWords.push_back(RandomChatText(gen, 3));
+		for (unsigned i = 0; i < 4; i++)
+			randomExceptions.push_back(RandomChatText(gen, 6));
+		BadWordCheck randomCheck;
+		randomCheck.setBadWords(randomBadWords, randomExceptions);
+		for (unsigned t = 0; t < 10; t++) {
+			string msg(RandomChatText(gen, 20));
+			UNITTEST_CHECK(randomCheck.run(msg) == ReferenceBadWordCheck(randomBadWords, randomExceptions, msg));
+		}
+	}
+}
+
+void
+TestUrlCheckExceptions()
+{
+	list<string> urlStrings;
+	urlStrings.push_back("http://");
+	urlStrings.push_back("www.");
+	list<string> exceptions;
+	exceptions.push_back("pokerth.net");
+
+	UrlCheck check;
+	check.setUrlStrings(urlStrings, exceptions);
+	UNITTEST_CHECK(check.run("visit WWW.example.com"));
+	UNITTEST_CHECK(check.run("HTTP://example.com"));
+	// Any allowed url in the message excuses it.
+	UNITTEST_CHECK(!check.run("see http://www.PokerTH.net/faq"));
+	UNITTEST_CHECK(!check.run("pokerth.net"));
+	UNITTEST_CHECK(!check.run("no link here"));
+}
+
+// Maps many keys to the same slot, so that erase has to shift long probe sequences.
+struct CollidingHash {
+	size_t operator()(unsigned key) const {
+		return key % 7;
+	}
+};
+
+struct EraseOddValues {
+	bool operator()(unsigned, int value) const {
+		return (value & 1) != 0;
+	}
+};
+
+template <typename Hash>
+static void
+CheckFlatHashMap(FlatHashMap<unsigned, int, Hash> &flatMap, const map<unsigned, int> &refMap, unsigned maxKey)
+{
+	UNITTEST_CHECK(flatMap.size() == refMap.size());
+	const FlatHashMap<unsigned, int, Hash> &constMap = flatMap;
+	for (unsigned key = 0; key < maxKey; key++) {
+		map<unsigned, int>::const_iterator pos = refMap.find(key);
+		const int *value = constMap.find(key);
+		if (pos == refMap.end())
+			UNITTEST_CHECK(!value);
+		else
+			UNITTEST_CHECK(value && *value == pos->second);
+	}
+}
+
+template <typename Hash>
+static void
+TestFlatHashMapWithHash(unsigned maxKey)
+{
+	boost::random::mt19937 gen(CHAT_CLEANER_TEST_SEED);
+	boost::random::uniform_int_distribution<unsigned> keyDist(0, maxKey - 1);
+	boost::random::uniform_int_distribution<unsigned> opDist(0, 9);
+	FlatHashMap<unsigned, int, Hash> flatMap;
+	map<unsigned, int> refMap;
+
+	for (unsigned n = 0; n < CHAT_CLEANER_TEST_ITERATIONS * 10; n++) {
+		unsigned key = keyDist(gen);
+		unsigned op = opDist(gen);
+		if (op < 6) {
+			// Growing beyond the initial 16 slots rehashes several times.
+			int &value = flatMap.insert(key);
+			UNITTEST_CHECK(value == refMap[key]);
+			value = static_cast<int>(n);
+			refMap[key] = static_cast<int>(n);
+		} else if (op < 9) {
+			UNITTEST_CHECK(flatMap.erase(key) == (refMap.erase(key) != 0));
+		} else {
+			int *value = flatMap.find(key);
+			UNITTEST_CHECK((value != 0) == (refMap.count(key) != 0));
+		}
+		if (n % 1000 == 0)
+			CheckFlatHashMap(flatMap, refMap, maxKey);
+	}
+	CheckFlatHashMap(flatMap, refMap, maxKey);
+
+	flatMap.eraseIf(EraseOddValues());
+	map<unsigned, int>::iterator i = refMap.begin();
+	while (i != refMap.end()) {
+		if (i->second & 1)
+			refMap.erase(i++);
+		else
+			++i;
+	}
+	CheckFlatHashMap(flatMap, refMap, maxKey);
+
+	// Slots are reused after erase.
+	for (unsigned key = 0; key < maxKey; key++)
+		flatMap.erase(key);
+	UNITTEST_CHECK(flatMap.size() == 0);
+	for (unsigned key = 0; key < maxKey; key++)
+		flatMap.insert(key) = static_cast<int>(key);
+	refMap.clear();
+	for (unsigned key = 0; key < maxKey; key++)
+		refMap[key] = static_cast<int>(key);
+	CheckFlatHashMap(flatMap, refMap, maxKey);
+	flatMap.clear();
+	UNITTEST_CHECK(flatMap.size() == 0 && !flatMap.find(0));
+}
+
+void
+TestFlatHashMap()
+{
+	TestFlatHashMapWithHash<boost::hash<unsigned> >(5000);
+	TestFlatHashMapWithHash<CollidingHash>(500);
+}
+
+// The text flood check as it was before the periodic sweep was removed.
+struct SweepTextFloodCheck {
+	struct Infos {
+		int floodLevel;
+		size_t timeStamp;
+	};
+
+	SweepTextFloodCheck(int trigger) : textFloodLevelToTrigger(trigger) {}
+
+	bool run(unsigned playerId, size_t now) {
+		map<unsigned, Infos>::iterator i = msgTimesList.find(playerId);
+		if (i == msgTimesList.end()) {
+			Infos tmpInfos;
+			tmpInfos.floodLevel = 0;
+			tmpInfos.timeStamp = now;
+			msgTimesList.insert(make_pair(playerId, tmpInfos));
+		} else {
+			Infos &infos = i->second;
+			if (now - infos.timeStamp <= 1) {
+				if (infos.floodLevel == textFloodLevelToTrigger) {
+					infos.floodLevel = infos.floodLevel - 1;
+					infos.timeStamp = now;
+					return true;
+				} else {
+					infos.floodLevel = infos.floodLevel + 1;
+				}
+			}
+			infos.timeStamp = now;
+		}
+		return false;
+	}
+
+	// Was called every 4 seconds.
+	void cleanMsgTimesList(size_t now) {
+		map<unsigned, Infos>::iterator it = msgTimesList.begin();
+		while (it != msgTimesList.end()) {
+			if (now - it->second.timeStamp > 3) {
+				if (it->second.floodLevel == 0) {
+					msgTimesList.erase(it++);
+					continue;
+				} else {
+					it->second.floodLevel = it->second.floodLevel - 1;
+				}
+			}
+			++it;
+		}
+	}
+
+	int getFloodLevel(unsigned playerId) const {
+		map<unsigned, Infos>::const_iterator i = msgTimesList.find(playerId);
+		return i != msgTimesList.end() ? i->second.floodLevel : 0;
+	}
+
+	map<unsigned, Infos> msgTimesList;
+	int textFloodLevelToTrigger;
+};
+
+void
+TestTextFloodCheckDecay()
+{
+	// Messages within a second raise the level until the trigger is reached.
+	TextFloodCheck check;
+	check.setTextFloodLevelToTrigger(3);
+	UNITTEST_CHECK(!check.runAt(1, 100));
+	UNITTEST_CHECK(!check.runAt(1, 100));
+	UNITTEST_CHECK(!check.runAt(1, 101));
+	UNITTEST_CHECK(!check.runAt(1, 102));
+	UNITTEST_CHECK(check.getFloodLevel(1, 102) == 3);
+	UNITTEST_CHECK(check.runAt(1, 102));
+	UNITTEST_CHECK(check.getFloodLevel(1, 102) == 2);
+	// Other players are independent.
+	UNITTEST_CHECK(!check.runAt(2, 102));
+	UNITTEST_CHECK(check.getFloodLevel(2, 102) == 0);
+	// The level drops after 3 idle seconds by one per 4 seconds.
+	UNITTEST_CHECK(check.getFloodLevel(1, 105) == 2);
+	UNITTEST_CHECK(check.getFloodLevel(1, 106) == 1);
+	UNITTEST_CHECK(check.getFloodLevel(1, 109) == 1);
+	UNITTEST_CHECK(check.getFloodLevel(1, 110) == 0);
+	UNITTEST_CHECK(!check.runAt(1, 110));
+	UNITTEST_CHECK(check.getFloodLevel(1, 110) == 0);
+	check.removeNickFromList(1);
+	UNITTEST_CHECK(check.getFloodLevel(1, 110) == 0);
+
+	// Compare one idle period with the removed sweep. The sweep ran every
+	// 4 seconds regardless of the player, so it could drop the level up to
+	// 3 seconds later. A sweep which is aligned with the last message of the
+	// player gives exactly the decayed level.
+	for (int level = 0; level <= 6; level++) {
+		for (size_t phase = 0; phase < 4; phase++) {
+			for (size_t idle = 0; idle <= 40; idle++) {
+				const size_t start = 1000;
+				TextFloodCheck lazyCheck;
+				SweepTextFloodCheck sweepCheck(100);
+				lazyCheck.setTextFloodLevelToTrigger(100);
+				// Raise the level with messages in the same second.
+				for (int i = 0; i <= level; i++) {
+					lazyCheck.runAt(1, start);
+					sweepCheck.run(1, start);
+				}
+				UNITTEST_CHECK(lazyCheck.getFloodLevel(1, start) == level && sweepCheck.getFloodLevel(1) == level);
+				for (size_t t = start + 1; t <= start + idle; t++) {
+					if (t % 4 == phase)
+						sweepCheck.cleanMsgTimesList(t);
+				}
+				int lazyLevel = lazyCheck.getFloodLevel(1, start + idle);
+				int sweepLevel = sweepCheck.getFloodLevel(1);
+				UNITTEST_CHECK(lazyLevel <= sweepLevel && sweepLevel <= lazyLevel + 1);
+				if (start % 4 == phase)
+					UNITTEST_CHECK(lazyLevel == sweepLevel);
+				// The next message sees the same level in both.
+				if (lazyLevel == sweepLevel) {
+					lazyCheck.runAt(1, start + idle);
+					sweepCheck.run(1, start + idle);
+					UNITTEST_CHECK(lazyCheck.getFloodLevel(1, start + idle) == sweepCheck.getFloodLevel(1));
+				}
+			}
+		}
+	}
+
+	// Idle players are purged when many players are known. This must not
+	// change the level of any player.
+	TextFloodCheck purgeCheck;
+	purgeCheck.setTextFloodLevelToTrigger(3);
+	for (unsigned playerId = 0; playerId < 5000; playerId++) {
+		purgeCheck.runAt(playerId, playerId / 100);
+		purgeCheck.runAt(playerId, playerId / 100);
+	}
+	for (unsigned playerId = 0; playerId < 5000; playerId++)
+		UNITTEST_CHECK(purgeCheck.getFloodLevel(playerId, 50) == (50 - playerId / 100 <= 3 ? 1 : 0));
+}
@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <configfile.h>
+#include <boost/thread.hpp>
+
+#include <list>
+
+using namespace std;
+
+static char g_configArgv0[] = "pokerth_unittests";
+
+void
+TestConfigFileKeys()
+{
+	ConfigFile config(g_configArgv0, true);
+
+	ConfigKey widthKey(config.getConfigKey("GameTableWidthSave"));
+	UNITTEST_CHECK(widthKey.isValid());
+	UNITTEST_CHECK(config.readConfigInt(widthKey) == 1024);
+	UNITTEST_CHECK(config.readConfigInt("GameTableWidthSave") == 1024);
+
+	ConfigKey invalidKey(config.getConfigKey("NoSuchConfigVariable"));
+	UNITTEST_CHECK(!invalidKey.isValid());
+	UNITTEST_CHECK(!ConfigKey().isValid());
+	UNITTEST_CHECK(config.readConfigInt(invalidKey) == 0);
+	UNITTEST_CHECK(config.readConfigString(invalidKey).empty());
+	UNITTEST_CHECK(config.readConfigIntList("NoSuchConfigVariable").empty());
+	UNITTEST_CHECK(config.readConfigStringList("NoSuchConfigVariable").empty());
+
+	// Writing an unknown variable is ignored.
+	config.writeConfigInt("NoSuchConfigVariable", 5);
+	UNITTEST_CHECK(config.readConfigInt("NoSuchConfigVariable") == 0);
+}
+
+void
+TestConfigFileReadAfterWrite()
+{
+	ConfigFile config(g_configArgv0, true);
+	ConfigKey widthKey(config.getConfigKey("GameTableWidthSave"));
+	ConfigKey heightKey(config.getConfigKey("GameTableHeightSave"));
+	ConfigKey passwordKey(config.getConfigKey("InternetLoginPassword"));
+
+	// Every read sees the preceding writes, also within a batch.
+	config.writeConfigInt("GameTableWidthSave", 800);
+	UNITTEST_CHECK(config.readConfigInt(widthKey) == 800);
+	config.writeConfigInt("GameTableWidthSave", 640);
+	config.writeConfigInt("GameTableHeightSave", 480);
+	config.writeConfigString("InternetLoginPassword", "secret");
+	UNITTEST_CHECK(config.readConfigInt(widthKey) == 640);
+	UNITTEST_CHECK(config.readConfigInt(heightKey) == 480);
+	UNITTEST_CHECK(config.readConfigString(passwordKey) == "secret");
+	UNITTEST_CHECK(config.readConfigString("GameTableHeightSave") == "480");
+
+	list<int> intList;
+	intList.push_back(3);
+	intList.push_back(-1);
+	intList.push_back(42);
+	config.writeConfigIntList("GameTableWidthSave", intList);
+	UNITTEST_CHECK(config.readConfigIntList("GameTableWidthSave") == intList);
+	UNITTEST_CHECK(config.readConfigStringList("GameTableWidthSave").size() == 3);
+	UNITTEST_CHECK(config.readConfigStringList("GameTableWidthSave").back() == "42");
+
+	list<string> stringList;
+	stringList.push_back("Alice");
+	stringList.push_back("Bob");
+	config.writeConfigStringList("PlayerIgnoreList", stringList);
+	UNITTEST_CHECK(config.readConfigStringList("PlayerIgnoreList") == stringList);
+
+	// Read only, writeBuffer only publishes the changes.
+	config.writeConfigInt("GameTableWidthSave", 1280);
+	config.writeBuffer();
+	UNITTEST_CHECK(config.readConfigInt(widthKey) == 1280);
+}
+
+static void
+ConfigFileWriterThread(ConfigFile *config, int numWrites)
+{
+	for (int i = 1; i <= numWrites; i++) {
+		config->writeConfigInt("GameTableWidthSave", i);
+	}
+}
+
+void
+TestConfigFileConcurrentReads()
+{
+	const int NumWrites = 20000;
+	ConfigFile config(g_configArgv0, true);
+	config.writeConfigInt("GameTableWidthSave", 0);
+	ConfigKey widthKey(config.getConfigKey("GameTableWidthSave"));
+
+	// Readers never see a torn or older value than before.
+	boost::thread writer(boost::bind(&ConfigFileWriterThread, &config, NumWrites));
+	int lastValue = 0;
+	bool inOrder = true;
+	while (lastValue < NumWrites) {
+		int value = config.readConfigInt(widthKey);
+		if (value < lastValue || value > NumWrites)
+			inOrder = false;
+		lastValue = value;
+		if (!inOrder)
+			break;
+	}
+	writer.join();
+	UNITTEST_CHECK(inOrder);
+	UNITTEST_CHECK(config.readConfigInt(widthKey) == NumWrites);
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <tests/unittesthttpserver.h>
+#include <net/downloaderthread.h>
+#include <boost/bind.hpp>
+
+using namespace std;
+
+#define DOWNLOAD_TEST_TIMEOUT_SEC		1
+#define DOWNLOAD_TEST_WAIT_MSEC			10000
+
+struct DownloadTestNotifier {
+	DownloadTestNotifier() : numCalls(0) {}
+
+	void Notify()
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		numCalls++;
+		cond.notify_all();
+	}
+
+	bool WaitForCalls(unsigned num)
+	{
+		boost::system_time deadline(boost::get_system_time() + boost::posix_time::milliseconds(DOWNLOAD_TEST_WAIT_MSEC));
+		boost::mutex::scoped_lock lock(mutex);
+		while (numCalls < num) {
+			if (!cond.timed_wait(lock, deadline))
+				return false;
+		}
+		return true;
+	}
+
+	unsigned numCalls;
+	boost::mutex mutex;
+	boost::condition_variable cond;
+};
+
+void
+TestDownloaderThread()
+{
+	UnitTestHttpServer server;
+	server.AddResponse("/ok", 200, "avatar data");
+	server.AddResponse("/slow", 0);
+
+	DownloadTestNotifier notifier;
+	// Only one transfer at a time, so that a hanging transfer blocks the following ones until it times out.
+	DownloaderThread downloader(boost::bind(&DownloadTestNotifier::Notify, &notifier), 1, DOWNLOAD_TEST_TIMEOUT_SEC);
+	downloader.Run();
+	downloader.QueueDownload(1, server.GetUrl("/slow"));
+	downloader.QueueDownload(2, server.GetUrl("/missing"));
+	downloader.QueueDownload(3, server.GetUrl("/ok"));
+
+	// Failed transfers do not produce a result.
+	UNITTEST_CHECK(notifier.WaitForCalls(1));
+	unsigned id = 0;
+	vector<unsigned char> data;
+	UNITTEST_CHECK(downloader.GetDownloadResult(id, data));
+	UNITTEST_CHECK(id == 3);
+	UNITTEST_CHECK(string(data.begin(), data.end()) == "avatar data");
+	UNITTEST_CHECK(!downloader.HasDownloadResult());
+	UNITTEST_CHECK(server.GetNumRequests("/slow") == 1);
+	UNITTEST_CHECK(server.GetNumRequests("/missing") == 1);
+
+	// Results are still queued, but the notifier is no longer called.
+	downloader.CancelResultNotifier();
+	downloader.QueueDownload(4, server.GetUrl("/ok"));
+	for (unsigned i = 0; i < DOWNLOAD_TEST_WAIT_MSEC / 10 && !downloader.HasDownloadResult(); i++)
+		Thread::Msleep(10);
+	UNITTEST_CHECK(downloader.GetDownloadResult(id, data));
+	UNITTEST_CHECK(id == 4);
+	UNITTEST_CHECK(notifier.numCalls == 1);
+
+	downloader.SignalTermination();
+	UNITTEST_CHECK(downloader.Join(DOWNLOADER_THREAD_TERMINATE_TIMEOUT));
+}
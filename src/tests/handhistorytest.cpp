@@ -0,0 +1,184 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <engine/handhistory.h>
+#include <boost/cstdint.hpp>
+#include <climits>
+
+using namespace std;
+
+void
+TestHandHistoryVarint()
+{
+	static const boost::uint64_t unsignedValues[] = {
+		0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFFULL, 0x100000000ULL, 0x812345678ULL, 0xFFFFFFFFFFFFFFFFULL
+	};
+	static const size_t unsignedSizes[] = { 1, 1, 1, 2, 2, 2, 3, 5, 5, 6, 10 };
+	string buf;
+	for (size_t i = 0; i < sizeof(unsignedValues) / sizeof(unsignedValues[0]); i++) {
+		string single;
+		HandHistoryAppendVarint(single, unsignedValues[i]);
+		UNITTEST_CHECK(single.size() == unsignedSizes[i]);
+		HandHistoryAppendVarint(buf, unsignedValues[i]);
+	}
+	size_t pos = 0;
+	for (size_t i = 0; i < sizeof(unsignedValues) / sizeof(unsignedValues[0]); i++) {
+		boost::uint64_t val;
+		UNITTEST_CHECK(HandHistoryParseVarint(buf, pos, val) && val == unsignedValues[i]);
+	}
+	UNITTEST_CHECK(pos == buf.size());
+
+	static const int signedValues[] = { 0, -1, 1, -64, 63, 64, -65, 1000000, INT_MAX, INT_MIN };
+	buf.clear();
+	for (size_t i = 0; i < sizeof(signedValues) / sizeof(signedValues[0]); i++)
+		HandHistoryAppendSigned(buf, signedValues[i]);
+	pos = 0;
+	for (size_t i = 0; i < sizeof(signedValues) / sizeof(signedValues[0]); i++) {
+		int val;
+		UNITTEST_CHECK(HandHistoryParseSigned(buf, pos, val) && val == signedValues[i]);
+	}
+	UNITTEST_CHECK(pos == buf.size());
+	// Small negative values are stored in one byte.
+	buf.clear();
+	HandHistoryAppendSigned(buf, -1);
+	UNITTEST_CHECK(buf.size() == 1);
+
+	// Damaged input is rejected.
+	boost::uint64_t val;
+	int signedVal;
+	buf.clear();
+	HandHistoryAppendVarint(buf, 16384);
+	buf.resize(buf.size() - 1);
+	pos = 0;
+	UNITTEST_CHECK(!HandHistoryParseVarint(buf, pos, val));
+	buf.assign(11, static_cast<char>(0x80));
+	pos = 0;
+	UNITTEST_CHECK(!HandHistoryParseVarint(buf, pos, val));
+	buf.assign(9, static_cast<char>(0xFF));
+	buf += static_cast<char>(0x02);
+	pos = 0;
+	UNITTEST_CHECK(!HandHistoryParseVarint(buf, pos, val));
+	buf.clear();
+	HandHistoryAppendVarint(buf, 0x100000000ULL);
+	pos = 0;
+	UNITTEST_CHECK(!HandHistoryParseSigned(buf, pos, signedVal));
+}
+
+static void
+WriteTestHistory(HandHistoryWriter &writer)
+{
+	writer.writeSession("1.0", "2012-01-01", "12:00:00", 1);
+	for (int game = 1; game <= 2; game++) {
+		writer.writeGame(game, game + 10, 5000, 10, 1);
+		writer.writePlayer(1, "Player 1");
+		writer.writePlayer(2, "Spieler \xc3\xa4");
+		for (int hand = 1; hand <= 3; hand++) {
+			vector<int> seatCash(10, -1);
+			seatCash[0] = 5000 - hand;
+			seatCash[1] = INT_MAX;
+			writer.writeHand(hand, 1, 10, 1, 20, 2, seatCash);
+			writer.writeAction(0, 1, 3, 2000000000);
+			writer.writeAction(0, 2, 1, -1);
+			int boardCards[5] = { 1, 2, 3, -1, -1 };
+			writer.writeBoardCards(1, boardCards);
+			writer.writeHoleCards(2, 51, 0);
+			writer.writeHandValue(2, 123456, "Two Pairs");
+		}
+	}
+}
+
+static void
+CheckTestHistory(HandHistoryReader &reader)
+{
+	HandHistoryRecord record;
+	UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_SESSION);
+	UNITTEST_CHECK(record.strings.size() == 3 && record.strings[2] == "12:00:00");
+	for (int game = 1; game <= 2; game++) {
+		UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_GAME && record.uniqueGameID == game);
+		UNITTEST_CHECK(record.values.size() == 5 && record.values[1] == game + 10);
+		UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_PLAYER);
+		UNITTEST_CHECK(reader.next(record) && record.strings.size() == 1 && record.strings[0] == "Spieler \xc3\xa4");
+		for (int hand = 1; hand <= 3; hand++) {
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_HAND && record.handID == hand);
+			UNITTEST_CHECK(record.values.size() == 16 && record.values[6] == 5000 - hand && record.values[7] == INT_MAX && record.values[8] == -1);
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_ACTION && record.values[3] == 2000000000);
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_ACTION && record.values[3] == -1);
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_BOARD_CARDS && record.values[4] == -1);
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_HOLE_CARDS && record.values[1] == 51);
+			UNITTEST_CHECK(reader.next(record) && record.type == HAND_HISTORY_RECORD_HAND_VALUE && record.strings[0] == "Two Pairs");
+			UNITTEST_CHECK(record.uniqueGameID == game && record.handID == hand);
+		}
+	}
+	UNITTEST_CHECK(!reader.next(record));
+}
+
+static void
+CheckTestHistoryIndex(HandHistoryReader &reader)
+{
+	vector<HandHistoryIndexEntry> index;
+	UNITTEST_CHECK(reader.readIndex(index));
+	// The index leaves the reader at the start.
+	CheckTestHistory(reader);
+	// One entry for each game and for each hand.
+	UNITTEST_CHECK(index.size() == 8);
+	if (index.size() == 8) {
+		UNITTEST_CHECK(index[4].uniqueGameID == 2 && index[4].handID == 0);
+		UNITTEST_CHECK(index[7].uniqueGameID == 2 && index[7].handID == 3);
+		HandHistoryRecord record;
+		UNITTEST_CHECK(reader.seek(index[6]) && reader.next(record));
+		UNITTEST_CHECK(record.type == HAND_HISTORY_RECORD_HAND && record.uniqueGameID == 2 && record.handID == 2);
+		UNITTEST_CHECK(record.offset == index[6].offset);
+	}
+}
+
+void
+TestHandHistoryRoundTrip()
+{
+	UnitTestTempFile tmpFile(HAND_HISTORY_FILE_EXTENSION);
+	HandHistoryWriter writer;
+	UNITTEST_CHECK(writer.open(tmpFile.GetName()));
+	WriteTestHistory(writer);
+	writer.flush();
+	{
+		// Not closed yet, the index is rebuilt.
+		HandHistoryReader reader;
+		UNITTEST_CHECK(reader.open(tmpFile.GetName()));
+		CheckTestHistoryIndex(reader);
+	}
+	writer.close();
+	{
+		HandHistoryReader reader;
+		UNITTEST_CHECK(reader.open(tmpFile.GetName()));
+		CheckTestHistory(reader);
+		CheckTestHistoryIndex(reader);
+	}
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <net/ipaddresstrie.h>
+
+using namespace std;
+
+void
+TestIPAddressTrie()
+{
+	IPAddressTrie trie;
+	UNITTEST_CHECK(!trie.IsMatch("192.0.2.1"));
+
+	// IPv4 ranges match both notations of the client address.
+	trie.Add("192.0.2.0/24");
+	UNITTEST_CHECK(trie.IsMatch("192.0.2.1"));
+	UNITTEST_CHECK(trie.IsMatch("192.0.2.255"));
+	UNITTEST_CHECK(trie.IsMatch("::ffff:192.0.2.17"));
+	UNITTEST_CHECK(!trie.IsMatch("192.0.3.1"));
+	UNITTEST_CHECK(!trie.IsMatch("::ffff:192.0.3.1"));
+	UNITTEST_CHECK(!trie.IsMatch("::192.0.2.1"));
+
+	trie.Add("198.51.100.7");
+	UNITTEST_CHECK(trie.IsMatch("198.51.100.7"));
+	UNITTEST_CHECK(trie.IsMatch("::ffff:198.51.100.7"));
+	UNITTEST_CHECK(!trie.IsMatch("198.51.100.8"));
+
+	trie.Add("2001:db8::/32");
+	UNITTEST_CHECK(trie.IsMatch("2001:db8::1"));
+	UNITTEST_CHECK(trie.IsMatch("2001:db8:ffff:1::5"));
+	UNITTEST_CHECK(!trie.IsMatch("2001:db9::1"));
+	UNITTEST_CHECK(!trie.IsMatch("2001:0:db8::1"));
+
+	// Invalid prefix lengths are not treated as ranges.
+	trie.Add("203.0.113.0/33");
+	UNITTEST_CHECK(!trie.IsMatch("203.0.113.1"));
+	UNITTEST_CHECK(trie.IsMatch("203.0.113.0/33"));
+
+	// An IPv4 /0 covers all IPv4 addresses, but no IPv6 addresses.
+	trie.Add("0.0.0.0/0");
+	UNITTEST_CHECK(trie.IsMatch("10.1.2.3"));
+	UNITTEST_CHECK(trie.IsMatch("::ffff:10.1.2.3"));
+	UNITTEST_CHECK(!trie.IsMatch("2001:db9::1"));
+	UNITTEST_CHECK(trie.Remove("0.0.0.0/0"));
+	UNITTEST_CHECK(!trie.IsMatch("10.1.2.3"));
+	trie.Add("::/0");
+	UNITTEST_CHECK(trie.IsMatch("10.1.2.3"));
+	UNITTEST_CHECK(trie.IsMatch("2001:db9::1"));
+	UNITTEST_CHECK(trie.Remove("::/0"));
+	UNITTEST_CHECK(!trie.IsMatch("2001:db9::1"));
+
+	// Entries which were added twice need to be removed twice.
+	trie.Add("192.0.2.0/24");
+	UNITTEST_CHECK(trie.Remove("192.0.2.0/24"));
+	UNITTEST_CHECK(trie.IsMatch("192.0.2.1"));
+	UNITTEST_CHECK(trie.Remove("192.0.2.0/24"));
+	UNITTEST_CHECK(!trie.IsMatch("192.0.2.1"));
+	UNITTEST_CHECK(!trie.Remove("192.0.2.0/24"));
+	UNITTEST_CHECK(!trie.Remove("192.0.2.0/25"));
+	UNITTEST_CHECK(trie.IsMatch("198.51.100.7"));
+	// A removed range can be added again.
+	trie.Add("192.0.2.0/24");
+	UNITTEST_CHECK(trie.IsMatch("192.0.2.1"));
+
+	// Entries which cannot be parsed are compared as strings.
+	trie.Add("host.example.org");
+	trie.Add("host.example.org");
+	UNITTEST_CHECK(trie.IsMatch("host.example.org"));
+	UNITTEST_CHECK(!trie.IsMatch("HOST.example.org"));
+	UNITTEST_CHECK(!trie.IsMatch("other.example.org"));
+	UNITTEST_CHECK(trie.Remove("host.example.org"));
+	UNITTEST_CHECK(trie.IsMatch("host.example.org"));
+	UNITTEST_CHECK(trie.Remove("host.example.org"));
+	UNITTEST_CHECK(!trie.IsMatch("host.example.org"));
+	UNITTEST_CHECK(!trie.Remove("host.example.org"));
+
+	trie.Clear();
+	UNITTEST_CHECK(!trie.IsMatch("192.0.2.1"));
+	UNITTEST_CHECK(!trie.IsMatch("2001:db8::1"));
+	UNITTEST_CHECK(!trie.IsMatch("198.51.100.7"));
+	UNITTEST_CHECK(!trie.IsMatch("203.0.113.0/33"));
+}
@@ -0,0 +1,1438 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/loadclient.h>
+#include <net/netpacket.h>
+#include <net/net_helper.h>
+#include <net/websocket_defs.h>
+#include <boost/array.hpp>
+#include <boost/bind.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <deque>
+#include <algorithm>
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+#define LOAD_RECV_BUF_SIZE				(4 * MAX_PACKET_SIZE)
+#define LOAD_LAUNCH_TICK_MSEC			10
+#define LOAD_CONTROL_TICK_MSEC			100
+#define LOAD_STOP_GRACE_MSEC			1000
+#define LOAD_GAME_NAME_PREFIX			"_loadtest_do_not_join_"
+#define LOAD_GAME_PASSWORD				"blah123"
+
+static const char *RttNames[RTT_NUM] = {
+	"connect", "login", "subscribe", "createGame", "joinGame", "leaveGame", "startGame", "action", "spectator"
+};
+
+long long
+LoadNowUsec()
+{
+	static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+	return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+}
+
+LoadStatistics::LoadStatistics()
+	: m_startTime(LoadNowUsec()), m_lastReportTime(m_startTime), m_connectAttempts(0), m_connects(0),
+	  m_lastConnects(0), m_connectFailures(0), m_disconnects(0), m_msgSent(0), m_msgReceived(0),
+	  m_lastMsgReceived(0), m_gamesStarted(0), m_gamesFinished(0), m_hands(0)
+{
+	for (int i = 0; i < RTT_NUM; i++) {
+		m_lastRttIndex[i] = 0;
+	}
+}
+
+void
+LoadStatistics::AddConnectAttempt()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_connectAttempts++;
+}
+
+void
+LoadStatistics::AddConnect()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_connects++;
+}
+
+void
+LoadStatistics::AddConnectFailure()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_connectFailures++;
+}
+
+void
+LoadStatistics::AddDisconnect()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_disconnects++;
+}
+
+void
+LoadStatistics::AddMessage(bool sent)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	if (sent) {
+		m_msgSent++;
+	} else {
+		m_msgReceived++;
+	}
+}
+
+void
+LoadStatistics::AddGameStarted()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_gamesStarted++;
+}
+
+void
+LoadStatistics::AddGameFinished()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_gamesFinished++;
+}
+
+void
+LoadStatistics::AddHand()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_hands++;
+}
+
+void
+LoadStatistics::AddRtt(LoadRttType type, long long usec)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_rtt[type].push_back(static_cast<unsigned>(usec));
+}
+
+void
+LoadStatistics::AddError(const string &what)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_errors[what]++;
+}
+
+void
+LoadStatistics::ResetSamples()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	m_startTime = m_lastReportTime = LoadNowUsec();
+	m_msgSent = m_msgReceived = m_lastMsgReceived = 0;
+	m_gamesStarted = m_gamesFinished = m_hands = 0;
+	m_lastConnects = m_connects;
+	for (int i = 0; i < RTT_NUM; i++) {
+		m_rtt[i].clear();
+		m_lastRttIndex[i] = 0;
+	}
+}
+
+unsigned
+LoadStatistics::GetConnects() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_connects;
+}
+
+unsigned
+LoadStatistics::GetConnectFailures() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_connectFailures;
+}
+
+unsigned
+LoadStatistics::GetMessagesReceived() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_msgReceived;
+}
+
+unsigned
+LoadStatistics::GetGamesStarted() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_gamesStarted;
+}
+
+unsigned
+LoadStatistics::GetGamesFinished() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_gamesFinished;
+}
+
+unsigned
+LoadStatistics::GetHands() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_hands;
+}
+
+unsigned
+LoadStatistics::GetErrorCount() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	unsigned count = 0;
+	ErrorMap::const_iterator i = m_errors.begin();
+	ErrorMap::const_iterator end = m_errors.end();
+	while (i != end) {
+		count += i->second;
+		++i;
+	}
+	return count;
+}
+
+size_t
+LoadStatistics::GetRttCount(LoadRttType type) const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return m_rtt[type].size();
+}
+
+LoadRttSummary
+LoadStatistics::GetRttSummary(LoadRttType type) const
+{
+	vector<unsigned> samples;
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		samples = m_rtt[type];
+	}
+	return Summarize(samples);
+}
+
+double
+LoadStatistics::GetElapsedSec() const
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	return (LoadNowUsec() - m_startTime) / 1000000.0;
+}
+
+const char *
+LoadStatistics::GetRttName(LoadRttType type)
+{
+	return RttNames[type];
+}
+
+LoadRttSummary
+LoadStatistics::Summarize(vector<unsigned> &samples)
+{
+	LoadRttSummary summary;
+	if (!samples.empty()) {
+		sort(samples.begin(), samples.end());
+		summary.count = samples.size();
+		// Values are in milliseconds.
+		summary.p50 = samples[(samples.size() * 50) / 100] / 1000.0;
+		summary.p90 = samples[(samples.size() * 90) / 100] / 1000.0;
+		summary.p99 = samples[(samples.size() * 99) / 100] / 1000.0;
+		summary.max = samples.back() / 1000.0;
+	}
+	return summary;
+}
+
+void
+LoadStatistics::Report(ostream &out, bool final)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	long long now = LoadNowUsec();
+	double totalSec = (now - m_startTime) / 1000000.0;
+	double intervalSec = (now - m_lastReportTime) / 1000000.0;
+	if (totalSec <= 0)
+		totalSec = 1;
+	if (intervalSec <= 0)
+		intervalSec = 1;
+
+	out << (final ? "=== Final report" : "--- Report") << " after " << fixed << setprecision(1) << totalSec << "s ---" << endl;
+	out << "connections: " << m_connects << "/" << m_connectAttempts << " established, "
+		<< m_connectFailures << " failed, " << m_disconnects << " dropped, "
+		<< setprecision(1) << (final ? m_connects / totalSec : (m_connects - m_lastConnects) / intervalSec) << " conn/s" << endl;
+	out << "messages: " << m_msgSent << " sent, " << m_msgReceived << " received, "
+		<< setprecision(1) << (final ? m_msgReceived / totalSec : (m_msgReceived - m_lastMsgReceived) / intervalSec) << " recv msg/s" << endl;
+	out << "games: " << m_gamesStarted << " started, " << m_gamesFinished << " finished, " << m_hands << " hands" << endl;
+	for (int i = 0; i < RTT_NUM; i++) {
+		size_t first = final ? 0 : m_lastRttIndex[i];
+		if (m_rtt[i].size() > first) {
+			vector<unsigned> samples(m_rtt[i].begin() + first, m_rtt[i].end());
+			LoadRttSummary summary(Summarize(samples));
+			out << "rtt " << setw(10) << left << RttNames[i] << right
+				<< " n=" << setw(8) << summary.count
+				<< " p50=" << setw(9) << setprecision(3) << summary.p50 << "ms"
+				<< " p90=" << setw(9) << summary.p90 << "ms"
+				<< " p99=" << setw(9) << summary.p99 << "ms"
+				<< " max=" << setw(9) << summary.max << "ms" << endl;
+		}
+		m_lastRttIndex[i] = m_rtt[i].size();
+	}
+	ErrorMap::const_iterator i = m_errors.begin();
+	ErrorMap::const_iterator end = m_errors.end();
+	while (i != end) {
+		out << "error " << i->first << ": " << i->second << endl;
+		++i;
+	}
+	m_lastReportTime = now;
+	m_lastConnects = m_connects;
+	m_lastMsgReceived = m_msgReceived;
+}
+
+LoadConfig::LoadConfig()
+	: useWebSocket(false), webSocketBatch(false), numGames(1), playersPerGame(10), spectatorsPerGame(0), numLobbyBots(0), numChurnBots(0),
+	  numLoginBots(0), firstId(10000), connectRate(100), numThreads(1), thinkTimeMsec(0), durationSec(0),
+	  reportIntervalSec(5), fillWithComputerPlayers(false), actionTimeoutSec(10), delayBetweenHandsSec(5),
+	  startMoney(3000), firstSmallBlind(10), randomSeed(0)
+{
+}
+
+bool
+LoadConfig::ParseActionScript(const string &script, vector<LoadAction> &actions)
+{
+	vector<string> tokens;
+	boost::split(tokens, script, boost::is_any_of(","));
+	for (size_t i = 0; i < tokens.size(); i++) {
+		string token(boost::trim_copy(tokens[i]));
+		if (token == "fold")
+			actions.push_back(LOAD_ACTION_FOLD);
+		else if (token == "check")
+			actions.push_back(LOAD_ACTION_CHECK);
+		else if (token == "call")
+			actions.push_back(LOAD_ACTION_CALL);
+		else if (token == "raise")
+			actions.push_back(LOAD_ACTION_RAISE);
+		else if (token == "allin")
+			actions.push_back(LOAD_ACTION_ALLIN);
+		else
+			return false;
+	}
+	return !actions.empty();
+}
+
+// Plain TCP transport, messages are prefixed by a 4 byte length in network byte order.
+class TcpLoadConnection : public LoadConnection, public boost::enable_shared_from_this<TcpLoadConnection>
+{
+public:
+	TcpLoadConnection(boost::asio::io_service &ioService, const vector<tcp::endpoint> &endpoints)
+		: m_socket(ioService), m_endpoints(endpoints), m_endpointIndex(0), m_recvBufUsed(0), m_sending(false), m_closed(false) {}
+
+	virtual void Connect(boost::shared_ptr<LoadConnectionHandler> handler)
+	{
+		m_handler = handler;
+		InternalConnect();
+	}
+
+	virtual void Send(const PokerTHMessage &msg)
+	{
+		if (m_closed)
+			return;
+		uint32_t packetSize = msg.ByteSize();
+		string buf(packetSize + NET_HEADER_SIZE, '\0');
+		uint32_t netSize = htonl(packetSize);
+		memcpy(&buf[0], &netSize, sizeof(uint32_t));
+		msg.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8 *>(&buf[NET_HEADER_SIZE]));
+		m_sendQueue.push_back(buf);
+		if (!m_sending)
+			InternalSend();
+	}
+
+	virtual void Close()
+	{
+		if (!m_closed) {
+			m_closed = true;
+			boost::system::error_code ec;
+			m_socket.shutdown(tcp::socket::shutdown_both, ec);
+			m_socket.close(ec);
+		}
+	}
+
+protected:
+	void InternalConnect()
+	{
+		m_socket.async_connect(m_endpoints[m_endpointIndex],
+							   boost::bind(&TcpLoadConnection::HandleConnect, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	void HandleConnect(const boost::system::error_code &ec)
+	{
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (m_closed || !handler)
+			return;
+		if (ec) {
+			boost::system::error_code closeEc;
+			m_socket.close(closeEc);
+			if (++m_endpointIndex < m_endpoints.size()) {
+				InternalConnect();
+			} else {
+				m_closed = true;
+				handler->HandleConnectFailed(ec.message());
+			}
+		} else {
+			boost::system::error_code optEc;
+			m_socket.set_option(tcp::no_delay(true), optEc);
+			handler->HandleConnected();
+			InternalRead();
+		}
+	}
+
+	void InternalRead()
+	{
+		m_socket.async_read_some(boost::asio::buffer(m_recvBuf.c_array() + m_recvBufUsed, LOAD_RECV_BUF_SIZE - m_recvBufUsed),
+								 boost::bind(&TcpLoadConnection::HandleRead, shared_from_this(),
+											 boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+	}
+
+	void HandleRead(const boost::system::error_code &ec, size_t bytesRead)
+	{
+		if (m_closed)
+			return;
+		if (ec) {
+			Disconnected(ec.message());
+			return;
+		}
+		m_recvBufUsed += bytesRead;
+		size_t pos = 0;
+		// Several packets may have been received at once, or only part of one.
+		while (m_recvBufUsed - pos >= NET_HEADER_SIZE) {
+			uint32_t nativeVal;
+			memcpy(&nativeVal, m_recvBuf.data() + pos, sizeof(uint32_t));
+			size_t packetSize = ntohl(nativeVal);
+			if (packetSize > MAX_PACKET_SIZE) {
+				Disconnected("invalid packet size");
+				return;
+			}
+			if (m_recvBufUsed - pos < packetSize + NET_HEADER_SIZE)
+				break;
+			m_tmpMsg.Clear();
+			if (!m_tmpMsg.ParseFromArray(m_recvBuf.data() + pos + NET_HEADER_SIZE, static_cast<int>(packetSize))) {
+				Disconnected("invalid packet");
+				return;
+			}
+			pos += packetSize + NET_HEADER_SIZE;
+			boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+			if (!handler)
+				return;
+			handler->HandleMessage(m_tmpMsg);
+			if (m_closed)
+				return;
+		}
+		if (pos) {
+			m_recvBufUsed -= pos;
+			if (m_recvBufUsed)
+				memmove(m_recvBuf.c_array(), m_recvBuf.c_array() + pos, m_recvBufUsed);
+		}
+		InternalRead();
+	}
+
+	void InternalSend()
+	{
+		m_sending = true;
+		boost::asio::async_write(m_socket, boost::asio::buffer(m_sendQueue.front()),
+								 boost::bind(&TcpLoadConnection::HandleWrite, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	void HandleWrite(const boost::system::error_code &ec)
+	{
+		m_sending = false;
+		if (m_closed)
+			return;
+		if (ec) {
+			Disconnected(ec.message());
+			return;
+		}
+		m_sendQueue.pop_front();
+		if (!m_sendQueue.empty())
+			InternalSend();
+	}
+
+	void Disconnected(const string &reason)
+	{
+		Close();
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (handler)
+			handler->HandleDisconnected(reason);
+	}
+
+private:
+	tcp::socket m_socket;
+	const vector<tcp::endpoint> &m_endpoints;
+	size_t m_endpointIndex;
+	boost::weak_ptr<LoadConnectionHandler> m_handler;
+	boost::array<char, LOAD_RECV_BUF_SIZE> m_recvBuf;
+	size_t m_recvBufUsed;
+	PokerTHMessage m_tmpMsg;
+	deque<string> m_sendQueue;
+	bool m_sending;
+	bool m_closed;
+};
+
+// WebSocket transport, every binary message contains exactly one PokerTHMessage.
+class WebLoadConnection : public LoadConnection, public boost::enable_shared_from_this<WebLoadConnection>
+{
+public:
+	WebLoadConnection(boost::shared_ptr<web_client> webClient, const string &uri, bool batch)
+		: m_webClient(webClient), m_uri(uri), m_batch(batch), m_closed(false) {}
+
+	virtual void Connect(boost::shared_ptr<LoadConnectionHandler> handler)
+	{
+		m_handler = handler;
+		websocketpp::lib::error_code ec;
+		web_client::connection_ptr con = m_webClient->get_connection(m_uri, ec);
+		if (ec) {
+			m_closed = true;
+			handler->HandleConnectFailed(ec.message());
+			return;
+		}
+		con->set_open_handler(boost::bind(&WebLoadConnection::on_open, shared_from_this(), _1));
+		con->set_fail_handler(boost::bind(&WebLoadConnection::on_fail, shared_from_this(), _1));
+		con->set_close_handler(boost::bind(&WebLoadConnection::on_close, shared_from_this(), _1));
+		con->set_message_handler(boost::bind(&WebLoadConnection::on_message, shared_from_this(), _1, _2));
+		if (m_batch)
+			con->add_subprotocol(WEBSOCKET_BATCH_SUBPROTOCOL);
+		m_webHandle = con->get_handle();
+		m_webClient->connect(con);
+	}
+
+	virtual void Send(const PokerTHMessage &msg)
+	{
+		if (m_closed)
+			return;
+		string buf;
+		msg.SerializeToString(&buf);
+		websocketpp::lib::error_code ec;
+		m_webClient->send(m_webHandle, buf, websocketpp::frame::opcode::BINARY, ec);
+		if (ec)
+			Disconnected(ec.message());
+	}
+
+	virtual void Close()
+	{
+		if (!m_closed) {
+			m_closed = true;
+			websocketpp::lib::error_code ec;
+			m_webClient->close(m_webHandle, websocketpp::close::status::normal, "", ec);
+		}
+	}
+
+protected:
+	void on_open(websocketpp::connection_hdl hdl)
+	{
+		// The server may decline the batch subprotocol.
+		m_batch = m_webClient->get_con_from_hdl(hdl)->get_subprotocol() == WEBSOCKET_BATCH_SUBPROTOCOL;
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (!m_closed && handler)
+			handler->HandleConnected();
+	}
+
+	void on_fail(websocketpp::connection_hdl hdl)
+	{
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (!m_closed && handler) {
+			m_closed = true;
+			web_client::connection_ptr con = m_webClient->get_con_from_hdl(hdl);
+			handler->HandleConnectFailed(con->get_ec().message());
+		}
+	}
+
+	void on_close(websocketpp::connection_hdl /*hdl*/)
+	{
+		if (!m_closed)
+			Disconnected("closed by server");
+	}
+
+	void on_message(websocketpp::connection_hdl /*hdl*/, web_client::message_ptr msg)
+	{
+		if (m_closed || msg->get_opcode() != websocketpp::frame::opcode::BINARY)
+			return;
+		const string &payload = msg->get_payload();
+		if (!m_batch) {
+			HandlePacket(payload.data(), payload.size());
+			return;
+		}
+		// Batched frame: several messages, each with a 4 byte size header.
+		size_t pos = 0;
+		while (!m_closed && pos < payload.size()) {
+			uint32_t nativeVal;
+			if (payload.size() - pos < NET_HEADER_SIZE) {
+				Disconnected("invalid batch frame");
+				return;
+			}
+			memcpy(&nativeVal, payload.data() + pos, sizeof(uint32_t));
+			size_t packetSize = ntohl(nativeVal);
+			pos += NET_HEADER_SIZE;
+			if (payload.size() - pos < packetSize) {
+				Disconnected("invalid batch frame");
+				return;
+			}
+			HandlePacket(payload.data() + pos, packetSize);
+			pos += packetSize;
+		}
+	}
+
+	void HandlePacket(const char *data, size_t size)
+	{
+		m_tmpMsg.Clear();
+		if (size > MAX_PACKET_SIZE || !m_tmpMsg.ParseFromArray(data, static_cast<int>(size))) {
+			Disconnected("invalid packet");
+			return;
+		}
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (handler)
+			handler->HandleMessage(m_tmpMsg);
+	}
+
+	void Disconnected(const string &reason)
+	{
+		Close();
+		boost::shared_ptr<LoadConnectionHandler> handler(m_handler.lock());
+		if (handler)
+			handler->HandleDisconnected(reason);
+	}
+
+private:
+	boost::shared_ptr<web_client> m_webClient;
+	string m_uri;
+	bool m_batch;
+	websocketpp::connection_hdl m_webHandle;
+	boost::weak_ptr<LoadConnectionHandler> m_handler;
+	PokerTHMessage m_tmpMsg;
+	bool m_closed;
+};
+
+LoadBot::LoadBot(const LoadConfig &config, LoadStatistics &stats, LoadWorker &worker,
+				 boost::shared_ptr<LoadGameGroup> group, unsigned botIndex, LoadBotRole role, bool isAdmin)
+	: m_config(config), m_stats(stats), m_worker(worker), m_group(group), m_thinkTimer(worker.ioService),
+	  m_botIndex(botIndex), m_role(role), m_isAdmin(isAdmin), m_loggedIn(false), m_inGame(false), m_closing(false),
+	  m_gameId(0), m_numGamesCreated(0), m_playerId(0), m_handNum(0), m_smallBlind(0), m_highestSet(0),
+	  m_minimumRaise(0), m_mySet(0), m_myMoney(0), m_turnGameState(netStatePreflop), m_lastAction(netActionNone),
+	  m_scriptPos(botIndex), m_lastActionSeq(0)
+{
+	ostringstream name;
+	name << SERVER_GUEST_PLAYER_NAME << (config.firstId + botIndex);
+	m_nickName = name.str();
+	for (int i = 0; i < RTT_NUM; i++) {
+		m_rttStart[i] = 0;
+	}
+}
+
+void
+LoadBot::Start()
+{
+	if (m_config.useWebSocket) {
+		ostringstream uri;
+		uri << "ws://" << m_config.server << ":" << m_config.port << "/" << m_config.webSocketResource;
+		m_connection.reset(new WebLoadConnection(m_worker.webClient, uri.str(), m_config.webSocketBatch));
+	} else {
+		m_connection.reset(new TcpLoadConnection(m_worker.ioService, m_config.endpoints));
+	}
+	m_stats.AddConnectAttempt();
+	StartRtt(RTT_CONNECT);
+	m_connection->Connect(shared_from_this());
+}
+
+void
+LoadBot::Stop()
+{
+	m_closing = true;
+	boost::system::error_code ec;
+	m_thinkTimer.cancel(ec);
+	if (m_connection)
+		m_connection->Close();
+}
+
+bool
+LoadBot::IsReadyForGame() const
+{
+	return m_loggedIn && !m_inGame && !m_closing;
+}
+
+void
+LoadBot::JoinGame(unsigned gameId)
+{
+	boost::shared_ptr<PokerTHMessage> msg(NewLobbyMessage(LobbyMessage::Type_JoinGameMessage));
+	JoinGameMessage *netJoin = msg->mutable_lobbymessage()->mutable_joingamemessage();
+	netJoin->set_gameid(gameId);
+	netJoin->set_password(LOAD_GAME_PASSWORD);
+	if (m_role == BOT_ROLE_SPECTATOR)
+		netJoin->set_spectateonly(true);
+	m_inGame = true;
+	StartRtt(RTT_JOIN_GAME);
+	Send(*msg);
+}
+
+void
+LoadBot::HandleConnected()
+{
+	m_stats.AddConnect();
+}
+
+void
+LoadBot::HandleConnectFailed(const string &reason)
+{
+	m_stats.AddConnectFailure();
+	m_stats.AddError("connect failed: " + reason);
+	LeaveGroup();
+}
+
+void
+LoadBot::HandleDisconnected(const string &reason)
+{
+	if (!m_closing) {
+		m_stats.AddDisconnect();
+		m_stats.AddError("disconnected: " + reason);
+		LeaveGroup();
+	}
+}
+
+void
+LoadBot::HandleMessage(const PokerTHMessage &msg)
+{
+	m_stats.AddMessage(false);
+	switch (msg.messagetype()) {
+	case PokerTHMessage::Type_AnnounceMessage:
+		HandleAnnounce(msg.announcemessage());
+		break;
+	case PokerTHMessage::Type_AuthMessage:
+		if (msg.authmessage().messagetype() == AuthMessage::Type_ErrorMessage)
+			HandleServerError("auth", msg.authmessage().errormessage());
+		break;
+	case PokerTHMessage::Type_LobbyMessage:
+		HandleLobbyMessage(msg.lobbymessage());
+		break;
+	case PokerTHMessage::Type_GameMessage:
+		if (msg.gamemessage().messagetype() == GameMessage::Type_GameManagementMessage)
+			HandleGameManagementMessage(msg.gamemessage().gamemanagementmessage());
+		else if (msg.gamemessage().messagetype() == GameMessage::Type_GameEngineMessage)
+			HandleGameEngineMessage(msg.gamemessage().gameenginemessage());
+		break;
+	}
+}
+
+void
+LoadBot::HandleAnnounce(const AnnounceMessage &announce)
+{
+	StopRtt(RTT_CONNECT);
+	if (announce.protocolversion().majorversion() != NET_VERSION_MAJOR) {
+		m_stats.AddError("protocol version mismatch");
+		Stop();
+		return;
+	}
+	boost::shared_ptr<PokerTHMessage> msg(new PokerTHMessage);
+	msg->set_messagetype(PokerTHMessage::Type_AuthMessage);
+	AuthMessage *netAuth = msg->mutable_authmessage();
+	netAuth->set_messagetype(AuthMessage::Type_AuthClientRequestMessage);
+	AuthClientRequestMessage *authRequest = netAuth->mutable_authclientrequestmessage();
+	authRequest->mutable_requestedversion()->set_majorversion(NET_VERSION_MAJOR);
+	authRequest->mutable_requestedversion()->set_minorversion(NET_VERSION_MINOR);
+	authRequest->set_buildid(0);
+	authRequest->set_login(AuthClientRequestMessage::guestLogin);
+	authRequest->set_nickname(m_nickName);
+	StartRtt(RTT_LOGIN);
+	Send(*msg);
+}
+
+void
+LoadBot::HandleLobbyMessage(const LobbyMessage &lobbyMsg)
+{
+	switch (lobbyMsg.messagetype()) {
+	case LobbyMessage::Type_InitDoneMessage:
+		StopRtt(RTT_LOGIN);
+		m_playerId = lobbyMsg.initdonemessage().yourplayerid();
+		if (m_role == BOT_ROLE_LOGIN) {
+			Stop();
+		} else {
+			boost::shared_ptr<PokerTHMessage> msg(NewLobbyMessage(LobbyMessage::Type_SubscriptionRequestMessage));
+			SubscriptionRequestMessage *netSubscribe = msg->mutable_lobbymessage()->mutable_subscriptionrequestmessage();
+			netSubscribe->set_requestid(m_botIndex);
+			netSubscribe->set_subscriptionaction(SubscriptionRequestMessage::resubscribeGameList);
+			StartRtt(RTT_SUBSCRIBE);
+			Send(*msg);
+		}
+		break;
+	case LobbyMessage::Type_SubscriptionReplyMessage:
+		StopRtt(RTT_SUBSCRIBE);
+		if (!m_loggedIn) {
+			m_loggedIn = true;
+			if (m_role == BOT_ROLE_CHURN)
+				CreateGame();
+			else if (m_role == BOT_ROLE_PLAYER || m_role == BOT_ROLE_SPECTATOR)
+				EnterGameGroup();
+		}
+		break;
+	case LobbyMessage::Type_JoinGameAckMessage:
+		HandleJoinGameAck(lobbyMsg.joingameackmessage());
+		break;
+	case LobbyMessage::Type_CreateGameFailedMessage: {
+		ostringstream error;
+		error << "CreateGameFailed(reason " << lobbyMsg.creategamefailedmessage().creategamefailurereason() << ")";
+		m_stats.AddError(error.str());
+		m_inGame = false;
+		LeaveGroup();
+	}
+	break;
+	case LobbyMessage::Type_JoinGameFailedMessage: {
+		ostringstream error;
+		error << "JoinGameFailed(reason " << lobbyMsg.joingamefailedmessage().joingamefailurereason() << ")";
+		m_stats.AddError(error.str());
+		m_inGame = false;
+		LeaveGroup();
+	}
+	break;
+	case LobbyMessage::Type_TimeoutWarningMessage:
+		Send(*NewLobbyMessage(LobbyMessage::Type_ResetTimeoutMessage));
+		break;
+	case LobbyMessage::Type_ErrorMessage:
+		HandleServerError("lobby", lobbyMsg.errormessage());
+		break;
+	default:
+		break;
+	}
+}
+
+void
+LoadBot::HandleJoinGameAck(const JoinGameAckMessage &joinAck)
+{
+	m_gameId = joinAck.gameid();
+	if (m_role == BOT_ROLE_CHURN) {
+		// Leave immediately, this produces game list updates for the lobby.
+		StopRtt(RTT_CREATE_GAME);
+		StartRtt(RTT_LEAVE_GAME);
+		Send(*NewGameManagementMessage(GameManagementMessage::Type_LeaveGameRequestMessage));
+		return;
+	}
+	if (m_role == BOT_ROLE_SPECTATOR) {
+		StopRtt(RTT_JOIN_GAME);
+		return;
+	}
+	boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+	if (!group)
+		return;
+	if (m_isAdmin) {
+		StopRtt(RTT_CREATE_GAME);
+		group->gameId = joinAck.gameid();
+		// Let all group members which are already logged in join the game.
+		for (size_t i = 0; i < group->bots.size(); i++) {
+			boost::shared_ptr<LoadBot> tmpBot(group->bots[i].lock());
+			if (tmpBot && tmpBot.get() != this && tmpBot->IsReadyForGame())
+				tmpBot->JoinGame(group->gameId);
+		}
+	} else {
+		StopRtt(RTT_JOIN_GAME);
+	}
+	group->numJoined++;
+	CheckStartGame(*group);
+}
+
+void
+LoadBot::HandleGameManagementMessage(const GameManagementMessage &manageMsg)
+{
+	switch (manageMsg.messagetype()) {
+	case GameManagementMessage::Type_StartEventMessage: {
+		boost::shared_ptr<PokerTHMessage> msg(NewGameManagementMessage(GameManagementMessage::Type_StartEventAckMessage));
+		msg->mutable_gamemessage()->mutable_gamemanagementmessage()->mutable_starteventackmessage();
+		Send(*msg);
+	}
+	break;
+	case GameManagementMessage::Type_GameStartInitialMessage:
+		m_handNum = 0;
+		m_myMoney = m_config.startMoney;
+		if (m_isAdmin) {
+			boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+			if (group && group->startEventTime) {
+				m_stats.AddRtt(RTT_START_GAME, LoadNowUsec() - group->startEventTime);
+				group->startEventTime = 0;
+			}
+			m_stats.AddGameStarted();
+		}
+		break;
+	case GameManagementMessage::Type_EndOfGameMessage:
+		if (m_isAdmin)
+			m_stats.AddGameFinished();
+		break;
+	case GameManagementMessage::Type_RemovedFromGameMessage:
+		m_inGame = false;
+		m_gameId = 0;
+		if (m_role == BOT_ROLE_CHURN) {
+			StopRtt(RTT_LEAVE_GAME);
+			if (!m_closing)
+				CreateGame();
+		}
+		break;
+	case GameManagementMessage::Type_TimeoutWarningMessage:
+		Send(*NewGameManagementMessage(GameManagementMessage::Type_ResetTimeoutMessage));
+		break;
+	case GameManagementMessage::Type_ErrorMessage:
+		HandleServerError("game", manageMsg.errormessage());
+		break;
+	default:
+		break;
+	}
+}
+
+void
+LoadBot::HandleGameEngineMessage(const GameEngineMessage &engineMsg)
+{
+	switch (engineMsg.messagetype()) {
+	case GameEngineMessage::Type_HandStartMessage:
+		m_handNum++;
+		m_smallBlind = engineMsg.handstartmessage().smallblind();
+		m_minimumRaise = 2 * m_smallBlind;
+		NewRound();
+		if (m_isAdmin)
+			m_stats.AddHand();
+		break;
+	case GameEngineMessage::Type_DealFlopCardsMessage:
+	case GameEngineMessage::Type_DealTurnCardMessage:
+	case GameEngineMessage::Type_DealRiverCardMessage:
+		NewRound();
+		break;
+	case GameEngineMessage::Type_PlayersTurnMessage: {
+		const PlayersTurnMessage &netTurn = engineMsg.playersturnmessage();
+		if (m_role == BOT_ROLE_PLAYER && netTurn.playerid() == m_playerId) {
+			m_turnGameState = netTurn.gamestate();
+			if (m_config.thinkTimeMsec) {
+				m_thinkTimer.expires_from_now(boost::posix_time::milliseconds(m_config.thinkTimeMsec));
+				m_thinkTimer.async_wait(boost::bind(&LoadBot::TimerAct, shared_from_this(), boost::asio::placeholders::error));
+			} else {
+				Act(NextAction());
+			}
+		}
+	}
+	break;
+	case GameEngineMessage::Type_PlayersActionDoneMessage: {
+		const PlayersActionDoneMessage &netDone = engineMsg.playersactiondonemessage();
+		m_highestSet = netDone.highestset();
+		m_minimumRaise = netDone.minimumraise();
+		if (netDone.playerid() == m_playerId) {
+			m_mySet = netDone.totalplayerbet();
+			m_myMoney = netDone.playermoney();
+			StopRtt(RTT_ACTION);
+		} else if (m_role == BOT_ROLE_SPECTATOR) {
+			// Delivery time of a bot action to the spectators.
+			boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+			if (group && group->lastActionTime && group->actionSeq != m_lastActionSeq
+					&& group->lastActionPlayerId == netDone.playerid()) {
+				m_lastActionSeq = group->actionSeq;
+				m_stats.AddRtt(RTT_SPECTATOR, LoadNowUsec() - group->lastActionTime);
+			}
+		}
+	}
+	break;
+	case GameEngineMessage::Type_YourActionRejectedMessage: {
+		const YourActionRejectedMessage &netRejected = engineMsg.youractionrejectedmessage();
+		StopRtt(RTT_ACTION);
+		ostringstream error;
+		error << "ActionRejected(reason " << netRejected.rejectionreason() << ")";
+		m_stats.AddError(error.str());
+		// Retry once with a more defensive action.
+		if (netRejected.rejectionreason() == YourActionRejectedMessage::rejectedActionNotAllowed) {
+			if (m_lastAction == netActionBet || m_lastAction == netActionRaise || m_lastAction == netActionAllIn)
+				Act(LOAD_ACTION_CALL);
+			else if (m_lastAction != netActionFold)
+				Act(LOAD_ACTION_FOLD);
+		}
+	}
+	break;
+	default:
+		break;
+	}
+}
+
+void
+LoadBot::HandleServerError(const char *where, const ErrorMessage &netError)
+{
+	ostringstream error;
+	error << where << " ErrorMessage(reason " << netError.errorreason() << ")";
+	m_stats.AddError(error.str());
+}
+
+void
+LoadBot::EnterGameGroup()
+{
+	boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+	if (!group)
+		return;
+	if (m_isAdmin)
+		CreateGame();
+	else if (group->gameId)
+		JoinGame(group->gameId);
+}
+
+void
+LoadBot::CreateGame()
+{
+	boost::shared_ptr<PokerTHMessage> msg(NewLobbyMessage(LobbyMessage::Type_CreateGameMessage));
+	CreateGameMessage *netCreate = msg->mutable_lobbymessage()->mutable_creategamemessage();
+	netCreate->set_requestid(++m_numGamesCreated);
+	netCreate->set_password(LOAD_GAME_PASSWORD);
+	NetGameInfo *gameInfo = netCreate->mutable_gameinfo();
+	ostringstream gameName;
+	gameName << LOAD_GAME_NAME_PREFIX << m_nickName << "_" << m_numGamesCreated;
+	gameInfo->set_gamename(gameName.str());
+	gameInfo->set_netgametype(NetGameInfo::normalGame);
+	gameInfo->set_maxnumplayers(m_role == BOT_ROLE_CHURN ? 10 : m_config.playersPerGame);
+	gameInfo->set_raiseintervalmode(NetGameInfo::raiseOnHandNum);
+	gameInfo->set_raiseeveryhands(8);
+	gameInfo->set_endraisemode(NetGameInfo::doubleBlinds);
+	gameInfo->set_proposedguispeed(5);
+	gameInfo->set_delaybetweenhands(m_config.delayBetweenHandsSec);
+	gameInfo->set_playeractiontimeout(m_config.actionTimeoutSec);
+	gameInfo->set_firstsmallblind(m_config.firstSmallBlind);
+	gameInfo->set_startmoney(m_config.startMoney);
+	m_inGame = true;
+	StartRtt(RTT_CREATE_GAME);
+	Send(*msg);
+}
+
+void
+LoadBot::LeaveGroup()
+{
+	boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+	if (group && m_role == BOT_ROLE_PLAYER && group->numExpected) {
+		group->numExpected--;
+		CheckStartGame(*group);
+	}
+	m_group.reset();
+}
+
+void
+LoadBot::CheckStartGame(LoadGameGroup &group)
+{
+	if (group.started || !group.gameId || group.numJoined < group.numExpected)
+		return;
+	boost::shared_ptr<LoadBot> admin(group.bots.front().lock());
+	if (!admin || !admin->m_inGame || admin->m_closing)
+		return;
+	group.started = true;
+	group.startEventTime = LoadNowUsec();
+	boost::shared_ptr<PokerTHMessage> msg(admin->NewGameManagementMessage(GameManagementMessage::Type_StartEventMessage));
+	StartEventMessage *netStart = msg->mutable_gamemessage()->mutable_gamemanagementmessage()->mutable_starteventmessage();
+	netStart->set_starteventtype(StartEventMessage::startEvent);
+	netStart->set_fillwithcomputerplayers(m_config.fillWithComputerPlayers);
+	admin->Send(*msg);
+}
+
+void
+LoadBot::NewRound()
+{
+	m_highestSet = 0;
+	m_mySet = 0;
+	if (m_minimumRaise < 2 * m_smallBlind)
+		m_minimumRaise = 2 * m_smallBlind;
+}
+
+LoadAction
+LoadBot::NextAction()
+{
+	if (!m_config.actionScript.empty())
+		return m_config.actionScript[m_scriptPos++ % m_config.actionScript.size()];
+	// Random play: mostly passive so that hands last a few rounds.
+	boost::random::uniform_int_distribution<> dist(0, 99);
+	int r = dist(m_worker.rng);
+	if (r < 10)
+		return LOAD_ACTION_FOLD;
+	else if (r < 45)
+		return LOAD_ACTION_CHECK;
+	else if (r < 80)
+		return LOAD_ACTION_CALL;
+	else if (r < 98)
+		return LOAD_ACTION_RAISE;
+	return LOAD_ACTION_ALLIN;
+}
+
+void
+LoadBot::TimerAct(const boost::system::error_code &ec)
+{
+	if (!ec && !m_closing)
+		Act(NextAction());
+}
+
+void
+LoadBot::Act(LoadAction action)
+{
+	NetPlayerAction netAction = netActionFold;
+	unsigned relativeBet = 0;
+	switch (action) {
+	case LOAD_ACTION_FOLD:
+		netAction = netActionFold;
+		break;
+	case LOAD_ACTION_CHECK:
+	case LOAD_ACTION_CALL:
+		// The server fills in the call amount if we leave it 0.
+		netAction = (m_highestSet > m_mySet) ? netActionCall : netActionCheck;
+		break;
+	case LOAD_ACTION_RAISE:
+		if (m_highestSet == 0) {
+			netAction = netActionBet;
+			relativeBet = 2 * m_smallBlind;
+		} else {
+			netAction = netActionRaise;
+			relativeBet = m_minimumRaise;
+		}
+		if (relativeBet == 0 || relativeBet > m_myMoney)
+			netAction = netActionAllIn;
+		break;
+	case LOAD_ACTION_ALLIN:
+		netAction = netActionAllIn;
+		break;
+	}
+	if (netAction == netActionAllIn)
+		relativeBet = 0;
+
+	boost::shared_ptr<PokerTHMessage> msg(NewGameEngineMessage(GameEngineMessage::Type_MyActionRequestMessage));
+	MyActionRequestMessage *netMyAction = msg->mutable_gamemessage()->mutable_gameenginemessage()->mutable_myactionrequestmessage();
+	netMyAction->set_handnum(m_handNum);
+	netMyAction->set_gamestate(m_turnGameState);
+	netMyAction->set_myaction(netAction);
+	netMyAction->set_myrelativebet(relativeBet);
+	m_lastAction = netAction;
+	StartRtt(RTT_ACTION);
+	boost::shared_ptr<LoadGameGroup> group(m_group.lock());
+	if (group) {
+		group->actionSeq++;
+		group->lastActionPlayerId = m_playerId;
+		group->lastActionTime = m_rttStart[RTT_ACTION];
+	}
+	Send(*msg);
+}
+
+boost::shared_ptr<PokerTHMessage>
+LoadBot::NewLobbyMessage(LobbyMessage::LobbyMessageType type)
+{
+	boost::shared_ptr<PokerTHMessage> msg(new PokerTHMessage);
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(type);
+	return msg;
+}
+
+boost::shared_ptr<PokerTHMessage>
+LoadBot::NewGameManagementMessage(GameManagementMessage::GameManagementMessageType type)
+{
+	boost::shared_ptr<PokerTHMessage> msg(NewGameMessage(GameMessage::Type_GameManagementMessage));
+	msg->mutable_gamemessage()->mutable_gamemanagementmessage()->set_messagetype(type);
+	return msg;
+}
+
+boost::shared_ptr<PokerTHMessage>
+LoadBot::NewGameEngineMessage(GameEngineMessage::GameEngineMessageType type)
+{
+	boost::shared_ptr<PokerTHMessage> msg(NewGameMessage(GameMessage::Type_GameEngineMessage));
+	msg->mutable_gamemessage()->mutable_gameenginemessage()->set_messagetype(type);
+	return msg;
+}
+
+boost::shared_ptr<PokerTHMessage>
+LoadBot::NewGameMessage(GameMessage::GameMessageType type)
+{
+	boost::shared_ptr<PokerTHMessage> msg(new PokerTHMessage);
+	msg->set_messagetype(PokerTHMessage::Type_GameMessage);
+	GameMessage *netGame = msg->mutable_gamemessage();
+	netGame->set_messagetype(type);
+	netGame->set_gameid(m_gameId);
+	return msg;
+}
+
+void
+LoadBot::Send(const PokerTHMessage &msg)
+{
+	if (m_connection && !m_closing) {
+		m_stats.AddMessage(true);
+		m_connection->Send(msg);
+	}
+}
+
+void
+LoadBot::StartRtt(LoadRttType type)
+{
+	m_rttStart[type] = LoadNowUsec();
+}
+
+void
+LoadBot::StopRtt(LoadRttType type)
+{
+	if (m_rttStart[type]) {
+		m_stats.AddRtt(type, LoadNowUsec() - m_rttStart[type]);
+		m_rttStart[type] = 0;
+	}
+}
+
+LoadController::LoadController(const LoadConfig &config, LoadStatistics &stats)
+	: m_config(config), m_stats(stats), m_launchTimer(m_ioService), m_tickTimer(m_ioService), m_reportTimer(m_ioService),
+	  m_stopTimer(m_ioService), m_signals(m_ioService, SIGINT, SIGTERM), m_nextBot(0), m_launchStart(0), m_readyTime(0),
+	  m_setupTimeoutSec(0), m_quiet(false), m_ready(false), m_stopped(false)
+{
+	unsigned seed = config.randomSeed ? config.randomSeed : static_cast<unsigned>(LoadNowUsec());
+	unsigned numThreads = config.numThreads ? config.numThreads : 1;
+	for (unsigned i = 0; i < numThreads; i++) {
+		boost::shared_ptr<LoadWorker> worker(new LoadWorker(seed + i));
+		if (config.useWebSocket) {
+			worker->webClient.reset(new web_client);
+			worker->webClient->clear_access_channels(websocketpp::log::alevel::all);
+			worker->webClient->clear_error_channels(websocketpp::log::elevel::all);
+			worker->webClient->init_asio(&worker->ioService);
+		}
+		m_workers.push_back(worker);
+	}
+}
+
+LoadController::~LoadController()
+{
+	// Bots use the io_service of their worker, release them first.
+	m_groups.clear();
+	m_bots.clear();
+}
+
+void
+LoadController::SetReadyCondition(boost::function<bool ()> condition)
+{
+	m_readyCondition = condition;
+}
+
+void
+LoadController::SetDoneCondition(boost::function<bool ()> condition)
+{
+	m_doneCondition = condition;
+}
+
+void
+LoadController::SetStopCallback(boost::function<void ()> callback)
+{
+	m_stopCallback = callback;
+}
+
+void
+LoadController::SetSetupTimeout(unsigned timeoutSec)
+{
+	m_setupTimeoutSec = timeoutSec;
+}
+
+void
+LoadController::SetQuiet(bool quiet)
+{
+	m_quiet = quiet;
+}
+
+unsigned
+LoadController::GetNumBots() const
+{
+	return m_config.numGames * (m_config.playersPerGame + m_config.spectatorsPerGame)
+		   + m_config.numLobbyBots + m_config.numChurnBots + m_config.numLoginBots;
+}
+
+bool
+LoadController::WasReady() const
+{
+	return m_ready;
+}
+
+void
+LoadController::Run()
+{
+	Init();
+
+	boost::thread_group threads;
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		threads.create_thread(boost::bind(&boost::asio::io_service::run, &m_workers[i]->ioService));
+	}
+	m_ioService.run();
+	threads.join_all();
+}
+
+void
+LoadController::Init()
+{
+	unsigned botIndex = 0;
+	size_t workerIndex = 0;
+	// Idle lobby users first, so that they see all game list updates.
+	for (unsigned i = 0; i < m_config.numLobbyBots; i++) {
+		LoadWorker &worker = *m_workers[workerIndex++ % m_workers.size()];
+		m_bots.push_back(make_pair(boost::shared_ptr<LoadBot>(
+									   new LoadBot(m_config, m_stats, worker, boost::shared_ptr<LoadGameGroup>(), botIndex++, BOT_ROLE_LOBBY, false)), &worker));
+	}
+	for (unsigned g = 0; g < m_config.numGames; g++) {
+		boost::shared_ptr<LoadGameGroup> group(new LoadGameGroup(g + 1));
+		group->numExpected = m_config.playersPerGame;
+		LoadWorker &worker = *m_workers[workerIndex++ % m_workers.size()];
+		for (unsigned p = 0; p < m_config.playersPerGame + m_config.spectatorsPerGame; p++) {
+			bool isPlayer = p < m_config.playersPerGame;
+			boost::shared_ptr<LoadBot> bot(new LoadBot(m_config, m_stats, worker, group, botIndex++,
+										   isPlayer ? BOT_ROLE_PLAYER : BOT_ROLE_SPECTATOR, p == 0));
+			group->bots.push_back(bot);
+			m_bots.push_back(make_pair(bot, &worker));
+		}
+		m_groups.push_back(group);
+	}
+	for (unsigned i = 0; i < m_config.numChurnBots; i++) {
+		LoadWorker &worker = *m_workers[workerIndex++ % m_workers.size()];
+		m_bots.push_back(make_pair(boost::shared_ptr<LoadBot>(
+									   new LoadBot(m_config, m_stats, worker, boost::shared_ptr<LoadGameGroup>(), botIndex++, BOT_ROLE_CHURN, true)), &worker));
+	}
+	for (unsigned i = 0; i < m_config.numLoginBots; i++) {
+		LoadWorker &worker = *m_workers[workerIndex++ % m_workers.size()];
+		m_bots.push_back(make_pair(boost::shared_ptr<LoadBot>(
+									   new LoadBot(m_config, m_stats, worker, boost::shared_ptr<LoadGameGroup>(), botIndex++, BOT_ROLE_LOGIN, false)), &worker));
+	}
+	if (!m_quiet) {
+		cout << "Starting " << m_bots.size() << " bots (" << m_config.numGames << " games) using "
+			 << (m_config.useWebSocket ? "WebSocket" : "TCP") << "." << endl;
+	}
+
+	m_signals.async_wait(boost::bind(&LoadController::HandleSignal, this, boost::asio::placeholders::error));
+	m_launchStart = LoadNowUsec();
+	if (!m_readyCondition) {
+		m_ready = true;
+		m_readyTime = m_launchStart;
+	}
+	LaunchBots();
+	m_tickTimer.expires_from_now(boost::posix_time::milliseconds(LOAD_CONTROL_TICK_MSEC));
+	m_tickTimer.async_wait(boost::bind(&LoadController::HandleTickTimer, this, boost::asio::placeholders::error));
+	if (!m_quiet) {
+		m_reportTimer.expires_from_now(boost::posix_time::seconds(m_config.reportIntervalSec));
+		m_reportTimer.async_wait(boost::bind(&LoadController::HandleReportTimer, this, boost::asio::placeholders::error));
+	}
+}
+
+void
+LoadController::LaunchBots()
+{
+	// Number of bots which should have been started by now.
+	size_t target = m_bots.size();
+	if (m_config.connectRate) {
+		long long elapsedUsec = LoadNowUsec() - m_launchStart;
+		target = static_cast<size_t>(elapsedUsec * m_config.connectRate / 1000000) + 1;
+		if (target > m_bots.size())
+			target = m_bots.size();
+	}
+	while (m_nextBot < target) {
+		m_bots[m_nextBot].second->ioService.post(boost::bind(&LoadBot::Start, m_bots[m_nextBot].first));
+		m_nextBot++;
+	}
+	if (m_nextBot < m_bots.size() && !m_stopped) {
+		m_launchTimer.expires_from_now(boost::posix_time::milliseconds(LOAD_LAUNCH_TICK_MSEC));
+		m_launchTimer.async_wait(boost::bind(&LoadController::HandleLaunchTimer, this, boost::asio::placeholders::error));
+	}
+}
+
+void
+LoadController::HandleLaunchTimer(const boost::system::error_code &ec)
+{
+	if (!ec && !m_stopped)
+		LaunchBots();
+}
+
+void
+LoadController::HandleTickTimer(const boost::system::error_code &ec)
+{
+	if (ec || m_stopped)
+		return;
+	long long now = LoadNowUsec();
+	if (!m_ready) {
+		if (m_readyCondition()) {
+			m_ready = true;
+			m_readyTime = now;
+			m_stats.ResetSamples();
+		} else if (m_setupTimeoutSec && now - m_launchStart >= (long long)m_setupTimeoutSec * 1000000) {
+			m_stats.AddError("setup timeout");
+			Stop();
+			return;
+		}
+	}
+	if (m_ready) {
+		if (m_config.durationSec) {
+			if (now - m_readyTime >= (long long)m_config.durationSec * 1000000) {
+				Stop();
+				return;
+			}
+		} else if (m_doneCondition ? m_doneCondition() : AllGamesFinished()) {
+			Stop();
+			return;
+		}
+	}
+	m_tickTimer.expires_from_now(boost::posix_time::milliseconds(LOAD_CONTROL_TICK_MSEC));
+	m_tickTimer.async_wait(boost::bind(&LoadController::HandleTickTimer, this, boost::asio::placeholders::error));
+}
+
+void
+LoadController::HandleReportTimer(const boost::system::error_code &ec)
+{
+	if (ec || m_stopped)
+		return;
+	m_stats.Report(cout, false);
+	m_reportTimer.expires_from_now(boost::posix_time::seconds(m_config.reportIntervalSec));
+	m_reportTimer.async_wait(boost::bind(&LoadController::HandleReportTimer, this, boost::asio::placeholders::error));
+}
+
+void
+LoadController::HandleSignal(const boost::system::error_code &ec)
+{
+	if (!ec)
+		Stop();
+}
+
+bool
+LoadController::AllGamesFinished() const
+{
+	return m_config.numGames && m_stats.GetGamesFinished() >= m_config.numGames;
+}
+
+void
+LoadController::Stop()
+{
+	if (m_stopped)
+		return;
+	m_stopped = true;
+	if (m_stopCallback)
+		m_stopCallback();
+	boost::system::error_code ec;
+	m_launchTimer.cancel(ec);
+	m_tickTimer.cancel(ec);
+	m_reportTimer.cancel(ec);
+	m_signals.cancel(ec);
+	for (size_t i = 0; i < m_nextBot; i++) {
+		m_bots[i].second->ioService.post(boost::bind(&LoadBot::Stop, m_bots[i].first));
+	}
+	// Give the workers some time to close the connections.
+	m_stopTimer.expires_from_now(boost::posix_time::milliseconds(LOAD_STOP_GRACE_MSEC));
+	m_stopTimer.async_wait(boost::bind(&LoadController::HandleStopTimer, this, boost::asio::placeholders::error));
+}
+
+void
+LoadController::HandleStopTimer(const boost::system::error_code &/*ec*/)
+{
+	for (size_t i = 0; i < m_workers.size(); i++) {
+		m_workers[i]->ioService.stop();
+	}
+}
@@ -0,0 +1,368 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Asynchronous bot clients for load tests and benchmarks. */
+
+#ifndef _LOADCLIENT_H_
+#define _LOADCLIENT_H_
+
+#include <boost/asio.hpp>
+#include <third_party/protobuf/pokerth.pb.h>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+typedef websocketpp::client<websocketpp::config::asio_client> web_client;
+
+enum LoadRttType {
+	RTT_CONNECT = 0,	// TCP/WebSocket connect until AnnounceMessage
+	RTT_LOGIN,			// AuthClientRequestMessage until InitDoneMessage
+	RTT_SUBSCRIBE,		// SubscriptionRequestMessage until SubscriptionReplyMessage
+	RTT_CREATE_GAME,	// CreateGameMessage until JoinGameAckMessage
+	RTT_JOIN_GAME,		// JoinGameMessage until JoinGameAckMessage
+	RTT_LEAVE_GAME,		// LeaveGameRequestMessage until RemovedFromGameMessage
+	RTT_START_GAME,		// StartEventMessage until GameStartInitialMessage
+	RTT_ACTION,			// MyActionRequestMessage until own PlayersActionDoneMessage
+	RTT_SPECTATOR,		// MyActionRequestMessage until PlayersActionDoneMessage at a spectator
+	RTT_NUM
+};
+
+enum LoadAction {
+	LOAD_ACTION_FOLD = 0,
+	LOAD_ACTION_CHECK,
+	LOAD_ACTION_CALL,
+	LOAD_ACTION_RAISE,
+	LOAD_ACTION_ALLIN
+};
+
+enum LoadBotRole {
+	BOT_ROLE_PLAYER = 0,	// Create/join a game of its group and play.
+	BOT_ROLE_SPECTATOR,		// Spectate the game of its group.
+	BOT_ROLE_LOBBY,			// Stay idle in the lobby.
+	BOT_ROLE_CHURN,			// Repeatedly create and leave a game.
+	BOT_ROLE_LOGIN			// Disconnect after login.
+};
+
+long long LoadNowUsec();
+
+struct LoadRttSummary {
+	LoadRttSummary() : count(0), p50(0), p90(0), p99(0), max(0) {}
+	size_t count;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+};
+
+// Statistics shared by all worker threads.
+class LoadStatistics
+{
+public:
+	LoadStatistics();
+
+	void AddConnectAttempt();
+	void AddConnect();
+	void AddConnectFailure();
+	void AddDisconnect();
+	void AddMessage(bool sent);
+	void AddGameStarted();
+	void AddGameFinished();
+	void AddHand();
+	void AddRtt(LoadRttType type, long long usec);
+	void AddError(const std::string &what);
+
+	// Start a new measurement window. Error counts are kept.
+	void ResetSamples();
+
+	unsigned GetConnects() const;
+	unsigned GetConnectFailures() const;
+	unsigned GetMessagesReceived() const;
+	unsigned GetGamesStarted() const;
+	unsigned GetGamesFinished() const;
+	unsigned GetHands() const;
+	unsigned GetErrorCount() const;
+	size_t GetRttCount(LoadRttType type) const;
+	LoadRttSummary GetRttSummary(LoadRttType type) const;
+	double GetElapsedSec() const;
+
+	void Report(std::ostream &out, bool final);
+
+	static const char *GetRttName(LoadRttType type);
+
+protected:
+	static LoadRttSummary Summarize(std::vector<unsigned> &samples);
+
+private:
+	typedef std::map<std::string, unsigned> ErrorMap;
+
+	mutable boost::mutex m_mutex;
+	long long m_startTime;
+	long long m_lastReportTime;
+	unsigned m_connectAttempts;
+	unsigned m_connects;
+	unsigned m_lastConnects;
+	unsigned m_connectFailures;
+	unsigned m_disconnects;
+	unsigned m_msgSent;
+	unsigned m_msgReceived;
+	unsigned m_lastMsgReceived;
+	unsigned m_gamesStarted;
+	unsigned m_gamesFinished;
+	unsigned m_hands;
+	std::vector<unsigned> m_rtt[RTT_NUM];
+	size_t m_lastRttIndex[RTT_NUM];
+	ErrorMap m_errors;
+};
+
+struct LoadConfig {
+	LoadConfig();
+
+	std::string server;
+	std::string port;
+	bool useWebSocket;
+	bool webSocketBatch;
+	std::string webSocketResource;
+	unsigned numGames;
+	unsigned playersPerGame;
+	unsigned spectatorsPerGame;
+	unsigned numLobbyBots;
+	unsigned numChurnBots;
+	unsigned numLoginBots;
+	unsigned firstId;
+	unsigned connectRate;
+	unsigned numThreads;
+	unsigned thinkTimeMsec;
+	unsigned durationSec;
+	unsigned reportIntervalSec;
+	bool fillWithComputerPlayers;
+	unsigned actionTimeoutSec;
+	unsigned delayBetweenHandsSec;
+	unsigned startMoney;
+	unsigned firstSmallBlind;
+	unsigned randomSeed;
+	std::vector<LoadAction> actionScript;
+	std::vector<boost::asio::ip::tcp::endpoint> endpoints;
+
+	static bool ParseActionScript(const std::string &script, std::vector<LoadAction> &actions);
+};
+
+// One io_service per worker thread. All bots of a game group live on the
+// same worker, so bot and group state is never accessed concurrently.
+struct LoadWorker {
+	LoadWorker(unsigned seed) : work(ioService), rng(seed) {}
+
+	boost::asio::io_service ioService;
+	boost::asio::io_service::work work;
+	boost::random::mt19937 rng;
+	boost::shared_ptr<web_client> webClient;
+};
+
+class LoadBot;
+
+struct LoadGameGroup {
+	LoadGameGroup(unsigned id)
+		: groupId(id), gameId(0), numExpected(0), numJoined(0), started(false), startEventTime(0),
+		  actionSeq(0), lastActionPlayerId(0), lastActionTime(0) {}
+
+	unsigned groupId;
+	unsigned gameId;
+	unsigned numExpected;
+	unsigned numJoined;
+	bool started;
+	long long startEventTime;
+	unsigned actionSeq;
+	unsigned lastActionPlayerId;
+	long long lastActionTime;
+	std::vector<boost::weak_ptr<LoadBot> > bots;
+};
+
+// Callbacks from a transport to its bot.
+class LoadConnectionHandler
+{
+public:
+	virtual ~LoadConnectionHandler() {}
+	virtual void HandleConnected() = 0;
+	virtual void HandleConnectFailed(const std::string &reason) = 0;
+	virtual void HandleMessage(const PokerTHMessage &msg) = 0;
+	virtual void HandleDisconnected(const std::string &reason) = 0;
+};
+
+class LoadConnection
+{
+public:
+	virtual ~LoadConnection() {}
+	virtual void Connect(boost::shared_ptr<LoadConnectionHandler> handler) = 0;
+	virtual void Send(const PokerTHMessage &msg) = 0;
+	virtual void Close() = 0;
+};
+
+class LoadBot : public LoadConnectionHandler, public boost::enable_shared_from_this<LoadBot>
+{
+public:
+	LoadBot(const LoadConfig &config, LoadStatistics &stats, LoadWorker &worker,
+			boost::shared_ptr<LoadGameGroup> group, unsigned botIndex, LoadBotRole role, bool isAdmin);
+
+	void Start();
+	void Stop();
+
+	bool IsReadyForGame() const;
+	void JoinGame(unsigned gameId);
+
+	virtual void HandleConnected();
+	virtual void HandleConnectFailed(const std::string &reason);
+	virtual void HandleDisconnected(const std::string &reason);
+	virtual void HandleMessage(const PokerTHMessage &msg);
+
+protected:
+	void HandleAnnounce(const AnnounceMessage &announce);
+	void HandleLobbyMessage(const LobbyMessage &lobbyMsg);
+	void HandleJoinGameAck(const JoinGameAckMessage &joinAck);
+	void HandleGameManagementMessage(const GameManagementMessage &manageMsg);
+	void HandleGameEngineMessage(const GameEngineMessage &engineMsg);
+	void HandleServerError(const char *where, const ErrorMessage &netError);
+
+	void EnterGameGroup();
+	void CreateGame();
+	void LeaveGroup();
+	void CheckStartGame(LoadGameGroup &group);
+	void NewRound();
+	LoadAction NextAction();
+	void TimerAct(const boost::system::error_code &ec);
+	void Act(LoadAction action);
+
+	boost::shared_ptr<PokerTHMessage> NewLobbyMessage(LobbyMessage::LobbyMessageType type);
+	boost::shared_ptr<PokerTHMessage> NewGameManagementMessage(GameManagementMessage::GameManagementMessageType type);
+	boost::shared_ptr<PokerTHMessage> NewGameEngineMessage(GameEngineMessage::GameEngineMessageType type);
+	boost::shared_ptr<PokerTHMessage> NewGameMessage(GameMessage::GameMessageType type);
+	void Send(const PokerTHMessage &msg);
+
+	void StartRtt(LoadRttType type);
+	void StopRtt(LoadRttType type);
+
+private:
+	const LoadConfig &m_config;
+	LoadStatistics &m_stats;
+	LoadWorker &m_worker;
+	boost::weak_ptr<LoadGameGroup> m_group;
+	boost::shared_ptr<LoadConnection> m_connection;
+	boost::asio::deadline_timer m_thinkTimer;
+	std::string m_nickName;
+	unsigned m_botIndex;
+	LoadBotRole m_role;
+	bool m_isAdmin;
+	bool m_loggedIn;
+	bool m_inGame;
+	bool m_closing;
+	unsigned m_gameId;
+	unsigned m_numGamesCreated;
+	unsigned m_playerId;
+	unsigned m_handNum;
+	unsigned m_smallBlind;
+	unsigned m_highestSet;
+	unsigned m_minimumRaise;
+	unsigned m_mySet;
+	unsigned m_myMoney;
+	NetGameState m_turnGameState;
+	NetPlayerAction m_lastAction;
+	size_t m_scriptPos;
+	unsigned m_lastActionSeq;
+	long long m_rttStart[RTT_NUM];
+};
+
+// Starts the bots at the configured connection rate, prints reports and
+// terminates the run.
+class LoadController
+{
+public:
+	LoadController(const LoadConfig &config, LoadStatistics &stats);
+	~LoadController();
+
+	// Measurement starts as soon as this returns true (default: immediately).
+	// The statistics are reset at this point, durationSec counts from there.
+	void SetReadyCondition(boost::function<bool ()> condition);
+	// The run ends when this returns true (default: all games finished).
+	void SetDoneCondition(boost::function<bool ()> condition);
+	// Called once when the run ends, before the bots are stopped.
+	void SetStopCallback(boost::function<void ()> callback);
+	// Give up if the ready condition was not met after this time.
+	void SetSetupTimeout(unsigned timeoutSec);
+	void SetQuiet(bool quiet);
+
+	unsigned GetNumBots() const;
+	bool WasReady() const;
+
+	void Run();
+
+protected:
+	void Init();
+	void LaunchBots();
+	void HandleLaunchTimer(const boost::system::error_code &ec);
+	void HandleTickTimer(const boost::system::error_code &ec);
+	void HandleReportTimer(const boost::system::error_code &ec);
+	void HandleSignal(const boost::system::error_code &ec);
+	bool AllGamesFinished() const;
+	void Stop();
+	void HandleStopTimer(const boost::system::error_code &ec);
+
+private:
+	typedef std::vector<std::pair<boost::shared_ptr<LoadBot>, LoadWorker *> > BotList;
+
+	const LoadConfig &m_config;
+	LoadStatistics &m_stats;
+	boost::asio::io_service m_ioService;
+	std::vector<boost::shared_ptr<LoadWorker> > m_workers;
+	boost::asio::deadline_timer m_launchTimer;
+	boost::asio::deadline_timer m_tickTimer;
+	boost::asio::deadline_timer m_reportTimer;
+	boost::asio::deadline_timer m_stopTimer;
+	boost::asio::signal_set m_signals;
+	boost::function<bool ()> m_readyCondition;
+	boost::function<bool ()> m_doneCondition;
+	boost::function<void ()> m_stopCallback;
+	BotList m_bots;
+	std::vector<boost::shared_ptr<LoadGameGroup> > m_groups;
+	size_t m_nextBot;
+	long long m_launchStart;
+	long long m_readyTime;
+	unsigned m_setupTimeoutSec;
+	bool m_quiet;
+	bool m_ready;
+	bool m_stopped;
+};
+
+#endif
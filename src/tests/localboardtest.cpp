@@ -0,0 +1,323 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <engine/local_engine/localenginefactory.h>
+#include <engine/boardinterface.h>
+#include <engine/playerinterface.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+#define DISTRIBUTE_POT_SEED			4711
+#define DISTRIBUTE_POT_NUM_RUNS		20000
+
+// The distributePot algorithm before it used fixed seat arrays, kept as reference.
+static void
+ReferenceDistributePot(PlayerList seatsList, int &pot, unsigned dealerPosition, list<unsigned> &winners)
+{
+	winners.clear();
+
+	size_t i,j,k,l;
+	PlayerListIterator it;
+	PlayerListConstIterator it_c;
+
+	// filling player sets vector
+	std::vector<unsigned> playerSets;
+	for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
+		if((*it)->getMyActiveStatus()) {
+			playerSets.push_back( ( ((*it)->getMyRoundStartCash()) - ((*it)->getMyCash()) ) );
+		} else {
+			playerSets.push_back(0);
+		}
+		(*it)->setLastMoneyWon(0);
+	}
+
+	// sort player sets asc
+	std::vector<unsigned> playerSetsSort = playerSets;
+	sort(playerSetsSort.begin(), playerSetsSort.end());
+
+	// potLevel[0] = amount, potLevel[1] = sum, potLevel[2..n] = winner
+	std::vector<unsigned> potLevel;
+
+	// temp var
+	int highestCardsValue;
+	size_t winnerCount;
+	bool finalPot;
+	int potCarryOver = 0;
+	size_t mod;
+	bool winnerHit;
+
+	// level loop
+	for(i=0; i<playerSetsSort.size(); i++) {
+
+		// restart levelHighestCardsValue
+		highestCardsValue = 0;
+
+		// level detection
+		if(playerSetsSort[i] > 0) {
+
+			// level amount
+			potLevel.push_back(playerSetsSort[i]);
+
+			// level sum
+			potLevel.push_back((playerSetsSort.size()-i)*potLevel[0] + potCarryOver);
+
+			// determine level highestCardsValue
+			for(it_c=seatsList->begin(), j=0; it_c!=seatsList->end(); ++it_c,j++) {
+				if((*it_c)->getMyActiveStatus() && (*it_c)->getMyCardsValueInt() > highestCardsValue && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && playerSets[j] >= potLevel[0]) {
+					highestCardsValue = (*it_c)->getMyCardsValueInt();
+				}
+			}
+
+			// level winners
+			for(it_c=seatsList->begin(), j=0; it_c!=seatsList->end(); ++it_c,j++) {
+				if((*it_c)->getMyActiveStatus() && highestCardsValue == (*it_c)->getMyCardsValueInt() && (*it_c)->getMyAction() != PLAYER_ACTION_FOLD && playerSets[j] >= potLevel[0]) {
+					potLevel.push_back((*it_c)->getMyUniqueID());
+				}
+			}
+
+			// determine the number of level winners
+			winnerCount = potLevel.size()-2;
+
+			// check if this is the final pot level for at least one winner
+			finalPot = false;
+			for(j=2; j<potLevel.size(); j++) {
+				// find seat with potLevel[j]-ID
+				for(it=seatsList->begin(), k=0; it!=seatsList->end(); ++it, k++) {
+					if((*it)->getMyUniqueID() == potLevel[j] && potLevel[0] == playerSets[k]) {
+						finalPot = true;
+						break;
+					}
+				}
+				if(finalPot) break;
+			}
+
+			if(finalPot && winnerCount>0) {
+				// distribute the pot level sum to level winners
+				mod = (potLevel[1])%winnerCount;
+				// pot level sum divisible by winnerCount
+				if(mod == 0) {
+
+					for(j=2; j<potLevel.size(); j++) {
+						// find seat with potLevel[j]-ID
+						for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
+							if((*it)->getMyUniqueID() == potLevel[j]) {
+								break;
+							}
+						}
+						if(it != seatsList->end()) {
+							(*it)->setMyCash( (*it)->getMyCash() + ((potLevel[1])/winnerCount));
+							// filling winners vector
+							winners.push_back((*it)->getMyUniqueID());
+							(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + (potLevel[1])/winnerCount );
+						}
+					}
+
+				}
+				// pot level sum not divisible by winnerCount
+				// --> distribution after smallBlind
+				else {
+
+					// find Seat with dealerPosition
+					for(it=seatsList->begin(); it!=seatsList->end(); ++it) {
+						if((*it)->getMyUniqueID() == dealerPosition) {
+							break;
+						}
+					}
+					if(it == seatsList->end()) {
+						it = seatsList->begin();
+					}
+
+					for(j=0; j<winnerCount; j++) {
+
+						winnerHit = false;
+
+						for(k=0; k<MAX_NUMBER_OF_PLAYERS && !winnerHit; k++) {
+
+							++it;
+							if(it == seatsList->end())
+								it = seatsList->begin();
+
+							for(l=2; l<potLevel.size(); l++) {
+								if((*it)->getMyActiveStatus() && (*it)->getMyUniqueID() == potLevel[l])
+									winnerHit = true;
+							}
+
+						}
+
+						if(winnerHit) {
+							if(j<mod) {
+								(*it)->setMyCash( (*it)->getMyCash() + (int)((potLevel[1])/winnerCount) + 1);
+								// filling winners vector
+								winners.push_back((*it)->getMyUniqueID());
+								(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + ((potLevel[1])/winnerCount) + 1 );
+							} else {
+								(*it)->setMyCash( (*it)->getMyCash() + (int)((potLevel[1])/winnerCount));
+								// filling winners vector
+								winners.push_back((*it)->getMyUniqueID());
+								(*it)->setLastMoneyWon( (*it)->getLastMoneyWon() + (potLevel[1])/winnerCount );
+							}
+						}
+					}
+				}
+				potCarryOver = 0;
+
+				// pot refresh
+				pot -= potLevel[1];
+
+			} else {
+				potCarryOver = potLevel[1];
+			}
+
+			// reevaluate the player sets
+			for(j=0; j<playerSets.size(); j++) {
+				if(playerSets[j]>0) {
+					playerSets[j] -= potLevel[0];
+				}
+			}
+
+			// sort player sets asc
+			playerSetsSort = playerSets;
+			sort(playerSetsSort.begin(), playerSetsSort.end());
+
+			// clear potLevel
+			potLevel.clear();
+
+		}
+	}
+
+	// winners sort and unique
+	winners.sort();
+	winners.unique();
+}
+
+struct DistributePotSeat {
+	bool active;
+	int roundStartCash;
+	int cash;
+	PlayerAction action;
+	int cardsValue;
+};
+
+static void
+SetSeats(PlayerList seatsList, const vector<DistributePotSeat> &seats)
+{
+	size_t i = 0;
+	for (PlayerListIterator it = seatsList->begin(); it != seatsList->end(); ++it, i++) {
+		(*it)->setMyActiveStatus(seats[i].active);
+		(*it)->setMyRoundStartCash(seats[i].roundStartCash);
+		(*it)->setMyCash(seats[i].cash);
+		(*it)->setMyAction(seats[i].action);
+		(*it)->setMyCardsValueInt(seats[i].cardsValue);
+		(*it)->setLastMoneyWon(-1);
+	}
+}
+
+// Random stacks, bets, folds and hand values, many of them equal, are
+// distributed by LocalBoard and by the reference. The results have to match.
+void
+TestDistributePotReference()
+{
+	boost::random::mt19937 rng(DISTRIBUTE_POT_SEED);
+	LocalEngineFactory factory(NULL);
+	for (unsigned run = 0; run < DISTRIBUTE_POT_NUM_RUNS; run++) {
+		int numPlayers = boost::random::uniform_int_distribution<>(2, MAX_NUMBER_OF_PLAYERS)(rng);
+		PlayerList seatsList(new std::list<boost::shared_ptr<PlayerInterface> >);
+		vector<DistributePotSeat> seats(numPlayers);
+		int pot = 0;
+		for (int i = 0; i < numPlayers; i++) {
+			// Unique ids are not in seat order.
+			unsigned uniqueId = (i * 3 + 7) % 17;
+			ostringstream name;
+			name << "Player " << uniqueId;
+			seatsList->push_back(factory.createPlayer(i, uniqueId, PLAYER_TYPE_COMPUTER, name.str(), "", 0, true, false, 0));
+
+			DistributePotSeat &seat = seats[i];
+			seat.active = boost::random::uniform_int_distribution<>(0, 7)(rng) != 0;
+			seat.roundStartCash = boost::random::uniform_int_distribution<>(1000, 5999)(rng);
+			int bet;
+			switch (boost::random::uniform_int_distribution<>(0, 3)(rng)) {
+			case 0:
+				// All in.
+				bet = seat.roundStartCash;
+				break;
+			case 1:
+				// Few distinct amounts, to get equal bets.
+				bet = boost::random::uniform_int_distribution<>(0, 4)(rng) * 250;
+				break;
+			default:
+				bet = boost::random::uniform_int_distribution<>(0, seat.roundStartCash)(rng);
+				break;
+			}
+			if (!seat.active)
+				bet = 0;
+			seat.cash = seat.roundStartCash - bet;
+			seat.action = boost::random::uniform_int_distribution<>(0, 3)(rng) == 0 ? PLAYER_ACTION_FOLD : PLAYER_ACTION_ALLIN;
+			// Few distinct values, to get ties. A value of 0 never wins.
+			seat.cardsValue = boost::random::uniform_int_distribution<>(0, 2)(rng) == 0 ? 0 : 1000 * boost::random::uniform_int_distribution<>(0, 5)(rng);
+			pot += bet;
+		}
+		// The dealer may have left the table.
+		unsigned dealerPosition = boost::random::uniform_int_distribution<>(0, 4)(rng) == 0
+								  ? 99 : (boost::random::uniform_int_distribution<>(0, numPlayers - 1)(rng) * 3 + 7) % 17;
+
+		SetSeats(seatsList, seats);
+		int referencePot = pot;
+		list<unsigned> referenceWinners;
+		ReferenceDistributePot(seatsList, referencePot, dealerPosition, referenceWinners);
+		vector<int> referenceCash, referenceWon;
+		for (PlayerListConstIterator it = seatsList->begin(); it != seatsList->end(); ++it) {
+			referenceCash.push_back((*it)->getMyCash());
+			referenceWon.push_back((*it)->getLastMoneyWon());
+		}
+
+		SetSeats(seatsList, seats);
+		boost::shared_ptr<BoardInterface> board(factory.createBoard());
+		board->setPlayerLists(seatsList, seatsList, seatsList);
+		board->setPot(pot);
+		board->distributePot(dealerPosition);
+
+		bool equal = board->getPot() == referencePot && board->getWinners() == referenceWinners;
+		size_t i = 0;
+		for (PlayerListConstIterator it = seatsList->begin(); it != seatsList->end() && equal; ++it, i++)
+			equal = (*it)->getMyCash() == referenceCash[i] && (*it)->getLastMoneyWon() == referenceWon[i];
+		UNITTEST_CHECK(equal);
+		if (!equal)
+			break;
+	}
+}
@@ -0,0 +1,130 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <core/loghelper.h>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+#define LOG_TEST_NUM_THREADS		4
+#define LOG_TEST_NUM_LINES			2000
+
+static void
+LogTestLines(unsigned threadNum)
+{
+	for (unsigned i = 0; i < LOG_TEST_NUM_LINES; i++) {
+		LOG_MSG("thread " << threadNum << " line " << i);
+		LOG_VERBOSE("verbose " << threadNum << " line " << i);
+		if (i % 500 == 0)
+			LOG_ERROR("thread " << threadNum << " error " << i);
+	}
+}
+
+static vector<string>
+LogTestReadFile(const string &fileName)
+{
+	vector<string> lines;
+	ifstream i(fileName.c_str());
+	string line;
+	while (getline(i, line))
+		lines.push_back(line);
+	return lines;
+}
+
+// The log writer is stopped by this test, so it must be the only one
+// which checks the log file.
+void
+TestLogHelper()
+{
+	UnitTestTempFile tmpDir("");
+	boost::filesystem::create_directory(tmpDir.GetName());
+	const string logFile((boost::filesystem::path(tmpDir.GetName()) / "server_messages.log").string());
+
+	loghelper_init(tmpDir.GetName(), 1);
+	UNITTEST_CHECK(internal_log_enabled(1));
+	UNITTEST_CHECK(!internal_log_enabled(2));
+
+	boost::thread_group threads;
+	for (unsigned t = 0; t < LOG_TEST_NUM_THREADS; t++)
+		threads.create_thread(boost::bind(&LogTestLines, t));
+	threads.join_all();
+	// All pending lines are written on shutdown.
+	loghelper_cleanup();
+
+	vector<string> lines(LogTestReadFile(logFile));
+	UNITTEST_CHECK(lines.size() == LOG_TEST_NUM_THREADS * (LOG_TEST_NUM_LINES + LOG_TEST_NUM_LINES / 500));
+	// Lines of one thread keep their order, verbose lines are not written.
+	vector<unsigned> nextLine(LOG_TEST_NUM_THREADS, 0);
+	vector<unsigned> nextError(LOG_TEST_NUM_THREADS, 0);
+	for (size_t i = 0; i < lines.size(); i++) {
+		UNITTEST_CHECK(lines[i].find("verbose") == string::npos);
+		size_t pos = lines[i].find(" MSG: thread ");
+		bool isError = false;
+		if (pos == string::npos) {
+			pos = lines[i].find(" ERR: thread ");
+			isError = true;
+		}
+		UNITTEST_CHECK(pos != string::npos);
+		if (pos == string::npos)
+			continue;
+		istringstream lineStream(lines[i].substr(pos + 13));
+		unsigned threadNum = LOG_TEST_NUM_THREADS;
+		string kind;
+		unsigned num = 0;
+		lineStream >> threadNum >> kind >> num;
+		UNITTEST_CHECK(threadNum < LOG_TEST_NUM_THREADS);
+		if (threadNum >= LOG_TEST_NUM_THREADS)
+			continue;
+		if (isError) {
+			UNITTEST_CHECK(kind == "error" && num == nextError[threadNum]);
+			// The error is logged after the line with the same number.
+			UNITTEST_CHECK(nextLine[threadNum] == num + 1);
+			nextError[threadNum] += 500;
+		} else {
+			UNITTEST_CHECK(kind == "line" && num == nextLine[threadNum]);
+			nextLine[threadNum]++;
+		}
+	}
+
+	// After shutdown, lines are written directly.
+	LOG_MSG("after shutdown");
+	lines = LogTestReadFile(logFile);
+	UNITTEST_CHECK(!lines.empty() && lines.back().find(" MSG: after shutdown") != string::npos);
+
+	boost::system::error_code ec;
+	boost::filesystem::remove_all(tmpDir.GetName(), ec);
+}
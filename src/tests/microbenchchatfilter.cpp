@@ -28,25 +28,18 @@
  * shall include the source code for the parts of OpenSSL used as well       *
  * as that of the covered work.                                              *
  *****************************************************************************/
-/* libcurl upload helper. */
 
-#ifndef _UPLOADHELPER_H_
-#define _UPLOADHELPER_H_
+#include <tests/microbenchchatfilter.h>
+#include <chatcleaner/cleanerconfig.h>
+#include <chatcleaner/messagefilter.h>
 
-#include <net/transferhelper.h>
+using namespace std;
 
-
-class UploadHelper : public TransferHelper
+MicroBenchChatFilter::MicroBenchChatFilter(const list<string> &badWords, const list<string> &badWordExceptions)
+	: m_config(new CleanerConfig)
 {
-public:
-	UploadHelper();
-	virtual ~UploadHelper();
-
-protected:
-	virtual void InternalInit(const std::string &url, const std::string &targetFileName,
-							  const std::string &user, const std::string &password,
-							  size_t filesize, const std::string &httpPost);
-};
-
-#endif
-
+	m_config->writeConfigStringList("BadWordsList", badWords);
+	m_config->writeConfigStringList("BadWordsException", badWordExceptions);
+	m_filter.reset(new MessageFilter(m_config.get()));
+	m_filter->refreshConfig();
+}
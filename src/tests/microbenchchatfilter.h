@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Chat filter fixture for the microbenchmarks. */
+
+#ifndef _MICROBENCHCHATFILTER_H_
+#define _MICROBENCHCHATFILTER_H_
+
+#include <boost/shared_ptr.hpp>
+#include <list>
+#include <string>
+
+class CleanerConfig;
+class MessageFilter;
+
+// A MessageFilter with the default chatcleaner settings and the given bad
+// words. Kept in its own file, because cleanerconfig.h and configfile.h
+// cannot be included together. The config file of the chatcleaner is
+// created if missing, but the word lists are not written to it.
+class MicroBenchChatFilter
+{
+public:
+	MicroBenchChatFilter(const std::list<std::string> &badWords, const std::list<std::string> &badWordExceptions);
+
+	MessageFilter &GetFilter()
+	{
+		return *m_filter;
+	}
+
+private:
+	boost::shared_ptr<CleanerConfig> m_config;
+	boost::shared_ptr<MessageFilter> m_filter;
+};
+
+#endif
@@ -29,70 +29,73 @@
  * as that of the covered work.                                              *
  *****************************************************************************/
 
-#include <net/socket_helper.h>
-#include <net/uploadhelper.h>
-#include <net/netexception.h>
-#include <net/socket_msg.h>
-#include <net/transferdata.h>
-#include <sys/stat.h>
+#include <tests/unittest.h>
+#include <net/namepatternmatcher.h>
 
-#include <cstdio>
+#include <sstream>
 
 using namespace std;
 
-
-size_t
-readFunction(char *bufptr, size_t size, size_t nitems, void *userp)
+void
+TestNamePatternMatcher()
 {
-	return fread(bufptr, size, nitems, (FILE *)userp);
-}
+	NamePatternMatcher matcher;
+	matcher.Add(1, "BadName");
+	matcher.Add(2, "(foo|bar)[0-9]+");
+	matcher.Add(3, "x(y)z");
+	matcher.Add(4, "^baz$");
 
-size_t
-writeFunction(char *bufptr, size_t size, size_t nitems, void *userp)
-{
-	string msgPart(bufptr, size * nitems);
-	((string *)userp)->append(msgPart);
-	return size * nitems;
-}
+	UNITTEST_CHECK(matcher.IsMatch("badname"));
+	UNITTEST_CHECK(matcher.IsMatch("foo12"));
+	UNITTEST_CHECK(matcher.IsMatch("BAR3"));
+	UNITTEST_CHECK(matcher.IsMatch("xyz"));
+	UNITTEST_CHECK(matcher.IsMatch("baz"));
+	// Patterns match the full name.
+	UNITTEST_CHECK(!matcher.IsMatch("foo"));
+	UNITTEST_CHECK(!matcher.IsMatch("foo12x"));
+	UNITTEST_CHECK(!matcher.IsMatch("xyzbaz"));
 
-UploadHelper::UploadHelper()
-{
-}
+	UNITTEST_CHECK(matcher.Remove(2));
+	UNITTEST_CHECK(!matcher.Remove(2));
+	UNITTEST_CHECK(!matcher.IsMatch("foo12"));
+	UNITTEST_CHECK(matcher.IsMatch("xyz"));
 
-UploadHelper::~UploadHelper()
-{
+	// More patterns than fit into one combined regex.
+	for (unsigned i = 0; i < 3 * NAME_PATTERN_REGEX_CHUNK_SIZE; i++) {
+		ostringstream pattern;
+		pattern << "(spam|bot)" << i << "[a-z]*";
+		matcher.Add(100 + i, pattern.str());
+	}
+	UNITTEST_CHECK(matcher.IsMatch("spam0"));
+	UNITTEST_CHECK(matcher.IsMatch("bot700abc"));
+	UNITTEST_CHECK(!matcher.IsMatch("bot700abc1"));
+	UNITTEST_CHECK(matcher.IsMatch("xyz"));
+	matcher.Clear();
+	UNITTEST_CHECK(!matcher.IsMatch("xyz"));
+	UNITTEST_CHECK(!matcher.IsMatch("badname"));
 }
 
 void
-UploadHelper::InternalInit(const string &/*url*/, const string &targetFileName, const string &user, const string &password, size_t filesize, const string &httpPost)
+TestNamePatternMatcherBackReference()
 {
-	curl_easy_setopt(GetData()->curlHandle, CURLOPT_SSL_VERIFYPEER, 0L);
-	curl_easy_setopt(GetData()->curlHandle, CURLOPT_SSL_VERIFYHOST, 0L);
+	UNITTEST_CHECK(NamePatternMatcher::HasBackReference("(a)\\1"));
+	UNITTEST_CHECK(NamePatternMatcher::HasBackReference("[[:alpha:]](b)\\1"));
+	UNITTEST_CHECK(NamePatternMatcher::HasBackReference("[^]a](b)\\1"));
+	UNITTEST_CHECK(!NamePatternMatcher::HasBackReference("ab\\\\1"));
+	UNITTEST_CHECK(!NamePatternMatcher::HasBackReference("[\\1]x"));
+	UNITTEST_CHECK(!NamePatternMatcher::HasBackReference("[]\\1]"));
+	UNITTEST_CHECK(!NamePatternMatcher::HasBackReference("x\\.y"));
 
-	if (!user.empty() || !password.empty()) {
-		GetData()->userCredentials = user + ":" + password;
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_USERPWD, GetData()->userCredentials.c_str());
-	}
-	if (httpPost.empty()) {
-		// Open target file for reading.
-		GetData()->targetFile = fopen(targetFileName.c_str(), "rb");
-		if (!GetData()->targetFile)
-			throw NetException(__FILE__, __LINE__, ERR_SOCK_TRANSFER_OPEN_FAILED, 0);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_READFUNCTION, readFunction);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_READDATA, GetData()->targetFile);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_PUT, 1L);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_UPLOAD, 1L);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_INFILESIZE, filesize);
-	} else {
-		// Curl will handle file I/O.
-		struct curl_httppost *last = NULL;
-		curl_formadd(&GetData()->post, &last,
-					 CURLFORM_COPYNAME, httpPost.c_str(),
-					 CURLFORM_FILE, targetFileName.c_str(),
-					 CURLFORM_END);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_HTTPPOST, GetData()->post);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_WRITEFUNCTION, writeFunction);
-		curl_easy_setopt(GetData()->curlHandle, CURLOPT_WRITEDATA, &GetData()->returnMessage);
+	NamePatternMatcher matcher;
+	matcher.Add(1, "(a)(b)c");
+	bool rejected = false;
+	try {
+		matcher.Add(2, "(x)\\1");
+	} catch (const boost::regex_error &) {
+		rejected = true;
 	}
+	UNITTEST_CHECK(rejected);
+	// Groups of other patterns do not change the result.
+	UNITTEST_CHECK(matcher.IsMatch("abc"));
+	UNITTEST_CHECK(!matcher.IsMatch("xx"));
 }
-
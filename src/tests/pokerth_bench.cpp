@@ -0,0 +1,471 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+// Server benchmark for PokerTH
+//
+// Starts a dedicated server within this process on the loopback interface
+// and runs a fixed set of scenarios against it using the load test bots
+// (see tests/loadclient.cpp). Every scenario uses a fresh server instance.
+// One JSON object per line is printed for each scenario, so that results
+// can be collected and compared across commits. Bots use a fixed random
+// seed, but the server shuffles cards non-deterministically, so the number
+// of actions may vary slightly between runs.
+//
+// Note that RSS and CPU time are measured for the whole process, i.e. they
+// include the bots.
+
+#include <net/netpacket.h>
+#include <net/asiosendbuffer.h>
+#include "session.h"
+#include "configfile.h"
+#include <qttoolsinterface.h>
+#include <gui/generic/serverguiwrapper.h>
+#include <net/socket_startup.h>
+#include <core/thread.h>
+#include <tests/loadclient.h>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <sys/resource.h>
+
+using namespace std;
+using boost::asio::ip::tcp;
+namespace po = boost::program_options;
+
+#define BENCH_SERVER_ADDRESS				"127.0.0.1"
+#define BENCH_SERVER_STARTUP_TIMEOUT_MSEC	5000
+#define BENCH_SETUP_TIMEOUT_SEC				120
+#define BENCH_MAX_SESSIONS					10000
+
+struct BenchOptions {
+	unsigned port;
+	unsigned numThreads;
+	unsigned randomSeed;
+	unsigned durationSec;
+	unsigned numLogins;
+	unsigned numLobbyUsers;
+	unsigned numChurnUsers;
+	unsigned numTables;
+	unsigned numSpectators;
+};
+
+// Values sampled when the measurement ends.
+struct BenchResult {
+	BenchResult() : ready(false), measureSec(0), ops(0), messagesReceived(0), errors(0),
+		rssKb(0), cpuUserSec(0), cpuSysSec(0), hands(0), serverWrites(0) {}
+
+	bool ready;
+	double measureSec;
+	size_t ops;
+	LoadRttSummary rtt;
+	unsigned messagesReceived;
+	unsigned errors;
+	long rssKb;
+	double cpuUserSec;
+	double cpuSysSec;
+	unsigned hands;
+	unsigned long serverWrites;
+};
+
+static long
+GetRssKb()
+{
+	long rss = 0;
+	ifstream status("/proc/self/status");
+	string line;
+	while (getline(status, line)) {
+		if (line.compare(0, 6, "VmRSS:") == 0) {
+			istringstream(line.substr(6)) >> rss;
+			break;
+		}
+	}
+	return rss;
+}
+
+static double
+TimevalToSec(const timeval &tv)
+{
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void
+GetCpuTime(double &userSec, double &sysSec)
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	userSec = TimevalToSec(usage.ru_utime);
+	sysSec = TimevalToSec(usage.ru_stime);
+}
+
+static void
+RaiseFileLimit()
+{
+	// Every bot needs two descriptors, one for each side of the connection.
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+}
+
+static bool
+WaitForServer(unsigned port)
+{
+	boost::asio::io_service ioService;
+	tcp::endpoint endpoint(boost::asio::ip::address::from_string(BENCH_SERVER_ADDRESS), port);
+	for (unsigned waited = 0; waited < BENCH_SERVER_STARTUP_TIMEOUT_MSEC; waited += 50) {
+		tcp::socket socket(ioService);
+		boost::system::error_code ec;
+		socket.connect(endpoint, ec);
+		if (!ec)
+			return true;
+		Thread::Msleep(50);
+	}
+	return false;
+}
+
+// Bench scenario, runs the bots of one configuration against a fresh server.
+class BenchScenario
+{
+public:
+	BenchScenario(const string &name, ConfigFile &serverConfig, const BenchOptions &options)
+		: m_name(name), m_serverConfig(serverConfig), m_options(options), m_rttType(RTT_ACTION), m_clients(0), m_cpuUserStart(0), m_cpuSysStart(0), m_writesStart(0)
+	{
+		m_config.server = BENCH_SERVER_ADDRESS;
+		ostringstream port;
+		port << options.port;
+		m_config.port = port.str();
+		m_config.numGames = 0;
+		m_config.connectRate = 0;
+		m_config.numThreads = options.numThreads;
+		m_config.randomSeed = options.randomSeed;
+		m_config.actionTimeoutSec = 10;
+		m_config.delayBetweenHandsSec = 5;
+		m_config.endpoints.push_back(tcp::endpoint(boost::asio::ip::address::from_string(BENCH_SERVER_ADDRESS), options.port));
+	}
+
+	LoadConfig &GetConfig()
+	{
+		return m_config;
+	}
+
+	// RTT type which counts as operation of this scenario.
+	void SetMeasuredRtt(LoadRttType type)
+	{
+		m_rttType = type;
+	}
+
+	void SetReadyCondition(boost::function<bool (const LoadStatistics &)> condition)
+	{
+		m_readyCondition = condition;
+	}
+
+	void SetDoneCondition(boost::function<bool (const LoadStatistics &)> condition)
+	{
+		m_doneCondition = condition;
+	}
+
+	bool Run(ostream &out)
+	{
+		boost::shared_ptr<QtToolsInterface> myQtToolsInterface(CreateQtToolsWrapper());
+		boost::shared_ptr<GuiInterface> myServerGuiInterface(new ServerGuiWrapper(&m_serverConfig, NULL, NULL, NULL));
+		boost::shared_ptr<Session> session(new Session(myServerGuiInterface.get(), &m_serverConfig, NULL));
+		session->init();
+		myServerGuiInterface->setSession(session);
+		session->startNetworkServer(true);
+
+		bool serverUp = WaitForServer(m_options.port);
+		if (serverUp) {
+			LoadController controller(m_config, m_stats);
+			controller.SetQuiet(true);
+			controller.SetSetupTimeout(BENCH_SETUP_TIMEOUT_SEC);
+			controller.SetStopCallback(boost::bind(&BenchScenario::HandleStop, this, boost::ref(controller)));
+			if (m_readyCondition)
+				controller.SetReadyCondition(boost::bind(&BenchScenario::CheckReady, this));
+			else
+				m_stats.ResetSamples();
+			if (m_doneCondition)
+				controller.SetDoneCondition(boost::bind(m_doneCondition, boost::cref(m_stats)));
+			GetCpuTime(m_cpuUserStart, m_cpuSysStart);
+			m_writesStart = AsioSendBuffer::GetNumWrites();
+			m_clients = controller.GetNumBots();
+			controller.Run();
+		}
+		session->terminateNetworkServer();
+		session.reset();
+		myServerGuiInterface.reset();
+
+		Print(out, serverUp);
+		return serverUp && m_result.ready;
+	}
+
+protected:
+	bool CheckReady()
+	{
+		bool ready = m_readyCondition(m_stats);
+		if (ready) {
+			GetCpuTime(m_cpuUserStart, m_cpuSysStart);
+			m_writesStart = AsioSendBuffer::GetNumWrites();
+		}
+		return ready;
+	}
+
+	void HandleStop(LoadController &controller)
+	{
+		double cpuUser, cpuSys;
+		GetCpuTime(cpuUser, cpuSys);
+		m_result.ready = controller.WasReady();
+		m_result.measureSec = m_stats.GetElapsedSec();
+		m_result.ops = m_stats.GetRttCount(m_rttType);
+		m_result.rtt = m_stats.GetRttSummary(m_rttType);
+		m_result.messagesReceived = m_stats.GetMessagesReceived();
+		m_result.errors = m_stats.GetErrorCount();
+		m_result.rssKb = GetRssKb();
+		m_result.cpuUserSec = cpuUser - m_cpuUserStart;
+		m_result.cpuSysSec = cpuSys - m_cpuSysStart;
+		m_result.hands = m_stats.GetHands();
+		m_result.serverWrites = AsioSendBuffer::GetNumWrites() - m_writesStart;
+	}
+
+	void Print(ostream &out, bool serverUp)
+	{
+		double measureSec = m_result.measureSec > 0 ? m_result.measureSec : 1;
+		out << fixed << setprecision(3)
+			<< "{\"scenario\":\"" << m_name << "\""
+			<< ",\"clients\":" << m_clients
+			<< ",\"server_started\":" << (serverUp ? "true" : "false")
+			<< ",\"ready\":" << (m_result.ready ? "true" : "false")
+			<< ",\"measure_sec\":" << m_result.measureSec
+			<< ",\"op\":\"" << LoadStatistics::GetRttName(m_rttType) << "\""
+			<< ",\"ops\":" << m_result.ops
+			<< ",\"ops_per_sec\":" << m_result.ops / measureSec
+			<< ",\"p50_ms\":" << m_result.rtt.p50
+			<< ",\"p90_ms\":" << m_result.rtt.p90
+			<< ",\"p99_ms\":" << m_result.rtt.p99
+			<< ",\"max_ms\":" << m_result.rtt.max
+			<< ",\"recv_msg_per_sec\":" << m_result.messagesReceived / measureSec
+			<< ",\"errors\":" << m_result.errors
+			<< ",\"rss_kb\":" << m_result.rssKb
+			<< ",\"cpu_user_sec\":" << m_result.cpuUserSec
+			<< ",\"cpu_sys_sec\":" << m_result.cpuSysSec
+			<< ",\"hands\":" << m_result.hands
+			<< ",\"server_writes\":" << m_result.serverWrites
+			<< ",\"server_writes_per_hand\":" << (m_result.hands ? (double)m_result.serverWrites / m_result.hands : 0.0)
+			<< "}" << endl;
+	}
+
+private:
+	string m_name;
+	ConfigFile &m_serverConfig;
+	const BenchOptions &m_options;
+	LoadConfig m_config;
+	LoadStatistics m_stats;
+	LoadRttType m_rttType;
+	boost::function<bool (const LoadStatistics &)> m_readyCondition;
+	boost::function<bool (const LoadStatistics &)> m_doneCondition;
+	unsigned m_clients;
+	double m_cpuUserStart;
+	double m_cpuSysStart;
+	unsigned long m_writesStart;
+	BenchResult m_result;
+};
+
+static bool
+AllLoginsDone(const LoadStatistics &stats, unsigned numLogins)
+{
+	return stats.GetRttCount(RTT_LOGIN) + stats.GetConnectFailures() + stats.GetErrorCount() >= numLogins;
+}
+
+static bool
+AllSubscribed(const LoadStatistics &stats, unsigned numUsers)
+{
+	return stats.GetRttCount(RTT_SUBSCRIBE) >= numUsers;
+}
+
+static bool
+AllGamesStarted(const LoadStatistics &stats, unsigned numGames, size_t numJoins)
+{
+	return stats.GetGamesStarted() >= numGames && stats.GetRttCount(RTT_JOIN_GAME) >= numJoins;
+}
+
+// Many guests logging in at once, each disconnects after the login.
+static bool
+RunLoginStorm(ConfigFile &serverConfig, const BenchOptions &options, ostream &out)
+{
+	BenchScenario scenario("login_storm", serverConfig, options);
+	scenario.GetConfig().numLoginBots = options.numLogins;
+	scenario.SetMeasuredRtt(RTT_LOGIN);
+	scenario.SetDoneCondition(boost::bind(AllLoginsDone, _1, options.numLogins));
+	return scenario.Run(out);
+}
+
+// Idle lobby users receiving game list updates caused by a few users
+// which repeatedly create and leave games.
+static bool
+RunIdleLobby(ConfigFile &serverConfig, const BenchOptions &options, ostream &out)
+{
+	BenchScenario scenario("idle_lobby", serverConfig, options);
+	LoadConfig &config = scenario.GetConfig();
+	config.numLobbyBots = options.numLobbyUsers;
+	config.numChurnBots = options.numChurnUsers;
+	config.durationSec = options.durationSec;
+	scenario.SetMeasuredRtt(RTT_CREATE_GAME);
+	scenario.SetReadyCondition(boost::bind(AllSubscribed, _1, options.numLobbyUsers + options.numChurnUsers));
+	return scenario.Run(out);
+}
+
+// Many concurrent heads-up tables, every bot calls.
+static bool
+RunBotTables(ConfigFile &serverConfig, const BenchOptions &options, ostream &out)
+{
+	BenchScenario scenario("bot_tables", serverConfig, options);
+	LoadConfig &config = scenario.GetConfig();
+	config.numGames = options.numTables;
+	config.playersPerGame = 2;
+	config.durationSec = options.durationSec;
+	LoadConfig::ParseActionScript("call", config.actionScript);
+	scenario.SetMeasuredRtt(RTT_ACTION);
+	scenario.SetReadyCondition(boost::bind(AllGamesStarted, _1, options.numTables, options.numTables));
+	return scenario.Run(out);
+}
+
+// A single table with the maximum number of spectators. The latency is
+// measured from a player action until it is received by a spectator.
+static bool
+RunSpectatorTable(ConfigFile &serverConfig, const BenchOptions &options, ostream &out)
+{
+	BenchScenario scenario("spectator_table", serverConfig, options);
+	LoadConfig &config = scenario.GetConfig();
+	config.numGames = 1;
+	config.playersPerGame = 2;
+	config.spectatorsPerGame = options.numSpectators;
+	config.durationSec = options.durationSec;
+	LoadConfig::ParseActionScript("call", config.actionScript);
+	scenario.SetMeasuredRtt(RTT_SPECTATOR);
+	scenario.SetReadyCondition(boost::bind(AllGamesStarted, _1, 1, 1 + options.numSpectators));
+	return scenario.Run(out);
+}
+
+int
+main(int argc, char *argv[])
+{
+	typedef bool (*ScenarioFunc)(ConfigFile &, const BenchOptions &, ostream &);
+	static const pair<const char *, ScenarioFunc> allScenarios[] = {
+		make_pair("login_storm", &RunLoginStorm),
+		make_pair("idle_lobby", &RunIdleLobby),
+		make_pair("bot_tables", &RunBotTables),
+		make_pair("spectator_table", &RunSpectatorTable)
+	};
+	const size_t numScenarios = sizeof(allScenarios) / sizeof(allScenarios[0]);
+
+	BenchOptions options;
+	vector<string> scenarios;
+	{
+		// Check command line options.
+		po::options_description desc("Allowed options");
+		desc.add_options()
+		("help,h", "produce help message")
+		("scenario,s", po::value<vector<string> >(), "run only this scenario (login_storm, idle_lobby, bot_tables, spectator_table)")
+		("port,P", po::value<unsigned>(&options.port)->default_value(17234), "loopback port of the benchmark server")
+		("threads,t", po::value<unsigned>(&options.numThreads)->default_value(2), "number of client worker threads")
+		("seed", po::value<unsigned>(&options.randomSeed)->default_value(4711), "random seed of the bots")
+		("duration,d", po::value<unsigned>(&options.durationSec)->default_value(30), "measurement time of the timed scenarios in seconds")
+		("logins", po::value<unsigned>(&options.numLogins)->default_value(1000), "number of guests in login_storm")
+		("lobbyUsers", po::value<unsigned>(&options.numLobbyUsers)->default_value(1000), "number of idle users in idle_lobby")
+		("churnUsers", po::value<unsigned>(&options.numChurnUsers)->default_value(10), "number of users creating games in idle_lobby")
+		("tables", po::value<unsigned>(&options.numTables)->default_value(500), "number of tables in bot_tables")
+		("spectators", po::value<unsigned>(&options.numSpectators)->default_value(100), "number of spectators in spectator_table")
+		;
+
+		po::variables_map vm;
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 1;
+		}
+		if (vm.count("scenario"))
+			scenarios = vm["scenario"].as<vector<string> >();
+		for (size_t i = 0; i < scenarios.size(); i++) {
+			size_t j = 0;
+			while (j < numScenarios && scenarios[i] != allScenarios[j].first)
+				j++;
+			if (j == numScenarios) {
+				cerr << "Unknown scenario \"" << scenarios[i] << "\", valid scenarios are:";
+				for (j = 0; j < numScenarios; j++)
+					cerr << " " << allScenarios[j].first;
+				cerr << endl;
+				return 1;
+			}
+		}
+		if (!options.numThreads)
+			options.numThreads = 1;
+	}
+
+	RaiseFileLimit();
+	socket_startup();
+
+	boost::shared_ptr<ConfigFile> myConfig(new ConfigFile(argv[0], true));
+	// Loopback server without logging, limits raised for the bots.
+	myConfig->writeConfigInt("ServerPort", options.port);
+	myConfig->writeConfigInt("ServerUseIpv6", 0);
+	myConfig->writeConfigInt("ServerUseSctp", 0);
+	myConfig->writeConfigInt("ServerUseWebSocket", 0);
+	myConfig->writeConfigInt("ServerBruteForceProtection", 0);
+	myConfig->writeConfigInt("ServerMaxLobbySessions", BENCH_MAX_SESSIONS);
+	myConfig->writeConfigInt("ServerMaxSessions", BENCH_MAX_SESSIONS);
+	myConfig->writeConfigInt("UseChatCleaner", 0);
+	myConfig->writeConfigInt("UseAdminIRC", 0);
+	myConfig->writeConfigInt("UseLobbyIRC", 0);
+	myConfig->writeConfigString("LogDir", "");
+
+	cout << "{\"benchmark\":\"pokerth_server\",\"version\":\"" << POKERTH_BETA_RELEASE_STRING << "\""
+		 << ",\"protocol\":\"" << NET_VERSION_MAJOR << "." << NET_VERSION_MINOR << "\""
+		 << ",\"threads\":" << options.numThreads << ",\"seed\":" << options.randomSeed
+		 << ",\"duration_sec\":" << options.durationSec << "}" << endl;
+
+	bool success = true;
+	for (size_t i = 0; i < numScenarios; i++) {
+		if (scenarios.empty() || find(scenarios.begin(), scenarios.end(), allScenarios[i].first) != scenarios.end()) {
+			if (!allScenarios[i].second(*myConfig, options, cout))
+				success = false;
+		}
+	}
+
+	myConfig.reset();
+	socket_cleanup();
+	return success ? 0 : 1;
+}
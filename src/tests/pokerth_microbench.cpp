@@ -0,0 +1,876 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+// Microbenchmarks for PokerTH
+//
+// Measures hot paths of the engine and the network protocol in isolation:
+// hand evaluation, computer player odds, pot distribution, shuffling,
+// packet parsing, packet encoding, message validation, server ban
+// lookups and chat filtering. Every benchmark
+// is run with an increasing number of iterations until it takes at least
+// the minimum time, the time per iteration of the best repetition is
+// reported. Setup code before the first call to KeepRunning() is not
+// measured. Inputs are generated with a fixed seed, so that the numbers
+// are comparable across commits.
+
+#include <net/netpacket.h>
+#include <net/asiosendbuffer.h>
+#include <net/validation/pokerthmessagevalidator.h>
+#include <net/serverbanmanager.h>
+#include <chatcleaner/badwordcheck.h>
+#include <chatcleaner/urlcheck.h>
+#include <chatcleaner/capsfloodcheck.h>
+#include <chatcleaner/letterrepeatingcheck.h>
+#include <chatcleaner/messagefilter.h>
+#include <tests/microbenchchatfilter.h>
+#include <engine/local_engine/cardsvalue.h>
+#include <engine/local_engine/localenginefactory.h>
+#include <engine/local_engine/localplayer.h>
+#include <engine/local_engine/tools.h>
+#include <engine/handinterface.h>
+#include <boost/program_options.hpp>
+#include <boost/chrono.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+namespace po = boost::program_options;
+
+#define MICROBENCH_SEED				4711
+#define MICROBENCH_NUM_INPUTS		4096	// Power of two.
+#define MICROBENCH_MAX_ITERATIONS	1000000000ULL
+#define MICROBENCH_NUM_BANS			10000
+#define MICROBENCH_NUM_BAD_WORDS	5000
+#define MICROBENCH_NUM_CHAT_PLAYERS	50000
+
+typedef boost::chrono::high_resolution_clock MicroBenchClock;
+
+// Keeps the compiler from optimizing away results.
+static volatile int g_sink;
+
+class MicroBenchState
+{
+public:
+	MicroBenchState(unsigned long long iterations)
+		: m_iterations(iterations), m_remaining(iterations), m_started(false), m_elapsedNsec(0) {}
+
+	// Timing starts with the first call.
+	bool KeepRunning()
+	{
+		if (!m_started) {
+			m_started = true;
+			m_start = MicroBenchClock::now();
+		}
+		if (m_remaining == 0) {
+			m_elapsedNsec = boost::chrono::duration_cast<boost::chrono::nanoseconds>(MicroBenchClock::now() - m_start).count();
+			return false;
+		}
+		m_remaining--;
+		return true;
+	}
+
+	unsigned long long GetIteration() const
+	{
+		return m_iterations - m_remaining - 1;
+	}
+
+	unsigned long long GetIterations() const
+	{
+		return m_iterations;
+	}
+
+	double GetElapsedNsec() const
+	{
+		return static_cast<double>(m_elapsedNsec);
+	}
+
+private:
+	unsigned long long m_iterations;
+	unsigned long long m_remaining;
+	bool m_started;
+	MicroBenchClock::time_point m_start;
+	long long m_elapsedNsec;
+};
+
+typedef void (*MicroBenchFunc)(MicroBenchState &);
+
+// Engine fixture: a hand with six players, like LocalHand is created by Game.
+class EngineFixture
+{
+public:
+	EngineFixture(unsigned numPlayers)
+		: m_factory(new LocalEngineFactory(NULL)), m_board(m_factory->createBoard()),
+		  m_seatsList(new std::list<boost::shared_ptr<PlayerInterface> >),
+		  m_activePlayerList(new std::list<boost::shared_ptr<PlayerInterface> >),
+		  m_runningPlayerList(new std::list<boost::shared_ptr<PlayerInterface> >)
+	{
+		for (unsigned i = 0; i < numPlayers; i++) {
+			ostringstream name;
+			name << "Player " << (i + 1);
+			boost::shared_ptr<PlayerInterface> tmpPlayer(
+				m_factory->createPlayer(i, i + 1, i ? PLAYER_TYPE_COMPUTER : PLAYER_TYPE_HUMAN, name.str(), "", 5000, true, false, 0));
+			m_seatsList->push_back(tmpPlayer);
+			m_activePlayerList->push_back(tmpPlayer);
+		}
+		(*m_runningPlayerList) = (*m_activePlayerList);
+		m_board->setPlayerLists(m_seatsList, m_activePlayerList, m_runningPlayerList);
+		m_hand = m_factory->createHand(m_factory, NULL, m_board, NULL, m_seatsList, m_activePlayerList, m_runningPlayerList,
+									   1, numPlayers, 1, 10, 5000);
+	}
+
+	boost::shared_ptr<BoardInterface> GetBoard()
+	{
+		return m_board;
+	}
+
+	boost::shared_ptr<HandInterface> GetHand()
+	{
+		return m_hand;
+	}
+
+	PlayerList GetSeatsList()
+	{
+		return m_seatsList;
+	}
+
+private:
+	boost::shared_ptr<EngineFactory> m_factory;
+	boost::shared_ptr<BoardInterface> m_board;
+	PlayerList m_seatsList;
+	PlayerList m_activePlayerList;
+	PlayerList m_runningPlayerList;
+	boost::shared_ptr<HandInterface> m_hand;
+};
+
+static void
+CreateRandomHands(vector<vector<int> > &hands)
+{
+	boost::random::mt19937 rng(MICROBENCH_SEED);
+	int cards[52];
+	hands.resize(MICROBENCH_NUM_INPUTS);
+	for (unsigned i = 0; i < MICROBENCH_NUM_INPUTS; i++) {
+		for (int c = 0; c < 52; c++) {
+			cards[c] = c;
+		}
+		// Partial Fisher-Yates, the first 7 cards are used.
+		for (int c = 0; c < 7; c++) {
+			boost::random::uniform_int_distribution<> dist(c, 51);
+			swap(cards[c], cards[dist(rng)]);
+		}
+		hands[i].assign(4, 0);
+		for (int c = 0; c < 7; c++) {
+			hands[i][cards[c] / 13] |= (1 << (cards[c] % 13));
+		}
+	}
+}
+
+static void
+BM_CardsValue(MicroBenchState &state)
+{
+	vector<vector<int> > hands;
+	CreateRandomHands(hands);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += CardsValue::cardsValue(&hands[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)][0]);
+	}
+	g_sink = sum;
+}
+
+static void
+BM_CardsValueBestHand(MicroBenchState &state)
+{
+	vector<vector<int> > hands;
+	CreateRandomHands(hands);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		int bestHand[4] = { 0, 0, 0, 0 };
+		sum += CardsValue::cardsValue(&hands[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)][0], bestHand);
+	}
+	g_sink = sum;
+}
+
+static void
+RunCalcMyOdds(MicroBenchState &state, GameState round)
+{
+	EngineFixture fixture(6);
+	// Fixed cards: pocket pair with a straight draw on a mixed board.
+	int boardCards[5] = { 8, 22, 36, 50, 1 };
+	int holeCards[2] = { 9, 23 };
+	fixture.GetBoard()->setMyCards(boardCards);
+	boost::shared_ptr<LocalPlayer> player(boost::static_pointer_cast<LocalPlayer>(fixture.GetSeatsList()->front()));
+	player->setMyHoleCards(holeCards);
+	fixture.GetHand()->setCurrentRound(round);
+	while (state.KeepRunning()) {
+		player->calcMyOdds();
+	}
+}
+
+static void
+BM_CalcMyOddsPreflop(MicroBenchState &state)
+{
+	RunCalcMyOdds(state, GAME_STATE_PREFLOP);
+}
+
+static void
+BM_CalcMyOddsFlop(MicroBenchState &state)
+{
+	RunCalcMyOdds(state, GAME_STATE_FLOP);
+}
+
+static void
+BM_CalcMyOddsTurn(MicroBenchState &state)
+{
+	RunCalcMyOdds(state, GAME_STATE_TURN);
+}
+
+static void
+BM_CalcMyOddsRiver(MicroBenchState &state)
+{
+	RunCalcMyOdds(state, GAME_STATE_RIVER);
+}
+
+static void
+BM_DistributePotSidePots(MicroBenchState &state)
+{
+	EngineFixture fixture(6);
+	// Two short stacks all in, a split pot on the second level, one player
+	// folded after betting and two players in the highest level.
+	static const int roundStartCash[6] = { 200, 800, 800, 5000, 3500, 6000 };
+	static const int bet[6] = { 200, 800, 800, 2000, 3500, 3500 };
+	static const int cardsValue[6] = { 9000, 7000, 7000, 8000, 5000, 4000 };
+	PlayerList seats(fixture.GetSeatsList());
+	int pot = 0;
+	unsigned i = 0;
+	for (PlayerListIterator it = seats->begin(); it != seats->end(); ++it, i++) {
+		(*it)->setMyCardsValueInt(cardsValue[i]);
+		(*it)->setMyAction(i == 3 ? PLAYER_ACTION_FOLD : PLAYER_ACTION_ALLIN);
+		pot += bet[i];
+	}
+	int sum = 0;
+	while (state.KeepRunning()) {
+		i = 0;
+		for (PlayerListIterator it = seats->begin(); it != seats->end(); ++it, i++) {
+			(*it)->setMyRoundStartCash(roundStartCash[i]);
+			(*it)->setMyCash(roundStartCash[i] - bet[i]);
+		}
+		fixture.GetBoard()->setPot(pot);
+		fixture.GetBoard()->distributePot(1);
+		sum += seats->front()->getMyCash();
+	}
+	g_sink = sum;
+}
+
+static void
+BM_ShuffleArrayNonDeterministic(MicroBenchState &state)
+{
+	int cards[52];
+	for (int i = 0; i < 52; i++) {
+		cards[i] = i;
+	}
+	while (state.KeepRunning()) {
+		Tools::ShuffleArrayNonDeterministic(cards, 52);
+	}
+	g_sink = cards[0];
+}
+
+static void
+InitGameInfo(NetGameInfo &gameInfo)
+{
+	gameInfo.set_gamename("Some typical game name");
+	gameInfo.set_netgametype(NetGameInfo::normalGame);
+	gameInfo.set_maxnumplayers(10);
+	gameInfo.set_raiseintervalmode(NetGameInfo::raiseOnHandNum);
+	gameInfo.set_raiseeveryhands(8);
+	gameInfo.set_endraisemode(NetGameInfo::doubleBlinds);
+	gameInfo.set_proposedguispeed(4);
+	gameInfo.set_delaybetweenhands(7);
+	gameInfo.set_playeractiontimeout(20);
+	gameInfo.set_firstsmallblind(10);
+	gameInfo.set_startmoney(5000);
+}
+
+// Typical messages sent by clients.
+static void
+CreateClientMessages(vector<boost::shared_ptr<NetPacket> > &packets)
+{
+	boost::shared_ptr<NetPacket> packet(new NetPacket);
+	PokerTHMessage *msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_AuthMessage);
+	msg->mutable_authmessage()->set_messagetype(AuthMessage::Type_AuthClientRequestMessage);
+	AuthClientRequestMessage *authRequest = msg->mutable_authmessage()->mutable_authclientrequestmessage();
+	authRequest->mutable_requestedversion()->set_majorversion(NET_VERSION_MAJOR);
+	authRequest->mutable_requestedversion()->set_minorversion(NET_VERSION_MINOR);
+	authRequest->set_buildid(0);
+	authRequest->set_login(AuthClientRequestMessage::guestLogin);
+	authRequest->set_nickname("Guest12345");
+	packets.push_back(packet);
+
+	packet.reset(new NetPacket);
+	msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(LobbyMessage::Type_CreateGameMessage);
+	CreateGameMessage *netCreate = msg->mutable_lobbymessage()->mutable_creategamemessage();
+	netCreate->set_requestid(1);
+	InitGameInfo(*netCreate->mutable_gameinfo());
+	packets.push_back(packet);
+
+	packet.reset(new NetPacket);
+	msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(LobbyMessage::Type_JoinGameMessage);
+	msg->mutable_lobbymessage()->mutable_joingamemessage()->set_gameid(17);
+	packets.push_back(packet);
+
+	packet.reset(new NetPacket);
+	msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(LobbyMessage::Type_ChatRequestMessage);
+	msg->mutable_lobbymessage()->mutable_chatrequestmessage()->set_chattext("good luck everyone, have fun at the tables");
+	packets.push_back(packet);
+
+	// Game actions are most frequent.
+	for (int i = 0; i < 4; i++) {
+		packet.reset(new NetPacket);
+		msg = packet->GetMsg();
+		msg->set_messagetype(PokerTHMessage::Type_GameMessage);
+		GameMessage *netGame = msg->mutable_gamemessage();
+		netGame->set_messagetype(GameMessage::Type_GameEngineMessage);
+		netGame->set_gameid(17);
+		GameEngineMessage *netEngine = netGame->mutable_gameenginemessage();
+		netEngine->set_messagetype(GameEngineMessage::Type_MyActionRequestMessage);
+		MyActionRequestMessage *netAction = netEngine->mutable_myactionrequestmessage();
+		netAction->set_handnum(12);
+		netAction->set_gamestate(static_cast<NetGameState>(netStatePreflop + i));
+		netAction->set_myaction(i == 3 ? netActionRaise : netActionCall);
+		netAction->set_myrelativebet(i == 3 ? 400 : 0);
+		packets.push_back(packet);
+	}
+}
+
+// Typical messages sent by the server.
+static void
+CreateServerMessages(vector<boost::shared_ptr<NetPacket> > &packets)
+{
+	boost::shared_ptr<NetPacket> packet(new NetPacket);
+	PokerTHMessage *msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(LobbyMessage::Type_GameListNewMessage);
+	GameListNewMessage *netListNew = msg->mutable_lobbymessage()->mutable_gamelistnewmessage();
+	netListNew->set_gameid(17);
+	netListNew->set_gamemode(netGameStarted);
+	netListNew->set_isprivate(false);
+	for (unsigned i = 0; i < 7; i++) {
+		netListNew->add_playerids(1000 + i);
+	}
+	netListNew->set_adminplayerid(1000);
+	InitGameInfo(*netListNew->mutable_gameinfo());
+	packets.push_back(packet);
+
+	packet.reset(new NetPacket);
+	msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_LobbyMessage);
+	msg->mutable_lobbymessage()->set_messagetype(LobbyMessage::Type_PlayerListMessage);
+	msg->mutable_lobbymessage()->mutable_playerlistmessage()->set_playerid(1234);
+	msg->mutable_lobbymessage()->mutable_playerlistmessage()->set_playerlistnotification(PlayerListMessage::playerListNew);
+	packets.push_back(packet);
+
+	packet.reset(new NetPacket);
+	msg = packet->GetMsg();
+	msg->set_messagetype(PokerTHMessage::Type_GameMessage);
+	msg->mutable_gamemessage()->set_messagetype(GameMessage::Type_GameEngineMessage);
+	msg->mutable_gamemessage()->set_gameid(17);
+	msg->mutable_gamemessage()->mutable_gameenginemessage()->set_messagetype(GameEngineMessage::Type_HandStartMessage);
+	HandStartMessage *netHandStart = msg->mutable_gamemessage()->mutable_gameenginemessage()->mutable_handstartmessage();
+	netHandStart->mutable_plaincards()->set_plaincard1(12);
+	netHandStart->mutable_plaincards()->set_plaincard2(25);
+	netHandStart->set_smallblind(20);
+	for (unsigned i = 0; i < 7; i++) {
+		netHandStart->add_seatstates(netPlayerStateNormal);
+	}
+	netHandStart->set_dealerplayerid(1003);
+	packets.push_back(packet);
+
+	for (int i = 0; i < 4; i++) {
+		packet.reset(new NetPacket);
+		msg = packet->GetMsg();
+		msg->set_messagetype(PokerTHMessage::Type_GameMessage);
+		msg->mutable_gamemessage()->set_messagetype(GameMessage::Type_GameEngineMessage);
+		msg->mutable_gamemessage()->set_gameid(17);
+		GameEngineMessage *netEngine = msg->mutable_gamemessage()->mutable_gameenginemessage();
+		netEngine->set_messagetype(GameEngineMessage::Type_PlayersActionDoneMessage);
+		PlayersActionDoneMessage *netDone = netEngine->mutable_playersactiondonemessage();
+		netDone->set_playerid(1000 + i);
+		netDone->set_gamestate(netStateFlop);
+		netDone->set_playeraction(netActionCall);
+		netDone->set_totalplayerbet(400);
+		netDone->set_playermoney(4600 - i * 100);
+		netDone->set_highestset(400);
+		netDone->set_minimumraise(200);
+		packets.push_back(packet);
+
+		packet.reset(new NetPacket);
+		msg = packet->GetMsg();
+		msg->set_messagetype(PokerTHMessage::Type_GameMessage);
+		msg->mutable_gamemessage()->set_messagetype(GameMessage::Type_GameEngineMessage);
+		msg->mutable_gamemessage()->set_gameid(17);
+		netEngine = msg->mutable_gamemessage()->mutable_gameenginemessage();
+		netEngine->set_messagetype(GameEngineMessage::Type_PlayersTurnMessage);
+		netEngine->mutable_playersturnmessage()->set_playerid(1001 + i);
+		netEngine->mutable_playersturnmessage()->set_gamestate(netStateFlop);
+		packets.push_back(packet);
+	}
+}
+
+static void
+SerializePackets(const vector<boost::shared_ptr<NetPacket> > &packets, vector<string> &data)
+{
+	for (size_t i = 0; i < packets.size(); i++) {
+		string buf;
+		packets[i]->GetMsg()->SerializeToString(&buf);
+		data.push_back(buf);
+	}
+}
+
+static void
+BM_NetPacketCreate(MicroBenchState &state)
+{
+	vector<boost::shared_ptr<NetPacket> > packets;
+	CreateClientMessages(packets);
+	vector<string> data;
+	SerializePackets(packets, data);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		const string &buf = data[state.GetIteration() % data.size()];
+		boost::shared_ptr<NetPacket> tmpPacket(NetPacket::Create(buf.data(), buf.size()));
+		sum += tmpPacket->GetMsg()->messagetype();
+	}
+	g_sink = sum;
+}
+
+static void
+BM_AsioSendBufferStorePacket(MicroBenchState &state)
+{
+	vector<boost::shared_ptr<NetPacket> > packets;
+	CreateServerMessages(packets);
+	boost::shared_ptr<SessionData> noSession;
+	boost::shared_ptr<AsioSendBuffer> sendBuffer;
+	while (state.KeepRunning()) {
+		// The buffer is never sent here, start over like a new session
+		// before reaching the size limit.
+		if ((state.GetIteration() & 255) == 0)
+			sendBuffer.reset(new AsioSendBuffer);
+		sendBuffer->InternalStorePacket(noSession, packets[state.GetIteration() % packets.size()]);
+	}
+}
+
+static void
+BM_PokerTHMessageValidator(MicroBenchState &state)
+{
+	vector<boost::shared_ptr<NetPacket> > packets;
+	CreateClientMessages(packets);
+	PokerTHMessageValidator validator;
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += validator.IsValidMessage(*packets[state.GetIteration() % packets.size()]->GetMsg()) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+// Ban list of a busy server: name, regex and IP address bans.
+static boost::shared_ptr<ServerBanManager>
+CreateBanManager()
+{
+	boost::shared_ptr<boost::asio::io_service> ioService(new boost::asio::io_service);
+	boost::shared_ptr<ServerBanManager> banManager(new ServerBanManager(ioService));
+	for (unsigned i = 0; i < MICROBENCH_NUM_BANS; i++) {
+		ostringstream name;
+		name << "BannedPlayer" << i;
+		banManager->BanPlayerName(name.str());
+
+		ostringstream ipAddress;
+		ipAddress << "10." << (i >> 8) << "." << (i & 255) << ".1";
+		banManager->BanIPAddress(ipAddress.str(), 0);
+
+		if (i % 10 == 0) {
+			ostringstream regex;
+			regex << "spam(mer|bot)?" << i << "[0-9]*";
+			banManager->BanPlayerRegex(regex.str());
+		}
+	}
+	list<string> badWords;
+	for (unsigned i = 0; i < MICROBENCH_NUM_BANS / 10; i++) {
+		ostringstream badWord;
+		badWord << ".*badword" << i << ".*";
+		badWords.push_back(badWord.str());
+	}
+	banManager->InitGameNameBadWordList(badWords);
+	return banManager;
+}
+
+// Mostly names which are not banned, like most logins.
+static void
+CreateBanLookups(vector<string> &names, vector<string> &ipAddresses)
+{
+	boost::random::mt19937 rng(MICROBENCH_SEED);
+	boost::random::uniform_int_distribution<> dist(0, MICROBENCH_NUM_BANS * 2 - 1);
+	for (unsigned i = 0; i < MICROBENCH_NUM_INPUTS; i++) {
+		int n = dist(rng);
+		ostringstream name;
+		if (i % 16 == 0)
+			name << "BannedPlayer" << n;
+		else if (i % 16 == 1)
+			name << "spambot" << n;
+		else
+			name << "Player" << n;
+		names.push_back(name.str());
+
+		ostringstream ipAddress;
+		ipAddress << (i % 4 ? "192.168." : "10.") << (n >> 8) << "." << (n & 255) << (i % 4 ? "" : ".1");
+		ipAddresses.push_back(ipAddress.str());
+	}
+}
+
+static void
+BM_ServerBanManagerIsPlayerBanned(MicroBenchState &state)
+{
+	boost::shared_ptr<ServerBanManager> banManager(CreateBanManager());
+	vector<string> names, ipAddresses;
+	CreateBanLookups(names, ipAddresses);
+	// The combined patterns are compiled with the first lookup.
+	banManager->IsPlayerBanned(string());
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += banManager->IsPlayerBanned(names[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static void
+BM_ServerBanManagerIsIPAddressBanned(MicroBenchState &state)
+{
+	boost::shared_ptr<ServerBanManager> banManager(CreateBanManager());
+	vector<string> names, ipAddresses;
+	CreateBanLookups(names, ipAddresses);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += banManager->IsIPAddressBanned(ipAddresses[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static void
+BM_ServerBanManagerIsBadGameName(MicroBenchState &state)
+{
+	boost::shared_ptr<ServerBanManager> banManager(CreateBanManager());
+	vector<string> names, ipAddresses;
+	CreateBanLookups(names, ipAddresses);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += banManager->IsBadGameName(names[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static string
+CreateRandomWord(boost::random::mt19937 &rng, int minLength, int maxLength)
+{
+	boost::random::uniform_int_distribution<> lengthDist(minLength, maxLength);
+	boost::random::uniform_int_distribution<> letterDist('a', 'z');
+	string word(lengthDist(rng), ' ');
+	for (size_t i = 0; i < word.size(); i++) {
+		word[i] = static_cast<char>(letterDist(rng));
+	}
+	return word;
+}
+
+// Chat lines of about 80 characters, some with bad words, urls, caps or
+// repeated letters.
+static void
+CreateChatLines(const vector<string> &badWords, vector<string> &lines)
+{
+	boost::random::mt19937 rng(MICROBENCH_SEED);
+	boost::random::uniform_int_distribution<> badWordDist(0, static_cast<int>(badWords.size()) - 1);
+	for (unsigned i = 0; i < MICROBENCH_NUM_INPUTS; i++) {
+		string line;
+		while (line.size() < 80) {
+			if (!line.empty())
+				line += ' ';
+			line += CreateRandomWord(rng, 2, 8);
+		}
+		switch (i % 16) {
+		case 0:
+			line += " " + badWords[badWordDist(rng)];
+			break;
+		case 1:
+			line += " see http://www.example.com";
+			break;
+		case 2:
+			line += " PLEASE STOP THAT NOW";
+			break;
+		case 3:
+			line += " nooooooooooooo";
+			break;
+		case 4:
+			line += " \xc3\x84rger \xc3\x9c" "bel";
+			break;
+		default:
+			break;
+		}
+		lines.push_back(line);
+	}
+}
+
+static void
+CreateBadWords(vector<string> &badWords, list<string> &exceptions)
+{
+	boost::random::mt19937 rng(MICROBENCH_SEED + 1);
+	for (unsigned i = 0; i < MICROBENCH_NUM_BAD_WORDS; i++) {
+		badWords.push_back(CreateRandomWord(rng, 4, 9));
+		if (i % 10 == 0)
+			exceptions.push_back("all-in " + badWords.back());
+	}
+}
+
+static void
+BM_BadWordCheck(MicroBenchState &state)
+{
+	vector<string> badWords;
+	list<string> exceptions;
+	CreateBadWords(badWords, exceptions);
+	vector<string> lines;
+	CreateChatLines(badWords, lines);
+	BadWordCheck check;
+	check.setBadWords(list<string>(badWords.begin(), badWords.end()), exceptions);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += check.run(lines[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static void
+BM_UrlCheck(MicroBenchState &state)
+{
+	vector<string> badWords;
+	list<string> exceptions;
+	CreateBadWords(badWords, exceptions);
+	vector<string> lines;
+	CreateChatLines(badWords, lines);
+	list<string> urlStrings, urlExceptions;
+	urlStrings.push_back("http://");
+	urlStrings.push_back(".com");
+	urlStrings.push_back(".net");
+	urlStrings.push_back(".org");
+	urlStrings.push_back(".de");
+	urlExceptions.push_back("http://www.pokerth.net");
+	urlExceptions.push_back("pokerth.net");
+	UrlCheck check;
+	check.setUrlStrings(urlStrings, urlExceptions);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += check.run(lines[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static void
+BM_CapsFloodCheck(MicroBenchState &state)
+{
+	vector<string> badWords;
+	list<string> exceptions;
+	CreateBadWords(badWords, exceptions);
+	vector<string> lines;
+	CreateChatLines(badWords, lines);
+	CapsFloodCheck check;
+	check.setCapsNumberToTrigger(10);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += check.run(lines[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+static void
+BM_LetterRepeatingCheck(MicroBenchState &state)
+{
+	vector<string> badWords;
+	list<string> exceptions;
+	CreateBadWords(badWords, exceptions);
+	vector<string> lines;
+	CreateChatLines(badWords, lines);
+	LetterRepeatingCheck check;
+	check.setLetterNumberToTrigger(10);
+	int sum = 0;
+	while (state.KeepRunning()) {
+		sum += check.run(lines[state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1)]) ? 1 : 0;
+	}
+	g_sink = sum;
+}
+
+// All checks and the per player state, messages of many players in the
+// lobby, including the warn and kick paths.
+static void
+BM_MessageFilterCheck(MicroBenchState &state)
+{
+	vector<string> badWords;
+	list<string> exceptions;
+	CreateBadWords(badWords, exceptions);
+	vector<string> lines;
+	CreateChatLines(badWords, lines);
+	MicroBenchChatFilter chatFilter(list<string>(badWords.begin(), badWords.end()), exceptions);
+	MessageFilter &filter = chatFilter.GetFilter();
+
+	boost::random::mt19937 rng(MICROBENCH_SEED);
+	boost::random::uniform_int_distribution<> playerDist(1, MICROBENCH_NUM_CHAT_PLAYERS);
+	vector<unsigned> playerIds(MICROBENCH_NUM_INPUTS);
+	vector<string> nicks(MICROBENCH_NUM_INPUTS);
+	for (unsigned i = 0; i < MICROBENCH_NUM_INPUTS; i++) {
+		playerIds[i] = playerDist(rng);
+		ostringstream nick;
+		nick << "Player" << playerIds[i];
+		nicks[i] = nick.str();
+	}
+	string returnMessage;
+	int sum = 0;
+	while (state.KeepRunning()) {
+		unsigned index = static_cast<unsigned>(state.GetIteration() & (MICROBENCH_NUM_INPUTS - 1));
+		sum += filter.check(0, playerIds[index], nicks[index], lines[index], returnMessage);
+	}
+	g_sink = sum;
+}
+
+struct MicroBench {
+	const char *name;
+	MicroBenchFunc func;
+};
+
+static const MicroBench AllBenchmarks[] = {
+	{ "CardsValue/cardsValue", &BM_CardsValue },
+	{ "CardsValue/cardsValue_bestHand", &BM_CardsValueBestHand },
+	{ "LocalPlayer/calcMyOdds/preflop", &BM_CalcMyOddsPreflop },
+	{ "LocalPlayer/calcMyOdds/flop", &BM_CalcMyOddsFlop },
+	{ "LocalPlayer/calcMyOdds/turn", &BM_CalcMyOddsTurn },
+	{ "LocalPlayer/calcMyOdds/river", &BM_CalcMyOddsRiver },
+	{ "LocalBoard/distributePot/sidePots", &BM_DistributePotSidePots },
+	{ "Tools/ShuffleArrayNonDeterministic", &BM_ShuffleArrayNonDeterministic },
+	{ "NetPacket/Create", &BM_NetPacketCreate },
+	{ "AsioSendBuffer/InternalStorePacket", &BM_AsioSendBufferStorePacket },
+	{ "PokerTHMessageValidator/IsValidMessage", &BM_PokerTHMessageValidator },
+	{ "ServerBanManager/IsPlayerBanned/10k", &BM_ServerBanManagerIsPlayerBanned },
+	{ "ServerBanManager/IsIPAddressBanned/10k", &BM_ServerBanManagerIsIPAddressBanned },
+	{ "ServerBanManager/IsBadGameName/1k", &BM_ServerBanManagerIsBadGameName },
+	{ "ChatCleaner/BadWordCheck/5k", &BM_BadWordCheck },
+	{ "ChatCleaner/UrlCheck", &BM_UrlCheck },
+	{ "ChatCleaner/CapsFloodCheck", &BM_CapsFloodCheck },
+	{ "ChatCleaner/LetterRepeatingCheck", &BM_LetterRepeatingCheck },
+	{ "ChatCleaner/MessageFilter/50kPlayers", &BM_MessageFilterCheck }
+};
+
+// Returns the time per iteration in nanoseconds.
+static double
+RunBenchmark(const MicroBench &bench, double minTimeSec, unsigned long long &iterations)
+{
+	iterations = 1;
+	for (;;) {
+		MicroBenchState state(iterations);
+		bench.func(state);
+		double elapsedNsec = state.GetElapsedNsec();
+		if (elapsedNsec >= minTimeSec * 1e9 || iterations >= MICROBENCH_MAX_ITERATIONS)
+			return elapsedNsec / iterations;
+		// Estimate the number of iterations needed, grow at most 10x per step.
+		double factor = elapsedNsec > 0 ? (minTimeSec * 1e9 * 1.4) / elapsedNsec : 10;
+		factor = max(2.0, min(10.0, factor));
+		iterations = static_cast<unsigned long long>(iterations * factor);
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	string filter;
+	double minTimeSec;
+	unsigned repetitions;
+	bool json;
+	{
+		// Check command line options.
+		po::options_description desc("Allowed options");
+		desc.add_options()
+		("help,h", "produce help message")
+		("filter,f", po::value<string>(&filter), "run only benchmarks containing this string")
+		("min-time,m", po::value<double>(&minTimeSec)->default_value(0.5), "minimum run time of each benchmark in seconds")
+		("repetitions,r", po::value<unsigned>(&repetitions)->default_value(3), "number of repetitions, the best one is reported")
+		("json,j", "print one JSON object per benchmark")
+		;
+
+		po::variables_map vm;
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 1;
+		}
+		json = vm.count("json") > 0;
+		if (!repetitions)
+			repetitions = 1;
+	}
+
+	if (!json)
+		cout << setw(45) << left << "Benchmark" << right << setw(15) << "Time" << setw(15) << "Iterations" << endl;
+	for (size_t i = 0; i < sizeof(AllBenchmarks) / sizeof(AllBenchmarks[0]); i++) {
+		const MicroBench &bench = AllBenchmarks[i];
+		if (!filter.empty() && string(bench.name).find(filter) == string::npos)
+			continue;
+		double bestNsec = 0;
+		unsigned long long bestIterations = 0;
+		for (unsigned r = 0; r < repetitions; r++) {
+			unsigned long long iterations;
+			double nsec = RunBenchmark(bench, minTimeSec, iterations);
+			if (r == 0 || nsec < bestNsec) {
+				bestNsec = nsec;
+				bestIterations = iterations;
+			}
+		}
+		if (json) {
+			cout << fixed << setprecision(2) << "{\"name\":\"" << bench.name << "\",\"ns_per_op\":" << bestNsec
+				 << ",\"iterations\":" << bestIterations << "}" << endl;
+		} else {
+			cout << setw(45) << left << bench.name << right << fixed << setprecision(1)
+				 << setw(12) << bestNsec << " ns" << setw(15) << bestIterations << endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+// Unit tests for PokerTH
+//
+// Every test is a function which checks its results with UNITTEST_CHECK.
+// The exit code is the number of failed tests, so that the tests can be
+// run by scripts.
+
+#include <tests/unittest.h>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <iostream>
+#include <cstdio>
+
+using namespace std;
+namespace po = boost::program_options;
+
+typedef void (*UnitTestFunc)();
+
+static unsigned g_numFailedChecks;
+
+void
+UnitTestFail(const char *file, int line, const char *expr)
+{
+	cout << file << ":" << line << ": check failed: " << expr << endl;
+	g_numFailedChecks++;
+}
+
+UnitTestTempFile::UnitTestTempFile(const string &extension)
+{
+	boost::filesystem::path tmpPath(boost::filesystem::temp_directory_path());
+	tmpPath /= boost::filesystem::unique_path("pokerth-test-%%%%-%%%%-%%%%" + extension);
+	m_name = tmpPath.string();
+}
+
+UnitTestTempFile::~UnitTestTempFile()
+{
+	remove(m_name.c_str());
+}
+
+struct UnitTest {
+	const char *name;
+	UnitTestFunc func;
+};
+
+static const UnitTest AllTests[] = {
+	{ "LocalBoard/distributePot/reference", &TestDistributePotReference },
+	{ "BoardOddsCache/reference", &TestBoardOddsCacheReference },
+	{ "HandHistory/varint", &TestHandHistoryVarint },
+	{ "HandHistory/roundTrip", &TestHandHistoryRoundTrip },
+	{ "ConfigFile/keys", &TestConfigFileKeys },
+	{ "ConfigFile/readAfterWrite", &TestConfigFileReadAfterWrite },
+	{ "ConfigFile/concurrentReads", &TestConfigFileConcurrentReads },
+	{ "NamePatternMatcher/match", &TestNamePatternMatcher },
+	{ "NamePatternMatcher/backReference", &TestNamePatternMatcherBackReference },
+	{ "DownloaderThread/transfers", &TestDownloaderThread },
+	{ "UploaderThread/transfers", &TestUploaderThread },
+	{ "LogHelper/levelOrderShutdown", &TestLogHelper },
+	{ "ChatCleaner/ahoCorasick/overlapping", &TestAhoCorasickOverlapping },
+	{ "ChatCleaner/ahoCorasick/caseFolding", &TestAhoCorasickCaseFolding },
+	{ "ChatCleaner/badWordCheck/exceptions", &TestBadWordCheckExceptions },
+	{ "ChatCleaner/urlCheck/exceptions", &TestUrlCheckExceptions },
+	{ "ChatCleaner/flatHashMap", &TestFlatHashMap },
+	{ "ChatCleaner/textFloodCheck/decay", &TestTextFloodCheckDecay },
+	{ "WebSocketDeflate/negotiation", &TestWebSocketDeflateNegotiation },
+	{ "WebSocketDeflate/roundTrip", &TestWebSocketDeflateRoundTrip },
+	{ "WebSocketDeflate/sizeLimit", &TestWebSocketDeflateSizeLimit },
+	{ "ServerGame/snapshotRejoin", &TestServerGameSnapshotRejoin },
+	{ "ServerSpectatorFanout/order", &TestServerSpectatorFanoutOrder },
+	{ "ServerSpectatorFanout/flush", &TestServerSpectatorFanoutFlush },
+	{ "ServerSpectatorFanout/direct", &TestServerSpectatorFanoutDirect },
+	{ "AvatarManager/packetCache", &TestAvatarPacketCache },
+	{ "AvatarManager/cacheIndex", &TestAvatarCacheIndex },
+	{ "AvatarManager/cacheRevalidation", &TestAvatarCacheRevalidation },
+	{ "ServerAuth/pool", &TestServerAuthPool },
+	{ "ServerAuth/cache", &TestServerAuthCache },
+	{ "IPAddressTrie/match", &TestIPAddressTrie }
+};
+
+int
+main(int argc, char *argv[])
+{
+	string filter;
+	{
+		// Check command line options.
+		po::options_description desc("Allowed options");
+		desc.add_options()
+		("help,h", "produce help message")
+		("filter,f", po::value<string>(&filter), "run only tests containing this string")
+		;
+
+		po::variables_map vm;
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::notify(vm);
+
+		if (vm.count("help")) {
+			cout << desc << endl;
+			return 1;
+		}
+	}
+
+	int numFailedTests = 0;
+	for (size_t i = 0; i < sizeof(AllTests) / sizeof(AllTests[0]); i++) {
+		const UnitTest &test = AllTests[i];
+		if (!filter.empty() && string(test.name).find(filter) == string::npos)
+			continue;
+		unsigned prevFailedChecks = g_numFailedChecks;
+		test.func();
+		bool failed = g_numFailedChecks != prevFailedChecks;
+		cout << (failed ? "FAILED " : "OK     ") << test.name << endl;
+		if (failed)
+			numFailedTests++;
+	}
+	return numFailedTests;
+}
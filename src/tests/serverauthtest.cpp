@@ -0,0 +1,218 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <net/serverauthcache.h>
+#include <net/serverauthpool.h>
+#include <net/sessiondata.h>
+#include <net/sessiondatacallback.h>
+#include <boost/bind.hpp>
+#include <vector>
+
+using namespace std;
+
+#define AUTH_TEST_WAIT_MSEC		10000
+
+class AuthTestCallback : public SessionDataCallback
+{
+public:
+	virtual void CloseSession(boost::shared_ptr<SessionData> /*session*/) {}
+	virtual void SessionError(boost::shared_ptr<SessionData> /*session*/, int /*errorCode*/) {}
+	virtual void SessionTimeoutWarning(boost::shared_ptr<SessionData> /*session*/, unsigned /*remainingSec*/) {}
+	virtual void HandlePacket(boost::shared_ptr<SessionData> /*session*/, boost::shared_ptr<NetPacket> /*packet*/) {}
+	virtual unsigned GetSpectatorFlushDelayMsec() const
+	{
+		return 0;
+	}
+};
+
+struct AuthTestResults {
+	void Handle(boost::shared_ptr<SessionData> session, bool result)
+	{
+		sessions.push_back(session);
+		results.push_back(result);
+	}
+
+	// Run the handlers, which are posted to the lobby io service.
+	bool WaitForResults(boost::asio::io_service &ioService, size_t num)
+	{
+		boost::system_time deadline(boost::get_system_time() + boost::posix_time::milliseconds(AUTH_TEST_WAIT_MSEC));
+		while (sessions.size() < num) {
+			if (boost::get_system_time() > deadline)
+				return false;
+			ioService.reset();
+			if (!ioService.poll())
+				boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+		}
+		return sessions.size() == num;
+	}
+
+	vector<boost::shared_ptr<SessionData> > sessions;
+	vector<bool> results;
+};
+
+static boost::shared_ptr<SessionData>
+CreateAuthTestSession(boost::asio::io_service &ioService, AuthTestCallback &callback, SessionId id, const string &addr)
+{
+	boost::shared_ptr<boost::asio::ip::tcp::socket> sock(new boost::asio::ip::tcp::socket(ioService));
+	boost::shared_ptr<SessionData> session(new SessionData(sock, id, callback, ioService));
+	session->SetClientAddr(addr);
+	return session;
+}
+
+void
+TestServerAuthPool()
+{
+	boost::shared_ptr<boost::asio::io_service> ioService(new boost::asio::io_service);
+	AuthTestCallback callback;
+	AuthTestResults testResults;
+	ServerAuthPool::ResultHandler handler(boost::bind(&AuthTestResults::Handle, &testResults, _1, _2));
+	boost::shared_ptr<SessionData> sessions[5];
+	for (unsigned i = 0; i < 4; i++)
+		sessions[i] = CreateAuthTestSession(*ioService, callback, i + 1, "192.0.2.1");
+	sessions[4] = CreateAuthTestSession(*ioService, callback, 5, "2001:db8::1");
+	boost::weak_ptr<SessionData> closedSession(sessions[4]);
+
+	{
+		// The steps stay queued until the pool is started.
+		ServerAuthPool pool(ioService, 2, 3);
+		UNITTEST_CHECK(pool.AsyncAuthStep(sessions[0], 2, "", handler));
+		UNITTEST_CHECK(pool.AsyncAuthStep(sessions[1], 2, "", handler));
+		UNITTEST_CHECK(pool.AsyncAuthStep(sessions[2], 2, "", handler));
+		// At most 3 steps per client address.
+		UNITTEST_CHECK(!pool.AsyncAuthStep(sessions[3], 2, "", handler));
+		UNITTEST_CHECK(pool.AsyncAuthStep(sessions[4], 2, "", handler));
+		unsigned curQueued, maxQueued, numSteps;
+		pool.GetQueueStats(curQueued, maxQueued, numSteps);
+		UNITTEST_CHECK(curQueued == 4 && maxQueued == 4 && numSteps == 0);
+
+		// The session goes away while its step is in flight.
+		sessions[4]->SetState(SessionData::Closed);
+		sessions[4].reset();
+		UNITTEST_CHECK(!closedSession.expired());
+
+		pool.Start();
+		UNITTEST_CHECK(testResults.WaitForResults(*ioService, 4));
+		pool.GetQueueStats(curQueued, maxQueued, numSteps);
+		UNITTEST_CHECK(curQueued == 0 && numSteps == 4);
+		// Without a SCRAM session, all steps fail.
+		for (size_t i = 0; i < testResults.results.size(); i++) {
+			UNITTEST_CHECK(!testResults.results[i]);
+		}
+		// The handler still gets the closed session, the lobby ignores it.
+		bool closedFound = false;
+		for (size_t i = 0; i < testResults.sessions.size(); i++) {
+			if (testResults.sessions[i]->GetId() == 5) {
+				UNITTEST_CHECK(testResults.sessions[i]->GetState() == SessionData::Closed);
+				closedFound = true;
+			}
+		}
+		UNITTEST_CHECK(closedFound);
+		testResults.sessions.clear();
+		UNITTEST_CHECK(closedSession.expired());
+
+		// Finished steps no longer count for the address.
+		UNITTEST_CHECK(pool.AsyncAuthStep(sessions[3], 2, "", handler));
+		UNITTEST_CHECK(testResults.WaitForResults(*ioService, 1));
+		testResults.sessions.clear();
+		pool.Stop();
+	}
+
+	boost::weak_ptr<SessionData> queuedRef;
+	{
+		// Steps which are still queued on destruction release their session.
+		ServerAuthPool pool(ioService, 1, 0);
+		boost::shared_ptr<SessionData> queuedSession(CreateAuthTestSession(*ioService, callback, 6, "192.0.2.1"));
+		queuedRef = queuedSession;
+		UNITTEST_CHECK(pool.AsyncAuthStep(queuedSession, 2, "", handler));
+		queuedSession.reset();
+		UNITTEST_CHECK(!queuedRef.expired());
+	}
+	UNITTEST_CHECK(queuedRef.expired());
+	ioService->reset();
+	ioService->poll();
+	UNITTEST_CHECK(testResults.sessions.empty());
+}
+
+void
+TestServerAuthCache()
+{
+	ServerAuthCache cache(1);
+	const string oldHash(ServerAuthCache::GetSecretHash("salt1", "oldpassword"));
+	const string newHash(ServerAuthCache::GetSecretHash("salt1", "newpassword"));
+	UNITTEST_CHECK(!oldHash.empty() && oldHash != newHash);
+	UNITTEST_CHECK(oldHash == ServerAuthCache::GetSecretHash("salt1", "oldpassword"));
+
+	string saltedPassword;
+	UNITTEST_CHECK(cache.GetSalt("player").empty());
+	UNITTEST_CHECK(!cache.Get("player", "salt1", oldHash, saltedPassword));
+	cache.Store("player", "salt1", oldHash, "key1");
+	UNITTEST_CHECK(cache.GetSalt("player") == "salt1");
+	UNITTEST_CHECK(cache.GetSalt("other").empty());
+	UNITTEST_CHECK(cache.Get("player", "salt1", oldHash, saltedPassword));
+	UNITTEST_CHECK(saltedPassword == "key1");
+
+	// The password was changed in the database.
+	saltedPassword.clear();
+	UNITTEST_CHECK(!cache.Get("player", "salt1", newHash, saltedPassword));
+	UNITTEST_CHECK(saltedPassword.empty());
+	// The key is bound to the salt which was sent to the client.
+	UNITTEST_CHECK(!cache.Get("player", "salt2", oldHash, saltedPassword));
+
+	// A new password replaces the entry.
+	cache.Store("player", "salt1", newHash, "key2");
+	UNITTEST_CHECK(!cache.Get("player", "salt1", oldHash, saltedPassword));
+	UNITTEST_CHECK(cache.Get("player", "salt1", newHash, saltedPassword));
+	UNITTEST_CHECK(saltedPassword == "key2");
+
+	cache.Remove("player");
+	UNITTEST_CHECK(cache.GetSalt("player").empty());
+	UNITTEST_CHECK(!cache.Get("player", "salt1", newHash, saltedPassword));
+
+	// Storing the same entry again keeps the timeout of the first login.
+	cache.Store("player", "salt1", oldHash, "key1");
+	boost::this_thread::sleep(boost::posix_time::milliseconds(600));
+	cache.Store("player", "salt1", oldHash, "key1");
+	boost::this_thread::sleep(boost::posix_time::milliseconds(600));
+	UNITTEST_CHECK(!cache.Get("player", "salt1", oldHash, saltedPassword));
+	UNITTEST_CHECK(cache.GetSalt("player").empty());
+
+	// An expired entry is replaced with a new timer.
+	cache.Store("player", "salt1", oldHash, "key3");
+	UNITTEST_CHECK(cache.Get("player", "salt1", oldHash, saltedPassword));
+	UNITTEST_CHECK(saltedPassword == "key3");
+
+	cache.RemoveExpired();
+	UNITTEST_CHECK(cache.GetSalt("player") == "salt1");
+	boost::this_thread::sleep(boost::posix_time::milliseconds(1100));
+	cache.RemoveExpired();
+	UNITTEST_CHECK(cache.GetSalt("player").empty());
+}
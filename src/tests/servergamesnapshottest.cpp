@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <net/servergame.h>
+#include <net/netpacket.h>
+
+using namespace std;
+
+static boost::shared_ptr<NetPacket>
+CreateTestGameSnapshot(unsigned dealerId, const unsigned *playerIds, int numPlayers)
+{
+	boost::shared_ptr<NetPacket> packet(new NetPacket);
+	packet->GetMsg()->set_messagetype(PokerTHMessage::Type_GameMessage);
+	GameMessage *netGame = packet->GetMsg()->mutable_gamemessage();
+	netGame->set_gameid(1);
+	netGame->set_messagetype(GameMessage::Type_GameManagementMessage);
+	GameManagementMessage *netManage = netGame->mutable_gamemanagementmessage();
+	netManage->set_messagetype(GameManagementMessage::Type_GameStartRejoinMessage);
+	GameStartRejoinMessage *netGameStart = netManage->mutable_gamestartrejoinmessage();
+	netGameStart->set_startdealerplayerid(dealerId);
+	netGameStart->set_handnum(3);
+	for (int i = 0; i < numPlayers; i++) {
+		GameStartRejoinMessage::RejoinPlayerData *playerSlot = netGameStart->add_rejoinplayerdata();
+		playerSlot->set_playerid(playerIds[i]);
+		playerSlot->set_playermoney(1000 + i);
+	}
+	return packet;
+}
+
+static const GameStartRejoinMessage &
+GetRejoinMessage(const NetPacket &packet)
+{
+	return packet.GetMsg()->gamemessage().gamemanagementmessage().gamestartrejoinmessage();
+}
+
+void
+TestServerGameSnapshotRejoin()
+{
+	static const unsigned playerIds[] = { 11, 12, 13, 14 };
+	// The cached snapshot of the hand, as kept by the server game.
+	boost::shared_ptr<NetPacket> snapshot(CreateTestGameSnapshot(12, playerIds, 4));
+	const string original(snapshot->GetMsg()->SerializeAsString());
+
+	// First rejoin: player 11 becomes 21 and is sent the snapshot.
+	snapshot = ServerGame::CopyGameSnapshotReplacePlayer(*snapshot, 11, 21);
+	boost::shared_ptr<NetPacket> firstSent(snapshot);
+	string firstData(firstSent->GetMsg()->SerializeAsString());
+
+	// Second rejoin in the same hand: the dealer 12 becomes 22.
+	snapshot = ServerGame::CopyGameSnapshotReplacePlayer(*snapshot, 12, 22);
+	const GameStartRejoinMessage &second = GetRejoinMessage(*snapshot);
+	UNITTEST_CHECK(second.startdealerplayerid() == 22);
+	UNITTEST_CHECK(second.handnum() == 3);
+	UNITTEST_CHECK(second.rejoinplayerdata_size() == 4);
+	UNITTEST_CHECK(second.rejoinplayerdata(0).playerid() == 21);
+	UNITTEST_CHECK(second.rejoinplayerdata(1).playerid() == 22);
+	UNITTEST_CHECK(second.rejoinplayerdata(2).playerid() == 13);
+	UNITTEST_CHECK(second.rejoinplayerdata(3).playerid() == 14);
+	UNITTEST_CHECK(second.rejoinplayerdata(1).playermoney() == 1001);
+
+	// A packet which was already handed out is not modified by later rejoins.
+	UNITTEST_CHECK(firstSent != snapshot);
+	UNITTEST_CHECK(firstSent->GetMsg()->SerializeAsString() == firstData);
+	const GameStartRejoinMessage &first = GetRejoinMessage(*firstSent);
+	UNITTEST_CHECK(first.startdealerplayerid() == 12);
+	UNITTEST_CHECK(first.rejoinplayerdata(0).playerid() == 21);
+	UNITTEST_CHECK(first.rejoinplayerdata(1).playerid() == 12);
+
+	// Unknown ids leave the data unchanged.
+	boost::shared_ptr<NetPacket> unchanged(ServerGame::CopyGameSnapshotReplacePlayer(*CreateTestGameSnapshot(12, playerIds, 4), 99, 98));
+	UNITTEST_CHECK(unchanged->GetMsg()->SerializeAsString() == original);
+}
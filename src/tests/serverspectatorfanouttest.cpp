@@ -0,0 +1,273 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <net/serverspectatorfanout.h>
+#include <net/sessiondata.h>
+#include <net/sessiondatacallback.h>
+#include <net/sendbuffer.h>
+#include <net/netpacket.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+#define SPECTATOR_TEST_NUM_SESSIONS		3
+#define SPECTATOR_TEST_NUM_PACKETS		300
+#define SPECTATOR_TEST_WAIT_MSEC		10000
+#define SPECTATOR_TEST_DELAY_MSEC		200
+
+typedef vector<unsigned> PacketIdList;
+
+class SpectatorTestCallback : public SessionDataCallback
+{
+public:
+	virtual void CloseSession(boost::shared_ptr<SessionData> /*session*/) {}
+	virtual void SessionError(boost::shared_ptr<SessionData> /*session*/, int /*errorCode*/) {}
+	virtual void SessionTimeoutWarning(boost::shared_ptr<SessionData> /*session*/, unsigned /*remainingSec*/) {}
+	virtual void HandlePacket(boost::shared_ptr<SessionData> /*session*/, boost::shared_ptr<NetPacket> /*packet*/) {}
+	virtual unsigned GetSpectatorFlushDelayMsec() const
+	{
+		return 0;
+	}
+};
+
+// Spectator sessions connected via loopback, the sent data is read by the test.
+class SpectatorTestSessions
+{
+public:
+	SpectatorTestSessions(unsigned numSessions)
+		: m_ioWork(new boost::asio::io_service::work(m_ioService)),
+		  m_acceptor(m_ioService, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+	{
+		for (unsigned i = 0; i < numSessions; i++) {
+			boost::shared_ptr<tcp::socket> client(new tcp::socket(m_clientService));
+			client->connect(m_acceptor.local_endpoint());
+			client->non_blocking(true);
+			boost::shared_ptr<tcp::socket> server(new tcp::socket(m_ioService));
+			m_acceptor.accept(*server);
+			m_clients.push_back(client);
+			m_sessions.push_back(boost::shared_ptr<SessionData>(new SessionData(server, i + 1, m_callback, m_ioService)));
+		}
+		m_ioThread = boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService));
+	}
+
+	~SpectatorTestSessions()
+	{
+		m_ioWork.reset();
+		m_ioService.stop();
+		m_ioThread.join();
+		m_sessions.clear();
+	}
+
+	const SessionDataList &GetSessions() const
+	{
+		return m_sessions;
+	}
+
+	// Read the given number of packets sent to a session, returns their ids.
+	PacketIdList ReadPackets(unsigned sessionIndex, unsigned num)
+	{
+		PacketIdList ids;
+		string data;
+		boost::system_time deadline(boost::get_system_time() + boost::posix_time::milliseconds(SPECTATOR_TEST_WAIT_MSEC));
+		while (ids.size() < num && boost::get_system_time() < deadline) {
+			char buf[4096];
+			boost::system::error_code ec;
+			size_t bytesRead = m_clients[sessionIndex]->read_some(boost::asio::buffer(buf), ec);
+			if (ec == boost::asio::error::would_block) {
+				boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+				continue;
+			} else if (ec) {
+				break;
+			}
+			data.append(buf, bytesRead);
+			size_t pos = 0;
+			while (data.size() - pos >= NET_HEADER_SIZE) {
+				uint32_t nativeVal;
+				memcpy(&nativeVal, &data[pos], sizeof(uint32_t));
+				uint32_t packetSize = ntohl(nativeVal);
+				if (data.size() - pos - NET_HEADER_SIZE < packetSize)
+					break;
+				PokerTHMessage msg;
+				if (!msg.ParsePartialFromArray(&data[pos + NET_HEADER_SIZE], packetSize))
+					return ids;
+				ids.push_back(msg.gamemessage().gameid());
+				pos += NET_HEADER_SIZE + packetSize;
+			}
+			data.erase(0, pos);
+		}
+		return ids;
+	}
+
+	// Returns true if nothing was sent to a session.
+	bool IsIdle(unsigned sessionIndex)
+	{
+		return m_clients[sessionIndex]->available() == 0;
+	}
+
+private:
+	boost::asio::io_service m_ioService;
+	boost::asio::io_service m_clientService;
+	boost::scoped_ptr<boost::asio::io_service::work> m_ioWork;
+	tcp::acceptor m_acceptor;
+	SpectatorTestCallback m_callback;
+	vector<boost::shared_ptr<tcp::socket> > m_clients;
+	SessionDataList m_sessions;
+	boost::thread m_ioThread;
+};
+
+static boost::shared_ptr<NetPacket>
+CreateSpectatorTestPacket(unsigned id)
+{
+	boost::shared_ptr<NetPacket> packet(new NetPacket);
+	packet->GetMsg()->set_messagetype(PokerTHMessage::Type_GameMessage);
+	GameMessage *netGame = packet->GetMsg()->mutable_gamemessage();
+	netGame->set_gameid(id);
+	netGame->set_messagetype(GameMessage::Type_GameManagementMessage);
+	return packet;
+}
+
+// Direct sending of the game thread, like ServerGame::SendToSession.
+static void
+SendSpectatorTestPacket(boost::shared_ptr<SessionData> session, unsigned id)
+{
+	SendBuffer &tmpBuffer = session->GetSendBuffer();
+	boost::mutex::scoped_lock lock(tmpBuffer.dataMutex);
+	tmpBuffer.InternalStorePacket(session, CreateSpectatorTestPacket(id));
+	tmpBuffer.AsyncSendNextPacket(session);
+}
+
+static void
+FlushAndSendSpectatorTestPacket(boost::shared_ptr<ServerSpectatorChannel> channel, boost::shared_ptr<SessionData> session, unsigned id, bool *flushed)
+{
+	channel->Flush();
+	*flushed = true;
+	SendSpectatorTestPacket(session, id);
+}
+
+void
+TestServerSpectatorFanoutOrder()
+{
+	SpectatorTestSessions testSessions(SPECTATOR_TEST_NUM_SESSIONS);
+	ServerSpectatorFanout fanout(3);
+	fanout.Start();
+	boost::shared_ptr<ServerSpectatorChannel> channel(fanout.CreateChannel());
+
+	// Some packets are not sent to the last session, so the recipients change.
+	const SessionDataList &allSessions = testSessions.GetSessions();
+	SessionDataList someSessions(allSessions.begin(), allSessions.end() - 1);
+	vector<PacketIdList> expectedIds(SPECTATOR_TEST_NUM_SESSIONS);
+	for (unsigned id = 1; id <= SPECTATOR_TEST_NUM_PACKETS; id++) {
+		bool toAll = (id % 7) != 0;
+		channel->Publish(toAll ? allSessions : someSessions, CreateSpectatorTestPacket(id));
+		for (unsigned i = 0; i < SPECTATOR_TEST_NUM_SESSIONS; i++) {
+			if (toAll || i < SPECTATOR_TEST_NUM_SESSIONS - 1)
+				expectedIds[i].push_back(id);
+		}
+		if (id % 50 == 0)
+			boost::this_thread::yield();
+	}
+	// The fan-out threads deliver all packets without a flush, in the order they were published.
+	for (unsigned i = 0; i < SPECTATOR_TEST_NUM_SESSIONS; i++) {
+		UNITTEST_CHECK(testSessions.ReadPackets(i, expectedIds[i].size()) == expectedIds[i]);
+	}
+	fanout.Stop();
+}
+
+void
+TestServerSpectatorFanoutFlush()
+{
+	SpectatorTestSessions testSessions(1);
+	ServerSpectatorFanout fanout(1);
+	fanout.Start();
+	boost::shared_ptr<ServerSpectatorChannel> channel(fanout.CreateChannel());
+	boost::shared_ptr<SessionData> session(testSessions.GetSessions().front());
+
+	bool flushed = false;
+	boost::thread gameThread;
+	{
+		// Block the delivery of the fan-out thread while it is running.
+		boost::mutex::scoped_lock lock(session->GetSendBuffer().dataMutex);
+		channel->Publish(testSessions.GetSessions(), CreateSpectatorTestPacket(1));
+		boost::this_thread::sleep(boost::posix_time::milliseconds(SPECTATOR_TEST_DELAY_MSEC));
+		channel->Publish(testSessions.GetSessions(), CreateSpectatorTestPacket(2));
+		// The game thread flushes before sending directly, this needs to wait for the running delivery.
+		gameThread = boost::thread(boost::bind(&FlushAndSendSpectatorTestPacket, channel, session, 3, &flushed));
+		boost::this_thread::sleep(boost::posix_time::milliseconds(SPECTATOR_TEST_DELAY_MSEC));
+		UNITTEST_CHECK(!flushed);
+	}
+	gameThread.join();
+	UNITTEST_CHECK(flushed);
+	PacketIdList expectedIds;
+	expectedIds.push_back(1);
+	expectedIds.push_back(2);
+	expectedIds.push_back(3);
+	UNITTEST_CHECK(testSessions.ReadPackets(0, 3) == expectedIds);
+	fanout.Stop();
+}
+
+void
+TestServerSpectatorFanoutDirect()
+{
+	SpectatorTestSessions testSessions(2);
+	// ServerSpectatorThreads=0: the publishing thread delivers the data.
+	ServerSpectatorFanout fanout(0);
+	fanout.Start();
+	boost::shared_ptr<ServerSpectatorChannel> channel(fanout.CreateChannel());
+	const SessionDataList &allSessions = testSessions.GetSessions();
+	SessionDataList firstSession(allSessions.begin(), allSessions.begin() + 1);
+
+	channel->Publish(allSessions, CreateSpectatorTestPacket(1));
+	channel->Publish(firstSession, CreateSpectatorTestPacket(2));
+	SendSpectatorTestPacket(allSessions[1], 3);
+	channel->Publish(allSessions, CreateSpectatorTestPacket(4));
+	// Nothing is pending, a flush does not send anything.
+	channel->Flush();
+
+	PacketIdList expectedIds;
+	expectedIds.push_back(1);
+	expectedIds.push_back(2);
+	expectedIds.push_back(4);
+	UNITTEST_CHECK(testSessions.ReadPackets(0, 3) == expectedIds);
+	expectedIds.clear();
+	expectedIds.push_back(1);
+	expectedIds.push_back(3);
+	expectedIds.push_back(4);
+	UNITTEST_CHECK(testSessions.ReadPackets(1, 3) == expectedIds);
+	boost::this_thread::sleep(boost::posix_time::milliseconds(SPECTATOR_TEST_DELAY_MSEC));
+	UNITTEST_CHECK(testSessions.IsIdle(0));
+	UNITTEST_CHECK(testSessions.IsIdle(1));
+	fanout.Stop();
+}
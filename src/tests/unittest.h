@@ -0,0 +1,124 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Minimal support for the PokerTH unit tests. */
+
+#ifndef _UNITTEST_H_
+#define _UNITTEST_H_
+
+#include <string>
+
+// A failed check is reported, the test continues.
+#define UNITTEST_CHECK(cond) \
+	do { \
+		if (!(cond)) \
+			UnitTestFail(__FILE__, __LINE__, #cond); \
+	} while (0)
+
+void UnitTestFail(const char *file, int line, const char *expr);
+
+// Name of a file in the temp directory, which is removed on destruction.
+class UnitTestTempFile
+{
+public:
+	UnitTestTempFile(const std::string &extension);
+	~UnitTestTempFile();
+
+	const std::string &GetName() const
+	{
+		return m_name;
+	}
+
+private:
+	std::string m_name;
+};
+
+// localboardtest.cpp
+void TestDistributePotReference();
+
+// boardoddscachetest.cpp
+void TestBoardOddsCacheReference();
+
+// handhistorytest.cpp
+void TestHandHistoryVarint();
+void TestHandHistoryRoundTrip();
+
+// configfiletest.cpp
+void TestConfigFileKeys();
+void TestConfigFileReadAfterWrite();
+void TestConfigFileConcurrentReads();
+
+// namepatternmatchertest.cpp
+void TestNamePatternMatcher();
+void TestNamePatternMatcherBackReference();
+
+// downloaderthreadtest.cpp
+void TestDownloaderThread();
+
+// uploaderthreadtest.cpp
+void TestUploaderThread();
+
+// loghelpertest.cpp
+void TestLogHelper();
+
+// chatcleanertest.cpp
+void TestAhoCorasickOverlapping();
+void TestAhoCorasickCaseFolding();
+void TestBadWordCheckExceptions();
+void TestUrlCheckExceptions();
+void TestFlatHashMap();
+void TestTextFloodCheckDecay();
+
+// websocketdeflatetest.cpp
+void TestWebSocketDeflateNegotiation();
+void TestWebSocketDeflateRoundTrip();
+void TestWebSocketDeflateSizeLimit();
+
+// servergamesnapshottest.cpp
+void TestServerGameSnapshotRejoin();
+
+// serverspectatorfanouttest.cpp
+void TestServerSpectatorFanoutOrder();
+void TestServerSpectatorFanoutFlush();
+void TestServerSpectatorFanoutDirect();
+
+// avatarmanagertest.cpp
+void TestAvatarPacketCache();
+void TestAvatarCacheIndex();
+void TestAvatarCacheRevalidation();
+
+// serverauthtest.cpp
+void TestServerAuthPool();
+void TestServerAuthCache();
+
+// ipaddresstrietest.cpp
+void TestIPAddressTrie();
+
+#endif
@@ -0,0 +1,194 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittesthttpserver.h>
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/bind.hpp>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+using boost::asio::ip::tcp;
+
+
+struct UnitTestHttpServer::Connection {
+	Connection(boost::asio::io_service &io)
+		: socket(io), contentLength(0) {}
+
+	tcp::socket socket;
+	boost::asio::streambuf buf;
+	string path;
+	size_t contentLength;
+	string response;
+};
+
+UnitTestHttpServer::UnitTestHttpServer()
+	: m_acceptor(m_ioService, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+{
+	StartAccept();
+	m_thread = boost::thread(boost::bind(&UnitTestHttpServer::Run, this));
+}
+
+UnitTestHttpServer::~UnitTestHttpServer()
+{
+	m_ioService.stop();
+	m_thread.join();
+}
+
+void
+UnitTestHttpServer::AddResponse(const string &path, int status, const string &body)
+{
+	boost::mutex::scoped_lock lock(m_pathDataMutex);
+	m_pathData[path].responses.push_back(Response(status, body));
+}
+
+string
+UnitTestHttpServer::GetUrl(const string &path) const
+{
+	ostringstream url;
+	url << "http://127.0.0.1:" << m_acceptor.local_endpoint().port() << path;
+	return url.str();
+}
+
+unsigned
+UnitTestHttpServer::GetNumRequests(const string &path) const
+{
+	boost::mutex::scoped_lock lock(m_pathDataMutex);
+	PathDataMap::const_iterator pos = m_pathData.find(path);
+	return pos != m_pathData.end() ? pos->second.numRequests : 0;
+}
+
+string
+UnitTestHttpServer::GetLastRequestBody(const string &path) const
+{
+	boost::mutex::scoped_lock lock(m_pathDataMutex);
+	PathDataMap::const_iterator pos = m_pathData.find(path);
+	return pos != m_pathData.end() ? pos->second.lastRequestBody : string();
+}
+
+void
+UnitTestHttpServer::Run()
+{
+	m_ioService.run();
+}
+
+void
+UnitTestHttpServer::StartAccept()
+{
+	boost::shared_ptr<Connection> conn(new Connection(m_ioService));
+	m_acceptor.async_accept(conn->socket,
+							boost::bind(&UnitTestHttpServer::HandleAccept, this, conn, boost::asio::placeholders::error));
+}
+
+void
+UnitTestHttpServer::HandleAccept(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec)
+{
+	if (ec)
+		return;
+	boost::asio::async_read_until(conn->socket, conn->buf, "\r\n\r\n",
+								  boost::bind(&UnitTestHttpServer::HandleHeader, this, conn, boost::asio::placeholders::error));
+	StartAccept();
+}
+
+void
+UnitTestHttpServer::HandleHeader(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec)
+{
+	if (ec)
+		return;
+	istream stream(&conn->buf);
+	string method;
+	string line;
+	stream >> method >> conn->path;
+	getline(stream, line);
+	bool expectContinue = false;
+	while (getline(stream, line) && line != "\r") {
+		boost::algorithm::to_lower(line);
+		if (line.compare(0, 15, "content-length:") == 0)
+			conn->contentLength = strtoul(line.c_str() + 15, NULL, 10);
+		else if (line.compare(0, 20, "expect: 100-continue") == 0)
+			expectContinue = true;
+	}
+	// The remaining buffer contains the start of the request body.
+	if (conn->buf.size() < conn->contentLength) {
+		if (expectContinue && !conn->buf.size()) {
+			boost::system::error_code writeEc;
+			boost::asio::write(conn->socket, boost::asio::buffer(string("HTTP/1.1 100 Continue\r\n\r\n")), writeEc);
+		}
+		boost::asio::async_read(conn->socket, conn->buf, boost::asio::transfer_exactly(conn->contentLength - conn->buf.size()),
+								boost::bind(&UnitTestHttpServer::HandleBody, this, conn, boost::asio::placeholders::error));
+	} else
+		SendResponse(conn);
+}
+
+void
+UnitTestHttpServer::HandleBody(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec)
+{
+	if (ec)
+		return;
+	SendResponse(conn);
+}
+
+void
+UnitTestHttpServer::SendResponse(boost::shared_ptr<Connection> conn)
+{
+	Response response(404, "");
+	{
+		boost::mutex::scoped_lock lock(m_pathDataMutex);
+		PathData &data = m_pathData[conn->path];
+		data.numRequests++;
+		data.lastRequestBody.assign(boost::asio::buffers_begin(conn->buf.data()), boost::asio::buffers_end(conn->buf.data()));
+		if (!data.responses.empty()) {
+			response = data.responses.front();
+			if (data.responses.size() > 1)
+				data.responses.pop_front();
+		}
+	}
+	if (!response.status) {
+		m_openConnections.push_back(conn);
+		return;
+	}
+	ostringstream msg;
+	msg << "HTTP/1.1 " << response.status << (response.status < 400 ? " OK" : " Error") << "\r\n"
+		<< "Content-Length: " << response.body.size() << "\r\n"
+		<< "Connection: close\r\n\r\n"
+		<< response.body;
+	conn->response = msg.str();
+	boost::asio::async_write(conn->socket, boost::asio::buffer(conn->response),
+							 boost::bind(&UnitTestHttpServer::HandleWrite, this, conn, boost::asio::placeholders::error));
+}
+
+void
+UnitTestHttpServer::HandleWrite(boost::shared_ptr<Connection> conn, const boost::system::error_code &/*ec*/)
+{
+	boost::system::error_code ec;
+	conn->socket.shutdown(tcp::socket::shutdown_both, ec);
+	conn->socket.close(ec);
+}
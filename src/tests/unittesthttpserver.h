@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+/* Local HTTP server for the network transfer unit tests. */
+
+#ifndef _UNITTESTHTTPSERVER_H_
+#define _UNITTESTHTTPSERVER_H_
+
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <list>
+#include <map>
+#include <string>
+
+// Answers requests on the loopback interface in a separate thread.
+// Every connection is closed after one response.
+class UnitTestHttpServer
+{
+public:
+	UnitTestHttpServer();
+	~UnitTestHttpServer();
+
+	// Requests for a path receive the added responses in order, the last
+	// one is repeated. Unknown paths receive 404. Requests with a status
+	// of 0 are never answered, but the connection stays open.
+	void AddResponse(const std::string &path, int status, const std::string &body = std::string());
+
+	std::string GetUrl(const std::string &path) const;
+	unsigned GetNumRequests(const std::string &path) const;
+	std::string GetLastRequestBody(const std::string &path) const;
+
+private:
+	struct Response {
+		Response() : status(0) {}
+		Response(int s, const std::string &b) : status(s), body(b) {}
+
+		int status;
+		std::string body;
+	};
+	struct PathData {
+		PathData() : numRequests(0) {}
+
+		std::list<Response> responses;
+		unsigned numRequests;
+		std::string lastRequestBody;
+	};
+	struct Connection;
+	typedef std::map<std::string, PathData> PathDataMap;
+
+	void Run();
+	void StartAccept();
+	void HandleAccept(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec);
+	void HandleHeader(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec);
+	void HandleBody(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec);
+	void HandleWrite(boost::shared_ptr<Connection> conn, const boost::system::error_code &ec);
+	void SendResponse(boost::shared_ptr<Connection> conn);
+
+	boost::asio::io_service m_ioService;
+	boost::asio::ip::tcp::acceptor m_acceptor;
+	// Connections of requests which are never answered.
+	std::list<boost::shared_ptr<Connection> > m_openConnections;
+	PathDataMap m_pathData;
+	mutable boost::mutex m_pathDataMutex;
+	boost::thread m_thread;
+};
+
+#endif
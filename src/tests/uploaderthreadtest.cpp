@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <tests/unittesthttpserver.h>
+#include <net/uploaderthread.h>
+#include <net/uploadcallback.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+using namespace std;
+
+#define UPLOAD_TEST_RETRY_DELAY_MSEC	10
+#define UPLOAD_TEST_TIMEOUT_SEC			1
+#define UPLOAD_TEST_WAIT_MSEC			10000
+
+class UploadTestCallback : public UploadCallback
+{
+public:
+	UploadTestCallback() : numCompleted(0), numErrors(0) {}
+
+	virtual void UploadCompleted(const string &/*filename*/, const string &returnMessage)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		numCompleted++;
+		lastReturnMessage = returnMessage;
+		cond.notify_all();
+	}
+
+	virtual void UploadError(const string &/*filename*/, const string &/*errorMessage*/)
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		numErrors++;
+		cond.notify_all();
+	}
+
+	bool WaitForCalls(unsigned num)
+	{
+		boost::system_time deadline(boost::get_system_time() + boost::posix_time::milliseconds(UPLOAD_TEST_WAIT_MSEC));
+		boost::mutex::scoped_lock lock(mutex);
+		while (numCompleted + numErrors < num) {
+			if (!cond.timed_wait(lock, deadline))
+				return false;
+		}
+		return true;
+	}
+
+	unsigned numCompleted;
+	unsigned numErrors;
+	string lastReturnMessage;
+	boost::mutex mutex;
+	boost::condition_variable cond;
+};
+
+void
+TestUploaderThread()
+{
+	const string fileData("avatar data");
+	UnitTestTempFile tmpFile(".png");
+	{
+		ofstream o(tmpFile.GetName().c_str(), ios_base::out | ios_base::binary);
+		o << fileData;
+	}
+	const string name(boost::filesystem::path(tmpFile.GetName()).filename().string());
+
+	UnitTestHttpServer server;
+	// The first attempt fails, the retry succeeds.
+	server.AddResponse("/retry/" + name, 500);
+	server.AddResponse("/retry/" + name, 200, "done");
+	// Error pages must not be reported as successful upload.
+	server.AddResponse("/denied/" + name, 403, "forbidden");
+
+	UploadTestCallback callback;
+	UploaderThread uploader(&callback, UPLOADER_MAX_PARALLEL_TRANSFERS, UPLOAD_TEST_RETRY_DELAY_MSEC);
+	uploader.Run();
+	uploader.QueueUpload(server.GetUrl("/retry/"), "", "", tmpFile.GetName(), fileData.size());
+	uploader.QueueUpload(server.GetUrl("/denied/"), "", "", tmpFile.GetName(), fileData.size());
+
+	UNITTEST_CHECK(callback.WaitForCalls(2));
+	{
+		boost::mutex::scoped_lock lock(callback.mutex);
+		UNITTEST_CHECK(callback.numCompleted == 1);
+		UNITTEST_CHECK(callback.numErrors == 1);
+		UNITTEST_CHECK(callback.lastReturnMessage == "done");
+	}
+	UNITTEST_CHECK(server.GetNumRequests("/retry/" + name) == 2);
+	UNITTEST_CHECK(server.GetLastRequestBody("/retry/" + name) == fileData);
+	UNITTEST_CHECK(server.GetNumRequests("/denied/" + name) == 1 + UPLOADER_MAX_RETRIES);
+
+	uploader.SignalTermination();
+	UNITTEST_CHECK(uploader.Join(UPLOADER_THREAD_TERMINATE_TIMEOUT));
+
+	// A server which does not answer is retried after the timeout, and the
+	// pending upload is reported as failed on termination.
+	server.AddResponse("/hang/" + name, 0);
+	UploadTestCallback hangCallback;
+	UploaderThread hangUploader(&hangCallback, 1, UPLOAD_TEST_RETRY_DELAY_MSEC, UPLOAD_TEST_TIMEOUT_SEC);
+	hangUploader.Run();
+	hangUploader.QueueUpload(server.GetUrl("/hang/"), "", "", tmpFile.GetName(), fileData.size());
+	for (unsigned i = 0; i < UPLOAD_TEST_WAIT_MSEC / 10 && server.GetNumRequests("/hang/" + name) < 2; i++)
+		Thread::Msleep(10);
+	UNITTEST_CHECK(server.GetNumRequests("/hang/" + name) >= 2);
+	hangUploader.SignalTermination();
+	UNITTEST_CHECK(hangUploader.Join(UPLOADER_THREAD_TERMINATE_TIMEOUT));
+	{
+		boost::mutex::scoped_lock lock(hangCallback.mutex);
+		UNITTEST_CHECK(hangCallback.numCompleted == 0);
+		UNITTEST_CHECK(hangCallback.numErrors == 1);
+	}
+}
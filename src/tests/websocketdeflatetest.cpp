@@ -0,0 +1,235 @@
+/*****************************************************************************
+ * PokerTH - The open source texas holdem engine                             *
+ * Copyright (C) 2006-2012 Felix Hammer, Florian Thauer, Lothar May          *
+ *                                                                           *
+ * This program is free software: you can redistribute it and/or modify      *
+ * it under the terms of the GNU Affero General Public License as            *
+ * published by the Free Software Foundation, either version 3 of the        *
+ * License, or (at your option) any later version.                           *
+ *                                                                           *
+ * This program is distributed in the hope that it will be useful,           *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ * GNU Affero General Public License for more details.                       *
+ *                                                                           *
+ * You should have received a copy of the GNU Affero General Public License  *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.     *
+ *                                                                           *
+ *                                                                           *
+ * Additional permission under GNU AGPL version 3 section 7                  *
+ *                                                                           *
+ * If you modify this program, or any covered work, by linking or            *
+ * combining it with the OpenSSL project's OpenSSL library (or a             *
+ * modified version of that library), containing parts covered by the        *
+ * terms of the OpenSSL or SSLeay licenses, the authors of PokerTH           *
+ * (Felix Hammer, Florian Thauer, Lothar May) grant you additional           *
+ * permission to convey the resulting work.                                  *
+ * Corresponding Source for a non-source form of such a combination          *
+ * shall include the source code for the parts of OpenSSL used as well       *
+ * as that of the covered work.                                              *
+ *****************************************************************************/
+
+#include <tests/unittest.h>
+#include <net/websocketdeflate.h>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+typedef WebSocketDeflate<void> TestDeflate;
+
+static bool
+NegotiateDeflate(TestDeflate &deflate, const websocketpp::http::attribute_list &offer, string &response)
+{
+	TestDeflate::err_str_pair result(deflate.negotiate(offer));
+	response = result.second;
+	return !result.first;
+}
+
+static string
+TestDeflateMessage(unsigned num)
+{
+	ostringstream msg;
+	for (unsigned i = 0; i < 20; i++)
+		msg << "player " << (num + i) % 7 << " raises to " << (num * 31 + i) % 1000 << ";";
+	return msg.str();
+}
+
+// Inflates a message like the hybi13 processor does: the payload is passed
+// in fragments as frames arrive, the removed tail is passed after the last one.
+static websocketpp::lib::error_code
+InflateDeflateMessage(TestDeflate &deflate, const string &payload, size_t fragmentSize, string &out)
+{
+	static const uint8_t trailer[4] = { 0x00, 0x00, 0xff, 0xff };
+	websocketpp::lib::error_code ec;
+	for (size_t pos = 0; !ec && pos < payload.size(); pos += fragmentSize) {
+		size_t len = min(fragmentSize, payload.size() - pos);
+		ec = deflate.decompress(reinterpret_cast<const uint8_t *>(payload.data() + pos), len, out);
+	}
+	if (!ec)
+		ec = deflate.decompress(trailer, sizeof(trailer), out);
+	return ec;
+}
+
+// Compresses messages with the server side and inflates them with a second
+// instance, as a client would.
+static void
+CheckDeflateRoundTrip(const websocketpp::http::attribute_list &offer, size_t &totalSize)
+{
+	TestDeflate server;
+	TestDeflate client;
+	string response;
+	UNITTEST_CHECK(NegotiateDeflate(server, offer, response));
+	UNITTEST_CHECK(NegotiateDeflate(client, websocketpp::http::attribute_list(), response));
+	totalSize = 0;
+	for (unsigned i = 0; i < 20; i++) {
+		// Every third message is the same, so that the context can be used.
+		string msg(i % 3 ? TestDeflateMessage(i) : TestDeflateMessage(0));
+		string compressed;
+		UNITTEST_CHECK(!server.compress(msg, compressed));
+		// The tail of the sync flush is removed.
+		UNITTEST_CHECK(compressed.size() < 4 || compressed.compare(compressed.size() - 4, 4, string("\x00\x00\xff\xff", 4)) != 0);
+		totalSize += compressed.size();
+		string inflated;
+		UNITTEST_CHECK(!InflateDeflateMessage(client, compressed, i % 2 ? 7 : compressed.size(), inflated));
+		UNITTEST_CHECK(inflated == msg);
+	}
+	// An empty message is sent as a single byte.
+	string compressed;
+	UNITTEST_CHECK(!server.compress("", compressed));
+	UNITTEST_CHECK(!compressed.empty());
+	string inflated;
+	UNITTEST_CHECK(!InflateDeflateMessage(client, compressed, compressed.size(), inflated));
+	UNITTEST_CHECK(inflated.empty());
+}
+
+void
+TestWebSocketDeflateNegotiation()
+{
+	WebSocketDeflateSettings &settings = GetWebSocketDeflateSettings();
+	const WebSocketDeflateSettings oldSettings(settings);
+	string response;
+
+	settings.enabled = false;
+	{
+		TestDeflate deflate;
+		UNITTEST_CHECK(!NegotiateDeflate(deflate, websocketpp::http::attribute_list(), response));
+		UNITTEST_CHECK(!deflate.is_enabled());
+	}
+	settings.enabled = true;
+	settings.contextTakeover = true;
+	settings.maxWindowBits = 15;
+	{
+		TestDeflate deflate;
+		UNITTEST_CHECK(NegotiateDeflate(deflate, websocketpp::http::attribute_list(), response));
+		UNITTEST_CHECK(response == "permessage-deflate");
+		UNITTEST_CHECK(deflate.is_enabled());
+		// Only the first acceptable offer is accepted.
+		UNITTEST_CHECK(!NegotiateDeflate(deflate, websocketpp::http::attribute_list(), response));
+	}
+	{
+		TestDeflate deflate;
+		websocketpp::http::attribute_list offer;
+		offer["server_no_context_takeover"] = "";
+		offer["client_no_context_takeover"] = "";
+		offer["server_max_window_bits"] = "10";
+		offer["client_max_window_bits"] = "";
+		UNITTEST_CHECK(NegotiateDeflate(deflate, offer, response));
+		UNITTEST_CHECK(response == "permessage-deflate; server_no_context_takeover; server_max_window_bits=10");
+	}
+	// Unsupported parameters and values are declined.
+	static const char *const badOffers[][2] = {
+		{ "unknown_parameter", "" },
+		{ "server_no_context_takeover", "1" },
+		{ "client_no_context_takeover", "x" },
+		{ "server_max_window_bits", "8" },
+		{ "server_max_window_bits", "16" },
+		{ "server_max_window_bits", "" },
+		{ "server_max_window_bits", "+9" },
+		{ "client_max_window_bits", "7" },
+		{ "client_max_window_bits", "abc" }
+	};
+	for (size_t i = 0; i < sizeof(badOffers) / sizeof(badOffers[0]); i++) {
+		TestDeflate deflate;
+		websocketpp::http::attribute_list offer;
+		offer[badOffers[i][0]] = badOffers[i][1];
+		UNITTEST_CHECK(!NegotiateDeflate(deflate, offer, response));
+		UNITTEST_CHECK(!deflate.is_enabled());
+	}
+	// The server may disable context takeover itself.
+	settings.contextTakeover = false;
+	{
+		TestDeflate deflate;
+		UNITTEST_CHECK(NegotiateDeflate(deflate, websocketpp::http::attribute_list(), response));
+		UNITTEST_CHECK(response == "permessage-deflate; server_no_context_takeover");
+	}
+	settings = oldSettings;
+}
+
+void
+TestWebSocketDeflateRoundTrip()
+{
+	WebSocketDeflateSettings &settings = GetWebSocketDeflateSettings();
+	const WebSocketDeflateSettings oldSettings(settings);
+	settings.enabled = true;
+	settings.contextTakeover = true;
+	settings.maxWindowBits = 15;
+
+	size_t sizeWithContext = 0;
+	CheckDeflateRoundTrip(websocketpp::http::attribute_list(), sizeWithContext);
+	size_t sizeWithoutContext = 0;
+	websocketpp::http::attribute_list offer;
+	offer["server_no_context_takeover"] = "";
+	CheckDeflateRoundTrip(offer, sizeWithoutContext);
+	size_t sizeSmallWindow = 0;
+	offer.clear();
+	offer["server_max_window_bits"] = "9";
+	CheckDeflateRoundTrip(offer, sizeSmallWindow);
+	// Repeated messages are cheaper if the context is kept.
+	UNITTEST_CHECK(sizeWithContext < sizeWithoutContext);
+
+	settings = oldSettings;
+}
+
+void
+TestWebSocketDeflateSizeLimit()
+{
+	WebSocketDeflateSettings &settings = GetWebSocketDeflateSettings();
+	const WebSocketDeflateSettings oldSettings(settings);
+	settings.enabled = true;
+	settings.contextTakeover = true;
+	settings.maxWindowBits = 15;
+
+	TestDeflate server;
+	TestDeflate client;
+	string response;
+	UNITTEST_CHECK(NegotiateDeflate(server, websocketpp::http::attribute_list(), response));
+	UNITTEST_CHECK(NegotiateDeflate(client, websocketpp::http::attribute_list(), response));
+
+	// A message of exactly the limit is accepted.
+	string compressed;
+	UNITTEST_CHECK(!server.compress(string(WEBSOCKET_MAX_INFLATED_SIZE, 'x'), compressed));
+	string inflated;
+	UNITTEST_CHECK(!InflateDeflateMessage(client, compressed, compressed.size(), inflated));
+	UNITTEST_CHECK(inflated.size() == WEBSOCKET_MAX_INFLATED_SIZE);
+
+	// A small payload which inflates beyond the limit is rejected.
+	compressed.clear();
+	UNITTEST_CHECK(!server.compress(string(WEBSOCKET_MAX_INFLATED_SIZE * 4, 'x'), compressed));
+	UNITTEST_CHECK(compressed.size() < 4096);
+	TestDeflate bombClient;
+	UNITTEST_CHECK(NegotiateDeflate(bombClient, websocketpp::http::attribute_list(), response));
+	inflated.clear();
+	websocketpp::lib::error_code ec(InflateDeflateMessage(bombClient, compressed, compressed.size(), inflated));
+	UNITTEST_CHECK(ec == websocketpp::error::make_error_code(websocketpp::error::payload_violation));
+	UNITTEST_CHECK(inflated.size() <= WEBSOCKET_MAX_INFLATED_SIZE);
+
+	// Invalid deflate data is rejected.
+	TestDeflate badClient;
+	UNITTEST_CHECK(NegotiateDeflate(badClient, websocketpp::http::attribute_list(), response));
+	static const uint8_t badData[] = { 0xff, 0xff, 0xff, 0xff, 0xff };
+	inflated.clear();
+	UNITTEST_CHECK(InflateDeflateMessage(badClient, string(reinterpret_cast<const char *>(badData), sizeof(badData)), sizeof(badData), inflated));
+
+	settings = oldSettings;
+}
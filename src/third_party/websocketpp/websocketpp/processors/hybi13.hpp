@@ -391,6 +391,13 @@ public:
                             m_msg_manager->get_message(op,m_bytes_needed),
                             frame::get_masking_key(m_basic_header,m_extended_header)
                         );
+
+                        // Only the first frame of a message carries RSV1,
+                        // remember it for the continuation frames.
+                        m_data_msg.msg_ptr->set_compressed(
+                            m_permessage_deflate.is_enabled()
+                            && frame::get_rsv1(m_basic_header)
+                        );
                     } else {
                         // Fetch the underlying payload buffer from the data message we
                         // are writing into.
@@ -432,6 +439,17 @@ public:
                 // If this was the last frame in the message set the ready flag.
                 // Otherwise, reset processor state to read additional frames.
                 if (frame::get_fin(m_basic_header)) {
+                    // Compressed messages have the trailing empty deflate
+                    // block stripped by the sender, re-add it (RFC 7692 7.2.2).
+                    if (m_current_msg == &m_data_msg
+                        && m_data_msg.msg_ptr->get_compressed())
+                    {
+                        static uint8_t const trailer[4] = {0x00,0x00,0xff,0xff};
+                        ec = m_permessage_deflate.decompress(trailer,4,
+                            m_data_msg.msg_ptr->get_raw_payload());
+                        if (ec) {break;}
+                    }
+
                     // ensure that text messages end on a valid UTF8 code point
                     if (frame::get_opcode(m_basic_header) == frame::opcode::TEXT) {
                         if (!m_current_msg->validator.complete()) {
@@ -551,24 +569,18 @@ public:
                           && in->get_compressed();
         bool fin = in->get_fin();
 
-        // generate header
-        frame::basic_header h(op,i.size(),fin,masked,compressed);
-
         if (masked) {
             // Generate masking key.
             key.i = m_rng();
-
-            frame::extended_header e(i.size(),key.i);
-            out->set_header(frame::prepare_header(h,e));
-        } else {
-            frame::extended_header e(i.size());
-            out->set_header(frame::prepare_header(h,e));
         }
 
         // prepare payload
         if (compressed) {
             // compress and store in o after header.
-            m_permessage_deflate.compress(i,o);
+            lib::error_code ec = m_permessage_deflate.compress(i,o);
+            if (ec) {
+                return ec;
+            }
 
             // mask in place if necessary
             if (masked) {
@@ -588,6 +600,17 @@ public:
             }
         }
 
+        // generate header, the payload length is the length on the wire
+        frame::basic_header h(op,o.size(),fin,masked,compressed);
+
+        if (masked) {
+            frame::extended_header e(o.size(),key.i);
+            out->set_header(frame::prepare_header(h,e));
+        } else {
+            frame::extended_header e(o.size());
+            out->set_header(frame::prepare_header(h,e));
+        }
+
         out->set_prepared(true);
         out->set_opcode(op);
 
@@ -730,13 +753,13 @@ protected:
 
         // decompress message if needed.
         if (m_permessage_deflate.is_enabled()
-            && frame::get_rsv1(m_basic_header))
+            && m_current_msg->msg_ptr->get_compressed())
         {
             // Decompress current buffer into the message buffer
-            m_permessage_deflate.decompress(buf,len,out);
-
-            // get the length of the newly uncompressed output
-            offset = out.size() - offset;
+            ec = m_permessage_deflate.decompress(buf,len,out);
+            if (ec) {
+                return 0;
+            }
         } else {
             // No compression, straight copy
             out.append(reinterpret_cast<char *>(buf),len);